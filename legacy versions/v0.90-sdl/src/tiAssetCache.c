@@ -0,0 +1,1065 @@
+/****************************************************************************
+*
+* tiAssetCache.c - cache of loaded images
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+#include <SDL/SDL.h>
+#include <SDL/SDL_image.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiAssetCache.h"
+
+/****************************************************************************
+* assetCacheInitialize - see tiAssetCache.h for description
+****************************************************************************/
+TiAssetCache *assetCacheInitialize(unsigned long budget)
+{
+    TiAssetCache *cache;
+    int counter;
+
+    cache = malloc(sizeof(TiAssetCache));
+    if(cache == NULL)
+    {
+        return NULL;
+    }
+
+    cache->numEntries = 0;
+    cache->numAtlasImages = 0;
+    cache->packData = NULL;
+    cache->packSize = 0;
+    cache->packHeader = NULL;
+    cache->packImages = NULL;
+    cache->packMatchesDisplay = TI_FALSE;
+    cache->loader = NULL;
+    cache->loaderLock = NULL;
+    cache->loaderWork = NULL;
+    cache->loaderDone = NULL;
+    cache->loaderQuit = TI_FALSE;
+    for(counter=0;counter<TI_ASSET_LOADER_MAX_LOADS;counter++)
+    {
+        cache->loads[counter].state = TI_ASSET_LOAD_FREE;
+        cache->loads[counter].decoded = NULL;
+    }
+    cache->numLoadsPending = 0;
+    cache->bytesQueued = 0;
+    cache->bytesDecoded = 0;
+    cache->budget = budget;
+    cache->totalSize = 0;
+    cache->useCounter = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->evictions = 0;
+
+    return cache;
+}
+
+/****************************************************************************
+* assetCacheDestroy - see tiAssetCache.h for description
+****************************************************************************/
+void assetCacheDestroy(TiAssetCache **cache)
+{
+    int counter;
+
+    if(*cache == NULL)
+    {
+        return;
+    }
+
+    assetCacheStopLoader(*cache);
+    for(counter=0;counter<(*cache)->numEntries;counter++)
+    {
+        SDL_FreeSurface((*cache)->entries[counter].surface);
+    }
+    assetCacheClosePack(*cache);
+
+    free(*cache);
+    *cache = NULL;
+}
+
+/****************************************************************************
+* assetCacheLoadAtlasIndex - see tiAssetCache.h for description
+****************************************************************************/
+int assetCacheLoadAtlasIndex(TiAssetCache *cache, char *fileName)
+{
+    FILE *fp;
+    char curLine[TI_LINE_MAX + 2 * TI_ASSET_CACHE_MAX_NAME_LENGTH];
+    TiAtlasImage *image;
+    int x, y, w, h, result;
+
+    cache->numAtlasImages = 0;
+
+    fp = fopen(fileName, "r");
+    if(fp == NULL)
+    {
+        return TI_ERROR;
+    }
+
+    while(fgets(curLine, sizeof(curLine), fp) != NULL)
+    {
+        if(curLine[0] == '#' || curLine[0] == '\n')
+        {
+            continue;
+        }
+
+        if(cache->numAtlasImages >= TI_ATLAS_MAX_IMAGES)
+        {
+            perror("assetCacheLoadAtlasIndex: too many images");
+            break;
+        }
+
+        image = &(cache->atlasImages[cache->numAtlasImages]);
+        result = sscanf(curLine, "%63s %63s %d %d %d %d", image->fileName, 
+                        image->atlasFileName, &x, &y, &w, &h);
+        if(result != 6 || x < 0 || y < 0 || w <= 0 || h <= 0 || 
+           x + w > TI_ATLAS_SIZE || y + h > TI_ATLAS_SIZE)
+        {
+            perror("assetCacheLoadAtlasIndex: invalid line");
+            fclose(fp);
+            cache->numAtlasImages = 0;
+            return TI_ERROR;
+        }
+        image->rect.x = x;
+        image->rect.y = y;
+        image->rect.w = w;
+        image->rect.h = h;
+        cache->numAtlasImages++;
+    }
+
+    fclose(fp);
+    return TI_OK;
+}
+
+/****************************************************************************
+* assetCacheFindAtlasImage - see tiAssetCache.h for description
+****************************************************************************/
+TiAtlasImage *assetCacheFindAtlasImage(TiAssetCache *cache, char *fileName)
+{
+    int counter;
+
+    for(counter=0;counter<cache->numAtlasImages;counter++)
+    {
+        if(strcmp(cache->atlasImages[counter].fileName, fileName) == 0)
+        {
+            return &(cache->atlasImages[counter]);
+        }
+    }
+
+    return NULL;
+}
+
+/****************************************************************************
+* assetCacheOpenPack - see tiAssetCache.h for description
+****************************************************************************/
+int assetCacheOpenPack(TiAssetCache *cache, char *fileName)
+{
+    TiAssetPackHeader *header;
+    TiAssetPackImage *image;
+    SDL_Surface *screen;
+    unsigned long size;
+    void *data;
+    int counter;
+#ifdef _WIN32
+    FILE *fp;
+#else
+    struct stat info;
+    int fd;
+#endif
+
+    assetCacheClosePack(cache);
+
+#ifdef _WIN32
+    /* There's no mmap here, so the pack is read in -- which still beats
+       decoding it */
+    fp = fopen(fileName, "rb");
+    if(fp == NULL)
+    {
+        return TI_ERROR;
+    }
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    data = malloc(size);
+    if(data == NULL || fread(data, 1, size, fp) != size)
+    {
+        free(data);
+        fclose(fp);
+        return TI_ERROR;
+    }
+    fclose(fp);
+#else
+    fd = open(fileName, O_RDONLY);
+    if(fd < 0)
+    {
+        return TI_ERROR;
+    }
+    if(fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        return TI_ERROR;
+    }
+    size = info.st_size;
+
+    /* A private mapping, so that anything drawn onto an image can't reach
+       the file.  Pages that are only read are shared with the page cache,
+       and are simply dropped if memory runs short. */
+    data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED)
+    {
+        return TI_ERROR;
+    }
+#endif
+
+    cache->packData = data;
+    cache->packSize = size;
+
+    header = data;
+    if(size < sizeof(TiAssetPackHeader) ||
+       header->magic != TI_ASSET_PACK_MAGIC ||
+       header->version != TI_ASSET_PACK_VERSION ||
+       header->bitsPerPixel != TI_ASSET_PACK_BITS_PER_PIXEL ||
+       header->numImages > TI_ASSET_PACK_MAX_IMAGES ||
+       size < sizeof(TiAssetPackHeader) + header->numImages * sizeof(TiAssetPackImage))
+    {
+        perror("assetCacheOpenPack: not a valid pack file");
+        assetCacheClosePack(cache);
+        return TI_ERROR;
+    }
+
+    for(counter=0;counter<header->numImages;counter++)
+    {
+        image = (TiAssetPackImage *)(header + 1) + counter;
+        if(image->fileName[TI_ASSET_CACHE_MAX_NAME_LENGTH - 1] != '\0' ||
+           image->pitch < image->width * (TI_ASSET_PACK_BITS_PER_PIXEL / 8) ||
+           image->offset % TI_ASSET_PACK_ALIGNMENT != 0 ||
+           image->offset > size || 
+           (unsigned long)image->height * image->pitch > size - image->offset)
+        {
+            perror("assetCacheOpenPack: pack file is damaged");
+            assetCacheClosePack(cache);
+            return TI_ERROR;
+        }
+    }
+
+    cache->packHeader = header;
+    cache->packImages = (TiAssetPackImage *)(header + 1);
+
+    screen = renderBackendGetCurrent()->screen;
+    cache->packMatchesDisplay = (screen != NULL &&
+                                 screen->format->BitsPerPixel == header->bitsPerPixel &&
+                                 screen->format->Rmask == header->Rmask &&
+                                 screen->format->Gmask == header->Gmask &&
+                                 screen->format->Bmask == header->Bmask) ? TI_TRUE : TI_FALSE;
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* assetCacheClosePack - see tiAssetCache.h for description
+****************************************************************************/
+void assetCacheClosePack(TiAssetCache *cache)
+{
+    if(cache->packData != NULL)
+    {
+#ifdef _WIN32
+        free(cache->packData);
+#else
+        munmap(cache->packData, cache->packSize);
+#endif
+    }
+
+    cache->packData = NULL;
+    cache->packSize = 0;
+    cache->packHeader = NULL;
+    cache->packImages = NULL;
+    cache->packMatchesDisplay = TI_FALSE;
+}
+
+/****************************************************************************
+* assetCacheLoadPackedImage - see tiAssetCache.h for description
+****************************************************************************/
+SDL_Surface *assetCacheLoadPackedImage(TiAssetCache *cache, char *fileName)
+{
+    TiAssetPackImage *image;
+    SDL_Surface *surface, *converted;
+    Uint32 flags;
+    int counter;
+
+    if(cache->packHeader == NULL)
+    {
+        return NULL;
+    }
+
+    for(counter=0;counter<cache->packHeader->numImages;counter++)
+    {
+        image = &(cache->packImages[counter]);
+        if(strcmp(image->fileName, fileName) != 0)
+        {
+            continue;
+        }
+
+        surface = SDL_CreateRGBSurfaceFrom((Uint8 *)cache->packData + image->offset,
+                                           image->width, image->height, 
+                                           cache->packHeader->bitsPerPixel, image->pitch,
+                                           cache->packHeader->Rmask, cache->packHeader->Gmask,
+                                           cache->packHeader->Bmask, 0);
+        if(surface == NULL)
+        {
+            return NULL;
+        }
+
+        /* The key is set in the pack's format, before any conversion, so 
+           that the conversion maps it the same way as the pixels that use 
+           it (magenta in 16 bits doesn't come back out as 0xFF00FF) */
+        if(image->flags & TI_ASSET_PACK_COLORKEY)
+        {
+            flags = SDL_SRCCOLORKEY;
+            if(image->flags & TI_ASSET_PACK_RLE)
+            {
+                flags |= SDL_RLEACCEL;
+            }
+            SDL_SetColorKey(surface, flags, cache->packHeader->colorkey);
+        }
+
+        if(cache->packMatchesDisplay == TI_FALSE)
+        {
+            converted = renderBackendGetCurrent()->convertSurface(renderBackendGetCurrent(),
+                                                                  surface);
+            SDL_FreeSurface(surface);
+            if(converted == NULL)
+            {
+                return NULL;
+            }
+            surface = converted;
+        }
+
+        return surface;
+    }
+
+    return NULL;
+}
+
+/****************************************************************************
+* assetCacheAddEntry - see tiAssetCache.h for description
+****************************************************************************/
+TiAssetCacheEntry *assetCacheAddEntry(TiAssetCache *cache, char *fileName, 
+                                      SDL_Surface *surface, SDL_Surface *atlas)
+{
+    TiAssetCacheEntry *entry;
+
+    if(cache->numEntries >= TI_ASSET_CACHE_MAX_ENTRIES)
+    {
+        return NULL;
+    }
+
+    entry = &(cache->entries[cache->numEntries++]);
+    strcpy(entry->fileName, fileName);
+    entry->surface = surface;
+    entry->atlas = atlas;
+    entry->refCount = 0;
+    /* An image in an atlas takes up no memory of its own */
+    entry->size = (atlas != NULL) ? 0 : (unsigned long)surface->h * surface->pitch;
+    entry->lastUsed = cache->useCounter;
+    entry->prefetched = TI_FALSE;
+    cache->totalSize += entry->size;
+
+    return entry;
+}
+
+/****************************************************************************
+* assetCacheStartLoader - see tiAssetCache.h for description
+****************************************************************************/
+int assetCacheStartLoader(TiAssetCache *cache)
+{
+    if(cache->loader != NULL)
+    {
+        return TI_OK;
+    }
+
+    cache->loaderLock = SDL_CreateMutex();
+    cache->loaderWork = SDL_CreateCond();
+    cache->loaderDone = SDL_CreateCond();
+    cache->loaderQuit = TI_FALSE;
+    if(cache->loaderLock != NULL && cache->loaderWork != NULL && cache->loaderDone != NULL)
+    {
+        cache->loader = SDL_CreateThread(assetCacheLoaderThread, cache);
+    }
+
+    if(cache->loader == NULL)
+    {
+        perror("assetCacheStartLoader: unable to start the loader thread");
+        assetCacheStopLoader(cache);
+        return TI_ERROR;
+    }
+    return TI_OK;
+}
+
+/****************************************************************************
+* assetCacheStopLoader - see tiAssetCache.h for description
+****************************************************************************/
+void assetCacheStopLoader(TiAssetCache *cache)
+{
+    int counter;
+
+    if(cache->loader != NULL)
+    {
+        SDL_mutexP(cache->loaderLock);
+        cache->loaderQuit = TI_TRUE;
+        SDL_CondSignal(cache->loaderWork);
+        SDL_mutexV(cache->loaderLock);
+        SDL_WaitThread(cache->loader, NULL);
+        cache->loader = NULL;
+    }
+
+    for(counter=0;counter<TI_ASSET_LOADER_MAX_LOADS;counter++)
+    {
+        if(cache->loads[counter].decoded != NULL)
+        {
+            SDL_FreeSurface(cache->loads[counter].decoded);
+            cache->loads[counter].decoded = NULL;
+        }
+        cache->loads[counter].state = TI_ASSET_LOAD_FREE;
+    }
+    cache->numLoadsPending = 0;
+    cache->bytesQueued = 0;
+    cache->bytesDecoded = 0;
+
+    if(cache->loaderDone != NULL)
+    {
+        SDL_DestroyCond(cache->loaderDone);
+        cache->loaderDone = NULL;
+    }
+    if(cache->loaderWork != NULL)
+    {
+        SDL_DestroyCond(cache->loaderWork);
+        cache->loaderWork = NULL;
+    }
+    if(cache->loaderLock != NULL)
+    {
+        SDL_DestroyMutex(cache->loaderLock);
+        cache->loaderLock = NULL;
+    }
+}
+
+/****************************************************************************
+* assetCacheLoaderThread - see tiAssetCache.h for description
+****************************************************************************/
+int assetCacheLoaderThread(void *data)
+{
+    TiAssetCache *cache;
+    TiAssetLoad *load;
+    SDL_RWops *file;
+    SDL_Surface *decoded;
+    int counter;
+
+    cache = (TiAssetCache *)data;
+
+    SDL_mutexP(cache->loaderLock);
+    while(cache->loaderQuit == TI_FALSE)
+    {
+        load = NULL;
+        for(counter=0;counter<TI_ASSET_LOADER_MAX_LOADS;counter++)
+        {
+            if(cache->loads[counter].state == TI_ASSET_LOAD_QUEUED)
+            {
+                load = &(cache->loads[counter]);
+                break;
+            }
+        }
+        if(load == NULL)
+        {
+            SDL_CondWait(cache->loaderWork, cache->loaderLock);
+            continue;
+        }
+
+        /* Nothing else touches a load while it's being decoded, so the lock
+           can be let go until it's done */
+        load->state = TI_ASSET_LOAD_DECODING;
+        SDL_mutexV(cache->loaderLock);
+
+        decoded = NULL;
+        file = assetCacheOpenCounted(cache, load);
+        if(file != NULL)
+        {
+            decoded = IMG_Load_RW(file, 1);
+        }
+
+        SDL_mutexP(cache->loaderLock);
+        /* Count whatever the decoder didn't read (or all of it, if the
+           image couldn't be decoded) so that the progress still adds up */
+        if(load->bytesRead < load->size)
+        {
+            cache->bytesDecoded += load->size - load->bytesRead;
+            load->bytesRead = load->size;
+        }
+        load->decoded = decoded;
+        load->state = (decoded != NULL) ? TI_ASSET_LOAD_DONE : TI_ASSET_LOAD_FAILED;
+        cache->numLoadsPending--;
+        SDL_CondBroadcast(cache->loaderDone);
+    }
+    SDL_mutexV(cache->loaderLock);
+
+    return 0;
+}
+
+/****************************************************************************
+* assetCacheCountedSeek - seeks in a file opened by assetCacheOpenCounted
+****************************************************************************/
+int SDLCALL assetCacheCountedSeek(SDL_RWops *context, int offset, int whence)
+{
+    TiAssetCountedFile *counted;
+
+    counted = (TiAssetCountedFile *)context->hidden.unknown.data1;
+    return SDL_RWseek(counted->file, offset, whence);
+}
+
+/****************************************************************************
+* assetCacheCountedRead - reads from a file opened by assetCacheOpenCounted,
+* counting any bytes that haven't been read before
+****************************************************************************/
+int SDLCALL assetCacheCountedRead(SDL_RWops *context, void *ptr, int size, int maxnum)
+{
+    TiAssetCountedFile *counted;
+    int numRead, position;
+
+    counted = (TiAssetCountedFile *)context->hidden.unknown.data1;
+    numRead = SDL_RWread(counted->file, ptr, size, maxnum);
+    position = SDL_RWtell(counted->file);
+    if(numRead > 0 && position > (int)counted->load->bytesRead)
+    {
+        SDL_mutexP(counted->cache->loaderLock);
+        counted->cache->bytesDecoded += position - counted->load->bytesRead;
+        counted->load->bytesRead = position;
+        SDL_mutexV(counted->cache->loaderLock);
+    }
+    return numRead;
+}
+
+/****************************************************************************
+* assetCacheCountedWrite - files opened by assetCacheOpenCounted are read 
+* only
+****************************************************************************/
+int SDLCALL assetCacheCountedWrite(SDL_RWops *context, const void *ptr, int size, int num)
+{
+    return -1;
+}
+
+/****************************************************************************
+* assetCacheCountedClose - closes a file opened by assetCacheOpenCounted
+****************************************************************************/
+int SDLCALL assetCacheCountedClose(SDL_RWops *context)
+{
+    TiAssetCountedFile *counted;
+
+    counted = (TiAssetCountedFile *)context->hidden.unknown.data1;
+    SDL_RWclose(counted->file);
+    free(counted);
+    SDL_FreeRW(context);
+    return 0;
+}
+
+/****************************************************************************
+* assetCacheOpenCounted - see tiAssetCache.h for description
+****************************************************************************/
+SDL_RWops *assetCacheOpenCounted(TiAssetCache *cache, TiAssetLoad *load)
+{
+    TiAssetCountedFile *counted;
+    SDL_RWops *context;
+
+    counted = malloc(sizeof(TiAssetCountedFile));
+    if(counted == NULL)
+    {
+        return NULL;
+    }
+    counted->cache = cache;
+    counted->load = load;
+    counted->file = SDL_RWFromFile(load->fileName, "rb");
+    if(counted->file == NULL)
+    {
+        free(counted);
+        return NULL;
+    }
+
+    context = SDL_AllocRW();
+    if(context == NULL)
+    {
+        SDL_RWclose(counted->file);
+        free(counted);
+        return NULL;
+    }
+    context->seek = assetCacheCountedSeek;
+    context->read = assetCacheCountedRead;
+    context->write = assetCacheCountedWrite;
+    context->close = assetCacheCountedClose;
+    context->hidden.unknown.data1 = counted;
+
+    return context;
+}
+
+/****************************************************************************
+* assetCachePrefetch - see tiAssetCache.h for description
+****************************************************************************/
+int assetCachePrefetch(TiAssetCache *cache, char *fileName)
+{
+    TiAtlasImage *image;
+    TiAssetLoad *load;
+    FILE *fp;
+    long size;
+    int counter;
+
+    if(cache->loader == NULL)
+    {
+        return TI_ERROR;
+    }
+
+    /* An image in an atlas is ready as soon as the atlas is */
+    image = assetCacheFindAtlasImage(cache, fileName);
+    if(image != NULL)
+    {
+        fileName = image->atlasFileName;
+    }
+
+    for(counter=0;counter<cache->numEntries;counter++)
+    {
+        if(strcmp(cache->entries[counter].fileName, fileName) == 0)
+        {
+            return TI_OK;
+        }
+    }
+    if(cache->packHeader != NULL)
+    {
+        for(counter=0;counter<cache->packHeader->numImages;counter++)
+        {
+            if(strcmp(cache->packImages[counter].fileName, fileName) == 0)
+            {
+                return TI_OK;
+            }
+        }
+    }
+
+    SDL_mutexP(cache->loaderLock);
+    load = NULL;
+    for(counter=0;counter<TI_ASSET_LOADER_MAX_LOADS;counter++)
+    {
+        if(cache->loads[counter].state == TI_ASSET_LOAD_FREE)
+        {
+            if(load == NULL)
+            {
+                load = &(cache->loads[counter]);
+            }
+        }
+        else if(strcmp(cache->loads[counter].fileName, fileName) == 0)
+        {
+            SDL_mutexV(cache->loaderLock);
+            return TI_OK;
+        }
+    }
+    SDL_mutexV(cache->loaderLock);
+    if(load == NULL || strlen(fileName) >= TI_ASSET_CACHE_MAX_NAME_LENGTH)
+    {
+        return TI_ERROR;
+    }
+
+    /* The size is only needed for the progress, so the file can't have 
+       changed in any way that matters by the time it's decoded */
+    fp = fopen(fileName, "rb");
+    if(fp == NULL)
+    {
+        return TI_ERROR;
+    }
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fclose(fp);
+
+    /* Only this thread ever hands out free loads, so it's still free */
+    SDL_mutexP(cache->loaderLock);
+    strcpy(load->fileName, fileName);
+    load->size = (size > 0) ? (unsigned long)size : 0;
+    load->bytesRead = 0;
+    load->decoded = NULL;
+    load->state = TI_ASSET_LOAD_QUEUED;
+    cache->numLoadsPending++;
+    cache->bytesQueued += load->size;
+    SDL_CondSignal(cache->loaderWork);
+    SDL_mutexV(cache->loaderLock);
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* assetCacheCollect - see tiAssetCache.h for description
+****************************************************************************/
+int assetCacheCollect(TiAssetCache *cache)
+{
+    TiAssetCacheEntry *entry;
+    SDL_Surface *surface;
+    char fileName[TI_ASSET_CACHE_MAX_NAME_LENGTH];
+    int counter, numCollected;
+
+    if(cache->loader == NULL)
+    {
+        return 0;
+    }
+
+    numCollected = 0;
+    for(counter=0;counter<TI_ASSET_LOADER_MAX_LOADS;counter++)
+    {
+        SDL_mutexP(cache->loaderLock);
+        if(cache->loads[counter].state != TI_ASSET_LOAD_DONE &&
+           cache->loads[counter].state != TI_ASSET_LOAD_FAILED)
+        {
+            SDL_mutexV(cache->loaderLock);
+            continue;
+        }
+        strcpy(fileName, cache->loads[counter].fileName);
+        surface = cache->loads[counter].decoded;
+        cache->loads[counter].decoded = NULL;
+        cache->loads[counter].state = TI_ASSET_LOAD_FREE;
+        SDL_mutexV(cache->loaderLock);
+
+        /* An image that couldn't be decoded is left for assetCacheAcquire 
+           to try again and report */
+        if(surface == NULL)
+        {
+            continue;
+        }
+        surface = renderConvertImage(surface);
+        if(surface == NULL)
+        {
+            continue;
+        }
+        entry = assetCacheAddEntry(cache, fileName, surface, NULL);
+        if(entry == NULL)
+        {
+            SDL_FreeSurface(surface);
+            continue;
+        }
+        entry->prefetched = TI_TRUE;
+        numCollected++;
+    }
+
+    /* Start counting progress again from nothing with the next prefetch */
+    SDL_mutexP(cache->loaderLock);
+    if(cache->numLoadsPending == 0)
+    {
+        cache->bytesQueued = 0;
+        cache->bytesDecoded = 0;
+    }
+    SDL_mutexV(cache->loaderLock);
+
+    return numCollected;
+}
+
+/****************************************************************************
+* assetCacheWaitForLoad - see tiAssetCache.h for description
+****************************************************************************/
+SDL_Surface *assetCacheWaitForLoad(TiAssetCache *cache, char *fileName)
+{
+    TiAssetLoad *load;
+    SDL_Surface *surface;
+    int counter;
+
+    if(cache->loader == NULL)
+    {
+        return NULL;
+    }
+
+    SDL_mutexP(cache->loaderLock);
+    load = NULL;
+    for(counter=0;counter<TI_ASSET_LOADER_MAX_LOADS;counter++)
+    {
+        if(cache->loads[counter].state != TI_ASSET_LOAD_FREE &&
+           strcmp(cache->loads[counter].fileName, fileName) == 0)
+        {
+            load = &(cache->loads[counter]);
+            break;
+        }
+    }
+    if(load == NULL)
+    {
+        SDL_mutexV(cache->loaderLock);
+        return NULL;
+    }
+
+    while(load->state == TI_ASSET_LOAD_QUEUED || load->state == TI_ASSET_LOAD_DECODING)
+    {
+        SDL_CondWait(cache->loaderDone, cache->loaderLock);
+    }
+    surface = load->decoded;
+    load->decoded = NULL;
+    load->state = TI_ASSET_LOAD_FREE;
+    SDL_mutexV(cache->loaderLock);
+
+    if(surface == NULL)
+    {
+        return NULL;
+    }
+    return renderConvertImage(surface);
+}
+
+/****************************************************************************
+* assetCacheLoaderBusy - see tiAssetCache.h for description
+****************************************************************************/
+int assetCacheLoaderBusy(TiAssetCache *cache)
+{
+    int busy;
+
+    if(cache->loader == NULL)
+    {
+        return TI_FALSE;
+    }
+
+    SDL_mutexP(cache->loaderLock);
+    busy = (cache->numLoadsPending > 0) ? TI_TRUE : TI_FALSE;
+    SDL_mutexV(cache->loaderLock);
+    return busy;
+}
+
+/****************************************************************************
+* assetCacheLoaderProgress - see tiAssetCache.h for description
+****************************************************************************/
+void assetCacheLoaderProgress(TiAssetCache *cache, unsigned long *done, unsigned long *total)
+{
+    if(cache->loader == NULL)
+    {
+        *done = 0;
+        *total = 0;
+        return;
+    }
+
+    SDL_mutexP(cache->loaderLock);
+    *done = cache->bytesDecoded;
+    *total = cache->bytesQueued;
+    SDL_mutexV(cache->loaderLock);
+}
+
+/****************************************************************************
+* assetCacheAcquire - see tiAssetCache.h for description
+****************************************************************************/
+SDL_Surface *assetCacheAcquire(TiAssetCache *cache, char *fileName)
+{
+    TiAssetCacheEntry *entry;
+    TiAtlasImage *image;
+    SDL_Surface *surface, *atlas;
+    Uint32 colorkey;
+    int counter;
+
+    for(counter=0;counter<cache->numEntries;counter++)
+    {
+        entry = &(cache->entries[counter]);
+        if(strcmp(entry->fileName, fileName) == 0)
+        {
+            entry->refCount++;
+            entry->prefetched = TI_FALSE;
+            cache->hits++;
+            return entry->surface;
+        }
+    }
+
+    /* Not loaded yet.  Make room for it first, so that the cache doesn't
+       have to hold both the new image and the ones it replaces. */
+    cache->misses++;
+    assetCacheTrim(cache);
+    if(strlen(fileName) >= TI_ASSET_CACHE_MAX_NAME_LENGTH)
+    {
+        perror("assetCacheAcquire: file name too long");
+        return NULL;
+    }
+
+    atlas = NULL;
+    image = assetCacheFindAtlasImage(cache, fileName);
+    if(image != NULL)
+    {
+        atlas = assetCacheAcquire(cache, image->atlasFileName);
+        if(atlas == NULL)
+        {
+            return NULL;
+        }
+
+        /* The atlas itself is never drawn, and must never be RLE encoded,
+           since that would free the pixels that its images use.  Its key
+           is kept for its images: it was set before the atlas was 
+           converted to the display format, so it's magenta as that format
+           has it, which isn't always what mapping 0xFF00FF into it gives */
+        if(atlas->flags & SDL_SRCCOLORKEY)
+        {
+            colorkey = atlas->format->colorkey;
+            SDL_SetColorKey(atlas, SDL_SRCCOLORKEY, colorkey);
+        }
+        else
+        {
+            colorkey = SDL_MapRGB(atlas->format, 0xFF, 0, 0xFF);
+        }
+        surface = SDL_CreateRGBSurfaceFrom((Uint8 *)atlas->pixels + 
+                                           image->rect.y * atlas->pitch +
+                                           image->rect.x * atlas->format->BytesPerPixel,
+                                           image->rect.w, image->rect.h,
+                                           atlas->format->BitsPerPixel, atlas->pitch,
+                                           atlas->format->Rmask, atlas->format->Gmask,
+                                           atlas->format->Bmask, atlas->format->Amask);
+        if(surface != NULL)
+        {
+            SDL_SetColorKey(surface, SDL_RLEACCEL | SDL_SRCCOLORKEY, colorkey);
+        }
+    }
+    else
+    {
+        surface = assetCacheLoadPackedImage(cache, fileName);
+        if(surface == NULL)
+        {
+            surface = assetCacheWaitForLoad(cache, fileName);
+        }
+        if(surface == NULL)
+        {
+            surface = renderLoadImage(fileName);
+        }
+    }
+
+    entry = NULL;
+    if(surface != NULL)
+    {
+        entry = assetCacheAddEntry(cache, fileName, surface, atlas);
+    }
+    if(entry == NULL)
+    {
+        perror("assetCacheAcquire: unable to load image");
+        if(surface != NULL)
+        {
+            SDL_FreeSurface(surface);
+        }
+        if(atlas != NULL)
+        {
+            assetCacheRelease(cache, atlas);
+        }
+        return NULL;
+    }
+
+    entry->refCount = 1;
+    return surface;
+}
+
+/****************************************************************************
+* assetCacheRelease - see tiAssetCache.h for description
+****************************************************************************/
+int assetCacheRelease(TiAssetCache *cache, SDL_Surface *surface)
+{
+    TiAssetCacheEntry *entry;
+    int counter;
+
+    for(counter=0;counter<cache->numEntries;counter++)
+    {
+        entry = &(cache->entries[counter]);
+        if(entry->surface == surface && entry->refCount > 0)
+        {
+            entry->refCount--;
+            entry->lastUsed = ++cache->useCounter;
+            if(entry->refCount == 0 && cache->totalSize > cache->budget)
+            {
+                assetCacheTrim(cache);
+            }
+            return TI_OK;
+        }
+    }
+
+    perror("assetCacheRelease: image isn't in the cache");
+    return TI_ERROR;
+}
+
+/****************************************************************************
+* assetCacheSetBudget - see tiAssetCache.h for description
+****************************************************************************/
+void assetCacheSetBudget(TiAssetCache *cache, unsigned long budget)
+{
+    cache->budget = budget;
+    assetCacheTrim(cache);
+}
+
+/****************************************************************************
+* assetCacheTrim - see tiAssetCache.h for description
+****************************************************************************/
+int assetCacheTrim(TiAssetCache *cache)
+{
+    TiAssetCacheEntry *entry;
+    SDL_Surface *atlas;
+    int counter, oldest, numFreed;
+
+    numFreed = 0;
+    while(cache->totalSize > cache->budget)
+    {
+        /* Find the image not in use that was released the longest ago, 
+           leaving prefetched images that are still to be used for last */
+        oldest = -1;
+        for(counter=0;counter<cache->numEntries;counter++)
+        {
+            entry = &(cache->entries[counter]);
+            if(entry->refCount == 0 &&
+               (oldest == -1 || 
+                entry->prefetched < cache->entries[oldest].prefetched ||
+                (entry->prefetched == cache->entries[oldest].prefetched &&
+                 entry->lastUsed < cache->entries[oldest].lastUsed)))
+            {
+                oldest = counter;
+            }
+        }
+        if(oldest == -1)
+        {
+            break;
+        }
+
+        entry = &(cache->entries[oldest]);
+        atlas = entry->atlas;
+        SDL_FreeSurface(entry->surface);
+        cache->totalSize -= entry->size;
+        cache->evictions++;
+        numFreed++;
+
+        /* Entries aren't kept in any order, so the last one fills the gap */
+        *entry = cache->entries[--cache->numEntries];
+
+        /* An image in an atlas frees nothing by itself, but once all of the
+           atlas's images are gone, the atlas can go too */
+        if(atlas != NULL)
+        {
+            assetCacheRelease(cache, atlas);
+        }
+    }
+
+    return numFreed;
+}
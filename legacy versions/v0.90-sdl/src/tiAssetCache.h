@@ -0,0 +1,577 @@
+/****************************************************************************
+*
+* tiAssetCache.h - Header for tiAssetCache.c
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#ifndef __TIASSETCACHE_H__
+#define __TIASSETCACHE_H__
+
+/*
+ * The asset cache holds on to images after the render state that loaded 
+ * them is done with them, so that going back to a screen that has been 
+ * shown before doesn't decode its images again.  Images are handed out by
+ * file name and counted; one that nothing is using stays loaded (already 
+ * converted to the display format) until the cache goes over its memory 
+ * budget, at which point the images that were used least recently are
+ * freed first.  Images that are still in use are never freed, so the cache
+ * can go over budget for as long as they are.
+ *
+ * Most images are packed into a few large texture atlases when the game is
+ * built (see tiAtlas.c).  The atlas index lists, for each image file, the
+ * atlas it was packed into and where.  An image that is in an atlas is 
+ * handed out as a surface that shares the atlas's pixels, so the whole 
+ * atlas is decoded the first time any image in it is needed, and it stays
+ * loaded as long as any of its images are.  Images that aren't in the 
+ * index (or all of them, if there is no index) are loaded from their own
+ * files.
+ *
+ * Decoding the atlases is most of the game's startup time on the N800, so
+ * they can also be converted ahead of time (see tiPack.c) into a pack file
+ * that holds their pixels already in the display's format.  The pack is
+ * mapped into memory, and its images are wrapped in surfaces without being
+ * copied or decoded.  Anything that isn't in the pack is loaded from its 
+ * own file as before.
+ *
+ * Images that still have to be decoded can be asked for ahead of time with
+ * assetCachePrefetch.  A background thread decodes them, and the main 
+ * thread picks them up (see assetCacheCollect) and converts them to the
+ * display format, since SDL's video functions may only be called from the
+ * main thread.  Prefetched images are kept until they've been used at
+ * least once, unless there is nothing else left to free.
+ */
+
+#define TI_ASSET_CACHE_MAX_ENTRIES          64
+#define TI_ASSET_CACHE_MAX_NAME_LENGTH      64
+
+/* The budget, in bytes of pixel data.  Everything the game loads comes to
+   about 7 MB at 16 bits per pixel (twice that at 32), so on the desktop
+   nothing is ever freed.  Can be set at build time with 
+   -DTI_ASSET_CACHE_BUDGET=<bytes>. */
+#ifndef TI_ASSET_CACHE_BUDGET
+#ifdef _NOKIA_N800_
+#define TI_ASSET_CACHE_BUDGET               (4 * 1024 * 1024)
+#else
+#define TI_ASSET_CACHE_BUDGET               (16 * 1024 * 1024)
+#endif
+#endif
+
+/* Atlases are at most this size; anything bigger isn't packed */
+#define TI_ATLAS_SIZE                       2048
+#define TI_ATLAS_MAX_IMAGES                 64
+
+typedef struct
+{
+    char fileName[TI_ASSET_CACHE_MAX_NAME_LENGTH];
+    char atlasFileName[TI_ASSET_CACHE_MAX_NAME_LENGTH];
+    SDL_Rect rect;
+} TiAtlasImage;
+
+/* The pack file starts with a TiAssetPackHeader, followed by a 
+   TiAssetPackImage for each image, followed by the pixels.  Everything is
+   in the byte order of the machine that wrote it, so the pack has to be
+   built where the game runs (a pack with the wrong byte order is ignored,
+   since its magic number won't match). */
+#define TI_ASSET_PACK_MAGIC                 0x4B505449      /* 'TIPK' */
+#define TI_ASSET_PACK_VERSION               1
+#define TI_ASSET_PACK_MAX_IMAGES            16
+
+/* Pixels are 16 bit 5-6-5 RGB, which is what the display uses at 
+   TI_GAME_DEPTH.  Each image's pixels start on an aligned boundary. */
+#define TI_ASSET_PACK_BITS_PER_PIXEL        16
+#define TI_ASSET_PACK_RMASK                 0xF800
+#define TI_ASSET_PACK_GMASK                 0x07E0
+#define TI_ASSET_PACK_BMASK                 0x001F
+#define TI_ASSET_PACK_ALIGNMENT             16
+
+/* Image flags: how the image is to be drawn */
+#define TI_ASSET_PACK_COLORKEY              0x01
+#define TI_ASSET_PACK_RLE                   0x02
+
+typedef struct
+{
+    Uint32 magic;
+    Uint32 version;
+    Uint32 numImages;
+    Uint32 bitsPerPixel;
+    Uint32 Rmask;
+    Uint32 Gmask;
+    Uint32 Bmask;
+    /* The transparent color, in the pack's pixel format */
+    Uint32 colorkey;
+} TiAssetPackHeader;
+
+typedef struct
+{
+    char fileName[TI_ASSET_CACHE_MAX_NAME_LENGTH];
+    /* Where the pixels start, from the start of the file */
+    Uint32 offset;
+    Uint32 width;
+    Uint32 height;
+    Uint32 pitch;
+    Uint32 flags;
+} TiAssetPackImage;
+
+/* States of an image handed to the background loader */
+#define TI_ASSET_LOAD_FREE                  0
+#define TI_ASSET_LOAD_QUEUED                1
+#define TI_ASSET_LOAD_DECODING              2
+#define TI_ASSET_LOAD_DONE                  3
+#define TI_ASSET_LOAD_FAILED                4
+
+#define TI_ASSET_LOADER_MAX_LOADS           TI_ASSET_CACHE_MAX_ENTRIES
+
+typedef struct
+{
+    char fileName[TI_ASSET_CACHE_MAX_NAME_LENGTH];
+    int state;
+    /* Size of the file, and how much of it the decoder has read so far */
+    unsigned long size;
+    unsigned long bytesRead;
+    /* The image as decoded, not yet converted to the display format */
+    SDL_Surface *decoded;
+} TiAssetLoad;
+
+typedef struct
+{
+    char fileName[TI_ASSET_CACHE_MAX_NAME_LENGTH];
+    SDL_Surface *surface;
+    /* For an image in an atlas, the atlas's surface (which has its own 
+       entry, and one reference for every entry like this one) */
+    SDL_Surface *atlas;
+    /* The number of times the image has been handed out and not released */
+    int refCount;
+    /* Size of the image's pixel data, in bytes */
+    unsigned long size;
+    /* When the image was last released (see TiAssetCache.useCounter) */
+    unsigned long lastUsed;
+    /* Set if the image was prefetched and hasn't been acquired since */
+    int prefetched;
+} TiAssetCacheEntry;
+
+typedef struct
+{
+    TiAssetCacheEntry entries[TI_ASSET_CACHE_MAX_ENTRIES];
+    int numEntries;
+    TiAtlasImage atlasImages[TI_ATLAS_MAX_IMAGES];
+    int numAtlasImages;
+    /* The pack file, if there is one */
+    void *packData;
+    unsigned long packSize;
+    TiAssetPackHeader *packHeader;
+    TiAssetPackImage *packImages;
+    /* If the display's format isn't the pack's, images are converted when
+       they're loaded (which still beats decoding them) */
+    int packMatchesDisplay;
+    /* The background loader.  Everything in loads[] (and the byte counts)
+       belongs to whoever holds loaderLock. */
+    SDL_Thread *loader;
+    SDL_mutex *loaderLock;
+    SDL_cond *loaderWork;
+    SDL_cond *loaderDone;
+    int loaderQuit;
+    TiAssetLoad loads[TI_ASSET_LOADER_MAX_LOADS];
+    int numLoadsPending;
+    /* Progress of the images prefetched since the loader was last idle */
+    unsigned long bytesQueued;
+    unsigned long bytesDecoded;
+    unsigned long budget;
+    unsigned long totalSize;
+    /* Counts up every time an image is released, for least-recently-used 
+       ordering */
+    unsigned long useCounter;
+    /* Statistics */
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+} TiAssetCache;
+
+/* What's behind a file opened with assetCacheOpenCounted */
+typedef struct
+{
+    SDL_RWops *file;
+    TiAssetCache *cache;
+    TiAssetLoad *load;
+} TiAssetCountedFile;
+
+/****************************************************************************
+* assetCacheInitialize
+*
+* Description:
+*   Creates an empty asset cache.
+*
+* Arguments:
+*   unsigned long budget - the most pixel data (in bytes) to keep loaded
+*                          for images that aren't in use
+*
+* Returns:
+*   A pointer to the cache, or NULL if it couldn't be created.
+*
+****************************************************************************/
+TiAssetCache *assetCacheInitialize(unsigned long budget);
+
+/****************************************************************************
+* assetCacheDestroy
+*
+* Description:
+*   Stops the background loader, frees every image in the cache, whether 
+*   it's in use or not, closes the pack file and frees the cache itself.
+*
+* Arguments:
+*   TiAssetCache **cache - the cache to destroy (set to NULL)
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void assetCacheDestroy(TiAssetCache **cache);
+
+/****************************************************************************
+* assetCacheLoadAtlasIndex
+*
+* Description:
+*   Reads the index of the images packed into atlases.  Each line of the
+*   file is an image file name, the atlas file it's in, and its x, y, width
+*   and height within the atlas, separated by spaces.
+*
+* Arguments:
+*   TiAssetCache *cache - the cache
+*   char *fileName      - the index file
+*
+* Returns:
+*   TI_OK, or TI_ERROR if the index couldn't be read (in which case every
+*   image is loaded from its own file).
+*
+****************************************************************************/
+int assetCacheLoadAtlasIndex(TiAssetCache *cache, char *fileName);
+
+/****************************************************************************
+* assetCacheFindAtlasImage
+*
+* Description:
+*   Looks an image up in the atlas index.
+*
+* Arguments:
+*   TiAssetCache *cache - the cache
+*   char *fileName      - the name of the image file
+*
+* Returns:
+*   The image's entry in the index, or NULL if it isn't in an atlas.
+*
+****************************************************************************/
+TiAtlasImage *assetCacheFindAtlasImage(TiAssetCache *cache, char *fileName);
+
+/****************************************************************************
+* assetCacheOpenPack
+*
+* Description:
+*   Maps a pack file into memory, so that its images can be handed out by
+*   the cache.  Must be called after the video mode is set.
+*
+* Arguments:
+*   TiAssetCache *cache - the cache
+*   char *fileName      - the pack file
+*
+* Returns:
+*   TI_OK, or TI_ERROR if the pack couldn't be opened or isn't valid (in
+*   which case images are loaded from their own files).
+*
+****************************************************************************/
+int assetCacheOpenPack(TiAssetCache *cache, char *fileName);
+
+/****************************************************************************
+* assetCacheClosePack
+*
+* Description:
+*   Unmaps the cache's pack file.  Images from the pack must not be in use.
+*
+* Arguments:
+*   TiAssetCache *cache - the cache
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void assetCacheClosePack(TiAssetCache *cache);
+
+/****************************************************************************
+* assetCacheLoadPackedImage
+*
+* Description:
+*   Makes a surface for an image in the cache's pack file.  The surface
+*   uses the pack's memory for its pixels, unless the display's format is
+*   different, in which case it's a converted copy.
+*
+* Arguments:
+*   TiAssetCache *cache - the cache
+*   char *fileName      - the name of the image file
+*
+* Returns:
+*   The surface, or NULL if the image isn't in the pack.
+*
+****************************************************************************/
+SDL_Surface *assetCacheLoadPackedImage(TiAssetCache *cache, char *fileName);
+
+/****************************************************************************
+* assetCacheAddEntry
+*
+* Description:
+*   Adds a loaded image to the cache, with no references.
+*
+* Arguments:
+*   TiAssetCache *cache  - the cache
+*   char *fileName       - the name of the image file
+*   SDL_Surface *surface - the image
+*   SDL_Surface *atlas   - the atlas the image's pixels belong to, or NULL
+*
+* Returns:
+*   The image's entry, or NULL if the cache is full.
+*
+****************************************************************************/
+TiAssetCacheEntry *assetCacheAddEntry(TiAssetCache *cache, char *fileName, 
+                                      SDL_Surface *surface, SDL_Surface *atlas);
+
+/****************************************************************************
+* assetCacheStartLoader
+*
+* Description:
+*   Starts the thread that decodes prefetched images.
+*
+* Arguments:
+*   TiAssetCache *cache - the cache
+*
+* Returns:
+*   TI_OK, or TI_ERROR if the thread couldn't be started (in which case
+*   prefetching does nothing, and images are decoded when acquired).
+*
+****************************************************************************/
+int assetCacheStartLoader(TiAssetCache *cache);
+
+/****************************************************************************
+* assetCacheStopLoader
+*
+* Description:
+*   Stops the background loader, waiting for the image it's decoding (if 
+*   any) to finish, and throws away anything it decoded that hasn't been 
+*   collected.
+*
+* Arguments:
+*   TiAssetCache *cache - the cache
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void assetCacheStopLoader(TiAssetCache *cache);
+
+/****************************************************************************
+* assetCacheLoaderThread
+*
+* Description:
+*   The background loader's thread.  Decodes queued images one at a time
+*   until told to stop.  Started by assetCacheStartLoader; don't call this
+*   directly.
+*
+* Arguments:
+*   void *data - the cache
+*
+* Returns:
+*   0
+*
+****************************************************************************/
+int assetCacheLoaderThread(void *data);
+
+/****************************************************************************
+* assetCacheOpenCounted
+*
+* Description:
+*   Opens a file for the background loader to decode, counting the bytes
+*   read from it into the load's bytesRead and the cache's bytesDecoded.
+*   Bytes read again after a seek back aren't counted twice.
+*
+* Arguments:
+*   TiAssetCache *cache - the cache
+*   TiAssetLoad *load   - the image being decoded
+*
+* Returns:
+*   The opened file, or NULL if it couldn't be opened.
+*
+****************************************************************************/
+SDL_RWops *assetCacheOpenCounted(TiAssetCache *cache, TiAssetLoad *load);
+
+/****************************************************************************
+* assetCachePrefetch
+*
+* Description:
+*   Asks the background loader to decode an image (or the atlas it's in),
+*   without waiting for it.  Does nothing if the image is already loaded,
+*   already asked for, or in the pack.
+*
+* Arguments:
+*   TiAssetCache *cache - the cache
+*   char *fileName      - the name of the image file
+*
+* Returns:
+*   TI_OK, or TI_ERROR if the loader isn't running, is full, or the file
+*   couldn't be found.
+*
+****************************************************************************/
+int assetCachePrefetch(TiAssetCache *cache, char *fileName);
+
+/****************************************************************************
+* assetCacheCollect
+*
+* Description:
+*   Takes the images the background loader has finished decoding, converts
+*   them to the display format and adds them to the cache.  Must be called
+*   from the main thread; once a frame is plenty.
+*
+* Arguments:
+*   TiAssetCache *cache - the cache
+*
+* Returns:
+*   The number of images added to the cache.
+*
+****************************************************************************/
+int assetCacheCollect(TiAssetCache *cache);
+
+/****************************************************************************
+* assetCacheWaitForLoad
+*
+* Description:
+*   If the background loader has been asked for an image, waits for it to
+*   be decoded and converts it.  The image is not added to the cache.
+*
+* Arguments:
+*   TiAssetCache *cache - the cache
+*   char *fileName      - the name of the image file
+*
+* Returns:
+*   The image, or NULL if the loader wasn't asked for it or couldn't 
+*   decode it.
+*
+****************************************************************************/
+SDL_Surface *assetCacheWaitForLoad(TiAssetCache *cache, char *fileName);
+
+/****************************************************************************
+* assetCacheLoaderBusy
+*
+* Description:
+*   Checks whether the background loader has anything left to decode.
+*
+* Arguments:
+*   TiAssetCache *cache - the cache
+*
+* Returns:
+*   TI_TRUE or TI_FALSE
+*
+****************************************************************************/
+int assetCacheLoaderBusy(TiAssetCache *cache);
+
+/****************************************************************************
+* assetCacheLoaderProgress
+*
+* Description:
+*   Gets how far the background loader is through the images it has been
+*   asked for since it was last idle.
+*
+* Arguments:
+*   TiAssetCache *cache   - the cache
+*   unsigned long *done   - set to the number of bytes decoded so far
+*   unsigned long *total  - set to the number of bytes to decode in all
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void assetCacheLoaderProgress(TiAssetCache *cache, unsigned long *done, unsigned long *total);
+
+/****************************************************************************
+* assetCacheAcquire
+*
+* Description:
+*   Gets an image from the cache, loading it (from the pack, from the 
+*   background loader, or else with renderLoadImage) or its atlas if it
+*   isn't already there.  Every image acquired must be released with 
+*   assetCacheRelease.
+*
+* Arguments:
+*   TiAssetCache *cache - the cache
+*   char *fileName      - the name of the image file
+*
+* Returns:
+*   The image, or NULL if it couldn't be loaded.
+*
+****************************************************************************/
+SDL_Surface *assetCacheAcquire(TiAssetCache *cache, char *fileName);
+
+/****************************************************************************
+* assetCacheRelease
+*
+* Description:
+*   Tells the cache that an image acquired with assetCacheAcquire is no
+*   longer needed.  The image stays loaded unless the cache is over its
+*   budget.
+*
+* Arguments:
+*   TiAssetCache *cache  - the cache
+*   SDL_Surface *surface - the image
+*
+* Returns:
+*   TI_OK, or TI_ERROR if the image didn't come from the cache.
+*
+****************************************************************************/
+int assetCacheRelease(TiAssetCache *cache, SDL_Surface *surface);
+
+/****************************************************************************
+* assetCacheSetBudget
+*
+* Description:
+*   Changes the cache's budget, freeing images as needed to fit the new one.
+*
+* Arguments:
+*   TiAssetCache *cache  - the cache
+*   unsigned long budget - the new budget, in bytes
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void assetCacheSetBudget(TiAssetCache *cache, unsigned long budget);
+
+/****************************************************************************
+* assetCacheTrim
+*
+* Description:
+*   Frees images that aren't in use, least recently used first, until the
+*   cache fits in its budget or nothing more can be freed.  Prefetched 
+*   images that haven't been used yet go last.
+*
+* Arguments:
+*   TiAssetCache *cache - the cache
+*
+* Returns:
+*   The number of images freed.
+*
+****************************************************************************/
+int assetCacheTrim(TiAssetCache *cache);
+
+#endif /* __TIASSETCACHE_H__ */
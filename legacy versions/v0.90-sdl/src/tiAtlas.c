@@ -0,0 +1,338 @@
+/****************************************************************************
+*
+* tiAtlas.c - packs the game's images into texture atlases
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <SDL/SDL.h>
+#include <SDL/SDL_image.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiAssetCache.h"
+
+/*
+ * Usage: tiAtlas <output directory> -g <image>... [-g <image>...]...
+ *
+ * Packs images into texture atlases (see tiAssetCache.h), and writes the
+ * atlases (atlas0.bmp, atlas1.bmp, ...) and their index to the output 
+ * directory.  Each -g starts a group of images that are used together;
+ * an atlas only ever holds images from one group, so that loading a screen
+ * doesn't also load images that only other screens use.  Images are 
+ * packed onto shelves, tallest first, and each atlas is cropped to the 
+ * space it uses.  Images too big for an atlas are left out, and the game
+ * loads them from their own files.
+ *
+ * The atlases are written as BMPs, so that nothing beyond SDL is needed to
+ * write them.  The file names in the index are the names given on the
+ * command line, so run from the bin directory (the Makefile's 'atlas'
+ * target does).
+ */
+
+#define TI_ATLAS_MAX_ATLASES        16
+#define TI_ATLAS_MAX_SHELVES        64
+
+typedef struct {
+    char *fileName;
+    SDL_Surface *image;
+    int group;
+    int atlas;
+    SDL_Rect rect;
+} AtlasInput;
+
+typedef struct {
+    int group;
+    int numShelves;
+    int shelfY[TI_ATLAS_MAX_SHELVES];
+    int shelfHeight[TI_ATLAS_MAX_SHELVES];
+    int shelfUsed[TI_ATLAS_MAX_SHELVES];
+    int width;
+    int height;
+} AtlasLayout;
+
+AtlasInput Inputs[TI_ATLAS_MAX_IMAGES];
+AtlasLayout Layouts[TI_ATLAS_MAX_ATLASES];
+int NumInputs;
+int NumAtlases;
+
+/****************************************************************************
+* atlasCompareInputs
+*
+* qsort comparison that puts images in group order, tallest first within
+* each group.
+****************************************************************************/
+int atlasCompareInputs(const void *a, const void *b)
+{
+    const AtlasInput *inputA = a;
+    const AtlasInput *inputB = b;
+
+    if(inputA->group != inputB->group)
+    {
+        return inputA->group - inputB->group;
+    }
+    if(inputA->image->h != inputB->image->h)
+    {
+        return inputB->image->h - inputA->image->h;
+    }
+    return inputB->image->w - inputA->image->w;
+}
+
+/****************************************************************************
+* atlasPlaceImage
+*
+* Finds room for an image in one of its group's atlases: on the first shelf
+* that's tall enough and has room left, or else on a new shelf, or else in
+* a new atlas.  Returns TI_OK or TI_ERROR (if there are too many atlases).
+****************************************************************************/
+int atlasPlaceImage(AtlasInput *input)
+{
+    AtlasLayout *layout;
+    int counter, shelf, w, h;
+
+    w = input->image->w;
+    h = input->image->h;
+
+    for(counter=0;counter<NumAtlases;counter++)
+    {
+        layout = &(Layouts[counter]);
+        if(layout->group != input->group)
+        {
+            continue;
+        }
+
+        for(shelf=0;shelf<layout->numShelves;shelf++)
+        {
+            if(layout->shelfHeight[shelf] >= h && 
+               layout->shelfUsed[shelf] + w <= TI_ATLAS_SIZE)
+            {
+                break;
+            }
+        }
+        if(shelf == layout->numShelves)
+        {
+            /* Start a new shelf, if there's room under the last one */
+            if(layout->numShelves >= TI_ATLAS_MAX_SHELVES ||
+               layout->height + h > TI_ATLAS_SIZE)
+            {
+                continue;
+            }
+            layout->shelfY[shelf] = layout->height;
+            layout->shelfHeight[shelf] = h;
+            layout->shelfUsed[shelf] = 0;
+            layout->height += h;
+            layout->numShelves++;
+        }
+
+        input->atlas = counter;
+        input->rect.x = layout->shelfUsed[shelf];
+        input->rect.y = layout->shelfY[shelf];
+        input->rect.w = w;
+        input->rect.h = h;
+        layout->shelfUsed[shelf] += w;
+        if(layout->shelfUsed[shelf] > layout->width)
+        {
+            layout->width = layout->shelfUsed[shelf];
+        }
+        return TI_OK;
+    }
+
+    if(NumAtlases >= TI_ATLAS_MAX_ATLASES)
+    {
+        return TI_ERROR;
+    }
+
+    layout = &(Layouts[NumAtlases++]);
+    layout->group = input->group;
+    layout->numShelves = 0;
+    layout->width = 0;
+    layout->height = 0;
+    return atlasPlaceImage(input);
+}
+
+/****************************************************************************
+* atlasWrite
+*
+* Draws the images of an atlas onto a surface and saves it.  Gaps are 
+* filled with the transparent color.  Returns TI_OK or TI_ERROR.
+****************************************************************************/
+int atlasWrite(int atlas, char *fileName)
+{
+    SDL_Surface *surface;
+    int counter;
+
+    surface = SDL_CreateRGBSurface(SDL_SWSURFACE, Layouts[atlas].width, Layouts[atlas].height,
+                                   32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0);
+    if(surface == NULL)
+    {
+        return TI_ERROR;
+    }
+    SDL_FillRect(surface, NULL, SDL_MapRGB(surface->format, 0xFF, 0, 0xFF));
+
+    for(counter=0;counter<NumInputs;counter++)
+    {
+        if(Inputs[counter].atlas == atlas)
+        {
+            /* Copy the pixels as they are -- the game converts images 
+               without their alpha channel or colorkey, too */
+            SDL_SetAlpha(Inputs[counter].image, 0, 0);
+            SDL_SetColorKey(Inputs[counter].image, 0, 0);
+            SDL_BlitSurface(Inputs[counter].image, NULL, surface, &(Inputs[counter].rect));
+        }
+    }
+
+    if(SDL_SaveBMP(surface, fileName) != 0)
+    {
+        SDL_FreeSurface(surface);
+        return TI_ERROR;
+    }
+
+    SDL_FreeSurface(surface);
+    return TI_OK;
+}
+
+int main(int argc, char **argv)
+{
+    FILE *fp;
+    SDL_Surface *image;
+    char *outDir;
+    char fileName[TI_ASSET_CACHE_MAX_NAME_LENGTH];
+    char atlasFileName[TI_ASSET_CACHE_MAX_NAME_LENGTH];
+    int counter, group, numSkipped;
+    unsigned long packedSize;
+
+    if(argc < 4 || strcmp(argv[2], "-g") != 0)
+    {
+        fprintf(stderr, "Usage: %s <output directory> -g <image>... [-g <image>...]...\n",
+                argv[0]);
+        return 1;
+    }
+    outDir = argv[1];
+
+    if(SDL_Init(0) < 0)
+    {
+        perror("Unable to initialize SDL");
+        return 1;
+    }
+
+    /* Load everything */
+    group = -1;
+    numSkipped = 0;
+    NumInputs = 0;
+    for(counter=2;counter<argc;counter++)
+    {
+        if(strcmp(argv[counter], "-g") == 0)
+        {
+            group++;
+            continue;
+        }
+
+        image = IMG_Load(argv[counter]);
+        if(image == NULL)
+        {
+            fprintf(stderr, "Unable to load %s\n", argv[counter]);
+            SDL_Quit();
+            return 1;
+        }
+        if(image->w > TI_ATLAS_SIZE || image->h > TI_ATLAS_SIZE ||
+           strlen(argv[counter]) >= TI_ASSET_CACHE_MAX_NAME_LENGTH)
+        {
+            fprintf(stderr, "%s is too big to pack, leaving it out\n", argv[counter]);
+            SDL_FreeSurface(image);
+            numSkipped++;
+            continue;
+        }
+        if(NumInputs >= TI_ATLAS_MAX_IMAGES)
+        {
+            fprintf(stderr, "Too many images (the most is %d)\n", TI_ATLAS_MAX_IMAGES);
+            SDL_Quit();
+            return 1;
+        }
+
+        Inputs[NumInputs].fileName = argv[counter];
+        Inputs[NumInputs].image = image;
+        Inputs[NumInputs].group = group;
+        NumInputs++;
+    }
+
+    /* Pack them */
+    qsort(Inputs, NumInputs, sizeof(AtlasInput), atlasCompareInputs);
+    NumAtlases = 0;
+    for(counter=0;counter<NumInputs;counter++)
+    {
+        if(atlasPlaceImage(&(Inputs[counter])) != TI_OK)
+        {
+            fprintf(stderr, "Too many atlases (the most is %d)\n", TI_ATLAS_MAX_ATLASES);
+            SDL_Quit();
+            return 1;
+        }
+    }
+
+    /* Write out the atlases and the index */
+    packedSize = 0;
+    for(counter=0;counter<NumAtlases;counter++)
+    {
+        snprintf(fileName, sizeof(fileName), "%s/atlas%d.bmp", outDir, counter);
+        if(atlasWrite(counter, fileName) != TI_OK)
+        {
+            fprintf(stderr, "Unable to write %s\n", fileName);
+            SDL_Quit();
+            return 1;
+        }
+        packedSize += Layouts[counter].width * Layouts[counter].height;
+        printf("%s: %dx%d\n", fileName, Layouts[counter].width, Layouts[counter].height);
+    }
+
+    snprintf(fileName, sizeof(fileName), "%s/index", outDir);
+    fp = fopen(fileName, "w");
+    if(fp == NULL)
+    {
+        perror("Unable to write atlas index");
+        SDL_Quit();
+        return 1;
+    }
+    fprintf(fp, "# Generated by tiAtlas -- image, atlas, x, y, width, height\n");
+    for(counter=0;counter<NumInputs;counter++)
+    {
+        snprintf(atlasFileName, sizeof(atlasFileName), "%s/atlas%d.bmp", outDir,
+                 Inputs[counter].atlas);
+        fprintf(fp, "%s %s %d %d %d %d\n", Inputs[counter].fileName, atlasFileName,
+                Inputs[counter].rect.x, Inputs[counter].rect.y, 
+                Inputs[counter].rect.w, Inputs[counter].rect.h);
+        SDL_FreeSurface(Inputs[counter].image);
+    }
+    fclose(fp);
+
+    printf("%d images packed into %d atlases (%lu pixels), %d left out\n", 
+           NumInputs, NumAtlases, packedSize, numSkipped);
+
+    SDL_Quit();
+    return 0;
+}
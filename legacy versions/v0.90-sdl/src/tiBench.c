@@ -0,0 +1,209 @@
+/****************************************************************************
+*
+* tiBench.c - AI self-play benchmark
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <SDL/SDL.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiSelfPlay.h"
+#include "tiPlayout.h"
+#include "tiMetrics.h"
+
+/*
+ * Usage: tiBench [games] [players] [endgame pool size]
+ *
+ * Plays a fixed, seeded set of games between the strongest computer players
+ * and reports how fast the AI makes decisions and how many heap allocations
+ * each decision costs.  Run from the bin directory so the data files can be
+ * found.  The benchmark is linked with -Wl,--wrap=malloc (see the Makefile)
+ * so that every allocation made by the game code passes through the counter
+ * below.  The engine's counters (see tiMetrics.h) for the self-play games
+ * are printed after the summary.
+ *
+ * Afterwards, random playouts (see tiPlayout.h) are run from the start of a
+ * game.  If they run slower than TI_BENCH_MIN_PLAYOUTS_PER_SECOND, the 
+ * benchmark fails, so that 'make bench' catches anything that slows them
+ * down.  Set TI_BENCH_NO_MIN_PLAYOUTS to skip that check (the instrumented
+ * build used to train profile-guided builds is always too slow to pass it).
+ */
+
+#define TI_BENCH_DEFAULT_GAMES              200
+#define TI_BENCH_DEFAULT_PLAYERS            4
+#define TI_BENCH_PLAYOUTS                   200000
+#define TI_BENCH_MIN_PLAYOUTS_PER_SECOND    100000
+
+Game *GameInstance;
+
+unsigned long BenchAllocations = 0;
+
+void *__real_malloc(size_t size);
+
+/****************************************************************************
+* __wrap_malloc
+*
+* Counts allocations made by the game code, then passes them on.
+****************************************************************************/
+void *__wrap_malloc(size_t size)
+{
+    BenchAllocations++;
+    TI_METRICS_ADD(TI_METRIC_ALLOCATIONS, 1);
+    return __real_malloc(size);
+}
+
+int main(int argc, char **argv)
+{
+    int numGames, numPlayers, counter, result;
+    int aiLevels[TI_MAX_PLAYERS];
+    unsigned long decisions, decisionAllocations, allocationsBefore, tilesPlayed;
+    Uint32 startTicks, decisionTicks, turnStart, playoutTicks;
+    double playoutsPerSecond;
+    PlayoutState startState, state;
+    TiMetrics metricsBefore, metrics;
+
+    numGames = (argc > 1) ? atoi(argv[1]) : TI_BENCH_DEFAULT_GAMES;
+    numPlayers = (argc > 2) ? atoi(argv[2]) : TI_BENCH_DEFAULT_PLAYERS;
+    if(argc > 3)
+    {
+        computerSetEndgamePoolSize(atoi(argv[3]));
+    }
+    if(numGames <= 0 || numPlayers < TI_MIN_PLAYERS || numPlayers > TI_MAX_PLAYERS)
+    {
+        fprintf(stderr, "Usage: %s [games] [players (%d-%d)] [endgame pool size]\n", argv[0],
+                TI_MIN_PLAYERS, TI_MAX_PLAYERS);
+        return 1;
+    }
+
+    if(SDL_Init(SDL_INIT_TIMER) < 0)
+    {
+        perror("Unable to initialize SDL timer");
+        return 1;
+    }
+    metricsInitialize();
+
+    GameInstance = gameInitialize(TI_TILE_DATA_FILE, TI_STATION_DATA_FILE);
+    if(GameInstance == NULL)
+    {
+        perror("Unable to initialize Game structure");
+        SDL_Quit();
+        return 1;
+    }
+
+    for(counter=0;counter<TI_MAX_PLAYERS;counter++)
+    {
+        aiLevels[counter] = TI_PLAYER_AI_SMARTEST;
+    }
+
+    decisions = 0;
+    decisionAllocations = 0;
+    decisionTicks = 0;
+    metricsSnapshot(&metricsBefore);
+    startTicks = SDL_GetTicks();
+    for(counter=0;counter<numGames;counter++)
+    {
+        srand(counter + 1);
+        if(selfPlayInitGame(GameInstance, numPlayers, aiLevels) != TI_OK)
+        {
+            perror("Unable to set up game");
+            break;
+        }
+        while(gameCheckForEndOfGame(GameInstance) == TI_FALSE)
+        {
+            allocationsBefore = BenchAllocations;
+            turnStart = SDL_GetTicks();
+            result = selfPlayTakeTurn(GameInstance);
+            decisionTicks += SDL_GetTicks() - turnStart;
+            decisionAllocations += BenchAllocations - allocationsBefore;
+            if(result < 0)
+            {
+                perror("Illegal computer move");
+                gameDestroy(&GameInstance);
+                SDL_Quit();
+                return 1;
+            }
+            decisions += result;
+        }
+    }
+
+    fprintf(stderr, "games:                    %d (%d players)\n", counter, numPlayers);
+    fprintf(stderr, "total time:               %u ms\n", (unsigned int)(SDL_GetTicks() - startTicks));
+    fprintf(stderr, "AI decisions:             %lu\n", decisions);
+    fprintf(stderr, "decisions per second:     %.0f\n",
+            (decisionTicks > 0) ? (decisions * 1000.0 / decisionTicks) : 0.0);
+    fprintf(stderr, "allocations per decision: %.2f\n",
+            (decisions > 0) ? ((double)decisionAllocations / decisions) : 0.0);
+    metricsSnapshot(&metrics);
+    metricsDifference(&metrics, &metricsBefore, &metrics);
+    metricsWrite(stderr, &metrics);
+
+    /* Random playouts from the start of a game */
+    srand(1);
+    if(selfPlayInitGame(GameInstance, numPlayers, aiLevels) != TI_OK || 
+       playoutInitialize(GameInstance) != TI_OK)
+    {
+        perror("Unable to set up playouts");
+        gameDestroy(&GameInstance);
+        SDL_Quit();
+        return 1;
+    }
+    playoutLoadState(&startState, GameInstance);
+
+    tilesPlayed = 0;
+    allocationsBefore = BenchAllocations;
+    startTicks = SDL_GetTicks();
+    for(counter=0;counter<TI_BENCH_PLAYOUTS;counter++)
+    {
+        state = startState;
+        tilesPlayed += playoutRun(&state, counter + 1);
+    }
+    playoutTicks = SDL_GetTicks() - startTicks;
+    playoutsPerSecond = TI_BENCH_PLAYOUTS * 1000.0 / ((playoutTicks > 0) ? playoutTicks : 1);
+
+    fprintf(stderr, "playouts:                 %d (%.1f tiles each)\n", TI_BENCH_PLAYOUTS,
+            (double)tilesPlayed / TI_BENCH_PLAYOUTS);
+    fprintf(stderr, "playouts per second:      %.0f\n", playoutsPerSecond);
+    fprintf(stderr, "playout allocations:      %lu\n", BenchAllocations - allocationsBefore);
+
+    gameDestroy(&GameInstance);
+    metricsDestroy();
+    SDL_Quit();
+
+    if(playoutsPerSecond < TI_BENCH_MIN_PLAYOUTS_PER_SECOND &&
+       getenv("TI_BENCH_NO_MIN_PLAYOUTS") == NULL)
+    {
+        fprintf(stderr, "Playouts are too slow (minimum is %d per second)\n", 
+                TI_BENCH_MIN_PLAYOUTS_PER_SECOND);
+        return 1;
+    }
+    return 0;
+}
@@ -36,6 +36,7 @@
 #include "tiPlayer.h"
 #include "tiGame.h"
 #include "tiComputerAI.h"
+#include "tiMetrics.h"
 
 /****************************************************************************
 * boardInitialize - see tiBoard.h for description
@@ -289,6 +290,8 @@ int boardMarkLegalMoves(Board *b, Tile *t)
 {	
     int counter, counter2, legalMoves;
 
+    TI_METRICS_ADD(TI_METRIC_LEGAL_MOVE_GENERATIONS, 1);
+
     /* Mark all moves as legal */
     for(counter=0;counter<TI_BOARD_WIDTH;counter++)
     {
@@ -587,6 +590,8 @@ int boardCalculateTrackScore(Board *b, int station, int passThruTileId,
         newType = boardFindNextTrackSection(b, oldX, oldY, oldExit,
                                             &newX, &newY, &newExit);
     }
+    TI_METRICS_ADD(TI_METRIC_TRACK_WALKS, 1);
+    TI_METRICS_ADD(TI_METRIC_TRACK_STEPS, loopCatcher);
 
     if(loopCatcher >= loopLimit)  /* Broke out from possible infinite loop */
     {
@@ -615,6 +620,43 @@ int boardCalculateTrackScore(Board *b, int station, int passThruTileId,
     return score;
 }
 
+/****************************************************************************
+* boardFollowTrack - see tiBoard.h for description
+****************************************************************************/
+int boardFollowTrack(Board *b, int x, int y, int exit, int *endX, int *endY)
+{
+    int newX, newY, newExit, newType;
+    int oldX, oldY, oldExit;
+    int loopCatcher;
+
+    newType = boardFindNextTrackSection(b, x, y, exit, &newX, &newY, &newExit);
+
+    loopCatcher = 0;
+    while((newType == TI_BOARDSQUARE_TYPE_PLAYED_TILE) &&
+          (loopCatcher < 255))
+    {
+        loopCatcher++;
+        oldX = newX;
+        oldY = newY;
+        oldExit = tileGetExit(
+                    &(b->tp->t[b->b[newX][newY].tileIndex]),
+                    newExit);
+        newType = boardFindNextTrackSection(b, oldX, oldY, oldExit,
+                                            &newX, &newY, &newExit);
+    }
+    TI_METRICS_ADD(TI_METRIC_TRACK_WALKS, 1);
+    TI_METRICS_ADD(TI_METRIC_TRACK_STEPS, loopCatcher);
+
+    if(loopCatcher >= 255)
+    {
+        return -1;
+    }
+
+    *endX = newX;
+    *endY = newY;
+    return newType;
+}
+
 /****************************************************************************
 * boardPlaceTile - see tiBoard.h for description
 ****************************************************************************/
@@ -719,7 +761,6 @@ int boardSquareSetTileIndex(BoardSquare *bsq, int tileIndex)
 Board *boardCopyBoard(Board *b)
 {
     Board *newBoard;
-    int counter, counter2;
 
     /* Copy all elements of the given board into a new one */
     newBoard = malloc(sizeof(Board));
@@ -735,6 +776,18 @@ Board *boardCopyBoard(Board *b)
         return NULL;
     }
 
+    boardCopyBoardInto(newBoard, b);
+
+    return newBoard;
+}
+
+/****************************************************************************
+* boardCopyBoardInto - see tiBoard.h for description
+****************************************************************************/
+int boardCopyBoardInto(Board *newBoard, Board *b)
+{
+    int counter, counter2;
+
     for(counter=0;counter<TI_BOARD_WIDTH;counter++)
     {
         for(counter2=0;counter2<TI_BOARD_HEIGHT;counter2++)
@@ -777,5 +830,29 @@ Board *boardCopyBoard(Board *b)
     newBoard->tp->numPlayedTiles = b->tp->numPlayedTiles;
     newBoard->tp->numUnplayedTiles = b->tp->numUnplayedTiles;
 
-    return newBoard;
+    return TI_OK;
+}
+
+/****************************************************************************
+* boardCalculateHash - see tiBoard.h for description
+****************************************************************************/
+unsigned int boardCalculateHash(Board *b)
+{
+    unsigned int hash;
+    int counter, counter2;
+
+    /* FNV-1a over the tile index and train of every square */
+    hash = 2166136261u;
+    for(counter=0;counter<TI_BOARD_WIDTH;counter++)
+    {
+        for(counter2=0;counter2<TI_BOARD_HEIGHT;counter2++)
+        {
+            hash ^= (unsigned int)(b->b[counter][counter2].tileIndex + 1);
+            hash *= 16777619u;
+            hash ^= (unsigned int)b->b[counter][counter2].trainPresent;
+            hash *= 16777619u;
+        }
+    }
+
+    return hash;
 }
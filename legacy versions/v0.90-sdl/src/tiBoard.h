@@ -208,6 +208,27 @@ int boardGetStationNumber(int x, int y);
 int boardCalculateTrackScore(Board *b, int station, int passThruTileId, 
                              int *passThruTile, int *destination);
 
+/****************************************************************************
+* boardFollowTrack
+*
+* Description:
+*   Follows the track leaving a square through a given exit and finds the
+*   square where it stops -- either a station, or the empty square that the
+*   track runs into.
+*
+* Arguments:
+*   Board *b - the board to use.
+*   int x, y - the (x,y) coordinate of the square to start from.
+*   int exit - the exit point of the square to leave through.
+*   int *endX, *endY - the (x,y) coordinate of the square the track stops at.
+*
+* Returns:
+*   The type of board square that the track stops at, or -1 if the track
+*   couldn't be followed.
+*
+****************************************************************************/
+int boardFollowTrack(Board *b, int x, int y, int exit, int *endX, int *endY);
+
 /****************************************************************************
 * boardPlaceTile
 *
@@ -269,6 +290,25 @@ int boardSquareSetTileIndex(BoardSquare *bsq, int tileIndex);
 ****************************************************************************/
 Board *boardCopyBoard(Board *b);
 
+/****************************************************************************
+* boardCopyBoardInto
+*
+* Description:
+*   Copies a Board into one that has already been allocated, without 
+*   allocating any memory.  Used where a scratch copy of the board is needed
+*   often, such as by the computer AI.
+*
+* Arguments:
+*   Board *newBoard - the board to copy into.  newBoard->tp must point to a
+*                     TilePool, which receives a copy of the board's tiles.
+*   Board *b        - the board to copy
+*
+* Returns:
+*   TI_OK.
+*
+****************************************************************************/
+int boardCopyBoardInto(Board *newBoard, Board *b);
+
 /****************************************************************************
 * boardRemoveTile
 *
@@ -285,4 +325,21 @@ Board *boardCopyBoard(Board *b);
 ****************************************************************************/
 int boardRemoveTile(Board *b, int x, int y);
 
+/****************************************************************************
+* boardCalculateHash
+*
+* Description:
+*   Calculates a hash of the parts of the board that affect the value of
+*   a move -- the tile placed in each square and the train waiting at
+*   each station.  Two boards with the same hash can share move analysis.
+*
+* Arguments:
+*   Board *b - the board to hash
+*
+* Returns:
+*   The hash value of the board.
+*
+****************************************************************************/
+unsigned int boardCalculateHash(Board *b);
+
 #endif /* __TIBOARD_H__ */
@@ -36,19 +36,45 @@
 #include "tiPlayer.h"
 #include "tiGame.h"
 #include "tiComputerAI.h"
+#include "tiMetrics.h"
+#include "tiLog.h"
+
+/* Positions evaluated ahead of time (see computerPonder) */
+static AIPonderEntry PonderTable[TI_CPU_PONDER_TABLE_SIZE];
+static unsigned int PonderClock = 0;
+static Board *PonderBoard = NULL;
+
+/* The evaluation profile of each player (see computerGetPlayerProfile) */
+static AIEvalProfile PlayerProfiles[TI_MAX_PLAYERS];
+static int PlayerProfilesSet = TI_FALSE;
+
+/* Endgame solver state (see computerEndgameSelectMove).  The keys are
+   random numbers that are combined to make a position's key. */
+static int EndgamePoolSize = TI_CPU_ENDGAME_POOL_SIZE;
+static AIEndgameEntry EndgameTable[TI_CPU_ENDGAME_TABLE_SIZE];
+static int EndgameGeneration = 0;
+static int EndgameKeysReady = TI_FALSE;
+static unsigned long long EndgameSquareKeys[TI_BOARD_WIDTH][TI_BOARD_HEIGHT][TI_TILEPOOL_NUM_TILE_TYPES];
+static unsigned long long EndgameHandKeys[TI_MAX_PLAYERS][2][TI_TILEPOOL_NUM_TILE_TYPES+2];
+static unsigned long long EndgameUnseenKeys[TI_TILEPOOL_NUM_TILE_TYPES][TI_TILEPOOL_NUM_TILES+1];
+static unsigned long long EndgameTurnKeys[TI_MAX_PLAYERS][2][TI_MAX_PLAYERS+1];
 
 /****************************************************************************
  * computerDetermineNextMove - see tiComputerAI.h for description
  ****************************************************************************/
-ComputerAIPacket *computerDetermineNextMove(ComputerAIPacket *lastMove)
+int computerDetermineNextMove(ComputerAIPacket *lastMove, ComputerAIPacket *p)
 {
-    ComputerAIPacket *p;
     Game *g;
     int tileQuantity;
-    AIMoveEval *evalList, *selectedMove;
-    Board *boardCopy;
+    AIMoveList evalList;
+    AIMoveEval *selectedMove;
+    Board boardCopyStorage, *boardCopy;
+    TilePool tilePoolCopy;
     int holdingPrimary, holdingSecondary, legalMoves, legalMoves2;
     int tilesInPool;
+#ifndef TI_NO_METRICS
+    unsigned long startTime;
+#endif
 
     /* How to decide on a move (V1):
      *
@@ -93,20 +119,22 @@ ComputerAIPacket *computerDetermineNextMove(ComputerAIPacket *lastMove)
      *   int tileY    (the y position of the tile)
      *   int value    (the value of the this move)
      *
-     * Create a linked list of this structure and add an element for each
-     * move evaluated.
+     * There can never be more than one move per square for each of the two
+     * held tiles, so the moves are kept in a fixed size list on the stack,
+     * and the move to make is picked out of it without sorting the whole
+     * list.  The scratch board lives on the stack as well, so deciding on
+     * a move doesn't touch the heap at all.
      */
 
+#ifndef TI_NO_METRICS
+    startTime = metricsGetMicroseconds();
+#endif
     g = gameGetGlobalGameInstance();
-    boardCopy = boardCopyBoard(g->board);
-
-    p = malloc(sizeof(ComputerAIPacket));
-    if(p == NULL)
-    {
-        return NULL;
-    }
+    boardCopy = &boardCopyStorage;
+    boardCopy->tp = &tilePoolCopy;
+    boardCopyBoardInto(boardCopy, g->board);
 
-    evalList = NULL;
+    evalList.numMoves = 0;
 
     tileQuantity = 0;
     holdingPrimary = TI_FALSE;
@@ -133,13 +161,11 @@ ComputerAIPacket *computerDetermineNextMove(ComputerAIPacket *lastMove)
             if(tilesInPool > 0)
             {
                 p->moveType = TI_CPU_MOVE_DRAW;
-                printf("    - Computer's move is 'TI_CPU_MOVE_DRAW'\n");
             }
             /* If there are no tiles left, pass */
             else
             {
                 p->moveType = TI_CPU_MOVE_END_TURN;
-                printf("    - Computer's move is 'TI_CPU_MOVE_END_TURN (pass)'\n");
             }
         }
         /* One tile in hand */
@@ -162,13 +188,11 @@ ComputerAIPacket *computerDetermineNextMove(ComputerAIPacket *lastMove)
                 if(tilesInPool > 0)
                 {
                     p->moveType = TI_CPU_MOVE_DRAW;
-                    printf("    - Computer's move is 'TI_CPU_MOVE_DRAW'\n");
                 }
                 /* If no tiles remain, pass */
                 else
                 {
                     p->moveType = TI_CPU_MOVE_END_TURN;
-                    printf("    - Computer's move is 'TI_CPU_MOVE_END_TURN (pass)'\n");
                 }
             }
             /* This tile has legal moves -- analyze them and pick one */
@@ -183,13 +207,11 @@ ComputerAIPacket *computerDetermineNextMove(ComputerAIPacket *lastMove)
                 {
                     computerMoveAnalyzeMoves(&evalList, boardCopy, g->players[g->curPlayer].reserveTileId, TI_CPU_HELD_TILE_RESERVE);
                 }
-                computerMoveEvalListSort(&evalList);
-                selectedMove = computerMoveSelectListMove(&evalList);
+                selectedMove = computerMoveSelectListMove(&evalList, boardCopy);
                 p->moveType = TI_CPU_MOVE_PLAY;
                 p->moveX = selectedMove->tileX;
                 p->moveY = selectedMove->tileY;
                 p->heldTile = selectedMove->tileType;
-                printf("    - Computer's move is 'TI_CPU_MOVE_PLAY' (%c at (%d, %d))\n", (p->heldTile == TI_CPU_HELD_TILE_PRIMARY) ? 'P' : 'S', p->moveX, p->moveY);
             }
         }
         /* Two tiles in hand */
@@ -216,18 +238,15 @@ ComputerAIPacket *computerDetermineNextMove(ComputerAIPacket *lastMove)
             {
                 p->moveType = TI_CPU_MOVE_DISCARD;
                 p->heldTile = TI_CPU_HELD_TILE_RESERVE;
-                printf("    - Computer's move is 'TI_CPU_MOVE_DISCARD (secondary)'\n");
             }
             /* Legal moves are available, pick one */
             else
             {
-                computerMoveEvalListSort(&evalList);
-                selectedMove = computerMoveSelectListMove(&evalList);
+                selectedMove = computerMoveSelectListMove(&evalList, boardCopy);
                 p->moveType = TI_CPU_MOVE_PLAY;
                 p->moveX = selectedMove->tileX;
                 p->moveY = selectedMove->tileY;
                 p->heldTile = selectedMove->tileType;
-                printf("    - Computer's move is 'TI_CPU_MOVE_PLAY' (%c at (%d, %d))\n", (p->heldTile == TI_CPU_HELD_TILE_PRIMARY) ? 'P' : 'S', p->moveX, p->moveY);
             }
         }
     }
@@ -240,8 +259,6 @@ ComputerAIPacket *computerDetermineNextMove(ComputerAIPacket *lastMove)
            lastMove->moveType == TI_CPU_MOVE_END_TURN)
         {
             p->moveType = TI_CPU_MOVE_END_TURN;
-            printf("    - Computer's move is 'TI_CPU_MOVE_END_TURN'\n");
-            SDL_Delay((rand() % TI_CPU_PASS_DYNAMIC_DELAY) + TI_CPU_PASS_STATIC_DELAY);
         }
         /* If the last move was draw, determine what to do now */
         else
@@ -250,8 +267,6 @@ ComputerAIPacket *computerDetermineNextMove(ComputerAIPacket *lastMove)
             if(tileQuantity == 0)
             {
                p->moveType = TI_CPU_MOVE_END_TURN;
-               printf("    - Computer's move is 'TI_CPU_MOVE_END_TURN'\n");
-               SDL_Delay((rand() % TI_CPU_PASS_DYNAMIC_DELAY) + TI_CPU_PASS_STATIC_DELAY);
             }
             /* If one tile, either pass or play, depending on whether there are legal moves */
             else if(tileQuantity == 1)
@@ -270,8 +285,6 @@ ComputerAIPacket *computerDetermineNextMove(ComputerAIPacket *lastMove)
                 if(legalMoves == 0)
                 {
                     p->moveType = TI_CPU_MOVE_END_TURN;
-                    printf("    - Computer's move s 'TI_CPU_MOVE_END_TURN (pass)'\n");
-                    SDL_Delay((rand() % TI_CPU_DYNAMIC_DELAY) + TI_CPU_STATIC_DELAY);
                 }
                 /* If the tile has legal moves, analyze the available moves and play */
                 else
@@ -284,13 +297,11 @@ ComputerAIPacket *computerDetermineNextMove(ComputerAIPacket *lastMove)
                     {
                         computerMoveAnalyzeMoves(&evalList, boardCopy, g->players[g->curPlayer].reserveTileId, TI_CPU_HELD_TILE_RESERVE);
                     }
-                    computerMoveEvalListSort(&evalList);
-                    selectedMove = computerMoveSelectListMove(&evalList);
+                    selectedMove = computerMoveSelectListMove(&evalList, boardCopy);
                     p->moveType = TI_CPU_MOVE_PLAY;
                     p->moveX = selectedMove->tileX;
                     p->moveY = selectedMove->tileY;
                     p->heldTile = selectedMove->tileType;
-                    printf("    - Computer's move is 'TI_CPU_MOVE_PLAY' (%c at (%d, %d))\n", (p->heldTile == TI_CPU_HELD_TILE_PRIMARY) ? 'P' : 'S', p->moveX, p->moveY);
                 }
             }
             /* If two tiles, play or discard, depending on whether there are legal
@@ -318,41 +329,51 @@ ComputerAIPacket *computerDetermineNextMove(ComputerAIPacket *lastMove)
                 {
                     p->moveType = TI_CPU_MOVE_DISCARD;
                     p->heldTile = TI_CPU_HELD_TILE_RESERVE;
-                    printf("    - Computer's move is 'TI_CPU_MOVE_DISCARD (secondary)'\n");
                 }
                 /* Legal moves are available, pick one. */
                 else
                 {
-                    computerMoveEvalListSort(&evalList);
-                    selectedMove = computerMoveSelectListMove(&evalList);
+                    selectedMove = computerMoveSelectListMove(&evalList, boardCopy);
                     p->moveType = TI_CPU_MOVE_PLAY;
                     p->moveX = selectedMove->tileX;
                     p->moveY = selectedMove->tileY;
                     p->heldTile = selectedMove->tileType;
-                    printf("    - Computer's move is 'TI_CPU_MOVE_PLAY' (%c at (%d, %d))\n", (p->heldTile == TI_CPU_HELD_TILE_PRIMARY) ? 'P' : 'S', p->moveX, p->moveY);
                 }
             }
         }
     }
 
-    tilePoolDestroy(&(boardCopy->tp));
-    boardDestroy(&boardCopy);
-    computerMoveEvalListFree(&evalList);
-    return p;
+    /* A pass is ending the turn without having played anything */
+    if(p->moveType == TI_CPU_MOVE_END_TURN)
+    {
+        TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_CPU_MOVE, p->moveType,
+               (lastMove == NULL || lastMove->moveType == TI_CPU_MOVE_DRAW) ? TI_TRUE : TI_FALSE, 0, 0);
+    }
+    else
+    {
+        TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_CPU_MOVE, p->moveType, p->heldTile, p->moveX, p->moveY);
+    }
+    TI_METRICS_DECISION(metricsGetMicroseconds() - startTime);
+
+    return TI_OK;
 }
 
 /****************************************************************************
  * computerMoveAnalyzeMoves - see tiComputerAI.h for description
  ****************************************************************************/
-int computerMoveAnalyzeMoves(AIMoveEval **p, Board *b, int tileIndex, int heldTile)
+int computerMoveAnalyzeMoves(AIMoveList *p, Board *b, int tileIndex, int heldTile)
 {
-    int counter, counter2, counter3;
-    int value, stationX, stationY, exit, score, passThru, destination;
+    int counter, counter2;
+    int value;
     Game *g;
-    float weight;
+    AIPonderEntry *e;
 
     g = gameGetGlobalGameInstance();
 
+    /* Any squares already evaluated for this position (either while
+       pondering, or earlier this turn) don't need to be evaluated again */
+    e = computerPonderGetEntry(b, g->curPlayer, tileIndex);
+
     /* Loop through and check for each legal move */
     for(counter=1;counter<TI_BOARD_WIDTH-1;counter++)
     {
@@ -360,180 +381,500 @@ int computerMoveAnalyzeMoves(AIMoveEval **p, Board *b, int tileIndex, int heldTi
         {
             if(b->legalMove[counter][counter2] == TI_BOARD_LEGAL_MOVE)
             {
-                value = 0;
-                /* Play the move */
-                boardPlaceTile(b, counter, counter2, tileIndex);
-                /* For each station, if a train is positioned there, check for
-                   partial/complete tracks, and either add or subtract the score
-                   from the value, depending on who owns the station */
-                for(counter3=0;counter3<TI_BOARD_NUM_STATIONS;counter3++)
+                if(e->evaluated[counter][counter2] == TI_TRUE)
+                {
+                    value = e->value[counter][counter2];
+                }
+                else
+                {
+                    value = computerMoveEvaluateSquare(b, counter, counter2,
+                                tileIndex, g->curPlayer,
+                                e->trackEnds[counter][counter2]);
+                    e->value[counter][counter2] = value;
+                    e->evaluated[counter][counter2] = TI_TRUE;
+                }
+                computerMoveListAdd(p, heldTile, counter, counter2, value);
+            }
+        }
+    }
+
+    return TI_OK;
+}
+
+/****************************************************************************
+ * computerMoveEvaluateSquare - see tiComputerAI.h for description
+ ****************************************************************************/
+int computerMoveEvaluateSquare(Board *b, int x, int y, int tileIndex, int player,
+                               signed char *trackEnds)
+{
+    int counter, counter2, numEnds, end, endX, endY, found;
+    int value, stationX, stationY, exit, score, passThru, destination;
+    Game *g;
+    AIEvalProfile *profile;
+    float weight;
+
+    g = gameGetGlobalGameInstance();
+    profile = computerGetPlayerProfile(player);
+    TI_METRICS_ADD(TI_METRIC_PLACEMENTS_EVALUATED, 1);
+
+    value = 0;
+    numEnds = 0;
+    /* Play the move */
+    boardPlaceTile(b, x, y, tileIndex);
+    /* For each station, if a train is positioned there, check for
+       partial/complete tracks, and either add or subtract the score
+       from the value, depending on who owns the station */
+    for(counter=0;counter<TI_BOARD_NUM_STATIONS;counter++)
+    {
+        boardGetStationInfo(counter, &stationX, &stationY, &exit);
+        if(b->b[stationX][stationY].trainPresent != TI_BOARD_NO_TRAIN)
+        {
+            weight = 1.0;
+            score = boardCalculateTrackScore(b, counter, tileIndex, &passThru, &destination);
+            if(passThru == TI_TRUE)
+            {
+                if(destination == TI_BOARDSQUARE_TYPE_TILE)
+                {
+                    weight = profile->incompleteTrack;
+                }
+                else if(destination == TI_BOARDSQUARE_TYPE_STATION)
+                {
+                    weight = profile->completeTrack;
+                }
+                else if(destination == TI_BOARDSQUARE_TYPE_CENTRAL)
+                {
+                    weight = profile->completeCentralStation;
+                }
+
+                if(b->playerStations[g->numPlayers][counter] == (player+1))
                 {
-                    boardGetStationInfo(counter3, &stationX, &stationY, &exit);
-                    if(b->b[stationX][stationY].trainPresent != TI_BOARD_NO_TRAIN)
+                    value += (score * weight);
+                }
+                else
+                {
+                    /* Completing an opponent's track blocks it from growing */
+                    if(destination == TI_BOARDSQUARE_TYPE_STATION)
                     {
-                        weight = 1.0;
-                        score = boardCalculateTrackScore(b, counter3, tileIndex, &passThru, &destination);
-                        if(passThru == TI_TRUE)
-                        {
-                            if(destination == TI_BOARDSQUARE_TYPE_TILE)
-                            {
-                                weight = TI_CPU_WEIGHT_INCOMPLETE_TRACK;
-                            }
-                            else if(destination == TI_BOARDSQUARE_TYPE_STATION)
-                            {
-                                weight = TI_CPU_WEIGHT_COMPLETE_TRACK;
-                            }
-                            else if(destination == TI_BOARDSQUARE_TYPE_CENTRAL)
-                            {
-                                weight = TI_CPU_WEIGHT_COMPLETE_CENTRAL_STATION;
-                            }
-
-                            if(b->playerStations[g->numPlayers][counter3] == (g->curPlayer+1))
-                            {
-                                value += (score * weight);
-                            }
-                            else
-                            {
-                                value -= (score * weight);
-                            }
-                        }
+                        weight /= profile->blockOpponent;
                     }
+                    value -= (score * weight);
                 }
+            }
+        }
+    }
 
-                boardRemoveTile(b, counter, counter2);
-                computerMoveEvalListAdd(p, heldTile, counter, counter2, value);
+    /* Remember the empty squares that the tracks through the tile run into
+       in each direction.  The value of this move can't change until a tile
+       gets played on one of them. */
+    if(trackEnds != NULL)
+    {
+        for(counter=0;counter<TI_TILE_NUM_EXITS;counter++)
+        {
+            if(boardFollowTrack(b, x, y, counter, &endX, &endY) == TI_BOARDSQUARE_TYPE_TILE)
+            {
+                end = endX * TI_BOARD_HEIGHT + endY;
+                found = TI_FALSE;
+                for(counter2=0;counter2<numEnds;counter2++)
+                {
+                    if(trackEnds[counter2] == end)
+                    {
+                        found = TI_TRUE;
+                    }
+                }
+                if(found == TI_FALSE)
+                {
+                    trackEnds[numEnds++] = (signed char)end;
+                }
             }
         }
+        trackEnds[numEnds] = -1;
     }
 
-    return TI_OK;
+    boardRemoveTile(b, x, y);
+
+    return value;
 }
 
 /****************************************************************************
- * computerMoveEvalListSort - see tiComputerAI.h for description
+ * computerPonderGetEntry - see tiComputerAI.h for description
  ****************************************************************************/
-AIMoveEval *computerMoveEvalListSort(AIMoveEval **list)
+AIPonderEntry *computerPonderGetEntry(Board *b, int player, int tileIndex)
 {
-    AIMoveEval *p, *q, *e, *tail;
-    int insize, nmerges, psize, qsize, i;
+    int counter, counter2, counter3, counter4;
+    int changes, bestChanges, valid, tileType;
+    unsigned int hash;
+    AIPonderEntry *e, *parent;
 
-    /* Perform a merge sort on the list to sort the list elements by value.
-     */
-    if(*list == NULL)
+    hash = boardCalculateHash(b);
+    tileType = b->tp->t[tileIndex].tileStripOffset;
+    PonderClock++;
+
+    /* Look for an exact match first.  The board is compared as well as the
+       hash, so a collision can't hand back the wrong results. */
+    for(counter=0;counter<TI_CPU_PONDER_TABLE_SIZE;counter++)
     {
-        return NULL;
+        e = &(PonderTable[counter]);
+        if(e->inUse == TI_TRUE && e->hash == hash && e->player == player &&
+           e->tileType == tileType &&
+           computerPonderCountChanges(e, b) == 0)
+        {
+            e->lastUsed = PonderClock;
+            return e;
+        }
     }
 
-    insize = 1;
+    /* Find the closest earlier position for this player and tile type -- one
+       that only differs from this board by tiles that have since been played */
+    parent = NULL;
+    bestChanges = TI_BOARD_WIDTH * TI_BOARD_HEIGHT;
+    for(counter=0;counter<TI_CPU_PONDER_TABLE_SIZE;counter++)
+    {
+        e = &(PonderTable[counter]);
+        if(e->inUse == TI_TRUE && e->player == player && e->tileType == tileType)
+        {
+            changes = computerPonderCountChanges(e, b);
+            if(changes >= 0 && changes < bestChanges)
+            {
+                bestChanges = changes;
+                parent = e;
+            }
+        }
+    }
+
+    /* Pick an entry to replace -- an unused one, or the least recently used */
+    e = NULL;
+    for(counter=0;counter<TI_CPU_PONDER_TABLE_SIZE;counter++)
+    {
+        if(&(PonderTable[counter]) == parent)
+        {
+            continue;
+        }
+        if(PonderTable[counter].inUse == TI_FALSE)
+        {
+            e = &(PonderTable[counter]);
+            break;
+        }
+        if(e == NULL || PonderTable[counter].lastUsed < e->lastUsed)
+        {
+            e = &(PonderTable[counter]);
+        }
+    }
 
-    while(1)
+    e->inUse = TI_TRUE;
+    e->hash = hash;
+    e->lastUsed = PonderClock;
+    e->player = player;
+    e->tileType = tileType;
+    for(counter=0;counter<TI_BOARD_WIDTH;counter++)
     {
-        p = *list;
-        *list = NULL;
-        tail = NULL;
+        for(counter2=0;counter2<TI_BOARD_HEIGHT;counter2++)
+        {
+            e->boardTiles[counter][counter2] = b->b[counter][counter2].tileIndex;
+            e->evaluated[counter][counter2] = TI_FALSE;
+        }
+    }
 
-        nmerges = 0;
+    if(parent == NULL)
+    {
+        return e;
+    }
 
-        while(p != NULL)
+    /* Carry forward every result whose tracks didn't run into one of the
+       newly played tiles */
+    for(counter=1;counter<TI_BOARD_WIDTH-1;counter++)
+    {
+        for(counter2=1;counter2<TI_BOARD_HEIGHT-1;counter2++)
         {
-            nmerges++;
-            q = p;
-            psize = 0;
-            for(i = 0; i < insize; i++)
+            if(parent->evaluated[counter][counter2] == TI_FALSE ||
+               b->b[counter][counter2].tileIndex != TI_TILE_NO_TILE)
+            {
+                continue;
+            }
+            valid = TI_TRUE;
+            for(counter3=0;parent->trackEnds[counter][counter2][counter3] != -1;counter3++)
             {
-                psize++;
-                q = q->next;
-                if(q == NULL)
+                counter4 = parent->trackEnds[counter][counter2][counter3];
+                if(parent->boardTiles[counter4 / TI_BOARD_HEIGHT][counter4 % TI_BOARD_HEIGHT] !=
+                   b->b[counter4 / TI_BOARD_HEIGHT][counter4 % TI_BOARD_HEIGHT].tileIndex)
                 {
+                    valid = TI_FALSE;
                     break;
                 }
             }
+            if(valid == TI_TRUE)
+            {
+                e->value[counter][counter2] = parent->value[counter][counter2];
+                memcpy(e->trackEnds[counter][counter2], parent->trackEnds[counter][counter2],
+                       sizeof(e->trackEnds[counter][counter2]));
+                e->evaluated[counter][counter2] = TI_TRUE;
+            }
+        }
+    }
+
+    return e;
+}
+
+/****************************************************************************
+ * computerPonder - see tiComputerAI.h for description
+ ****************************************************************************/
+int computerPonder(Uint32 timeSlice)
+{
+    Game *g;
+    AIPonderEntry *e;
+    Uint32 startTime;
+    int counter, counter2, counter3, counter4;
+    int player, tileIndex, numCandidates;
+    int candidates[TI_TILEPOOL_NUM_TILES + 2];
+    int typeSeen[TI_TILEPOOL_NUM_TILE_TYPES];
+
+    g = gameGetGlobalGameInstance();
+    startTime = SDL_GetTicks();
+
+    /* Keep a private copy of the board to ponder on, since marking legal
+       moves on the real board would disturb the human player's view of it */
+    if(PonderBoard == NULL ||
+       boardCalculateHash(PonderBoard) != boardCalculateHash(g->board) ||
+       PonderBoard->tp->numUnplayedTiles != g->tilepool->numUnplayedTiles)
+    {
+        computerPonderFreeBoard();
+        PonderBoard = boardCopyBoard(g->board);
+        if(PonderBoard == NULL)
+        {
+            return TI_FALSE;
+        }
+    }
+
+    /* Work through the computer players in the order they'll take their turns */
+    for(counter=1;counter<g->numPlayers;counter++)
+    {
+        player = (g->curPlayer + counter) % g->numPlayers;
+        if(g->players[player].controlledBy != TI_PLAYER_COMPUTER)
+        {
+            continue;
+        }
 
-            qsize = insize;
+        /* The tiles the player could end up playing -- the ones in hand, and
+           one of each type still left in the tile pool */
+        numCandidates = 0;
+        candidates[numCandidates++] = g->players[player].currentTileId;
+        candidates[numCandidates++] = g->players[player].reserveTileId;
+        for(counter2=0;counter2<g->tilepool->numUnplayedTiles;counter2++)
+        {
+            candidates[numCandidates++] = g->tilepool->unplayedTiles[counter2];
+        }
+        memset(typeSeen, 0, sizeof(typeSeen));
 
-            while(psize > 0 || (qsize > 0 && q != NULL)) 
+        for(counter2=0;counter2<numCandidates;counter2++)
+        {
+            tileIndex = candidates[counter2];
+            if(tileIndex == TI_TILE_NO_TILE ||
+               typeSeen[g->tilepool->t[tileIndex].tileStripOffset] == TI_TRUE)
             {
-                if(psize == 0)
-                {
-                    e = q;
-                    q = q->next;
-                    qsize--;
-                }
-                else if(qsize == 0 || q == NULL)
-                {
-                    e = p;
-                    p = p->next;
-                    psize--;
-                }
-                else if(p->value >= q->value)
-                {
-                    e = p;
-                    p = p->next;
-                    psize--;
-                }
-                else
-                {
-                    e = q;
-                    q = q->next;
-                    qsize--;
-                }
+                continue;
+            }
+            typeSeen[g->tilepool->t[tileIndex].tileStripOffset] = TI_TRUE;
 
-                if(tail != NULL)
+            e = computerPonderGetEntry(PonderBoard, player, tileIndex);
+            boardMarkLegalMoves(PonderBoard, tilePoolGetTile(PonderBoard->tp, tileIndex));
+            for(counter3=1;counter3<TI_BOARD_WIDTH-1;counter3++)
+            {
+                for(counter4=1;counter4<TI_BOARD_HEIGHT-1;counter4++)
                 {
-                    tail->next = e;
+                    if(PonderBoard->legalMove[counter3][counter4] == TI_BOARD_LEGAL_MOVE &&
+                       e->evaluated[counter3][counter4] == TI_FALSE)
+                    {
+                        if(SDL_GetTicks() - startTime >= timeSlice)
+                        {
+                            return TI_TRUE;
+                        }
+                        e->value[counter3][counter4] =
+                            computerMoveEvaluateSquare(PonderBoard, counter3, counter4,
+                                tileIndex, player, e->trackEnds[counter3][counter4]);
+                        e->evaluated[counter3][counter4] = TI_TRUE;
+                    }
                 }
-                else
+            }
+        }
+    }
+
+    return TI_FALSE;
+}
+
+/****************************************************************************
+ * computerPonderReset - see tiComputerAI.h for description
+ ****************************************************************************/
+void computerPonderReset(void)
+{
+    int counter;
+
+    for(counter=0;counter<TI_CPU_PONDER_TABLE_SIZE;counter++)
+    {
+        PonderTable[counter].inUse = TI_FALSE;
+    }
+    PonderClock = 0;
+    computerPonderFreeBoard();
+}
+
+/****************************************************************************
+ * computerPonderCountChanges - see tiComputerAI.h for description
+ ****************************************************************************/
+int computerPonderCountChanges(AIPonderEntry *e, Board *b)
+{
+    int counter, counter2, changes;
+
+    changes = 0;
+    for(counter=0;counter<TI_BOARD_WIDTH;counter++)
+    {
+        for(counter2=0;counter2<TI_BOARD_HEIGHT;counter2++)
+        {
+            if(e->boardTiles[counter][counter2] != b->b[counter][counter2].tileIndex)
+            {
+                if(e->boardTiles[counter][counter2] != TI_TILE_NO_TILE)
                 {
-                    *list = e;
+                    return -1;
                 }
-                tail = e;
+                changes++;
             }
-
-            p = q;
         }
-        tail->next = NULL;
+    }
+
+    return changes;
+}
+
+/****************************************************************************
+ * computerPonderFreeBoard - see tiComputerAI.h for description
+ ****************************************************************************/
+void computerPonderFreeBoard(void)
+{
+    if(PonderBoard != NULL)
+    {
+        tilePoolDestroy(&(PonderBoard->tp));
+        boardDestroy(&PonderBoard);
+    }
+}
+
+/****************************************************************************
+ * computerMoveListAdd - see tiComputerAI.h for description
+ ****************************************************************************/
+AIMoveEval *computerMoveListAdd(AIMoveList *p, int type, int x, int y, int val)
+{
+    AIMoveEval *a;
+
+    if(p->numMoves >= TI_CPU_MAX_MOVES)
+    {
+        return NULL;
+    }
+
+    a = &(p->moves[p->numMoves]);
+    p->numMoves++;
+    a->tileType = type;
+    a->tileX = x;
+    a->tileY = y;
+    a->value = val;
+    return a;
+}
+
+/****************************************************************************
+ * computerMoveEvalRanksAhead - see tiComputerAI.h for description
+ ****************************************************************************/
+int computerMoveEvalRanksAhead(AIMoveEval *a, AIMoveEval *b)
+{
+    int orderA, orderB;
+
+    if(a->value != b->value)
+    {
+        return (a->value > b->value) ? TI_TRUE : TI_FALSE;
+    }
 
-        if(nmerges<=1)
+    /* Moves of equal value are ranked with the most recently analyzed move
+       first, which is the order that the moves were always picked in */
+    orderA = (a->tileType * TI_BOARD_WIDTH + a->tileX) * TI_BOARD_HEIGHT + a->tileY;
+    orderB = (b->tileType * TI_BOARD_WIDTH + b->tileX) * TI_BOARD_HEIGHT + b->tileY;
+    return (orderA > orderB) ? TI_TRUE : TI_FALSE;
+}
+
+/****************************************************************************
+ * computerMoveListSelect - see tiComputerAI.h for description
+ ****************************************************************************/
+AIMoveEval *computerMoveListSelect(AIMoveList *p, int n)
+{
+    AIMoveEval pivot, temp;
+    int left, right, store, counter;
+
+    if(n < 0 || n >= p->numMoves)
+    {
+        return NULL;
+    }
+
+    /* Quickselect -- partition around the middle element until the 
+       partition point lands on n.  Only the side holding n is revisited, 
+       so this is linear on average rather than the n log n of a sort. */
+    left = 0;
+    right = p->numMoves - 1;
+    while(left < right)
+    {
+        pivot = p->moves[(left + right) / 2];
+        p->moves[(left + right) / 2] = p->moves[right];
+        p->moves[right] = pivot;
+
+        store = left;
+        for(counter=left;counter<right;counter++)
         {
-            AIMoveEval *ptr = *list;
-            while(ptr != NULL)
+            if(computerMoveEvalRanksAhead(&(p->moves[counter]), &pivot) == TI_TRUE)
             {
-                ptr = ptr->next;
+                temp = p->moves[counter];
+                p->moves[counter] = p->moves[store];
+                p->moves[store] = temp;
+                store++;
             }
-            return *list;
         }
+        p->moves[right] = p->moves[store];
+        p->moves[store] = pivot;
 
-        insize *=2;
+        if(n == store)
+        {
+            break;
+        }
+        else if(n < store)
+        {
+            right = store - 1;
+        }
+        else
+        {
+            left = store + 1;
+        }
     }
+
+    return &(p->moves[n]);
 }
 
 /****************************************************************************
  * computerMoveSelectListMove - see tiComputerAI.h for description
  ****************************************************************************/
-AIMoveEval *computerMoveSelectListMove(AIMoveEval **evalList)
+AIMoveEval *computerMoveSelectListMove(AIMoveList *evalList, Board *b)
 {
-    AIMoveEval *ctr, *movePtr;
-    int numMoves, moveIndex, aiLevel, index;
+    AIMoveEval *movePtr;
+    int numMoves, moveIndex, aiLevel, counter, numPositive;
     Game *g;
 
     g = gameGetGlobalGameInstance();
-    ctr = *evalList;
-    numMoves = 0;
+    numMoves = evalList->numMoves;
     aiLevel = g->players[g->curPlayer].computerAiLevel;
 
-    while(ctr != NULL)
-    {
-        numMoves++;
-        ctr = ctr->next;
-    }
-
     if(numMoves <= 0)
     {
         return NULL;
     }
 
-    /* Reset the list pointer */
-    ctr = *evalList;
+    /* Near the end of the game, the best AI works out the best move exactly */
+    if(aiLevel == TI_PLAYER_AI_SMARTEST && numMoves > 1)
+    {
+        movePtr = computerEndgameSelectMove(evalList, b);
+        if(movePtr != NULL)
+        {
+            return movePtr;
+        }
+    }
 
     /* If there are less than 3 moves:
         - Best AI = best move
@@ -553,53 +894,43 @@ AIMoveEval *computerMoveSelectListMove(AIMoveEval **evalList)
            aiLevel == TI_PLAYER_AI_SMARTER)
         {
             moveIndex = 0;
-            movePtr = *evalList;
         }
         else
         {
             moveIndex = (numMoves - 1);
-            movePtr = *evalList;
-            for(index=0;index<moveIndex;index++)
-            {
-                movePtr = movePtr->next;
-            }
         }
+        movePtr = computerMoveListSelect(evalList, moveIndex);
     }
     else
     {
         if(aiLevel == TI_PLAYER_AI_SMARTEST)
         {
-            moveIndex = 0;
-            movePtr = *evalList;
+            movePtr = computerMoveListSelect(evalList, 0);
         }
         else if(aiLevel == TI_PLAYER_AI_SMARTER)
         {
             moveIndex = (int)((float)numMoves - 1.0) * 0.33;
-            movePtr = *evalList;
-            for(index=0;index<moveIndex;index++)
-            {
-                movePtr = movePtr->next;
-            }
+            movePtr = computerMoveListSelect(evalList, moveIndex);
             if(movePtr->value <= 0)
             {
-                moveIndex = 0;
-                movePtr = *evalList;
-                while(movePtr->next != NULL &&
-                      movePtr->next->value > 0)
+                /* The weakest move with a positive score is the last of the
+                   positive moves in ranked order */
+                numPositive = 0;
+                for(counter=0;counter<numMoves;counter++)
                 {
-                    moveIndex++;
-                    movePtr = movePtr->next;
+                    if(evalList->moves[counter].value > 0)
+                    {
+                        numPositive++;
+                    }
                 }
+                moveIndex = (numPositive > 0) ? (numPositive - 1) : 0;
+                movePtr = computerMoveListSelect(evalList, moveIndex);
             }
         }
         else
         {
             moveIndex = (int)((float)numMoves - 1.0) * 0.67;
-            movePtr = *evalList;
-            for(index=0;index<moveIndex;index++)
-            {
-                movePtr = movePtr->next;
-            }
+            movePtr = computerMoveListSelect(evalList, moveIndex);
         }
     }
 
@@ -607,43 +938,659 @@ AIMoveEval *computerMoveSelectListMove(AIMoveEval **evalList)
 }
 
 /****************************************************************************
- * computerMoveEvalListAdd - see tiComputerAI.h for description
+ * computerProfileSetDefaults - see tiComputerAI.h for description
  ****************************************************************************/
-AIMoveEval *computerMoveEvalListAdd(AIMoveEval **p, int type, int x, int y, int val)
+void computerProfileSetDefaults(AIEvalProfile *p)
 {
-    AIMoveEval *a = malloc(sizeof(AIMoveEval));
-    a->next = *p;
-    *p = a;
-    a->tileType = type;
-    a->tileX = x;
-    a->tileY = y;
-    a->value = val;
-    return a;
+    p->completeTrack = TI_CPU_WEIGHT_COMPLETE_TRACK;
+    p->incompleteTrack = TI_CPU_WEIGHT_INCOMPLETE_TRACK;
+    p->completeCentralStation = TI_CPU_WEIGHT_COMPLETE_CENTRAL_STATION;
+    p->blockOpponent = TI_CPU_WEIGHT_BLOCK_OPPONENT;
 }
 
 /****************************************************************************
- * computerMoveEvalListRemove - see tiComputerAI.h for description
+ * computerProfileLoad - see tiComputerAI.h for description
  ****************************************************************************/
-void computerMoveEvalListRemove(AIMoveEval **p)
+int computerProfileLoad(AIEvalProfile *p, char *fileName)
 {
-    AIMoveEval *n;
+    FILE *fp;
+    char curLine[TI_LINE_MAX];
+    char name[TI_LINE_MAX];
+    float weight;
+    int result;
 
-    if(*p != NULL)
+    computerProfileSetDefaults(p);
+
+    fp = fopen(fileName, "r");
+    if(fp == NULL)
     {
-        n = *p;
-        *p = (*p)->next;
-        free(n);
+        return TI_ERROR;
     }
-}
 
-/****************************************************************************
- * computerMoveEvalListFree - see tiComputerAI.h for description
- ****************************************************************************/
-void computerMoveEvalListFree(AIMoveEval **p)
-{
-    while(*p != NULL)
+    while(fgets(curLine, TI_LINE_MAX, fp) != NULL)
     {
-        computerMoveEvalListRemove(p);
+        if(curLine[0] == '#' || curLine[0] == '\n')
+        {
+            continue;
+        }
+
+        result = sscanf(curLine, "%[^:]:%f", name, &weight);
+        /* Every weight divides or multiplies a score, so must be positive */
+        if(result != 2 || weight <= 0.0)
+        {
+            perror("computerProfileLoad: invalid line");
+            fclose(fp);
+            computerProfileSetDefaults(p);
+            return TI_ERROR;
+        }
+
+        if(strcmp(name, "completeTrack") == 0)
+        {
+            p->completeTrack = weight;
+        }
+        else if(strcmp(name, "incompleteTrack") == 0)
+        {
+            p->incompleteTrack = weight;
+        }
+        else if(strcmp(name, "completeCentralStation") == 0)
+        {
+            p->completeCentralStation = weight;
+        }
+        else if(strcmp(name, "blockOpponent") == 0)
+        {
+            p->blockOpponent = weight;
+        }
+        else
+        {
+            perror("computerProfileLoad: unknown weight");
+            fclose(fp);
+            computerProfileSetDefaults(p);
+            return TI_ERROR;
+        }
     }
-    *p = NULL;
+
+    if(ferror(fp))
+    {
+        perror("computerProfileLoad: file read error");
+        fclose(fp);
+        computerProfileSetDefaults(p);
+        return TI_ERROR;
+    }
+
+    fclose(fp);
+    return TI_OK;
+}
+
+/****************************************************************************
+ * computerProfileSave - see tiComputerAI.h for description
+ ****************************************************************************/
+int computerProfileSave(AIEvalProfile *p, char *fileName)
+{
+    FILE *fp;
+
+    fp = fopen(fileName, "w");
+    if(fp == NULL)
+    {
+        perror("computerProfileSave: unable to open file");
+        return TI_ERROR;
+    }
+
+    fprintf(fp, "#\n# TrackInsanity AI evaluation profile\n#\n");
+    fprintf(fp, "completeTrack:%f\n", p->completeTrack);
+    fprintf(fp, "incompleteTrack:%f\n", p->incompleteTrack);
+    fprintf(fp, "completeCentralStation:%f\n", p->completeCentralStation);
+    fprintf(fp, "blockOpponent:%f\n", p->blockOpponent);
+
+    if(fclose(fp) != 0)
+    {
+        perror("computerProfileSave: file write error");
+        return TI_ERROR;
+    }
+
+    return TI_OK;
+}
+
+/****************************************************************************
+ * computerGetPlayerProfile - see tiComputerAI.h for description
+ ****************************************************************************/
+AIEvalProfile *computerGetPlayerProfile(int player)
+{
+    int counter;
+
+    if(PlayerProfilesSet == TI_FALSE)
+    {
+        for(counter=0;counter<TI_MAX_PLAYERS;counter++)
+        {
+            computerProfileSetDefaults(&PlayerProfiles[counter]);
+        }
+        PlayerProfilesSet = TI_TRUE;
+    }
+
+    return &PlayerProfiles[player];
+}
+
+/****************************************************************************
+ * computerSetPlayerProfile - see tiComputerAI.h for description
+ ****************************************************************************/
+void computerSetPlayerProfile(int player, AIEvalProfile *p)
+{
+    int counter;
+
+    for(counter=0;counter<TI_MAX_PLAYERS;counter++)
+    {
+        if(player == TI_CPU_ALL_PLAYERS || player == counter)
+        {
+            *computerGetPlayerProfile(counter) = *p;
+        }
+    }
+
+    computerPonderReset();
+}
+
+/****************************************************************************
+ * computerSetEndgamePoolSize - see tiComputerAI.h for description
+ ****************************************************************************/
+void computerSetEndgamePoolSize(int poolSize)
+{
+    EndgamePoolSize = poolSize;
+}
+
+/****************************************************************************
+ * computerEndgameSelectMove - see tiComputerAI.h for description
+ ****************************************************************************/
+AIMoveEval *computerEndgameSelectMove(AIMoveList *evalList, Board *b)
+{
+    Game *g;
+    AIEndgameState s;
+    AIMoveEval *move, *bestMove;
+    float outcome[TI_MAX_PLAYERS];
+    float bestValue;
+    int counter, counter2, type, player, next, result, savedPoolSize;
+    int heldTiles[2], savedHand[2];
+    unsigned long long seed, *keys;
+    int numKeys;
+
+    g = gameGetGlobalGameInstance();
+    if(EndgamePoolSize <= 0 || g->tilepool->numUnplayedTiles > EndgamePoolSize)
+    {
+        return NULL;
+    }
+
+    /* Fill in the position keys the first time through (splitmix64, so the
+       keys are the same every time the game is run) */
+    if(EndgameKeysReady == TI_FALSE)
+    {
+        seed = 0x5452414b494e53ULL;
+        for(counter=0;counter<4;counter++)
+        {
+            if(counter == 0)
+            {
+                keys = &EndgameSquareKeys[0][0][0];
+                numKeys = sizeof(EndgameSquareKeys) / sizeof(unsigned long long);
+            }
+            else if(counter == 1)
+            {
+                keys = &EndgameHandKeys[0][0][0];
+                numKeys = sizeof(EndgameHandKeys) / sizeof(unsigned long long);
+            }
+            else if(counter == 2)
+            {
+                keys = &EndgameUnseenKeys[0][0];
+                numKeys = sizeof(EndgameUnseenKeys) / sizeof(unsigned long long);
+            }
+            else
+            {
+                keys = &EndgameTurnKeys[0][0][0];
+                numKeys = sizeof(EndgameTurnKeys) / sizeof(unsigned long long);
+            }
+            for(counter2=0;counter2<numKeys;counter2++)
+            {
+                seed += 0x9e3779b97f4a7c15ULL;
+                keys[counter2] = seed;
+                keys[counter2] = (keys[counter2] ^ (keys[counter2] >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                keys[counter2] = (keys[counter2] ^ (keys[counter2] >> 27)) * 0x94d049bb133111ebULL;
+                keys[counter2] = keys[counter2] ^ (keys[counter2] >> 31);
+            }
+        }
+        EndgameKeysReady = TI_TRUE;
+    }
+
+    /* Set up the position as the current player sees it */
+    s.b = b;
+    s.numPlayers = g->numPlayers;
+    s.nodes = 0;
+    s.numUnseen = 0;
+    s.numUnknownHeld = 0;
+    s.boardKey = 0;
+    for(counter=0;counter<TI_TILEPOOL_NUM_TILE_TYPES;counter++)
+    {
+        s.unseen[counter] = 0;
+        s.typeTile[counter] = TI_TILE_NO_TILE;
+    }
+    for(counter=0;counter<TI_TILEPOOL_NUM_TILES;counter++)
+    {
+        type = b->tp->t[counter].tileStripOffset;
+        s.unseen[type]++;
+        if(s.typeTile[type] == TI_TILE_NO_TILE)
+        {
+            s.typeTile[type] = counter;
+        }
+    }
+    for(counter=1;counter<TI_BOARD_WIDTH-1;counter++)
+    {
+        for(counter2=1;counter2<TI_BOARD_HEIGHT-1;counter2++)
+        {
+            if(b->b[counter][counter2].type == TI_BOARDSQUARE_TYPE_PLAYED_TILE)
+            {
+                type = b->tp->t[b->b[counter][counter2].tileIndex].tileStripOffset;
+                s.unseen[type]--;
+                s.boardKey ^= EndgameSquareKeys[counter][counter2][type];
+            }
+        }
+    }
+    for(counter=0;counter<TI_MAX_PLAYERS;counter++)
+    {
+        heldTiles[0] = g->players[counter].currentTileId;
+        heldTiles[1] = g->players[counter].reserveTileId;
+        for(counter2=0;counter2<2;counter2++)
+        {
+            if(counter >= s.numPlayers || heldTiles[counter2] == TI_TILE_NO_TILE)
+            {
+                s.hand[counter][counter2] = TI_TILE_NO_TILE;
+            }
+            else if(counter == g->curPlayer)
+            {
+                type = b->tp->t[heldTiles[counter2]].tileStripOffset;
+                s.hand[counter][counter2] = type;
+                s.unseen[type]--;
+            }
+            else
+            {
+                s.hand[counter][counter2] = TI_CPU_ENDGAME_UNKNOWN_TILE;
+                s.numUnknownHeld++;
+            }
+        }
+    }
+    for(counter=0;counter<TI_TILEPOOL_NUM_TILE_TYPES;counter++)
+    {
+        s.numUnseen += s.unseen[counter];
+    }
+    for(counter=0;counter<TI_BOARD_NUM_STATIONS;counter++)
+    {
+        boardGetStationInfo(counter, &heldTiles[0], &heldTiles[1], &type);
+        s.stationOwner[counter] = b->b[heldTiles[0]][heldTiles[1]].trainPresent;
+    }
+
+    EndgameGeneration++;
+    savedPoolSize = b->tp->numUnplayedTiles;
+    player = g->curPlayer;
+    next = (player + 1) % s.numPlayers;
+    savedHand[0] = s.hand[player][0];
+    savedHand[1] = s.hand[player][1];
+
+    /* Try each move, and keep the one with the best outcome.  Moves that
+       come out the same are ranked the usual way. */
+    bestMove = NULL;
+    bestValue = 0.0;
+    for(counter=0;counter<evalList->numMoves;counter++)
+    {
+        move = &(evalList->moves[counter]);
+        type = savedHand[move->tileType];
+        boardSquareSetTileIndex(&(b->b[move->tileX][move->tileY]), s.typeTile[type]);
+        s.boardKey ^= EndgameSquareKeys[move->tileX][move->tileY][type];
+        if(move->tileType == TI_CPU_HELD_TILE_PRIMARY)
+        {
+            s.hand[player][0] = savedHand[1];
+        }
+        s.hand[player][1] = TI_TILE_NO_TILE;
+
+        result = computerEndgameSearch(&s, next, TI_CPU_ENDGAME_TURN_START, 0, outcome);
+
+        s.hand[player][0] = savedHand[0];
+        s.hand[player][1] = savedHand[1];
+        s.boardKey ^= EndgameSquareKeys[move->tileX][move->tileY][type];
+        boardRemoveTile(b, move->tileX, move->tileY);
+
+        if(result == TI_ERROR)
+        {
+            /* Too big to solve in time */
+            b->tp->numUnplayedTiles = savedPoolSize;
+            return NULL;
+        }
+
+        if(bestMove == NULL || outcome[player] > bestValue + 0.0001 ||
+           (outcome[player] > bestValue - 0.0001 &&
+            computerMoveEvalRanksAhead(move, bestMove) == TI_TRUE))
+        {
+            bestMove = move;
+            bestValue = outcome[player];
+        }
+    }
+
+    b->tp->numUnplayedTiles = savedPoolSize;
+    return bestMove;
+}
+
+/****************************************************************************
+ * computerEndgameSearch - see tiComputerAI.h for description
+ ****************************************************************************/
+int computerEndgameSearch(AIEndgameState *s, int player, int phase, int idleTurns,
+                          float *value)
+{
+    AIEndgameEntry *e;
+    unsigned long long key;
+    int counter, numHeld, poolSize, next, result, played, discarded;
+
+    poolSize = s->numUnseen - s->numUnknownHeld;
+    numHeld = 0;
+    for(counter=0;counter<s->numPlayers;counter++)
+    {
+        numHeld += (s->hand[counter][0] != TI_TILE_NO_TILE) ? 1 : 0;
+        numHeld += (s->hand[counter][1] != TI_TILE_NO_TILE) ? 1 : 0;
+    }
+
+    /* The game is over once all of the tiles have been played.  If every
+       player has gone a turn without being able to play, the game is 
+       treated as over as well -- otherwise they could go on drawing and 
+       discarding the same tiles forever. */
+    if((poolSize == 0 && numHeld == 0) || idleTurns >= s->numPlayers)
+    {
+        computerEndgameScore(s, value);
+        return TI_OK;
+    }
+
+    key = computerEndgamePositionKey(s, player, phase, idleTurns);
+    e = &EndgameTable[key & (TI_CPU_ENDGAME_TABLE_SIZE - 1)];
+    if(e->generation == EndgameGeneration && e->key == key)
+    {
+        for(counter=0;counter<s->numPlayers;counter++)
+        {
+            value[counter] = e->value[counter];
+        }
+        return TI_OK;
+    }
+
+    s->nodes++;
+    if(s->nodes > TI_CPU_ENDGAME_MAX_NODES)
+    {
+        return TI_ERROR;
+    }
+
+    next = (player + 1) % s->numPlayers;
+    played = TI_TRUE;
+    numHeld = ((s->hand[player][0] != TI_TILE_NO_TILE) ? 1 : 0) +
+              ((s->hand[player][1] != TI_TILE_NO_TILE) ? 1 : 0);
+
+    /* Find out what any tiles the player is holding are */
+    if(s->hand[player][0] == TI_CPU_ENDGAME_UNKNOWN_TILE)
+    {
+        result = computerEndgameDraw(s, player, 0, phase, idleTurns, value);
+    }
+    else if(s->hand[player][1] == TI_CPU_ENDGAME_UNKNOWN_TILE)
+    {
+        result = computerEndgameDraw(s, player, 1, phase, idleTurns, value);
+    }
+    /* With no tiles, draw one, or pass if there are none left */
+    else if(numHeld == 0)
+    {
+        if(poolSize > 0)
+        {
+            result = computerEndgameDraw(s, player, 0, TI_CPU_ENDGAME_AFTER_DRAW,
+                                         idleTurns, value);
+        }
+        else
+        {
+            result = computerEndgameSearch(s, next, TI_CPU_ENDGAME_TURN_START,
+                                           idleTurns + 1, value);
+        }
+    }
+    /* With one tile at the start of the turn, play it, or else draw another
+       (or pass if there are none left) */
+    else if(numHeld == 1 && phase == TI_CPU_ENDGAME_TURN_START)
+    {
+        result = computerEndgamePlayTile(s, player, value, &played);
+        if(result == TI_OK && played == TI_FALSE)
+        {
+            if(poolSize > 0)
+            {
+                result = computerEndgameDraw(s, player, 1, TI_CPU_ENDGAME_AFTER_DRAW,
+                                             idleTurns, value);
+            }
+            else
+            {
+                result = computerEndgameSearch(s, next, TI_CPU_ENDGAME_TURN_START,
+                                               idleTurns + 1, value);
+            }
+        }
+    }
+    /* Otherwise, play a tile if possible.  If not, the reserve tile gets
+       discarded, or a single tile is kept for next turn. */
+    else
+    {
+        result = computerEndgamePlayTile(s, player, value, &played);
+        if(result == TI_OK && played == TI_FALSE)
+        {
+            discarded = s->hand[player][1];
+            if(discarded != TI_TILE_NO_TILE)
+            {
+                s->hand[player][1] = TI_TILE_NO_TILE;
+                s->unseen[discarded]++;
+                s->numUnseen++;
+            }
+            result = computerEndgameSearch(s, next, TI_CPU_ENDGAME_TURN_START,
+                                           idleTurns + 1, value);
+            if(discarded != TI_TILE_NO_TILE)
+            {
+                s->hand[player][1] = discarded;
+                s->unseen[discarded]--;
+                s->numUnseen--;
+            }
+        }
+    }
+
+    if(result == TI_ERROR)
+    {
+        return TI_ERROR;
+    }
+
+    /* The search below this position may have replaced the entry */
+    e->key = key;
+    e->generation = EndgameGeneration;
+    for(counter=0;counter<s->numPlayers;counter++)
+    {
+        e->value[counter] = value[counter];
+    }
+
+    return TI_OK;
+}
+
+/****************************************************************************
+ * computerEndgameDraw - see tiComputerAI.h for description
+ ****************************************************************************/
+int computerEndgameDraw(AIEndgameState *s, int player, int slot, int phase,
+                        int idleTurns, float *value)
+{
+    float outcome[TI_MAX_PLAYERS];
+    float chance;
+    int counter, type, revealing, oldTile, result;
+
+    oldTile = s->hand[player][slot];
+    revealing = (oldTile == TI_CPU_ENDGAME_UNKNOWN_TILE) ? TI_TRUE : TI_FALSE;
+
+    for(counter=0;counter<s->numPlayers;counter++)
+    {
+        value[counter] = 0.0;
+    }
+
+    for(type=0;type<TI_TILEPOOL_NUM_TILE_TYPES;type++)
+    {
+        if(s->unseen[type] == 0)
+        {
+            continue;
+        }
+
+        chance = (float)s->unseen[type] / (float)s->numUnseen;
+        s->hand[player][slot] = type;
+        s->unseen[type]--;
+        s->numUnseen--;
+        if(revealing == TI_TRUE)
+        {
+            s->numUnknownHeld--;
+        }
+
+        result = computerEndgameSearch(s, player, phase, idleTurns, outcome);
+
+        if(revealing == TI_TRUE)
+        {
+            s->numUnknownHeld++;
+        }
+        s->numUnseen++;
+        s->unseen[type]++;
+        s->hand[player][slot] = oldTile;
+
+        if(result == TI_ERROR)
+        {
+            return TI_ERROR;
+        }
+        for(counter=0;counter<s->numPlayers;counter++)
+        {
+            value[counter] += chance * outcome[counter];
+        }
+    }
+
+    return TI_OK;
+}
+
+/****************************************************************************
+ * computerEndgamePlayTile - see tiComputerAI.h for description
+ ****************************************************************************/
+int computerEndgamePlayTile(AIEndgameState *s, int player, float *value, int *played)
+{
+    float outcome[TI_MAX_PLAYERS];
+    int squares[TI_BOARD_WIDTH * TI_BOARD_HEIGHT];
+    int numSquares, slot, type, tileIndex, counter, counter2, x, y, next, result;
+    int savedHand[2];
+
+    next = (player + 1) % s->numPlayers;
+    savedHand[0] = s->hand[player][0];
+    savedHand[1] = s->hand[player][1];
+    *played = TI_FALSE;
+
+    /* Which squares are legal depends on whether the pool is empty */
+    s->b->tp->numUnplayedTiles = s->numUnseen - s->numUnknownHeld;
+
+    for(slot=0;slot<2;slot++)
+    {
+        type = savedHand[slot];
+        /* A second tile of the same type would play exactly the same way */
+        if(type == TI_TILE_NO_TILE || (slot == 1 && type == savedHand[0]))
+        {
+            continue;
+        }
+        tileIndex = s->typeTile[type];
+
+        /* The board's list of legal moves gets overwritten further down the
+           search, so make a copy */
+        numSquares = 0;
+        if(boardMarkLegalMoves(s->b, &(s->b->tp->t[tileIndex])) > 0)
+        {
+            for(counter=1;counter<TI_BOARD_WIDTH-1;counter++)
+            {
+                for(counter2=1;counter2<TI_BOARD_HEIGHT-1;counter2++)
+                {
+                    if(s->b->legalMove[counter][counter2] == TI_BOARD_LEGAL_MOVE)
+                    {
+                        squares[numSquares++] = counter * TI_BOARD_HEIGHT + counter2;
+                    }
+                }
+            }
+        }
+
+        for(counter=0;counter<numSquares;counter++)
+        {
+            x = squares[counter] / TI_BOARD_HEIGHT;
+            y = squares[counter] % TI_BOARD_HEIGHT;
+            boardSquareSetTileIndex(&(s->b->b[x][y]), tileIndex);
+            s->boardKey ^= EndgameSquareKeys[x][y][type];
+            if(slot == 0)
+            {
+                s->hand[player][0] = savedHand[1];
+            }
+            s->hand[player][1] = TI_TILE_NO_TILE;
+
+            result = computerEndgameSearch(s, next, TI_CPU_ENDGAME_TURN_START, 0, outcome);
+
+            s->hand[player][0] = savedHand[0];
+            s->hand[player][1] = savedHand[1];
+            s->boardKey ^= EndgameSquareKeys[x][y][type];
+            boardRemoveTile(s->b, x, y);
+
+            if(result == TI_ERROR)
+            {
+                return TI_ERROR;
+            }
+
+            if(*played == TI_FALSE || outcome[player] > value[player])
+            {
+                for(counter2=0;counter2<s->numPlayers;counter2++)
+                {
+                    value[counter2] = outcome[counter2];
+                }
+                *played = TI_TRUE;
+            }
+        }
+    }
+
+    return TI_OK;
+}
+
+/****************************************************************************
+ * computerEndgameScore - see tiComputerAI.h for description
+ ****************************************************************************/
+void computerEndgameScore(AIEndgameState *s, float *value)
+{
+    int counter, stationX, stationY, exit, endX, endY, endType, destination;
+
+    for(counter=0;counter<s->numPlayers;counter++)
+    {
+        value[counter] = 0.0;
+    }
+
+    for(counter=0;counter<TI_BOARD_NUM_STATIONS;counter++)
+    {
+        if(s->stationOwner[counter] == TI_BOARD_NO_TRAIN)
+        {
+            continue;
+        }
+        boardGetStationInfo(counter, &stationX, &stationY, &exit);
+        endType = boardFollowTrack(s->b, stationX, stationY, exit, &endX, &endY);
+        if(endType == TI_BOARDSQUARE_TYPE_STATION || endType == TI_BOARDSQUARE_TYPE_CENTRAL)
+        {
+            value[s->stationOwner[counter] - 1] +=
+                boardCalculateTrackScore(s->b, counter, TI_TILE_NO_TILE, NULL, &destination);
+        }
+    }
+}
+
+/****************************************************************************
+ * computerEndgamePositionKey - see tiComputerAI.h for description
+ ****************************************************************************/
+unsigned long long computerEndgamePositionKey(AIEndgameState *s, int player,
+                                              int phase, int idleTurns)
+{
+    unsigned long long key;
+    int counter;
+
+    key = s->boardKey ^ EndgameTurnKeys[player][phase][idleTurns];
+    for(counter=0;counter<s->numPlayers;counter++)
+    {
+        key ^= EndgameHandKeys[counter][0][s->hand[counter][0] + 2];
+        key ^= EndgameHandKeys[counter][1][s->hand[counter][1] + 2];
+    }
+    for(counter=0;counter<TI_TILEPOOL_NUM_TILE_TYPES;counter++)
+    {
+        key ^= EndgameUnseenKeys[counter][s->unseen[counter]];
+    }
+
+    return key;
 }
@@ -68,18 +68,99 @@ enum {
    at a central station is fairly valuable due to the double point bonus.  The
    multiplier isn't as high as that of an incomplete track, since completed tracks
    to a central station already have a 2x multipler (creating a net 4x multiplier
-   with the current weights)
+   with the current weights)  When a play completes an opponent's track at an
+   outer station, the opponent scores it but the track can't grow any further,
+   so the penalty for helping the opponent is divided by the blocking weight.
+   The default of 1.0 leaves the penalty as it is.
+
+   These are the defaults.  The weights actually used come from each player's
+   evaluation profile (AIEvalProfile), which can be loaded from a file at
+   runtime; ti-tune searches for better ones.
  */
 #define TI_CPU_WEIGHT_COMPLETE_TRACK            1.0
 #define TI_CPU_WEIGHT_INCOMPLETE_TRACK          3.0
 #define TI_CPU_WEIGHT_COMPLETE_CENTRAL_STATION  2.0
-#define TI_CPU_WEIGHT_BLOCK_OPPONENT            1.5
+#define TI_CPU_WEIGHT_BLOCK_OPPONENT            1.0
+
+/* Passed to computerSetPlayerProfile to change the profile of every player */
+#define TI_CPU_ALL_PLAYERS                      -1
+
+/* The set of weights used to evaluate moves (see above) */
+typedef struct {
+    float completeTrack;
+    float incompleteTrack;
+    float completeCentralStation;
+    float blockOpponent;
+} AIEvalProfile;
 
 #define TI_CPU_STATIC_DELAY                     400
 #define TI_CPU_DYNAMIC_DELAY                    1100
 #define TI_CPU_PASS_DYNAMIC_DELAY               200
 #define TI_CPU_PASS_STATIC_DELAY                100
 
+/* Pondering.  While a human player is deciding on a move, the computer
+   players evaluate the tiles they might play (the ones they hold, and the 
+   ones still left to draw) against the current board a little at a time (at
+   most TI_CPU_PONDER_TIME_SLICE milliseconds per logic update).  Tiles of the
+   same type always score the same, so results are kept per tile type in a
+   table of positions.  When a tile is later played, a position's results are
+   carried forward to the new board, and only the squares whose tracks ran
+   into the newly played tile are evaluated again. */
+#define TI_CPU_PONDER_TABLE_SIZE                (TI_MAX_PLAYERS * TI_TILEPOOL_NUM_TILE_TYPES)
+#define TI_CPU_PONDER_TIME_SLICE                3
+
+/* The most places that the tracks through a single tile can stop at */
+#define TI_CPU_PONDER_MAX_TRACK_ENDS            TI_TILE_NUM_EXITS
+
+/* Endgame solving.  Once the tile pool is down to TI_CPU_ENDGAME_POOL_SIZE
+   tiles or fewer (see computerSetEndgamePoolSize), the strongest computer
+   players stop relying on the weights and search the rest of the game, 
+   picking the move with the best expected final score.  Every player is 
+   assumed to take turns the way the computer does and to play for his own
+   score.  Tiles held by other players can't be seen, so they're treated
+   like the tiles left in the pool.  Positions that can be reached in more
+   than one way are only searched once (see AIEndgameEntry).  If the search
+   would visit more than TI_CPU_ENDGAME_MAX_NODES positions, it gives up
+   and the usual move is made instead, so that a move never takes longer
+   than the computer's normal delay. */
+#define TI_CPU_ENDGAME_POOL_SIZE                5
+#define TI_CPU_ENDGAME_MAX_NODES                100000
+#define TI_CPU_ENDGAME_TABLE_SIZE               32768
+
+/* A held tile that the computer player can't see */
+#define TI_CPU_ENDGAME_UNKNOWN_TILE             -2
+
+/* The points in a player's turn that the search can be at */
+#define TI_CPU_ENDGAME_TURN_START               0
+#define TI_CPU_ENDGAME_AFTER_DRAW               1
+
+/* One entry in the endgame position table.  The key combines the tiles on
+   the board, the tiles each player holds, the unseen tiles, and whose turn
+   it is.  value holds the expected number of points each player will score
+   from that position to the end of the game. */
+typedef struct {
+    unsigned long long key;
+    int generation;
+    float value[TI_MAX_PLAYERS];
+} AIEndgameEntry;
+
+/* The position being searched by the endgame solver.  Held tiles and 
+   unseen tiles are kept by type (tileStripOffset), since tiles of the same
+   type play the same way; typeTile holds a tile of each type to place on
+   the board. */
+typedef struct {
+    Board *b;
+    int numPlayers;
+    int hand[TI_MAX_PLAYERS][2];
+    int unseen[TI_TILEPOOL_NUM_TILE_TYPES];
+    int numUnseen;
+    int numUnknownHeld;
+    int typeTile[TI_TILEPOOL_NUM_TILE_TYPES];
+    int stationOwner[TI_BOARD_NUM_STATIONS];
+    unsigned long long boardKey;
+    long nodes;
+} AIEndgameState;
+
 /* This structure holds everything necessary to determine the move that
    a computer opponent will make, including move type, tile to use, and
    location to place it */
@@ -90,16 +171,42 @@ typedef struct {
     int heldTile;
 } ComputerAIPacket;
 
-/* This list is used to group together move analysis for further sorting and
-   move selection. */
-typedef struct AIEvalElem {
+/* The most moves that can be analyzed for a single decision -- one for each
+   square that a tile can be placed on, for each of the two held tiles */
+#define TI_CPU_MAX_MOVES                        (2 * (TI_BOARD_WIDTH - 2) * (TI_BOARD_HEIGHT - 2))
+
+/* The analysis of a single move */
+typedef struct {
     int tileType;
     int tileX;
     int tileY;
     int value;
-    struct AIEvalElem *next;
 } AIMoveEval;
 
+/* This list is used to group together move analysis for further ranking and
+   move selection.  It's a fixed size, so it can live on the stack. */
+typedef struct {
+    AIMoveEval moves[TI_CPU_MAX_MOVES];
+    int numMoves;
+} AIMoveList;
+
+/* One entry in the pondering table.  For every square that has been evaluated
+   with the given tile type, the value of the move and the empty squares that the
+   tracks passing through the tile run into in either direction (trackEnds,
+   stored as x * TI_BOARD_HEIGHT + y and terminated by -1) are kept.  A move's
+   value can only change if one of those squares is filled. */
+typedef struct {
+    int inUse;
+    unsigned int hash;
+    unsigned int lastUsed;
+    int player;
+    int tileType;
+    int boardTiles[TI_BOARD_WIDTH][TI_BOARD_HEIGHT];
+    int evaluated[TI_BOARD_WIDTH][TI_BOARD_HEIGHT];
+    int value[TI_BOARD_WIDTH][TI_BOARD_HEIGHT];
+    signed char trackEnds[TI_BOARD_WIDTH][TI_BOARD_HEIGHT][TI_CPU_PONDER_MAX_TRACK_ENDS+1];
+} AIPonderEntry;
+
 
 /****************************************************************************
  * computerDetermineNextMove
@@ -111,9 +218,10 @@ typedef struct AIEvalElem {
  * Arguments:
  *   ComputerAIPacket *lastMove - the last action taken (or NULL if no action
  *                                has been taken yet)
+ *   ComputerAIPacket *p        - filled in with the computer's next move
  *
  * Returns:
- *   A ComputerAIPacket that contains the computer's next move.
+ *   TI_OK.
  *
  * Notes:
  *   The AI uses a copy of the global game instance to determine the current
@@ -122,7 +230,7 @@ typedef struct AIEvalElem {
  *  equivalent to that of a human player. 
  *
  ****************************************************************************/
-ComputerAIPacket *computerDetermineNextMove(ComputerAIPacket *lastMove);
+int computerDetermineNextMove(ComputerAIPacket *lastMove, ComputerAIPacket *p);
 
 /****************************************************************************
  * computerMoveAnalyzeMoves
@@ -132,9 +240,8 @@ ComputerAIPacket *computerDetermineNextMove(ComputerAIPacket *lastMove);
  *   useful the move is to the computer and how detrimental to other players.
  *
  * Arguments:
- *   AIMoveEval **p - a pointer to a AIMoveEval list.  This list will contain
- *                    the analysis for all legal moves when this function
- *                    completes. 
+ *   AIMoveList *p -  a pointer to a AIMoveList.  The analysis for all legal
+ *                    moves is added to this list.
  *   int tileIndex -  the tile to place in all legal board locations
  *   int heldTile  -  used to determine if the tile is the computer's 
  *                    primary or secondary tile.
@@ -143,90 +250,410 @@ ComputerAIPacket *computerDetermineNextMove(ComputerAIPacket *lastMove);
  *   TI_OK.
  *
  ****************************************************************************/
-int computerMoveAnalyzeMoves(AIMoveEval **p, Board *b, int tileIndex, int heldTile);
+int computerMoveAnalyzeMoves(AIMoveList *p, Board *b, int tileIndex, int heldTile);
 
 /****************************************************************************
- * computerMoveEvalListAdd
+ * computerMoveListAdd
  *
  * Description:
- *   Adds an entry to the AIMoveEval linked list.
+ *   Adds an entry to an AIMoveList.
  *
  * Arguments:
- *   AIMoveEval **p - a pointer to a AIMoveEval list to append the new value to.
+ *   AIMoveList *p - the list to append the new value to.
+ *   int type - the held tile used for the move (primary or reserve)
  *   int x - the x position of the move on the board
  *   int y - the y position of the move on the board
  *   int val - the value of this move
 
  * Returns:
- *   A pointer to the newly added element.
+ *   A pointer to the newly added element, or NULL if the list is full.
+ *
+ ****************************************************************************/
+AIMoveEval *computerMoveListAdd(AIMoveList *p, int type, int x, int y, int val);
+
+/****************************************************************************
+ * computerMoveEvalRanksAhead
+ *
+ * Description:
+ *   Compares two moves.  Moves are ranked by value, from best to worst.
+ *   Moves of equal value are ranked so that the most recently analyzed
+ *   one comes first.
+ *
+ * Arguments:
+ *   AIMoveEval *a, *b - the moves to compare
+
+ * Returns:
+ *   TI_TRUE if a ranks ahead of b, TI_FALSE otherwise.
+ *
+ ****************************************************************************/
+int computerMoveEvalRanksAhead(AIMoveEval *a, AIMoveEval *b);
+
+/****************************************************************************
+ * computerMoveListSelect
+ *
+ * Description:
+ *   Finds the move with a given rank in an AIMoveList, without sorting the
+ *   whole list.
+ *
+ * Arguments:
+ *   AIMoveList *p - the list to take the move from.  The list is reordered
+ *                   so that the moves ranked ahead of the selected move come
+ *                   before it, and the rest come after it.
+ *   int n - the rank of the move to find (0 is the best move)
+
+ * Returns:
+ *   A pointer to the move, or NULL if n is out of range.
+ *
+ ****************************************************************************/
+AIMoveEval *computerMoveListSelect(AIMoveList *p, int n);
+
+/****************************************************************************
+ * computerMoveSelectListMove
+ *
+ * Description:
+ *   Given a list of moves, picks a move depending on the strength of the
+ *   computer AI.  In the endgame, the strongest AI uses the endgame solver
+ *   (see computerEndgameSelectMove).
+ *
+ * Arguments:
+ *   AIMoveList *evalList - the list to take a move from.
+ *   Board *b             - the board the moves were analyzed on
+
+ * Returns:
+ *   A pointer to the move that the computer will make.
+ *
+ ****************************************************************************/
+AIMoveEval *computerMoveSelectListMove(AIMoveList *evalList, Board *b);
+
+/****************************************************************************
+ * computerMoveEvaluateSquare
+ *
+ * Description:
+ *   Determines the value of placing a tile at a single (legal) square of 
+ *   the board for a given player.
+ *
+ * Arguments:
+ *   Board *b      - the board to evaluate the move on.  The tile is placed
+ *                   and removed again before this function returns.
+ *   int x, y      - the square to place the tile on
+ *   int tileIndex - the tile to place
+ *   int player    - the player (0-based) making the move
+ *   signed char *trackEnds - if not NULL, filled with the empty squares that
+ *                   the tracks passing through the tile run into (see
+ *                   AIPonderEntry)
+ *
+ * Returns:
+ *   The value of the move.
+ *
+ ****************************************************************************/
+int computerMoveEvaluateSquare(Board *b, int x, int y, int tileIndex, int player,
+                               signed char *trackEnds);
+
+/****************************************************************************
+ * computerPonder
+ *
+ * Description:
+ *   Spends up to timeSlice milliseconds evaluating the tiles that the
+ *   computer players could play (held tiles first, then each type of tile
+ *   left in the tile pool) against the current board, in the order that the
+ *   players will take their turns.  Called while a human player is deciding
+ *   on a move.
+ *
+ * Arguments:
+ *   Uint32 timeSlice - the maximum time to spend, in milliseconds
+ *
+ * Returns:
+ *   TI_TRUE if there is still work left to do, TI_FALSE otherwise.
+ *
+ ****************************************************************************/
+int computerPonder(Uint32 timeSlice);
+
+/****************************************************************************
+ * computerPonderGetEntry
+ *
+ * Description:
+ *   Finds the pondering table entry for a board, player and type of tile.
+ *   If there isn't one, a new entry is created, and the results of the
+ *   closest earlier position that are still valid are copied into it.
+ *
+ * Arguments:
+ *   Board *b      - the board
+ *   int player    - the player (0-based)
+ *   int tileIndex - the tile (any tile of the same type shares the entry)
+ *
+ * Returns:
+ *   A pointer to the entry.
+ *
+ ****************************************************************************/
+AIPonderEntry *computerPonderGetEntry(Board *b, int player, int tileIndex);
+
+/****************************************************************************
+ * computerPonderReset
+ *
+ * Description:
+ *   Clears the pondering table and frees the board used for pondering.
+ *   Should be called whenever a new game is started.
+ *
+ * Arguments:
+ *   None.
+ *
+ * Returns:
+ *   Nothing.
+ *
+ ****************************************************************************/
+void computerPonderReset(void);
+
+/****************************************************************************
+ * computerPonderCountChanges
+ *
+ * Description:
+ *   Compares the board stored in a pondering table entry with a board.
+ *
+ * Arguments:
+ *   AIPonderEntry *e - the entry
+ *   Board *b         - the board to compare against
+ *
+ * Returns:
+ *   The number of squares that have had tiles played on them since the
+ *   position in the entry, or -1 if the entry isn't an earlier position of
+ *   the board (a tile was removed or replaced).
  *
  ****************************************************************************/
-AIMoveEval *computerMoveEvalListAdd(AIMoveEval **p, int type, int x, int y, int val);
+int computerPonderCountChanges(AIPonderEntry *e, Board *b);
 
 /****************************************************************************
- * computerMoveEvalListFree
+ * computerPonderFreeBoard
  *
  * Description:
- *   Deletes all entries in an AIMoveEval linked list. 
+ *   Frees the private copy of the board used for pondering.
  *
  * Arguments:
- *   AIMoveEval **p - a pointer to a AIMoveEval list to delete.
+ *   None.
+ *
+ * Returns:
+ *   Nothing.
+ *
+ ****************************************************************************/
+void computerPonderFreeBoard(void);
 
+/****************************************************************************
+ * computerProfileSetDefaults
+ *
+ * Description:
+ *   Fills in an evaluation profile with the default weights.
+ *
+ * Arguments:
+ *   AIEvalProfile *p - the profile
+ *
  * Returns:
  *   Nothing.
  *
  ****************************************************************************/
-void computerMoveEvalListFree(AIMoveEval **p);
+void computerProfileSetDefaults(AIEvalProfile *p);
+
+/****************************************************************************
+ * computerProfileLoad
+ *
+ * Description:
+ *   Reads an evaluation profile from a file.  Each non-comment line of the
+ *   file has the form 'name:value'.  Weights not listed in the file keep
+ *   their default values.
+ *
+ * Arguments:
+ *   AIEvalProfile *p - the profile to fill in
+ *   char *fileName   - the file to read
+ *
+ * Returns:
+ *   TI_OK, or TI_ERROR if the file couldn't be opened or parsed.
+ *
+ ****************************************************************************/
+int computerProfileLoad(AIEvalProfile *p, char *fileName);
 
 /****************************************************************************
- * computerMoveEvalListRemove
+ * computerProfileSave
  *
  * Description:
- *   Deletes the head of an AIMoveEval linked list. 
+ *   Writes an evaluation profile to a file, in the format read by
+ *   computerProfileLoad.
  *
  * Arguments:
- *   AIMoveEval **p - a pointer to a AIMoveEval list head to delete
+ *   AIEvalProfile *p - the profile
+ *   char *fileName   - the file to write
+ *
+ * Returns:
+ *   TI_OK or TI_ERROR.
+ *
+ ****************************************************************************/
+int computerProfileSave(AIEvalProfile *p, char *fileName);
+
+/****************************************************************************
+ * computerGetPlayerProfile
+ *
+ * Description:
+ *   Gets the evaluation profile used by a player.
+ *
+ * Arguments:
+ *   int player - the player (0-based)
+ *
+ * Returns:
+ *   A pointer to the player's profile.
+ *
+ ****************************************************************************/
+AIEvalProfile *computerGetPlayerProfile(int player);
+
+/****************************************************************************
+ * computerSetPlayerProfile
+ *
+ * Description:
+ *   Changes the evaluation profile used by a player.  Anything the computer
+ *   players have pondered is thrown away, since it was evaluated with the 
+ *   old weights.
+ *
+ * Arguments:
+ *   int player       - the player (0-based), or TI_CPU_ALL_PLAYERS
+ *   AIEvalProfile *p - the profile to copy
+ *
+ * Returns:
+ *   Nothing.
+ *
+ ****************************************************************************/
+void computerSetPlayerProfile(int player, AIEvalProfile *p);
 
+/****************************************************************************
+ * computerSetEndgamePoolSize
+ *
+ * Description:
+ *   Sets the number of tiles left in the tile pool at which the strongest
+ *   computer players start solving the endgame.
+ *
+ * Arguments:
+ *   int poolSize - the number of tiles (0 turns the endgame solver off)
+ *
  * Returns:
  *   Nothing.
  *
  ****************************************************************************/
-void computerMoveEvalListRemove(AIMoveEval **p);
+void computerSetEndgamePoolSize(int poolSize);
 
 /****************************************************************************
- * computerMoveEvalListSort
+ * computerEndgameSelectMove
  *
  * Description:
- *   Sorts all entries in an AIMoveEval linked list.
+ *   Picks the move from a list that gives the current player the best
+ *   expected final score, by searching the rest of the game.
  *
  * Arguments:
- *   AIMoveEval **p - a pointer to a AIMoveEval list to sort.
+ *   AIMoveList *evalList - the moves that can be made
+ *   Board *b             - the board the moves were analyzed on.  Tiles
+ *                          are placed and removed again during the search.
+ *
+ * Returns:
+ *   A pointer to the move, or NULL if the endgame hasn't been reached yet or
+ *   the search was too large to finish.
+ *
+ ****************************************************************************/
+AIMoveEval *computerEndgameSelectMove(AIMoveList *evalList, Board *b);
 
+/****************************************************************************
+ * computerEndgameSearch
+ *
+ * Description:
+ *   Determines the expected number of points that each player will score
+ *   from a position to the end of the game.
+ *
+ * Arguments:
+ *   AIEndgameState *s - the position
+ *   int player        - the player whose turn it is
+ *   int phase         - the point in the player's turn (TURN_START or 
+ *                       AFTER_DRAW)
+ *   int idleTurns     - the number of turns in a row that no tile has been
+ *                       played.  Once every player has gone without playing
+ *                       a tile, the game is treated as over.
+ *   float *value      - filled in with the expected points of each player
+ *
  * Returns:
- *   A pointer to the head of the sorted list
+ *   TI_OK, or TI_ERROR if the search went over TI_CPU_ENDGAME_MAX_NODES.
  *
- * Notes:
- *   Based on 'Mergesort for Linked Lists' by Simon Tatham
- *    (http://www.chiark.greenend.org.uk/~sgtatham/algorithms/listsort.html)
- *   This implementation allows use for any purpose, (presumably) including
- *   use in this software.
  ****************************************************************************/
-AIMoveEval *computerMoveEvalListSort(AIMoveEval **list);
+int computerEndgameSearch(AIEndgameState *s, int player, int phase, int idleTurns,
+                          float *value);
 
 /****************************************************************************
- * computerMoveSelectListMove
+ * computerEndgameDraw
+ *
+ * Description:
+ *   Averages the outcome of the current player drawing each type of unseen
+ *   tile (or, if slot holds a tile that can't be seen, of each type that 
+ *   tile could be), weighted by how likely each one is.
+ *
+ * Arguments:
+ *   AIEndgameState *s - the position
+ *   int player        - the player drawing the tile
+ *   int slot          - the hand slot the tile goes into (0 or 1)
+ *   int phase         - the phase to continue the search in afterwards
+ *   int idleTurns     - see computerEndgameSearch
+ *   float *value      - filled in with the expected points of each player
+ *
+ * Returns:
+ *   TI_OK or TI_ERROR (see computerEndgameSearch).
+ *
+ ****************************************************************************/
+int computerEndgameDraw(AIEndgameState *s, int player, int slot, int phase,
+                        int idleTurns, float *value);
+
+/****************************************************************************
+ * computerEndgamePlayTile
  *
  * Description:
- *   Given a sorted list of moves (from best to worst), picks a move 
- *   depending on the strength of the computer AI.
+ *   Finds the best place for the current player to play one of the tiles
+ *   he holds, from his point of view.
  *
  * Arguments:
- *   AIMoveEval **p - a pointer to a AIMoveEval list to take a move from.
+ *   AIEndgameState *s - the position
+ *   int player        - the player
+ *   float *value      - filled in with the expected points of each player
+ *                       after the best move
+ *   int *played       - set to TI_FALSE if none of the held tiles can be
+ *                       played (value is left alone), TI_TRUE otherwise
+ *
+ * Returns:
+ *   TI_OK or TI_ERROR (see computerEndgameSearch).
+ *
+ ****************************************************************************/
+int computerEndgamePlayTile(AIEndgameState *s, int player, float *value, int *played);
 
+/****************************************************************************
+ * computerEndgameScore
+ *
+ * Description:
+ *   Adds up the points scored by the tracks completed on the board since 
+ *   the search started.
+ *
+ * Arguments:
+ *   AIEndgameState *s - the position
+ *   float *value      - filled in with the points of each player
+ *
  * Returns:
- *   A pointer to the move that the computer will make.
+ *   Nothing.
+ *
+ ****************************************************************************/
+void computerEndgameScore(AIEndgameState *s, float *value);
+
+/****************************************************************************
+ * computerEndgamePositionKey
+ *
+ * Description:
+ *   Calculates the key used to look a position up in the endgame table.
+ *
+ * Arguments:
+ *   AIEndgameState *s - the position
+ *   int player, phase, idleTurns - see computerEndgameSearch
+ *
+ * Returns:
+ *   The key.
  *
  ****************************************************************************/
-AIMoveEval *computerMoveSelectListMove(AIMoveEval **evalList);
+unsigned long long computerEndgamePositionKey(AIEndgameState *s, int player,
+                                              int phase, int idleTurns);
 
 #endif /* __TI_COMPUTERAI_H__ */
@@ -36,6 +36,9 @@
 #include "tiPlayer.h"
 #include "tiGame.h"
 #include "tiComputerAI.h"
+#include "tiLog.h"
+#include "tiPlayout.h"
+#include "tiRecord.h"
 
 /****************************************************************************
 * gameInitialize - see tiGame.h for description
@@ -121,6 +124,9 @@ int gameResetGameStructure(Game *g)
     g->selectedMoveIsReserveTile = TI_FALSE;
 
     g->deleteLastPlayerHighlight = TI_FALSE;
+
+    /* Nothing the computer players pondered in the last game is useful now */
+    computerPonderReset();
     return TI_OK;
 }
 
@@ -200,7 +206,7 @@ int gameSetGameState(Game *g, int state)
         case TI_GAME_STATE_DEFAULT:
             break;
         case TI_GAME_STATE_SELECT_ACTION:
-            printf("  Changing game state to TI_GAME_STATE_SELECT_ACTION\n");
+            TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_GAME_STATE, state, g->curPlayer, 0, 0);
             g->previousGameState = g->gameState;
             g->gameState = state;
             g->gameStateChanged = TI_TRUE;
@@ -228,7 +234,7 @@ int gameSetGameState(Game *g, int state)
             }
             break;
         case TI_GAME_STATE_TILE_DRAW:
-            printf("  Changing game state to TI_GAME_STATE_TILE_DRAW\n");
+            TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_GAME_STATE, state, g->curPlayer, 0, 0);
             g->previousGameState = g->gameState;
             g->gameState = state;
             g->gameStateChanged = TI_TRUE;
@@ -242,7 +248,7 @@ int gameSetGameState(Game *g, int state)
             }
             break;
         case TI_GAME_STATE_TILE_SELECT:
-            printf("  Changing game state to TI_GAME_STATE_TILE_SELECT\n");
+            TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_GAME_STATE, state, g->curPlayer, 0, 0);
             g->previousGameState = g->gameState;
             g->gameState = state;
             g->gameStateChanged = TI_TRUE;
@@ -264,7 +270,7 @@ int gameSetGameState(Game *g, int state)
             numLegalMoves = boardMarkLegalMoves(g->board, tilePoolGetTile(g->tilepool, tileIdToUse));
             break;
         case TI_GAME_STATE_TILE_PLAY:
-            printf("  Changing game state to TI_GAME_STATE_TILE_PLAY\n");
+            TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_GAME_STATE, state, g->curPlayer, 0, 0);
             g->previousGameState = g->gameState;
             g->gameState = state;
             g->gameStateChanged = TI_TRUE;
@@ -274,20 +280,23 @@ int gameSetGameState(Game *g, int state)
                 perror("Invalid tile placement!\n");
                 exit(1);
             }
+            recordAddEvent(CurrentRecord, TI_RECORD_EVENT_PLAY, g->selectedMoveIsReserveTile,
+                           TI_RECORD_SQUARE(g->selectedMoveTileX, g->selectedMoveTileY));
             gameCheckForCompletedTracks(g);
             break;
         case TI_GAME_STATE_DISCARD:
-            printf("  Changing game state to TI_GAME_STATE_DISCARD\n");
+            TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_GAME_STATE, state, g->curPlayer, 0, 0);
             g->previousGameState = g->gameState;
             g->gameState = state;
             g->gameStateChanged = TI_TRUE;
             break;
         case TI_GAME_STATE_END_TURN:
-            printf("  Changing game state to TI_GAME_STATE_END_TURN\n");
+            TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_GAME_STATE, state, g->curPlayer, 0, 0);
             g->previousGameState = g->gameState;
             g->gameState = state;
             g->gameStateChanged = TI_TRUE;
             g->playerHasDrawn = TI_FALSE;
+            recordAddEvent(CurrentRecord, TI_RECORD_EVENT_END_TURN, TI_FALSE, 0);
             /* increment the player number */
             g->curPlayer = g->curPlayer + 1;
             if(g->curPlayer >= g->numPlayers)
@@ -307,19 +316,20 @@ int gameSetGameState(Game *g, int state)
             }
             break;
         case TI_GAME_STATE_CONFIRM_EXIT:
-            printf("  Changing game state to TI_GAME_STATE_CONFIRM_EXIT\n");
+            TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_GAME_STATE, state, g->curPlayer, 0, 0);
             g->previousGameState = g->gameState;
             g->gameState = state;
             g->gameStateChanged = TI_TRUE;
             break;
         case TI_GAME_STATE_GAME_FINISHED:
-            printf("  Changing game state to TI_GAME_STATE_GAME_FINISHED\n");
+            TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_GAME_STATE, state, g->curPlayer, 0, 0);
             g->previousGameState = g->gameState;
             g->gameState = state;
             g->gameStateChanged = TI_TRUE;
+            recordEndGame(CurrentRecord, g);
             break;
         case TI_GAME_STATE_COMPUTER_MOVE:
-            printf("  Changing game state to TI_GAME_STATE_COMPUTER_MOVE\n");
+            TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_GAME_STATE, state, g->curPlayer, 0, 0);
             g->previousGameState = g->gameState;
             g->gameState = state;
             g->gameStateChanged = TI_TRUE;
@@ -372,6 +382,7 @@ int gameDiscardTile(Game *g)
     {
         return TI_ERROR;
     }
+    recordAddEvent(CurrentRecord, TI_RECORD_EVENT_DISCARD, g->selectedMoveIsReserveTile, 0);
 
     if(g->selectedMoveIsReserveTile == TI_TRUE)
     {
@@ -398,6 +409,7 @@ int gameDiscardTile(Game *g)
 ****************************************************************************/
 int gameDestroy(Game **g)
 {
+    computerPonderReset();
     tilePoolDestroy(&((*g)->board->tp));
     boardDestroy(&((*g)->board));
     free(*g);
@@ -0,0 +1,505 @@
+/****************************************************************************
+*
+* tiGameDb.c - Append-only database of game records
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+
+/* Databases grow well past 2 GB */
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+#include <SDL/SDL.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiPlayout.h"
+#include "tiRecord.h"
+#include "tiGameDb.h"
+
+#ifdef _WIN32
+#define TI_GAMEDB_SEEK(fp, offset)          _fseeki64((fp), (offset), SEEK_SET)
+#else
+#define TI_GAMEDB_SEEK(fp, offset)          fseeko((fp), (off_t)(offset), SEEK_SET)
+#endif
+
+/****************************************************************************
+* gameDbOpenWriter - see tiGameDb.h for description
+****************************************************************************/
+TiGameDbWriter *gameDbOpenWriter(char *fileName)
+{
+    TiGameDbWriter *w;
+
+    w = (TiGameDbWriter *)malloc(sizeof(TiGameDbWriter));
+    if(w == NULL)
+    {
+        return NULL;
+    }
+    memset(w, 0, sizeof(TiGameDbWriter));
+
+    w->fp = fopen(fileName, "r+b");
+    if(w->fp != NULL)
+    {
+        /* Games go after the last whole block */
+        if(fread(&(w->header), sizeof(TiGameDbHeader), 1, w->fp) != 1 ||
+           w->header.magic != TI_GAMEDB_MAGIC || w->header.version != TI_GAMEDB_VERSION ||
+           w->header.size < sizeof(TiGameDbHeader))
+        {
+            perror("gameDbOpenWriter: not a game database");
+            fclose(w->fp);
+            free(w);
+            return NULL;
+        }
+    }
+    else
+    {
+        w->fp = fopen(fileName, "w+b");
+        if(w->fp == NULL)
+        {
+            free(w);
+            return NULL;
+        }
+        w->header.magic = TI_GAMEDB_MAGIC;
+        w->header.version = TI_GAMEDB_VERSION;
+        w->header.numBlocks = 0;
+        w->header.blockGames = TI_GAMEDB_BLOCK_GAMES;
+        w->header.numGames = 0;
+        w->header.size = sizeof(TiGameDbHeader);
+        if(fwrite(&(w->header), sizeof(TiGameDbHeader), 1, w->fp) != 1)
+        {
+            fclose(w->fp);
+            free(w);
+            return NULL;
+        }
+    }
+
+    w->records = (unsigned char *)malloc(TI_GAMEDB_BLOCK_BYTES);
+    if(w->records == NULL)
+    {
+        fclose(w->fp);
+        free(w);
+        return NULL;
+    }
+    w->maxRecordBytes = TI_GAMEDB_BLOCK_BYTES;
+
+    return w;
+}
+
+/****************************************************************************
+* gameDbAddRecord - see tiGameDb.h for description
+****************************************************************************/
+int gameDbAddRecord(TiGameDbWriter *w, TiRecord *r)
+{
+    TiGameDbEntry *entry;
+    TiRecordPosition position;
+    unsigned char *records, *e;
+    Uint32 size, maxRecordBytes;
+    int counter;
+
+    size = sizeof(TiRecordHeader) + r->header.numKeyframes * sizeof(TiRecordIndexEntry) +
+           r->header.numBytes;
+    size = (size + TI_GAMEDB_ALIGNMENT - 1) & ~(TI_GAMEDB_ALIGNMENT - 1);
+
+    /* A game that doesn't fit goes in the next block (or in a block of its
+       own, if it's bigger than a block) */
+    if(w->block.numGames == TI_GAMEDB_BLOCK_GAMES ||
+       (w->block.numGames > 0 && w->recordBytes + size > TI_GAMEDB_BLOCK_BYTES))
+    {
+        if(gameDbFlush(w) != TI_OK)
+        {
+            return TI_ERROR;
+        }
+    }
+    if(w->recordBytes + size > w->maxRecordBytes)
+    {
+        maxRecordBytes = w->maxRecordBytes * 2;
+        while(maxRecordBytes < w->recordBytes + size)
+        {
+            maxRecordBytes *= 2;
+        }
+        records = (unsigned char *)realloc(w->records, maxRecordBytes);
+        if(records == NULL)
+        {
+            perror("gameDbAddRecord: out of memory");
+            return TI_ERROR;
+        }
+        w->records = records;
+        w->maxRecordBytes = maxRecordBytes;
+    }
+
+    entry = &(w->entries[w->block.numGames]);
+    memset(entry, 0, sizeof(TiGameDbEntry));
+    entry->seed = r->header.seed;
+    entry->numEvents = r->header.numEvents;
+    entry->offset = w->recordBytes;
+    entry->size = size;
+    entry->numPlayers = r->header.numPlayers;
+    for(counter=0;counter<TI_MAX_PLAYERS;counter++)
+    {
+        entry->aiLevel[counter] = r->header.aiLevel[counter];
+        entry->score[counter] = TI_GAMEDB_NO_SCORE;
+    }
+
+    /* The scores come from the end of the game, if it got that far */
+    entry->finished = TI_FALSE;
+    if(r->header.numEvents > 0 && recordSeek(r, r->header.numEvents - 1, &position) == TI_OK)
+    {
+        while(position.offset < r->header.numBytes &&
+              (r->events[position.offset] & TI_RECORD_EVENT_MASK) == TI_RECORD_EVENT_KEYFRAME)
+        {
+            if(recordApplyEvent(r, &position) != TI_OK)
+            {
+                break;
+            }
+        }
+        e = r->events + position.offset;
+        if(r->header.numBytes - position.offset >= 1 + 2 * r->header.numPlayers &&
+           (e[0] & TI_RECORD_EVENT_MASK) == TI_RECORD_EVENT_END_GAME)
+        {
+            entry->finished = TI_TRUE;
+            for(counter=0;counter<r->header.numPlayers;counter++)
+            {
+                entry->score[counter] = e[1 + 2 * counter] | (e[2 + 2 * counter] << 8);
+            }
+        }
+        recordApplyEvent(r, &position);
+        entry->numTurns = position.turn;
+    }
+
+    records = w->records + w->recordBytes;
+    memcpy(records, &(r->header), sizeof(TiRecordHeader));
+    records += sizeof(TiRecordHeader);
+    memcpy(records, r->keyframes, r->header.numKeyframes * sizeof(TiRecordIndexEntry));
+    records += r->header.numKeyframes * sizeof(TiRecordIndexEntry);
+    memcpy(records, r->events, r->header.numBytes);
+    records += r->header.numBytes;
+    memset(records, 0, w->records + w->recordBytes + size - records);
+
+    if(w->block.numGames == 0 || entry->seed < w->block.minSeed)
+    {
+        w->block.minSeed = entry->seed;
+    }
+    if(w->block.numGames == 0 || entry->seed > w->block.maxSeed)
+    {
+        w->block.maxSeed = entry->seed;
+    }
+    w->block.playerCounts |= 1 << entry->numPlayers;
+    w->block.numGames++;
+    w->recordBytes += size;
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* gameDbFlush - see tiGameDb.h for description
+****************************************************************************/
+int gameDbFlush(TiGameDbWriter *w)
+{
+    Uint32 entriesSize, counter;
+
+    if(w->block.numGames == 0)
+    {
+        return TI_OK;
+    }
+
+    entriesSize = w->block.numGames * sizeof(TiGameDbEntry);
+    w->block.magic = TI_GAMEDB_BLOCK_MAGIC;
+    w->block.size = sizeof(TiGameDbBlock) + entriesSize + w->recordBytes;
+    w->block.firstGame = w->header.numGames;
+    for(counter=0;counter<w->block.numGames;counter++)
+    {
+        w->entries[counter].offset += sizeof(TiGameDbBlock) + entriesSize;
+    }
+
+    /* The block goes in first, so that the header never takes in a block
+       that isn't all there */
+    if(TI_GAMEDB_SEEK(w->fp, w->header.size) != 0 ||
+       fwrite(&(w->block), sizeof(TiGameDbBlock), 1, w->fp) != 1 ||
+       fwrite(w->entries, sizeof(TiGameDbEntry), w->block.numGames, w->fp) != w->block.numGames ||
+       fwrite(w->records, 1, w->recordBytes, w->fp) != w->recordBytes ||
+       fflush(w->fp) != 0)
+    {
+        return TI_ERROR;
+    }
+
+    w->header.numBlocks++;
+    w->header.numGames += w->block.numGames;
+    w->header.size += w->block.size;
+    if(TI_GAMEDB_SEEK(w->fp, 0) != 0 ||
+       fwrite(&(w->header), sizeof(TiGameDbHeader), 1, w->fp) != 1 ||
+       fflush(w->fp) != 0)
+    {
+        return TI_ERROR;
+    }
+
+    memset(&(w->block), 0, sizeof(TiGameDbBlock));
+    w->recordBytes = 0;
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* gameDbCloseWriter - see tiGameDb.h for description
+****************************************************************************/
+void gameDbCloseWriter(TiGameDbWriter **w)
+{
+    if(*w == NULL)
+    {
+        return;
+    }
+
+    if(gameDbFlush(*w) != TI_OK)
+    {
+        perror("gameDbCloseWriter: unable to write the last block");
+    }
+    fclose((*w)->fp);
+    free((*w)->records);
+    free(*w);
+    *w = NULL;
+}
+
+/****************************************************************************
+* gameDbOpen - see tiGameDb.h for description
+****************************************************************************/
+TiGameDb *gameDbOpen(char *fileName)
+{
+    TiGameDb *db;
+    TiGameDbBlock *block;
+    Uint64 offset, numGames;
+    Uint32 numBlocks;
+#ifdef _WIN32
+    FILE *fp;
+#else
+    struct stat info;
+    int fd;
+#endif
+
+    db = (TiGameDb *)malloc(sizeof(TiGameDb));
+    if(db == NULL)
+    {
+        return NULL;
+    }
+
+#ifdef _WIN32
+    fp = fopen(fileName, "rb");
+    if(fp == NULL)
+    {
+        free(db);
+        return NULL;
+    }
+    _fseeki64(fp, 0, SEEK_END);
+    db->dataSize = _ftelli64(fp);
+    _fseeki64(fp, 0, SEEK_SET);
+    /* Too big to fit in memory at all (on a 32 bit machine) */
+    if((Uint64)(size_t)db->dataSize != db->dataSize)
+    {
+        free(db);
+        fclose(fp);
+        return NULL;
+    }
+    db->data = (unsigned char *)malloc((size_t)db->dataSize);
+    if(db->data == NULL || fread(db->data, 1, (size_t)db->dataSize, fp) != db->dataSize)
+    {
+        free(db->data);
+        free(db);
+        fclose(fp);
+        return NULL;
+    }
+    fclose(fp);
+#else
+    fd = open(fileName, O_RDONLY);
+    if(fd < 0)
+    {
+        free(db);
+        return NULL;
+    }
+    if(fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(TiGameDbHeader))
+    {
+        close(fd);
+        free(db);
+        return NULL;
+    }
+    db->dataSize = info.st_size;
+
+    /* Too big to map in one piece (on a 32 bit machine).  It would be 
+       mapped cut short, and the checks below go by the whole size. */
+    if((Uint64)(size_t)db->dataSize != db->dataSize)
+    {
+        close(fd);
+        free(db);
+        return NULL;
+    }
+
+    /* Read only and shared, so the pages are the page cache's own and are
+       only read in as they're touched */
+    db->data = (unsigned char *)mmap(NULL, (size_t)db->dataSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(db->data == MAP_FAILED)
+    {
+        free(db);
+        return NULL;
+    }
+#endif
+
+    db->header = (TiGameDbHeader *)db->data;
+    if(db->dataSize < sizeof(TiGameDbHeader) ||
+       db->header->magic != TI_GAMEDB_MAGIC || db->header->version != TI_GAMEDB_VERSION ||
+       db->header->size < sizeof(TiGameDbHeader) || db->header->size > db->dataSize)
+    {
+        perror("gameDbOpen: not a game database");
+        gameDbClose(&db);
+        return NULL;
+    }
+
+    /* Make sure the blocks lead from one to the next, and add up to what
+       the header says */
+    offset = sizeof(TiGameDbHeader);
+    numBlocks = 0;
+    numGames = 0;
+    while(offset < db->header->size)
+    {
+        block = (TiGameDbBlock *)(db->data + offset);
+        if(db->header->size - offset < sizeof(TiGameDbBlock) ||
+           block->magic != TI_GAMEDB_BLOCK_MAGIC ||
+           block->firstGame != numGames ||
+           block->size < sizeof(TiGameDbBlock) + (Uint64)block->numGames * sizeof(TiGameDbEntry) ||
+           block->size > db->header->size - offset ||
+           block->size % TI_GAMEDB_ALIGNMENT != 0)
+        {
+            break;
+        }
+        numBlocks++;
+        numGames += block->numGames;
+        offset += block->size;
+    }
+    if(offset != db->header->size || numBlocks != db->header->numBlocks ||
+       numGames != db->header->numGames)
+    {
+        perror("gameDbOpen: database is damaged");
+        gameDbClose(&db);
+        return NULL;
+    }
+
+    return db;
+}
+
+/****************************************************************************
+* gameDbClose - see tiGameDb.h for description
+****************************************************************************/
+void gameDbClose(TiGameDb **db)
+{
+    if(*db == NULL)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    free((*db)->data);
+#else
+    munmap((*db)->data, (size_t)(*db)->dataSize);
+#endif
+    free(*db);
+    *db = NULL;
+}
+
+/****************************************************************************
+* gameDbFirstBlock - see tiGameDb.h for description
+****************************************************************************/
+TiGameDbBlock *gameDbFirstBlock(TiGameDb *db)
+{
+    if(db->header->size <= sizeof(TiGameDbHeader))
+    {
+        return NULL;
+    }
+
+    return (TiGameDbBlock *)(db->data + sizeof(TiGameDbHeader));
+}
+
+/****************************************************************************
+* gameDbNextBlock - see tiGameDb.h for description
+****************************************************************************/
+TiGameDbBlock *gameDbNextBlock(TiGameDb *db, TiGameDbBlock *block)
+{
+    unsigned char *next;
+
+    next = (unsigned char *)block + block->size;
+    if(next >= db->data + db->header->size)
+    {
+        return NULL;
+    }
+
+    return (TiGameDbBlock *)next;
+}
+
+/****************************************************************************
+* gameDbGetRecord - see tiGameDb.h for description
+****************************************************************************/
+int gameDbGetRecord(TiGameDbBlock *block, int game, TiRecord *r)
+{
+    TiGameDbEntry *entry;
+    TiRecordHeader *header;
+
+    if(game < 0 || game >= block->numGames)
+    {
+        return TI_ERROR;
+    }
+
+    entry = &(TI_GAMEDB_ENTRIES(block)[game]);
+    if(entry->offset > block->size || entry->size > block->size - entry->offset ||
+       entry->size < sizeof(TiRecordHeader) || entry->offset % TI_GAMEDB_ALIGNMENT != 0)
+    {
+        return TI_ERROR;
+    }
+
+    header = (TiRecordHeader *)((unsigned char *)block + entry->offset);
+    if(header->magic != TI_RECORD_MAGIC || header->version != TI_RECORD_VERSION ||
+       header->numPlayers < TI_MIN_PLAYERS || header->numPlayers > TI_MAX_PLAYERS ||
+       sizeof(TiRecordHeader) + (Uint64)header->numKeyframes * sizeof(TiRecordIndexEntry) +
+           header->numBytes > entry->size)
+    {
+        return TI_ERROR;
+    }
+
+    /* The record is only a view of the database */
+    memset(r, 0, sizeof(TiRecord));
+    r->header = *header;
+    r->keyframes = (TiRecordIndexEntry *)(header + 1);
+    r->events = (unsigned char *)(r->keyframes + header->numKeyframes);
+    recordStartPosition(r, &(r->position));
+
+    return recordCheckIndex(r);
+}
@@ -0,0 +1,270 @@
+/****************************************************************************
+*
+* tiGameDb.h - Header for tiGameDb.c
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+
+#ifndef __TIGAMEDB_H__
+#define __TIGAMEDB_H__
+
+/*
+ * A game database holds the records (see tiRecord.h) of as many games as
+ * self-play can produce, in one file that is only ever added to.  The file
+ * starts with a TiGameDbHeader, followed by blocks of up to
+ * TI_GAMEDB_BLOCK_GAMES games.  Each block starts with a TiGameDbBlock,
+ * then a TiGameDbEntry for each of its games (the seed, the players and
+ * their AI levels, how long the game went and the final scores), then the
+ * records themselves.  Analysis that only needs what's in the entries
+ * never has to touch the records, and the block headers say which seeds
+ * and numbers of players are in a block, so whole blocks can be skipped.
+ *
+ * Games are added a block at a time: the writer keeps a block in memory
+ * until it is full, writes it to the end of the file in one go, and only
+ * then updates the header.  If the writer stops part way through a block,
+ * the header still ends at the last whole one, and the next writer starts
+ * over from there.
+ *
+ * Readers map the file into memory, and hand out records that point right
+ * into it (see gameDbGetRecord), so nothing is read until it is used and
+ * nothing is copied.  Each record is stored as its header, its keyframe
+ * index and its events, aligned so that they can be used where they lie.
+ * Where there's no mmap (Windows), the file is read in instead, which
+ * limits it to what fits in memory.
+ *
+ * Like the records, everything is in the byte order of the machine that
+ * wrote it.
+ */
+
+#define TI_GAMEDB_MAGIC                     0x42445449      /* 'TIDB' */
+#define TI_GAMEDB_BLOCK_MAGIC               0x4B424954      /* 'TIBK' */
+#define TI_GAMEDB_VERSION                   1
+
+/* A block is written once it holds this many games, or this many bytes
+   of records */
+#define TI_GAMEDB_BLOCK_GAMES               1024
+#define TI_GAMEDB_BLOCK_BYTES               (4 * 1024 * 1024)
+#define TI_GAMEDB_ALIGNMENT                 8
+
+/* The score of a player in a game that didn't finish */
+#define TI_GAMEDB_NO_SCORE                  0xffff
+
+typedef struct
+{
+    Uint32 magic;
+    Uint32 version;
+    Uint32 numBlocks;
+    Uint32 blockGames;
+    Uint64 numGames;
+    /* The end of the last whole block.  Anything after it in the file is
+       a block that never got finished. */
+    Uint64 size;
+} TiGameDbHeader;
+
+typedef struct
+{
+    Uint32 magic;
+    Uint32 numGames;
+    /* The size of the whole block, header, entries and records */
+    Uint32 size;
+    /* Bit n is set if any game in the block has n players */
+    Uint32 playerCounts;
+    Uint32 minSeed;
+    Uint32 maxSeed;
+    /* The number of games in the blocks before this one */
+    Uint64 firstGame;
+} TiGameDbBlock;
+
+typedef struct
+{
+    Uint32 seed;
+    Uint32 numEvents;
+    Uint32 numTurns;
+    /* Where the record is, from the start of the block, and its size */
+    Uint32 offset;
+    Uint32 size;
+    Uint16 score[TI_MAX_PLAYERS];
+    Uint8 numPlayers;
+    Uint8 aiLevel[TI_MAX_PLAYERS];
+    Uint8 finished;
+} TiGameDbEntry;
+
+/* The entries of a block */
+#define TI_GAMEDB_ENTRIES(block)            ((TiGameDbEntry *)((block) + 1))
+
+typedef struct
+{
+    FILE *fp;
+    TiGameDbHeader header;
+    /* The block being filled */
+    TiGameDbBlock block;
+    TiGameDbEntry entries[TI_GAMEDB_BLOCK_GAMES];
+    unsigned char *records;
+    Uint32 recordBytes;
+    Uint32 maxRecordBytes;
+} TiGameDbWriter;
+
+typedef struct
+{
+    unsigned char *data;
+    Uint64 dataSize;
+    TiGameDbHeader *header;
+} TiGameDb;
+
+/* Function prototypes */
+
+/****************************************************************************
+* gameDbOpenWriter
+*
+* Description:
+*   Opens a game database to add games to, creating it if it doesn't
+*   exist.
+*
+* Arguments:
+*   char *fileName - the database file
+*
+* Returns:
+*   A pointer to the writer, or NULL if the file couldn't be created or
+*   isn't a game database.
+*
+****************************************************************************/
+TiGameDbWriter *gameDbOpenWriter(char *fileName);
+
+/****************************************************************************
+* gameDbAddRecord
+*
+* Description:
+*   Adds a game's record to the block being filled, writing the block out
+*   if that fills it.
+*
+* Arguments:
+*   TiGameDbWriter *w - the writer
+*   TiRecord *r       - the record
+*
+* Returns:
+*   TI_OK or TI_ERROR.
+*
+****************************************************************************/
+int gameDbAddRecord(TiGameDbWriter *w, TiRecord *r);
+
+/****************************************************************************
+* gameDbFlush
+*
+* Description:
+*   Writes the block being filled to the end of the database (if it has
+*   any games in it) and updates the header.
+*
+* Arguments:
+*   TiGameDbWriter *w - the writer
+*
+* Returns:
+*   TI_OK or TI_ERROR.
+*
+****************************************************************************/
+int gameDbFlush(TiGameDbWriter *w);
+
+/****************************************************************************
+* gameDbCloseWriter
+*
+* Description:
+*   Writes out any games that haven't been, closes the database and frees
+*   the writer.
+*
+* Arguments:
+*   TiGameDbWriter **w - the writer.  Set to NULL.
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void gameDbCloseWriter(TiGameDbWriter **w);
+
+/****************************************************************************
+* gameDbOpen
+*
+* Description:
+*   Maps a game database into memory to read it, and checks that its
+*   blocks fit together.
+*
+* Arguments:
+*   char *fileName - the database file
+*
+* Returns:
+*   A pointer to the database, or NULL if it couldn't be opened or is
+*   damaged.
+*
+****************************************************************************/
+TiGameDb *gameDbOpen(char *fileName);
+
+/****************************************************************************
+* gameDbClose
+*
+* Description:
+*   Unmaps a game database and frees it.  Records handed out by
+*   gameDbGetRecord can't be used after this.
+*
+* Arguments:
+*   TiGameDb **db - the database.  Set to NULL.
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void gameDbClose(TiGameDb **db);
+
+/****************************************************************************
+* gameDbFirstBlock, gameDbNextBlock
+*
+* Description:
+*   Go through the blocks of a database in order.
+*
+* Arguments:
+*   TiGameDb *db          - the database
+*   TiGameDbBlock *block  - the block before the one wanted
+*
+* Returns:
+*   The block, or NULL if there are no more.
+*
+****************************************************************************/
+TiGameDbBlock *gameDbFirstBlock(TiGameDb *db);
+TiGameDbBlock *gameDbNextBlock(TiGameDb *db, TiGameDbBlock *block);
+
+/****************************************************************************
+* gameDbGetRecord
+*
+* Description:
+*   Sets up a record for one of the games in a block.  The record's events
+*   and keyframe index point into the database rather than being copied,
+*   so it can be played back and seeked in, but not added to, and must
+*   not be passed to recordDestroy.
+*
+* Arguments:
+*   TiGameDbBlock *block - the block
+*   int game             - the game in the block
+*   TiRecord *r          - the record to set up
+*
+* Returns:
+*   TI_OK, or TI_ERROR if the record is damaged.
+*
+****************************************************************************/
+int gameDbGetRecord(TiGameDbBlock *block, int game, TiRecord *r);
+
+#endif
@@ -0,0 +1,420 @@
+/****************************************************************************
+*
+* tiLog.c - low overhead logging to per-thread ring buffers
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <SDL/SDL.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiLog.h"
+
+TiLog *CurrentLog = NULL;
+
+char *TI_LOG_LEVEL_NAMES[TI_LOG_NUM_LEVELS] = 
+{
+    "debug", "info", "warning", "error"
+};
+
+char *TI_LOG_GAME_STATE_NAMES[] = 
+{
+    "TI_GAME_STATE_DEFAULT", "TI_GAME_STATE_SELECT_ACTION", "TI_GAME_STATE_TILE_DRAW",
+    "TI_GAME_STATE_TILE_SELECT", "TI_GAME_STATE_TILE_PLAY", "TI_GAME_STATE_PASS",
+    "TI_GAME_STATE_DISCARD", "TI_GAME_STATE_END_TURN", "TI_GAME_STATE_GAME_FINISHED",
+    "TI_GAME_STATE_CONFIRM_EXIT", "TI_GAME_STATE_COMPUTER_MOVE", "TI_GAME_STATE_PAUSE"
+};
+
+char *TI_LOG_RENDER_STATE_NAMES[] = 
+{
+    "TI_STATE_NO_STATE", "TI_STATE_COMPANY_LOGO", "TI_STATE_TITLE_SCREEN",
+    "TI_STATE_TITLE_MENU_SCREEN", "TI_STATE_NEW_GAME_SCREEN", "TI_STATE_OPTIONS_SCREEN",
+    "TI_STATE_IN_GAME", "TI_STATE_GAME_RESULTS_SCREEN", "TI_STATE_END_GAME"
+};
+
+char *TI_LOG_CPU_MOVE_NAMES[] = 
+{
+    "TI_CPU_MOVE_DRAW", "TI_CPU_MOVE_PLAY", "TI_CPU_MOVE_DISCARD", "TI_CPU_MOVE_END_TURN"
+};
+
+char *TI_LOG_FALLBACK_MESSAGES[] = 
+{
+    "No texture atlases found, loading each image from its own file",
+    "No asset pack found, decoding images instead",
+    "No background loader, images will be decoded as they're needed"
+};
+
+/****************************************************************************
+* logInitialize - see tiLog.h for description
+****************************************************************************/
+int logInitialize(char *fileName)
+{
+    TiLog *log;
+    TiLogFileHeader header;
+
+    log = (TiLog *)malloc(sizeof(TiLog));
+    if(log == NULL)
+    {
+        return TI_ERROR;
+    }
+    memset(log, 0, sizeof(TiLog));
+
+    log->fp = fopen(fileName, "wb");
+    if(log->fp == NULL)
+    {
+        free(log);
+        return TI_ERROR;
+    }
+    header.magic = TI_LOG_MAGIC;
+    header.version = TI_LOG_VERSION;
+    header.recordSize = sizeof(TiLogRecord);
+    fwrite(&header, sizeof(TiLogFileHeader), 1, log->fp);
+
+    log->ringLock = SDL_CreateMutex();
+    log->drainLock = SDL_CreateMutex();
+    log->drainWork = SDL_CreateCond();
+    log->quit = TI_FALSE;
+    if(log->ringLock == NULL || log->drainLock == NULL || log->drainWork == NULL ||
+       (log->drainThread = SDL_CreateThread(logDrainThread, log)) == NULL)
+    {
+        if(log->drainWork != NULL)
+        {
+            SDL_DestroyCond(log->drainWork);
+        }
+        if(log->drainLock != NULL)
+        {
+            SDL_DestroyMutex(log->drainLock);
+        }
+        if(log->ringLock != NULL)
+        {
+            SDL_DestroyMutex(log->ringLock);
+        }
+        fclose(log->fp);
+        free(log);
+        return TI_ERROR;
+    }
+
+    CurrentLog = log;
+    return TI_OK;
+}
+
+/****************************************************************************
+* logDestroy - see tiLog.h for description
+****************************************************************************/
+void logDestroy(void)
+{
+    TiLog *log;
+
+    if(CurrentLog == NULL)
+    {
+        return;
+    }
+
+    /* Anything written from here on is thrown away */
+    log = CurrentLog;
+    CurrentLog = NULL;
+
+    SDL_mutexP(log->drainLock);
+    log->quit = TI_TRUE;
+    SDL_CondSignal(log->drainWork);
+    SDL_mutexV(log->drainLock);
+    SDL_WaitThread(log->drainThread, NULL);
+    logDrain(log);
+
+    fclose(log->fp);
+    SDL_DestroyCond(log->drainWork);
+    SDL_DestroyMutex(log->drainLock);
+    SDL_DestroyMutex(log->ringLock);
+    free(log);
+}
+
+/****************************************************************************
+* logWrite - see tiLog.h for description
+****************************************************************************/
+void logWrite(int level, int event, Sint32 a, Sint32 b, Sint32 c, Sint32 d)
+{
+    TiLogRing *ring;
+    TiLogRecord *r;
+
+    if(CurrentLog == NULL)
+    {
+        return;
+    }
+    ring = logGetRing(CurrentLog);
+    if(ring == NULL)
+    {
+        return;
+    }
+
+    /* The drain thread hasn't caught up */
+    if(ring->head - ring->tail >= TI_LOG_RING_SIZE)
+    {
+        ring->dropped++;
+        return;
+    }
+
+    r = &(ring->records[ring->head & (TI_LOG_RING_SIZE - 1)]);
+    r->ticks = SDL_GetTicks();
+    r->event = event;
+    r->level = level;
+    r->thread = ring - CurrentLog->rings;
+    r->args[0] = a;
+    r->args[1] = b;
+    r->args[2] = c;
+    r->args[3] = d;
+
+    /* The record has to be all there before the drain thread can see it */
+    TI_LOG_BARRIER();
+    ring->head++;
+
+    /* Only the write that fills the ring this far takes the lock */
+    if(ring->head - ring->tail == TI_LOG_DRAIN_THRESHOLD)
+    {
+        SDL_mutexP(CurrentLog->drainLock);
+        SDL_CondSignal(CurrentLog->drainWork);
+        SDL_mutexV(CurrentLog->drainLock);
+    }
+}
+
+/****************************************************************************
+* logGetRing - see tiLog.h for description
+****************************************************************************/
+TiLogRing *logGetRing(TiLog *log)
+{
+    TiLogRing *ring;
+    Uint32 threadId;
+    int counter;
+
+    threadId = SDL_ThreadID();
+    for(counter=0;counter<log->numRings;counter++)
+    {
+        if(log->rings[counter].threadId == threadId)
+        {
+            return &(log->rings[counter]);
+        }
+    }
+
+    /* This thread hasn't written anything yet */
+    ring = NULL;
+    SDL_mutexP(log->ringLock);
+    if(log->numRings < TI_LOG_MAX_THREADS)
+    {
+        ring = &(log->rings[log->numRings]);
+        ring->threadId = threadId;
+        ring->head = 0;
+        ring->tail = 0;
+        ring->dropped = 0;
+        ring->droppedLogged = 0;
+        TI_LOG_BARRIER();
+        log->numRings++;
+    }
+    SDL_mutexV(log->ringLock);
+
+    return ring;
+}
+
+/****************************************************************************
+* logDrain - see tiLog.h for description
+****************************************************************************/
+int logDrain(TiLog *log)
+{
+    TiLogRing *ring;
+    TiLogRecord dropped;
+    Uint32 head, start, count, numDropped;
+    int counter, written;
+
+    written = 0;
+    for(counter=0;counter<log->numRings;counter++)
+    {
+        ring = &(log->rings[counter]);
+        head = ring->head;
+        TI_LOG_BARRIER();
+
+        /* Up to the end of the ring's buffer, then whatever wrapped around
+           to the start of it */
+        while(ring->tail != head)
+        {
+            start = ring->tail & (TI_LOG_RING_SIZE - 1);
+            count = head - ring->tail;
+            if(start + count > TI_LOG_RING_SIZE)
+            {
+                count = TI_LOG_RING_SIZE - start;
+            }
+            fwrite(&(ring->records[start]), sizeof(TiLogRecord), count, log->fp);
+            written += count;
+            /* Done with the records before the thread can reuse them */
+            TI_LOG_BARRIER();
+            ring->tail += count;
+        }
+
+        numDropped = ring->dropped;
+        if(numDropped != ring->droppedLogged)
+        {
+            memset(&dropped, 0, sizeof(TiLogRecord));
+            dropped.ticks = SDL_GetTicks();
+            dropped.event = TI_LOG_EVENT_DROPPED;
+            dropped.level = TI_LOG_WARNING;
+            dropped.thread = counter;
+            dropped.args[0] = numDropped - ring->droppedLogged;
+            fwrite(&dropped, sizeof(TiLogRecord), 1, log->fp);
+            written++;
+            ring->droppedLogged = numDropped;
+        }
+    }
+
+    if(written > 0)
+    {
+        fflush(log->fp);
+    }
+    return written;
+}
+
+/****************************************************************************
+* logNeedsDrain - see tiLog.h for description
+****************************************************************************/
+int logNeedsDrain(TiLog *log)
+{
+    int counter;
+
+    for(counter=0;counter<log->numRings;counter++)
+    {
+        if(log->rings[counter].head - log->rings[counter].tail >= TI_LOG_DRAIN_THRESHOLD)
+        {
+            return TI_TRUE;
+        }
+    }
+    return TI_FALSE;
+}
+
+/****************************************************************************
+* logDrainThread - see tiLog.h for description
+****************************************************************************/
+int logDrainThread(void *data)
+{
+    TiLog *log;
+
+    log = (TiLog *)data;
+    SDL_mutexP(log->drainLock);
+    while(log->quit == TI_FALSE)
+    {
+        if(logNeedsDrain(log) == TI_FALSE)
+        {
+            SDL_CondWait(log->drainWork, log->drainLock);
+            continue;
+        }
+        SDL_mutexV(log->drainLock);
+        logDrain(log);
+        SDL_mutexP(log->drainLock);
+    }
+    SDL_mutexV(log->drainLock);
+
+    return 0;
+}
+
+/****************************************************************************
+* logGetName - see tiLog.h for description
+****************************************************************************/
+char *logGetName(char **names, int numNames, int value)
+{
+    if(value < 0 || value >= numNames)
+    {
+        return "unknown";
+    }
+    return names[value];
+}
+
+/****************************************************************************
+* logFormatRecord - see tiLog.h for description
+****************************************************************************/
+void logFormatRecord(TiLogRecord *r, char *buffer, int size)
+{
+    char *move;
+
+    switch(r->event)
+    {
+        case TI_LOG_EVENT_DROPPED:
+            snprintf(buffer, size, "%d records dropped", r->args[0]);
+            break;
+        case TI_LOG_EVENT_GAME_STATE:
+            snprintf(buffer, size, "  Changing game state to %s (player %d)",
+                     logGetName(TI_LOG_GAME_STATE_NAMES, 
+                                sizeof(TI_LOG_GAME_STATE_NAMES) / sizeof(char *), r->args[0]),
+                     r->args[1] + 1);
+            break;
+        case TI_LOG_EVENT_RENDER_STATE:
+            snprintf(buffer, size, "Changing render state to %s (from %s)",
+                     logGetName(TI_LOG_RENDER_STATE_NAMES, 
+                                sizeof(TI_LOG_RENDER_STATE_NAMES) / sizeof(char *), r->args[0]),
+                     logGetName(TI_LOG_RENDER_STATE_NAMES, 
+                                sizeof(TI_LOG_RENDER_STATE_NAMES) / sizeof(char *), r->args[1]));
+            break;
+        case TI_LOG_EVENT_CPU_MOVE:
+            move = logGetName(TI_LOG_CPU_MOVE_NAMES, 
+                              sizeof(TI_LOG_CPU_MOVE_NAMES) / sizeof(char *), r->args[0]);
+            switch(r->args[0])
+            {
+                case TI_CPU_MOVE_PLAY:
+                    snprintf(buffer, size, "    - Computer's move is '%s' (%c at (%d, %d))", move,
+                             (r->args[1] == TI_CPU_HELD_TILE_PRIMARY) ? 'P' : 'S', 
+                             r->args[2], r->args[3]);
+                    break;
+                case TI_CPU_MOVE_DISCARD:
+                    snprintf(buffer, size, "    - Computer's move is '%s (%s)'", move,
+                             (r->args[1] == TI_CPU_HELD_TILE_PRIMARY) ? "primary" : "secondary");
+                    break;
+                case TI_CPU_MOVE_END_TURN:
+                    snprintf(buffer, size, "    - Computer's move is '%s%s'", move,
+                             (r->args[1] == TI_TRUE) ? " (pass)" : "");
+                    break;
+                default:
+                    snprintf(buffer, size, "    - Computer's move is '%s'", move);
+                    break;
+            }
+            break;
+        case TI_LOG_EVENT_ASSET_FALLBACK:
+            snprintf(buffer, size, "%s",
+                     logGetName(TI_LOG_FALLBACK_MESSAGES,
+                                sizeof(TI_LOG_FALLBACK_MESSAGES) / sizeof(char *), r->args[0]));
+            break;
+        case TI_LOG_EVENT_SCREEN_UPDATES:
+            snprintf(buffer, size, "Screen updates: %d frames, %d pixels per frame (%d drawn)",
+                     r->args[0], r->args[1], r->args[2]);
+            break;
+        case TI_LOG_EVENT_SURFACE_POOL:
+            snprintf(buffer, size, "Surface pool: %d surfaces, %d acquired, %d made after startup",
+                     r->args[0], r->args[1], r->args[2]);
+            break;
+        default:
+            snprintf(buffer, size, "Unknown event %d (%d, %d, %d, %d)", r->event,
+                     r->args[0], r->args[1], r->args[2], r->args[3]);
+            break;
+    }
+}
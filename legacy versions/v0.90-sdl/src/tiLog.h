@@ -0,0 +1,313 @@
+/****************************************************************************
+*
+* tiLog.h - Header for tiLog.c
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#ifndef __TILOG_H__
+#define __TILOG_H__
+
+/*
+ * The log records what the game is doing (state changes, the computer 
+ * players' moves) without printing anything while it does it.  Each 
+ * record is a small fixed size structure -- an event number and a few 
+ * numbers that go with it -- which is put into a ring buffer belonging to
+ * the thread that wrote it.  Only that thread adds to its ring, and only 
+ * the log's drain thread takes from it, so writing a record never waits 
+ * on a lock; if the drain thread falls behind and a ring fills up, records
+ * are dropped (and the number dropped is logged).  The drain thread sleeps
+ * until a ring holds TI_LOG_DRAIN_THRESHOLD records (the thread that fills
+ * it that far wakes it) or the log is destroyed, then writes the records 
+ * to TI_LOG_FILE, so an idle game has nothing waking up to check on the 
+ * log.  tiLogDecode turns the file back into text.
+ *
+ * Records below TI_LOG_LEVEL are compiled out.  Build with, for example,
+ * -DTI_LOG_LEVEL=TI_LOG_WARNING to keep only warnings and errors.  If the
+ * log was never started (as in the benchmark and the tuner), records are
+ * thrown away as soon as they're written.
+ *
+ * Like the asset pack, the file is in the byte order of the machine that
+ * wrote it.
+ */
+
+/* Levels */
+#define TI_LOG_DEBUG                        0
+#define TI_LOG_INFO                         1
+#define TI_LOG_WARNING                      2
+#define TI_LOG_ERROR                        3
+#define TI_LOG_NUM_LEVELS                   4
+
+#ifndef TI_LOG_LEVEL
+#define TI_LOG_LEVEL                        TI_LOG_DEBUG
+#endif
+
+/* Events, and what their arguments are */
+#define TI_LOG_EVENT_DROPPED                0   /* count (records a ring had no room for) */
+#define TI_LOG_EVENT_GAME_STATE             1   /* new state, current player */
+#define TI_LOG_EVENT_RENDER_STATE           2   /* new state, previous state */
+#define TI_LOG_EVENT_CPU_MOVE               3   /* move type, held tile (or TI_TRUE for a 
+                                                   pass at the end of a turn), x, y */
+#define TI_LOG_EVENT_ASSET_FALLBACK         4   /* which fallback (see below) */
+#define TI_LOG_EVENT_SCREEN_UPDATES         5   /* frames, pixels pushed per frame, 
+                                                   pixels drawn per frame */
+#define TI_LOG_EVENT_SURFACE_POOL           6   /* surfaces, acquired, made after startup */
+#define TI_LOG_NUM_EVENTS                   7
+
+/* Ways of loading images that are used when the faster one isn't there */
+#define TI_LOG_FALLBACK_NO_ATLAS            0   /* each image from its own file */
+#define TI_LOG_FALLBACK_NO_PACK             1   /* decoded instead of read from the pack */
+#define TI_LOG_FALLBACK_NO_LOADER           2   /* decoded when needed, not in the background */
+
+#define TI_LOG_FILE                         "trackInsanity.log"
+#define TI_LOG_MAGIC                        0x474C4954      /* 'TILG' */
+#define TI_LOG_VERSION                      1
+#define TI_LOG_MAX_ARGS                     4
+#define TI_LOG_MAX_THREADS                  4
+/* A power of two, so the ring's positions can just keep counting up */
+#define TI_LOG_RING_SIZE                    1024
+#define TI_LOG_DRAIN_THRESHOLD              (TI_LOG_RING_SIZE / 4)
+#define TI_LOG_MAX_LINE_LENGTH              128
+
+/* Keeps the compiler (and, where it can, the processor) from moving a 
+   record's contents past the update of the ring position that hands it 
+   over.  Older compilers only get the compiler part, which is all the 
+   single core machines they build for need. */
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+#define TI_LOG_BARRIER()                    __sync_synchronize()
+#elif defined(__GNUC__)
+#define TI_LOG_BARRIER()                    __asm__ __volatile__("" : : : "memory")
+#else
+#define TI_LOG_BARRIER()
+#endif
+
+#define TI_LOG(level, event, a, b, c, d)                                \
+    do                                                                  \
+    {                                                                   \
+        if((level) >= TI_LOG_LEVEL)                                     \
+        {                                                               \
+            logWrite((level), (event), (a), (b), (c), (d));             \
+        }                                                               \
+    } while(0)
+
+/* The log file starts with a TiLogFileHeader, followed by the records in
+   the order they were drained (which is only in order of time within each
+   thread) */
+typedef struct
+{
+    Uint32 magic;
+    Uint32 version;
+    Uint32 recordSize;
+} TiLogFileHeader;
+
+typedef struct
+{
+    /* SDL_GetTicks when the record was written */
+    Uint32 ticks;
+    Uint16 event;
+    Uint8 level;
+    /* The ring the record was written to */
+    Uint8 thread;
+    Sint32 args[TI_LOG_MAX_ARGS];
+} TiLogRecord;
+
+typedef struct
+{
+    Uint32 threadId;
+    /* Records written so far (only changed by the ring's thread), and 
+       records drained so far (only changed by the drain thread) */
+    volatile Uint32 head;
+    volatile Uint32 tail;
+    /* Records the ring had no room for, and how many of those the drain
+       thread has logged */
+    volatile Uint32 dropped;
+    Uint32 droppedLogged;
+    TiLogRecord records[TI_LOG_RING_SIZE];
+} TiLogRing;
+
+typedef struct
+{
+    FILE *fp;
+    TiLogRing rings[TI_LOG_MAX_THREADS];
+    /* Rings are only added, under ringLock, and numRings goes up once the
+       new one is set up, so that finding a thread's ring needs no lock */
+    volatile int numRings;
+    SDL_mutex *ringLock;
+    /* The drain thread waits on drainWork, under drainLock, for a ring to
+       fill up or for quit to be set */
+    SDL_mutex *drainLock;
+    SDL_cond *drainWork;
+    SDL_Thread *drainThread;
+    volatile int quit;
+} TiLog;
+
+extern TiLog *CurrentLog;
+extern char *TI_LOG_LEVEL_NAMES[TI_LOG_NUM_LEVELS];
+
+/****************************************************************************
+* logInitialize
+*
+* Description:
+*   Opens the log file, writes its header, and starts the drain thread.
+*
+* Arguments:
+*   char *fileName - the log file
+*
+* Returns:
+*   TI_OK, or TI_ERROR if the log couldn't be started (records written
+*   after that are thrown away).
+*
+****************************************************************************/
+int logInitialize(char *fileName);
+
+/****************************************************************************
+* logDestroy
+*
+* Description:
+*   Stops the drain thread, writes out whatever is left in the rings, and 
+*   closes the log file.
+*
+* Arguments:
+*   None.
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void logDestroy(void);
+
+/****************************************************************************
+* logWrite
+*
+* Description:
+*   Adds a record to the calling thread's ring, and wakes the drain thread
+*   if that fills the ring to TI_LOG_DRAIN_THRESHOLD.  Use TI_LOG instead,
+*   so that records below TI_LOG_LEVEL are compiled out.
+*
+* Arguments:
+*   int level           - TI_LOG_DEBUG, etc.
+*   int event           - TI_LOG_EVENT_GAME_STATE, etc.
+*   Sint32 a, b, c, d   - the event's arguments (see above)
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void logWrite(int level, int event, Sint32 a, Sint32 b, Sint32 c, Sint32 d);
+
+/****************************************************************************
+* logGetRing
+*
+* Description:
+*   Finds the calling thread's ring, or gives it one if it doesn't have one.
+*
+* Arguments:
+*   TiLog *log - the log
+*
+* Returns:
+*   The ring, or NULL if every ring is taken.
+*
+****************************************************************************/
+TiLogRing *logGetRing(TiLog *log);
+
+/****************************************************************************
+* logDrain
+*
+* Description:
+*   Writes the records in every ring to the log file, along with a 
+*   TI_LOG_EVENT_DROPPED record for each ring that had to drop any.  Only
+*   called from the drain thread (or once it has stopped).
+*
+* Arguments:
+*   TiLog *log - the log
+*
+* Returns:
+*   The number of records written.
+*
+****************************************************************************/
+int logDrain(TiLog *log);
+
+/****************************************************************************
+* logNeedsDrain
+*
+* Description:
+*   Checks whether any ring holds TI_LOG_DRAIN_THRESHOLD records or more.
+*   Called with drainLock held.
+*
+* Arguments:
+*   TiLog *log - the log
+*
+* Returns:
+*   TI_TRUE or TI_FALSE.
+*
+****************************************************************************/
+int logNeedsDrain(TiLog *log);
+
+/****************************************************************************
+* logDrainThread
+*
+* Description:
+*   The drain thread.  Drains the rings whenever one fills up, until the
+*   log is destroyed.
+*
+* Arguments:
+*   void *data - the log
+*
+* Returns:
+*   0.
+*
+****************************************************************************/
+int logDrainThread(void *data);
+
+/****************************************************************************
+* logGetName
+*
+* Description:
+*   Looks up the name of a state or a move for logFormatRecord.
+*
+* Arguments:
+*   char **names - the names, in order
+*   int numNames - the number of names
+*   int value    - the state or move
+*
+* Returns:
+*   The name, or "unknown" if the value is out of range.
+*
+****************************************************************************/
+char *logGetName(char **names, int numNames, int value);
+
+/****************************************************************************
+* logFormatRecord
+*
+* Description:
+*   Turns a record back into the text the game used to print for it.
+*
+* Arguments:
+*   TiLogRecord *r - the record
+*   char *buffer   - where to put the text
+*   int size       - the size of the buffer
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void logFormatRecord(TiLogRecord *r, char *buffer, int size);
+
+#endif /* __TILOG_H__ */
@@ -0,0 +1,109 @@
+/****************************************************************************
+*
+* tiLogDecode.c - prints the records in a log file
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <SDL/SDL.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiLog.h"
+
+/*
+ * Usage: tiLogDecode [-l <level>] <log file>
+ *
+ * Prints the records in a log file written by the game (see tiLog.h), one
+ * per line, with the time they were written, the thread that wrote them
+ * and their level.  -l leaves out records below a level (0 is debug, 3 is
+ * error).  Records are printed in the order they're in the file, which is
+ * only in order of time for each thread.
+ */
+
+int main(int argc, char **argv)
+{
+    FILE *fp;
+    TiLogFileHeader header;
+    TiLogRecord record;
+    char line[TI_LOG_MAX_LINE_LENGTH];
+    char *fileName;
+    int minLevel;
+
+    minLevel = TI_LOG_DEBUG;
+    fileName = NULL;
+    if(argc == 2)
+    {
+        fileName = argv[1];
+    }
+    else if(argc == 4 && strcmp(argv[1], "-l") == 0)
+    {
+        minLevel = atoi(argv[2]);
+        fileName = argv[3];
+    }
+    if(fileName == NULL)
+    {
+        fprintf(stderr, "Usage: %s [-l <level>] <log file>\n", argv[0]);
+        return 1;
+    }
+
+    fp = fopen(fileName, "rb");
+    if(fp == NULL)
+    {
+        perror("Unable to open log file");
+        return 1;
+    }
+
+    if(fread(&header, sizeof(TiLogFileHeader), 1, fp) != 1 ||
+       header.magic != TI_LOG_MAGIC || header.version != TI_LOG_VERSION ||
+       header.recordSize != sizeof(TiLogRecord))
+    {
+        fprintf(stderr, "%s isn't a log file from this version of the game "
+                "(or was written on a machine with a different byte order)\n", fileName);
+        fclose(fp);
+        return 1;
+    }
+
+    while(fread(&record, sizeof(TiLogRecord), 1, fp) == 1)
+    {
+        if(record.level < minLevel)
+        {
+            continue;
+        }
+        logFormatRecord(&record, line, TI_LOG_MAX_LINE_LENGTH);
+        printf("%6lu.%03lu [%d] %-7s %s\n", (unsigned long)(record.ticks / 1000), 
+               (unsigned long)(record.ticks % 1000), record.thread,
+               (record.level < TI_LOG_NUM_LEVELS) ? TI_LOG_LEVEL_NAMES[record.level] : "?",
+               line);
+    }
+
+    fclose(fp);
+    return 0;
+}
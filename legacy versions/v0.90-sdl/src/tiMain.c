@@ -37,6 +37,11 @@
 #include "tiPlayer.h"
 #include "tiGame.h"
 #include "tiComputerAI.h"
+#include "tiMetrics.h"
+#include "tiProfile.h"
+#include "tiLog.h"
+#include "tiPlayout.h"
+#include "tiRecord.h"
 
 TiSharedData *GameData;
 TiScreen     *GameDisplay;
@@ -46,16 +51,63 @@ Game        *GameInstance;
 int main(int argc, char **argv)
 {
     int updateIterations;
+    AIEvalProfile aiProfile;
+    TiRenderBackend *backend;
+    char *script;
 
-    srand(time(NULL));
+    /* State changes and the computer players' moves (see tiLogDecode) */
+    if(logInitialize(TI_LOG_FILE) == TI_ERROR)
+    {
+        perror("Unable to start the log");
+    }
+    if(metricsInitialize() == TI_ERROR)
+    {
+        perror("Unable to set up the metrics");
+    }
+    /* Each game is recorded to TI_RECORD_FILE as it's played */
+    CurrentRecord = recordInitialize();
+    if(CurrentRecord == NULL)
+    {
+        perror("Unable to set up the game record");
+    }
+
+    /* Draw to the display, or (for tests and benchmarks) to memory */
+    backend = renderBackendFind(getenv("TI_RENDER_BACKEND"));
+    if(backend == NULL)
+    {
+        fprintf(stderr, "Unknown render backend %s\n", getenv("TI_RENDER_BACKEND"));
+        exit(1);
+    }
+
+    if(backend == &TI_RENDER_BACKEND_HEADLESS)
+    {
+        srand(TI_RENDER_HEADLESS_SEED);
+        script = getenv("TI_HEADLESS_SCRIPT");
+        if(script != NULL && renderBackendLoadScript(backend, script) == TI_ERROR)
+        {
+            perror("Unable to read headless script");
+            exit(1);
+        }
+    }
+    else
+    {
+        srand(time(NULL));
+    }
 
-    GameDisplay = renderInitialize(TI_GAME_XRES, TI_GAME_YRES, TI_GAME_DEPTH);
+    GameDisplay = renderInitialize(TI_GAME_XRES, TI_GAME_YRES, TI_GAME_DEPTH, backend);
     if(GameDisplay == NULL)
     {
         perror("Unable to initialize render structure");
         exit(1);
     }
 
+#ifdef TI_PROFILE
+    if(TI_PROFILE_INITIALIZE() == TI_ERROR)
+    {
+        perror("Unable to start the profiler");
+    }
+#endif
+
     GameData = renderSharedDataInitialize();
     if(GameData == NULL)
     {
@@ -63,6 +115,7 @@ int main(int argc, char **argv)
         renderDestroy(&GameDisplay);
         exit(1);
     }
+    renderReserveSurfaces(GameDisplay, GameData);
 
     GameAssetPool = renderAssetsInitialize();
     if(GameAssetPool == NULL)
@@ -76,6 +129,7 @@ int main(int argc, char **argv)
     {
         perror("Unable to load all images");
         renderFreeAssets(GameAssetPool, GameData);
+        renderAssetsDestroy(&GameAssetPool);
         renderSharedDataDestroy(&GameData);
         renderDestroy(&GameDisplay);
         exit(1);
@@ -86,17 +140,45 @@ int main(int argc, char **argv)
     {
         perror("Unable to initialize Game structure");
         renderFreeAssets(GameAssetPool, GameData);
+        renderAssetsDestroy(&GameAssetPool);
         renderSharedDataDestroy(&GameData);
         renderDestroy(&GameDisplay);
         exit(1);
     }
 
+    /* Use a tuned AI evaluation profile (see ti-tune) if there is one */
+    if(computerProfileLoad(&aiProfile, TI_AI_PROFILE_FILE) == TI_OK)
+    {
+        computerSetPlayerProfile(TI_CPU_ALL_PLAYERS, &aiProfile);
+    }
+
     /* Start up the state machine */
     renderSetRenderState(TI_STATE_COMPANY_LOGO, TI_STATE_NO_STATE, GameDisplay, GameAssetPool, GameData);
 
     while(GameData->exitGame == TI_FALSE)
     {
-        GameData->curTicks = SDL_GetTicks();
+        /* If nothing is moving and the game is waiting on the player, sleep
+           until there's input instead of running frames that draw nothing */
+        if(renderIsIdle(GameDisplay, GameAssetPool, GameData) == TI_TRUE)
+        {
+            renderBackendWaitEvent();
+            TI_PROFILE_FRAME_BEGIN();
+            /* Don't make up for the time spent asleep */
+            GameData->curTicks = renderBackendGetTicks();
+            GameData->lastFrameTicks = GameData->curTicks;
+            GameData->cyclesLeftOver = 0;
+            TI_PROFILE_BEGIN(TI_PROFILE_EVENTS);
+            renderProcessEvents(GameDisplay, GameAssetPool, GameData);
+            TI_PROFILE_END(TI_PROFILE_EVENTS);
+            TI_PROFILE_BEGIN(TI_PROFILE_RENDER);
+            renderUpdateScreen(GameDisplay, GameAssetPool, GameData);
+            TI_PROFILE_END(TI_PROFILE_RENDER);
+            TI_PROFILE_FRAME_END();
+            continue;
+        }
+
+        TI_PROFILE_FRAME_BEGIN();
+        GameData->curTicks = renderBackendGetTicks();
         updateIterations = ((GameData->curTicks - GameData->lastFrameTicks) +
                             GameData->cyclesLeftOver);
         if(updateIterations > (TI_MAX_CYCLES_PER_FRAME * TI_RENDER_FRAME_DURATION))
@@ -108,22 +190,41 @@ int main(int argc, char **argv)
         {
             updateIterations -= TI_RENDER_FRAME_DURATION;
             GameData->numFrames++;
+            TI_PROFILE_BEGIN(TI_PROFILE_LOGIC);
             renderUpdateLogic(GameDisplay, GameData, GameAssetPool);
+            TI_PROFILE_END(TI_PROFILE_LOGIC);
+            TI_PROFILE_BEGIN(TI_PROFILE_EVENTS);
             renderProcessEvents(GameDisplay, GameAssetPool, GameData);
+            TI_PROFILE_END(TI_PROFILE_EVENTS);
+            TI_PROFILE_BEGIN(TI_PROFILE_LOGIC);
             renderCheckTimingConditions(GameDisplay, GameAssetPool, GameData);
+            TI_PROFILE_END(TI_PROFILE_LOGIC);
         }
 
         GameData->cyclesLeftOver = updateIterations;
         GameData->lastFrameTicks = GameData->curTicks;
 
+        TI_PROFILE_BEGIN(TI_PROFILE_RENDER);
         renderUpdateScreen(GameDisplay, GameAssetPool, GameData);
-        SDL_Delay(1);
+        TI_PROFILE_END(TI_PROFILE_RENDER);
+        TI_PROFILE_FRAME_END();
+
+        /* Nothing changes on the screen until the next update is due */
+        if(GameData->cyclesLeftOver < TI_RENDER_FRAME_DURATION)
+        {
+            renderBackendDelay(TI_RENDER_FRAME_DURATION - GameData->cyclesLeftOver);
+        }
     }
 
     /* Free resources here */
     gameDestroy(&GameInstance);
     /* This call will free any remaining assets that are still loaded */
     renderFreeAssets(GameAssetPool, GameData);
+    renderAssetsDestroy(&GameAssetPool);
     renderDestroy(&GameDisplay);
     renderSharedDataDestroy(&GameData);
+    TI_PROFILE_DESTROY();
+    recordDestroy(&CurrentRecord);
+    metricsDestroy();
+    logDestroy();
 }
@@ -42,5 +42,8 @@
 
 #define TI_TILE_DATA_FILE               "data/tileData"
 #define TI_STATION_DATA_FILE            "data/stationData"
+#define TI_AI_PROFILE_FILE              "data/aiProfile"
+#define TI_ATLAS_INDEX_FILE             "data/atlas/index"
+#define TI_ASSET_PACK_FILE              "data/assets.pack"
 
 #endif /* __TIMAIN_H__ */
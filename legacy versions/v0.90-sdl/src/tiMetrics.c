@@ -0,0 +1,265 @@
+/****************************************************************************
+*
+* tiMetrics.c - counts of the work done by the engine
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+#include <SDL/SDL.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiMetrics.h"
+
+char *TI_METRIC_NAMES[TI_METRIC_NUM_COUNTERS] = 
+{
+    "legal_move_generations", "track_walks", "track_steps", "placements_evaluated",
+    "ai_decisions", "tile_draws", "allocations"
+};
+
+/* The first set of counters is the main thread's (it has no owner until
+   the main thread is known).  The rest are only added to under 
+   MetricsLock, and MetricsNumThreads goes up once a new one is set up, so
+   that finding a thread's counters needs no lock. */
+TiMetricsThread MetricsThreads[TI_METRICS_MAX_THREADS];
+volatile int MetricsNumThreads = 1;
+volatile int MetricsHaveMainThread = TI_FALSE;
+SDL_mutex *MetricsLock = NULL;
+/* Where threads that aren't registered, and aren't the main thread, count */
+TiMetrics MetricsDiscarded;
+
+/****************************************************************************
+* metricsInitialize - see tiMetrics.h for description
+****************************************************************************/
+int metricsInitialize(void)
+{
+    if(MetricsLock == NULL)
+    {
+        MetricsLock = SDL_CreateMutex();
+    }
+    MetricsThreads[0].threadId = SDL_ThreadID();
+    MetricsHaveMainThread = TI_TRUE;
+    return (MetricsLock != NULL) ? TI_OK : TI_ERROR;
+}
+
+/****************************************************************************
+* metricsDestroy - see tiMetrics.h for description
+****************************************************************************/
+void metricsDestroy(void)
+{
+    if(MetricsLock != NULL)
+    {
+        SDL_DestroyMutex(MetricsLock);
+        MetricsLock = NULL;
+    }
+}
+
+/****************************************************************************
+* metricsRegisterThread - see tiMetrics.h for description
+****************************************************************************/
+int metricsRegisterThread(void)
+{
+    TiMetricsThread *t;
+    int status;
+
+    if(MetricsLock == NULL)
+    {
+        return TI_ERROR;
+    }
+
+    status = TI_ERROR;
+    SDL_mutexP(MetricsLock);
+    if(MetricsNumThreads < TI_METRICS_MAX_THREADS)
+    {
+        t = &(MetricsThreads[MetricsNumThreads]);
+        memset(t, 0, sizeof(TiMetricsThread));
+        t->threadId = SDL_ThreadID();
+        TI_METRICS_BARRIER();
+        MetricsNumThreads++;
+        status = TI_OK;
+    }
+    SDL_mutexV(MetricsLock);
+
+    return status;
+}
+
+/****************************************************************************
+* metricsGetThreadMetrics - see tiMetrics.h for description
+****************************************************************************/
+TiMetrics *metricsGetThreadMetrics(void)
+{
+    Uint32 threadId;
+    int counter;
+
+    threadId = SDL_ThreadID();
+    if(MetricsHaveMainThread == TI_FALSE)
+    {
+        /* Without metricsInitialize there's only the one thread */
+        MetricsThreads[0].threadId = threadId;
+        MetricsHaveMainThread = TI_TRUE;
+    }
+    if(MetricsThreads[0].threadId == threadId)
+    {
+        return &(MetricsThreads[0].metrics);
+    }
+
+    for(counter=1;counter<MetricsNumThreads;counter++)
+    {
+        if(MetricsThreads[counter].threadId == threadId)
+        {
+            return &(MetricsThreads[counter].metrics);
+        }
+    }
+
+    return &MetricsDiscarded;
+}
+
+/****************************************************************************
+* metricsRecordDecision - see tiMetrics.h for description
+****************************************************************************/
+void metricsRecordDecision(unsigned long microseconds)
+{
+    TiMetrics *m;
+    unsigned long upTo;
+    int bucket;
+
+    bucket = 0;
+    upTo = 1;
+    while(microseconds >= upTo && bucket < TI_METRICS_LATENCY_BUCKETS - 1)
+    {
+        bucket++;
+        upTo <<= 1;
+    }
+
+    m = metricsGetThreadMetrics();
+    m->counters[TI_METRIC_AI_DECISIONS]++;
+    m->decisionLatency[bucket]++;
+    m->decisionTime += microseconds;
+}
+
+/****************************************************************************
+* metricsSnapshot - see tiMetrics.h for description
+****************************************************************************/
+void metricsSnapshot(TiMetrics *snapshot)
+{
+    TiMetrics *m;
+    int counter, counter2;
+
+    memset(snapshot, 0, sizeof(TiMetrics));
+    for(counter=0;counter<MetricsNumThreads;counter++)
+    {
+        m = &(MetricsThreads[counter].metrics);
+        for(counter2=0;counter2<TI_METRIC_NUM_COUNTERS;counter2++)
+        {
+            snapshot->counters[counter2] += m->counters[counter2];
+        }
+        for(counter2=0;counter2<TI_METRICS_LATENCY_BUCKETS;counter2++)
+        {
+            snapshot->decisionLatency[counter2] += m->decisionLatency[counter2];
+        }
+        snapshot->decisionTime += m->decisionTime;
+    }
+}
+
+/****************************************************************************
+* metricsDifference - see tiMetrics.h for description
+****************************************************************************/
+void metricsDifference(TiMetrics *after, TiMetrics *before, TiMetrics *result)
+{
+    int counter;
+
+    for(counter=0;counter<TI_METRIC_NUM_COUNTERS;counter++)
+    {
+        result->counters[counter] = after->counters[counter] - before->counters[counter];
+    }
+    for(counter=0;counter<TI_METRICS_LATENCY_BUCKETS;counter++)
+    {
+        result->decisionLatency[counter] = after->decisionLatency[counter] - 
+                                           before->decisionLatency[counter];
+    }
+    result->decisionTime = after->decisionTime - before->decisionTime;
+}
+
+/****************************************************************************
+* metricsWrite - see tiMetrics.h for description
+****************************************************************************/
+void metricsWrite(FILE *fp, TiMetrics *snapshot)
+{
+    unsigned long upTo;
+    int counter;
+
+    for(counter=0;counter<TI_METRIC_NUM_COUNTERS;counter++)
+    {
+        fprintf(fp, "%s %lu\n", TI_METRIC_NAMES[counter], snapshot->counters[counter]);
+    }
+    fprintf(fp, "decision_time_us %lu\n", snapshot->decisionTime);
+
+    upTo = 1;
+    for(counter=0;counter<TI_METRICS_LATENCY_BUCKETS;counter++)
+    {
+        if(snapshot->decisionLatency[counter] > 0)
+        {
+            if(counter < TI_METRICS_LATENCY_BUCKETS - 1)
+            {
+                fprintf(fp, "latency_%luus %lu\n", upTo, snapshot->decisionLatency[counter]);
+            }
+            else
+            {
+                fprintf(fp, "latency_over %lu\n", snapshot->decisionLatency[counter]);
+            }
+        }
+        upTo <<= 1;
+    }
+}
+
+/****************************************************************************
+* metricsGetMicroseconds - see tiMetrics.h for description
+****************************************************************************/
+unsigned long metricsGetMicroseconds(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER count, frequency;
+
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+    return (unsigned long)((count.QuadPart / frequency.QuadPart) * 1000000 +
+                           (count.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart);
+#else
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+    return (unsigned long)now.tv_sec * 1000000 + now.tv_usec;
+#endif
+}
@@ -0,0 +1,248 @@
+/****************************************************************************
+*
+* tiMetrics.h - Header for tiMetrics.c
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#ifndef __TIMETRICS_H__
+#define __TIMETRICS_H__
+
+/*
+ * Metrics count the work the engine does: legal move generations, track
+ * walks (and the tiles walked over), placements evaluated by the computer
+ * players, their decisions (with a histogram of how long each one took),
+ * tiles drawn and heap allocations.  Allocations are only counted in 
+ * programs linked with -Wl,--wrap=malloc (tiBench), whose wrapper adds to
+ * TI_METRIC_ALLOCATIONS.
+ *
+ * Each thread that registers with metricsRegisterThread gets its own set
+ * of counters, which only it writes to, so counting never takes a lock.
+ * The first set belongs to the main thread: the one that called 
+ * metricsInitialize, or in a program that never does (and so never starts
+ * threads of its own), the first one to count anything.  Any other thread
+ * that counts without registering (or after the sets have run out) counts
+ * into a set that is never read, so its counts are lost rather than 
+ * mixed into the main thread's.  metricsSnapshot adds up every thread's
+ * counters; since they're read while other threads may be counting, a 
+ * snapshot taken while games are running can be a little behind.
+ *
+ * Build with TI_NO_METRICS defined to leave the counting out altogether.
+ */
+
+/* Counters */
+#define TI_METRIC_LEGAL_MOVE_GENERATIONS    0
+#define TI_METRIC_TRACK_WALKS               1
+#define TI_METRIC_TRACK_STEPS               2
+#define TI_METRIC_PLACEMENTS_EVALUATED      3
+#define TI_METRIC_AI_DECISIONS              4
+#define TI_METRIC_TILE_DRAWS                5
+#define TI_METRIC_ALLOCATIONS               6
+#define TI_METRIC_NUM_COUNTERS              7
+
+#define TI_METRICS_MAX_THREADS              8
+
+/* Decision times are counted in buckets by powers of two.  The first 
+   bucket is for decisions that took under a microsecond; after that,
+   bucket n is for ones that took from 2^(n-1) up to 2^n microseconds,
+   and the last bucket has everything longer than that. */
+#define TI_METRICS_LATENCY_BUCKETS          24
+
+/* Keeps a new thread's set of counters from being found before it has 
+   been cleared.  Older compilers only get the compiler part, which is all
+   the single core machines they build for need. */
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+#define TI_METRICS_BARRIER()                __sync_synchronize()
+#elif defined(__GNUC__)
+#define TI_METRICS_BARRIER()                __asm__ __volatile__("" : : : "memory")
+#else
+#define TI_METRICS_BARRIER()
+#endif
+
+typedef struct
+{
+    unsigned long counters[TI_METRIC_NUM_COUNTERS];
+    unsigned long decisionLatency[TI_METRICS_LATENCY_BUCKETS];
+    /* Total time spent making decisions, in microseconds */
+    unsigned long decisionTime;
+} TiMetrics;
+
+typedef struct
+{
+    Uint32 threadId;
+    TiMetrics metrics;
+} TiMetricsThread;
+
+extern char *TI_METRIC_NAMES[TI_METRIC_NUM_COUNTERS];
+
+#ifndef TI_NO_METRICS
+#define TI_METRICS_ADD(counter, amount)     (metricsGetThreadMetrics()->counters[(counter)] += (amount))
+#define TI_METRICS_DECISION(microseconds)   metricsRecordDecision(microseconds)
+#else
+#define TI_METRICS_ADD(counter, amount)
+#define TI_METRICS_DECISION(microseconds)
+#endif
+
+/****************************************************************************
+* metricsInitialize
+*
+* Description:
+*   Sets up what metricsRegisterThread needs, and makes the calling thread
+*   the main thread.  Call it before starting any threads that count.
+*   A program with only one thread can count without it.
+*
+* Arguments:
+*   None.
+*
+* Returns:
+*   TI_OK or TI_ERROR.
+*
+****************************************************************************/
+int metricsInitialize(void);
+
+/****************************************************************************
+* metricsDestroy
+*
+* Description:
+*   Undoes metricsInitialize, once no more threads will register.
+*
+* Arguments:
+*   None.
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void metricsDestroy(void);
+
+/****************************************************************************
+* metricsRegisterThread
+*
+* Description:
+*   Gives the calling thread its own counters, starting at zero.
+*
+* Arguments:
+*   None.
+*
+* Returns:
+*   TI_OK, or TI_ERROR if there are no more sets of counters (the thread
+*   keeps using the shared ones).
+*
+****************************************************************************/
+int metricsRegisterThread(void);
+
+/****************************************************************************
+* metricsGetThreadMetrics
+*
+* Description:
+*   Finds the counters the calling thread counts into.
+*
+* Arguments:
+*   None.
+*
+* Returns:
+*   The thread's counters, the main thread's, or (for an unregistered 
+*   thread that isn't the main thread) ones that are never read.
+*
+****************************************************************************/
+TiMetrics *metricsGetThreadMetrics(void);
+
+/****************************************************************************
+* metricsRecordDecision
+*
+* Description:
+*   Counts a computer player's decision and how long it took.
+*
+* Arguments:
+*   unsigned long microseconds - how long the decision took
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void metricsRecordDecision(unsigned long microseconds);
+
+/****************************************************************************
+* metricsSnapshot
+*
+* Description:
+*   Adds up the counters of every thread.
+*
+* Arguments:
+*   TiMetrics *snapshot - where to put the totals
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void metricsSnapshot(TiMetrics *snapshot);
+
+/****************************************************************************
+* metricsDifference
+*
+* Description:
+*   Works out what was counted between two snapshots.
+*
+* Arguments:
+*   TiMetrics *after, *before - the snapshots
+*   TiMetrics *result         - where to put the difference (can be either
+*                               of the snapshots)
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void metricsDifference(TiMetrics *after, TiMetrics *before, TiMetrics *result);
+
+/****************************************************************************
+* metricsWrite
+*
+* Description:
+*   Writes a snapshot as text, one 'name value' pair per line, with the 
+*   decision time histogram as 'latency_<up to>us count' lines (empty 
+*   buckets are left out).
+*
+* Arguments:
+*   FILE *fp            - where to write it
+*   TiMetrics *snapshot - the snapshot
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void metricsWrite(FILE *fp, TiMetrics *snapshot);
+
+/****************************************************************************
+* metricsGetMicroseconds
+*
+* Description:
+*   Reads a clock with better resolution than SDL_GetTicks.  Only 
+*   differences between its values mean anything.
+*
+* Arguments:
+*   None.
+*
+* Returns:
+*   The clock, in microseconds.
+*
+****************************************************************************/
+unsigned long metricsGetMicroseconds(void);
+
+#endif /* __TIMETRICS_H__ */
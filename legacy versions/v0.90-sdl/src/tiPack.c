@@ -0,0 +1,176 @@
+/****************************************************************************
+*
+* tiPack.c - converts images into a pre-decoded asset pack
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <SDL/SDL.h>
+#include <SDL/SDL_image.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiAssetCache.h"
+
+/*
+ * Usage: tiPack <pack file> <image>...
+ *
+ * Converts images (normally the texture atlases written by tiAtlas) into
+ * the display's pixel format and writes them to a pack file that the game
+ * maps straight into memory (see tiAssetCache.h).  Every image is drawn 
+ * with magenta as its transparent color and RLE acceleration, just as
+ * renderLoadImage sets it up.  The file names in the pack are the names
+ * given on the command line, so run from the bin directory (the Makefile's
+ * 'pack' target does).
+ */
+
+/****************************************************************************
+* packAlign
+*
+* Rounds an offset in the pack file up to where the next image can start.
+****************************************************************************/
+Uint32 packAlign(Uint32 offset)
+{
+    return (offset + TI_ASSET_PACK_ALIGNMENT - 1) & ~(TI_ASSET_PACK_ALIGNMENT - 1);
+}
+
+int main(int argc, char **argv)
+{
+    FILE *fp;
+    SDL_Surface *images[TI_ASSET_PACK_MAX_IMAGES];
+    SDL_Surface *loaded;
+    TiAssetPackHeader header;
+    TiAssetPackImage packImages[TI_ASSET_PACK_MAX_IMAGES];
+    char padding[TI_ASSET_PACK_ALIGNMENT];
+    Uint32 offset;
+    int counter, numImages;
+
+    numImages = argc - 2;
+    if(numImages < 1 || numImages > TI_ASSET_PACK_MAX_IMAGES)
+    {
+        fprintf(stderr, "Usage: %s <pack file> <image>... (up to %d images)\n", argv[0],
+                TI_ASSET_PACK_MAX_IMAGES);
+        return 1;
+    }
+
+    if(SDL_Init(0) < 0)
+    {
+        perror("Unable to initialize SDL");
+        return 1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = TI_ASSET_PACK_MAGIC;
+    header.version = TI_ASSET_PACK_VERSION;
+    header.numImages = numImages;
+    header.bitsPerPixel = TI_ASSET_PACK_BITS_PER_PIXEL;
+    header.Rmask = TI_ASSET_PACK_RMASK;
+    header.Gmask = TI_ASSET_PACK_GMASK;
+    header.Bmask = TI_ASSET_PACK_BMASK;
+
+    /* Convert each image, and work out where it goes */
+    memset(packImages, 0, sizeof(packImages));
+    offset = packAlign(sizeof(TiAssetPackHeader) + numImages * sizeof(TiAssetPackImage));
+    for(counter=0;counter<numImages;counter++)
+    {
+        if(strlen(argv[counter + 2]) >= TI_ASSET_CACHE_MAX_NAME_LENGTH)
+        {
+            fprintf(stderr, "%s: file name too long\n", argv[counter + 2]);
+            SDL_Quit();
+            return 1;
+        }
+
+        loaded = IMG_Load(argv[counter + 2]);
+        if(loaded == NULL)
+        {
+            fprintf(stderr, "Unable to load %s\n", argv[counter + 2]);
+            SDL_Quit();
+            return 1;
+        }
+        images[counter] = SDL_CreateRGBSurface(SDL_SWSURFACE, loaded->w, loaded->h,
+                                               TI_ASSET_PACK_BITS_PER_PIXEL, 
+                                               TI_ASSET_PACK_RMASK, TI_ASSET_PACK_GMASK,
+                                               TI_ASSET_PACK_BMASK, 0);
+        if(images[counter] == NULL)
+        {
+            perror("Unable to create surface");
+            SDL_Quit();
+            return 1;
+        }
+
+        /* Copy the pixels as they are, like SDL_DisplayFormat does */
+        SDL_SetAlpha(loaded, 0, 0);
+        SDL_SetColorKey(loaded, 0, 0);
+        SDL_BlitSurface(loaded, NULL, images[counter], NULL);
+        SDL_FreeSurface(loaded);
+
+        strcpy(packImages[counter].fileName, argv[counter + 2]);
+        packImages[counter].offset = offset;
+        packImages[counter].width = images[counter]->w;
+        packImages[counter].height = images[counter]->h;
+        packImages[counter].pitch = images[counter]->pitch;
+        packImages[counter].flags = TI_ASSET_PACK_COLORKEY | TI_ASSET_PACK_RLE;
+        offset = packAlign(offset + images[counter]->h * images[counter]->pitch);
+    }
+    header.colorkey = SDL_MapRGB(images[0]->format, 0xFF, 0, 0xFF);
+
+    /* Write it all out */
+    fp = fopen(argv[1], "wb");
+    if(fp == NULL)
+    {
+        perror("Unable to open pack file");
+        SDL_Quit();
+        return 1;
+    }
+    memset(padding, 0, sizeof(padding));
+    fwrite(&header, sizeof(header), 1, fp);
+    fwrite(packImages, sizeof(TiAssetPackImage), numImages, fp);
+    for(counter=0;counter<numImages;counter++)
+    {
+        fwrite(padding, 1, packImages[counter].offset - ftell(fp), fp);
+        SDL_LockSurface(images[counter]);
+        fwrite(images[counter]->pixels, images[counter]->pitch, images[counter]->h, fp);
+        SDL_UnlockSurface(images[counter]);
+        printf("%s: %dx%d\n", packImages[counter].fileName, packImages[counter].width,
+               packImages[counter].height);
+        SDL_FreeSurface(images[counter]);
+    }
+
+    if(ferror(fp) || fclose(fp) != 0)
+    {
+        perror("Unable to write pack file");
+        SDL_Quit();
+        return 1;
+    }
+
+    printf("%d images, %lu bytes\n", numImages, (unsigned long)offset);
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,494 @@
+/****************************************************************************
+*
+* tiPlayout.c - Fast random playouts on a packed copy of the game
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <SDL/SDL.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiPlayout.h"
+
+/* Masks of squares on the playing area */
+#define TI_PLAYOUT_COLUMN_1     0x0101010101010101ULL
+#define TI_PLAYOUT_COLUMN_8     0x8080808080808080ULL
+#define TI_PLAYOUT_ROW_1        0x00000000000000ffULL
+#define TI_PLAYOUT_ROW_8        0xff00000000000000ULL
+#define TI_PLAYOUT_OUTER_RING   (TI_PLAYOUT_COLUMN_1 | TI_PLAYOUT_COLUMN_8 | \
+                                 TI_PLAYOUT_ROW_1 | TI_PLAYOUT_ROW_8)
+#define TI_PLAYOUT_CENTRAL      0x0000001818000000ULL
+
+/* Tables built by playoutInitialize */
+static signed char PlayoutPaths[TI_TILEPOOL_NUM_TILE_TYPES][TI_TILE_NUM_EXITS];
+static unsigned long long PlayoutIllegalSquares[TI_TILEPOOL_NUM_TILE_TYPES];
+static unsigned short PlayoutEmptyBoardEnd[TI_PLAYOUT_NUM_ENDS];
+static signed char PlayoutEndOwner[TI_PLAYOUT_NUM_ENDS];
+static int PlayoutTileType[TI_TILEPOOL_NUM_TILES];
+static signed char PlayoutNthSquare[256][8];
+
+/****************************************************************************
+* playoutInitialize - see tiPlayout.h for description
+****************************************************************************/
+int playoutInitialize(Game *g)
+{
+    Board *b;
+    Tile *t;
+    int counter, exit, x, y, square, type, station, path;
+    int newX, newY, enter, squareType;
+    int stationX, stationY, stationExit;
+
+    b = g->board;
+
+    for(counter=0;counter<TI_TILEPOOL_NUM_TILES;counter++)
+    {
+        t = &(g->tilepool->t[counter]);
+        type = t->tileStripOffset;
+        if(type < 0 || type >= TI_TILEPOOL_NUM_TILE_TYPES)
+        {
+            perror("playoutInitialize: invalid tile type");
+            return TI_ERROR;
+        }
+        PlayoutTileType[counter] = type;
+
+        /* The two exits of each path through the tile, one pair after the
+           other.  Every exit belongs to exactly one path. */
+        path = 0;
+        for(exit=0;exit<TI_TILE_NUM_EXITS;exit++)
+        {
+            if(tileGetExit(t, exit) > exit)
+            {
+                PlayoutPaths[type][path++] = exit;
+                PlayoutPaths[type][path++] = tileGetExit(t, exit);
+            }
+        }
+        if(path != TI_TILE_NUM_EXITS)
+        {
+            perror("playoutInitialize: invalid tile exits");
+            return TI_ERROR;
+        }
+
+        /* The outer squares where this tile would make a track of length
+           1 (the same checks as boardMarkLegalMoves) */
+        PlayoutIllegalSquares[type] = 0;
+        if(tileGetExit(t, 0) == 1)
+        {
+            PlayoutIllegalSquares[type] |= TI_PLAYOUT_ROW_1;
+        }
+        if(tileGetExit(t, 5) == 4)
+        {
+            PlayoutIllegalSquares[type] |= TI_PLAYOUT_ROW_8;
+        }
+        if(tileGetExit(t, 3) == 2)
+        {
+            PlayoutIllegalSquares[type] |= TI_PLAYOUT_COLUMN_8;
+        }
+        if(tileGetExit(t, 7) == 6)
+        {
+            PlayoutIllegalSquares[type] |= TI_PLAYOUT_COLUMN_1;
+        }
+        if(tileGetExit(t, 6) == 1 || tileGetExit(t, 0) == 7)
+        {
+            PlayoutIllegalSquares[type] |= 1ULL << 0;
+        }
+        if(tileGetExit(t, 2) == 1 || tileGetExit(t, 3) == 0)
+        {
+            PlayoutIllegalSquares[type] |= 1ULL << 7;
+        }
+        if(tileGetExit(t, 4) == 3 || tileGetExit(t, 5) == 2)
+        {
+            PlayoutIllegalSquares[type] |= 1ULL << 63;
+        }
+        if(tileGetExit(t, 5) == 6 || tileGetExit(t, 4) == 7)
+        {
+            PlayoutIllegalSquares[type] |= 1ULL << 56;
+        }
+    }
+
+    /* The position of the nth square in each possible row */
+    for(counter=0;counter<256;counter++)
+    {
+        path = 0;
+        for(exit=0;exit<8;exit++)
+        {
+            PlayoutNthSquare[counter][exit] = 0;
+            if(counter & (1 << exit))
+            {
+                PlayoutNthSquare[counter][path++] = exit;
+            }
+        }
+    }
+
+    /* Points for a track go to the owner of the station at either end.  
+       Points for any other end go to TI_PLAYOUT_NO_OWNER and are ignored. */
+    for(counter=0;counter<TI_PLAYOUT_NUM_ENDS;counter++)
+    {
+        PlayoutEndOwner[counter] = TI_PLAYOUT_NO_OWNER;
+    }
+    for(station=0;station<TI_BOARD_NUM_STATIONS;station++)
+    {
+        if(b->playerStations[g->numPlayers][station] != TI_BOARD_NO_TRAIN)
+        {
+            PlayoutEndOwner[TI_PLAYOUT_END_STATION + station] = 
+                b->playerStations[g->numPlayers][station] - 1;
+        }
+    }
+
+    /* On an empty board, each port faces a port of the next square, a 
+       station or a central station */
+    for(square=0;square<TI_PLAYOUT_NUM_SQUARES;square++)
+    {
+        x = (square % 8) + 1;
+        y = (square / 8) + 1;
+        for(exit=0;exit<TI_TILE_NUM_EXITS;exit++)
+        {
+            squareType = boardFindNextTrackSection(b, x, y, exit, &newX, &newY, &enter);
+            if(squareType == TI_BOARDSQUARE_TYPE_TILE ||
+               squareType == TI_BOARDSQUARE_TYPE_PLAYED_TILE)
+            {
+                PlayoutEmptyBoardEnd[square * 8 + exit] =
+                    ((newY - 1) * 8 + (newX - 1)) * 8 + enter;
+            }
+            else if(squareType == TI_BOARDSQUARE_TYPE_CENTRAL)
+            {
+                PlayoutEmptyBoardEnd[square * 8 + exit] = TI_PLAYOUT_END_CENTRAL;
+            }
+            else
+            {
+                /* Only one side of a station square is the station's exit */
+                station = boardGetStationNumber(newX, newY);
+                boardGetStationInfo(station, &stationX, &stationY, &stationExit);
+                boardFindNextTrackSection(b, stationX, stationY, stationExit,
+                                          &newX, &newY, &enter);
+                if(newX == x && newY == y && enter == exit)
+                {
+                    PlayoutEmptyBoardEnd[square * 8 + exit] = TI_PLAYOUT_END_STATION + station;
+                }
+                else
+                {
+                    PlayoutEmptyBoardEnd[square * 8 + exit] = TI_PLAYOUT_END_DEAD_END;
+                }
+            }
+        }
+    }
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* playoutLoadState - see tiPlayout.h for description
+****************************************************************************/
+void playoutLoadState(PlayoutState *s, Game *g)
+{
+    int counter, x, y, tileIndex;
+
+    s->occupied = 0;
+    memcpy(s->end, PlayoutEmptyBoardEnd, sizeof(s->end));
+    memset(s->length, 0, sizeof(s->length));
+    memset(s->score, 0, sizeof(s->score));
+    s->numPlayers = g->numPlayers;
+    s->curPlayer = g->curPlayer;
+    s->random = 1;
+
+    /* Tracks that were completed earlier get scored again here, so the
+       scores are set afterwards */
+    for(y=1;y<TI_BOARD_HEIGHT-1;y++)
+    {
+        for(x=1;x<TI_BOARD_WIDTH-1;x++)
+        {
+            tileIndex = g->board->b[x][y].tileIndex;
+            if(g->board->b[x][y].type == TI_BOARDSQUARE_TYPE_PLAYED_TILE)
+            {
+                playoutPlaceTile(s, (y - 1) * 8 + (x - 1), PlayoutTileType[tileIndex]);
+            }
+        }
+    }
+
+    s->poolSize = g->tilepool->numUnplayedTiles;
+    for(counter=0;counter<s->poolSize;counter++)
+    {
+        s->pool[counter] = PlayoutTileType[g->tilepool->unplayedTiles[counter]];
+    }
+
+    for(counter=0;counter<TI_MAX_PLAYERS;counter++)
+    {
+        s->hand[counter][0] = TI_PLAYOUT_NO_TILE;
+        s->hand[counter][1] = TI_PLAYOUT_NO_TILE;
+        s->score[counter] = 0;
+        if(counter < s->numPlayers)
+        {
+            if(g->players[counter].currentTileId != TI_TILE_NO_TILE)
+            {
+                s->hand[counter][0] = PlayoutTileType[g->players[counter].currentTileId];
+            }
+            if(g->players[counter].reserveTileId != TI_TILE_NO_TILE)
+            {
+                s->hand[counter][1] = PlayoutTileType[g->players[counter].reserveTileId];
+            }
+            s->score[counter] = g->players[counter].score;
+        }
+    }
+}
+
+/****************************************************************************
+* playoutLegalSquares - see tiPlayout.h for description
+****************************************************************************/
+unsigned long long playoutLegalSquares(PlayoutState *s, int type)
+{
+    unsigned long long empty, next, legal;
+
+    empty = ~(s->occupied | TI_PLAYOUT_CENTRAL);
+    next = ((s->occupied >> 1) & ~TI_PLAYOUT_COLUMN_8) |
+           ((s->occupied << 1) & ~TI_PLAYOUT_COLUMN_1) |
+           (s->occupied >> 8) | (s->occupied << 8);
+
+    /* Squares on the outside can always be played on, unless the tile
+       would make a track of length 1.  Squares inside need a neighbor. */
+    legal = empty & (TI_PLAYOUT_OUTER_RING | next) & ~PlayoutIllegalSquares[type];
+
+    /* With nothing left to draw, a tile can go anywhere */
+    if(legal == 0 && s->poolSize == 0)
+    {
+        legal = empty;
+    }
+
+    return legal;
+}
+
+/****************************************************************************
+* playoutPlaceTile - see tiPlayout.h for description
+****************************************************************************/
+void playoutPlaceTile(PlayoutState *s, int square, int type)
+{
+    int port, path, length, complete;
+    unsigned short portA, portB, endA, endB;
+
+    s->occupied |= 1ULL << square;
+    port = square * 8;
+
+    for(path=0;path<TI_TILE_NUM_EXITS;path+=2)
+    {
+        portA = port + PlayoutPaths[type][path];
+        portB = port + PlayoutPaths[type][path+1];
+        endA = s->end[portA];
+        endB = s->end[portB];
+        length = s->length[portA] + s->length[portB] + 1;
+
+        /* The track leaves the tile and comes straight back in -- a loop */
+        if(endA == portB)
+        {
+            continue;
+        }
+
+        s->end[endA] = endB;
+        s->length[endA] = length;
+        s->end[endB] = endA;
+        s->length[endB] = length;
+
+        /* If neither end is a port, the track is complete.  Whether it is or
+           not is hard to predict, so it's scored without branching -- an
+           incomplete track scores 0. */
+        complete = -((endA >= TI_PLAYOUT_NUM_PORTS) & (endB >= TI_PLAYOUT_NUM_PORTS));
+        s->score[PlayoutEndOwner[endA]] += (length << (endB == TI_PLAYOUT_END_CENTRAL)) & complete;
+        s->score[PlayoutEndOwner[endB]] += (length << (endA == TI_PLAYOUT_END_CENTRAL)) & complete;
+    }
+}
+
+/****************************************************************************
+* playoutTakeTurn - see tiPlayout.h for description
+****************************************************************************/
+int playoutTakeTurn(PlayoutState *s)
+{
+    signed char *hand;
+    unsigned long long legal, legalReserve;
+    int pick, numLegal, numLegalReserve, played;
+
+    hand = s->hand[s->curPlayer];
+    played = TI_FALSE;
+    legal = 0;
+    legalReserve = 0;
+
+    /* Draw a tile if there isn't one in hand */
+    if(hand[0] == TI_PLAYOUT_NO_TILE)
+    {
+        if(s->poolSize > 0)
+        {
+            pick = playoutRandom(s, s->poolSize);
+            hand[0] = s->pool[pick];
+            s->pool[pick] = s->pool[--s->poolSize];
+            legal = playoutLegalSquares(s, hand[0]);
+        }
+    }
+    else
+    {
+        legal = playoutLegalSquares(s, hand[0]);
+        /* If the tile that was already held can't be played, draw a 
+           second one */
+        if(legal == 0 && hand[1] == TI_PLAYOUT_NO_TILE && s->poolSize > 0)
+        {
+            pick = playoutRandom(s, s->poolSize);
+            hand[1] = s->pool[pick];
+            s->pool[pick] = s->pool[--s->poolSize];
+        }
+        if(hand[1] != TI_PLAYOUT_NO_TILE)
+        {
+            legalReserve = playoutLegalSquares(s, hand[1]);
+        }
+    }
+
+    numLegal = playoutCountSquares(legal);
+    numLegalReserve = playoutCountSquares(legalReserve);
+    if(numLegal + numLegalReserve > 0)
+    {
+        /* Pick one of the legal moves of either tile */
+        pick = playoutRandom(s, numLegal + numLegalReserve);
+        if(pick < numLegal)
+        {
+            playoutPlaceTile(s, playoutFindSquare(legal, pick), hand[0]);
+            hand[0] = hand[1];
+        }
+        else
+        {
+            playoutPlaceTile(s, playoutFindSquare(legalReserve, pick - numLegal), hand[1]);
+        }
+        hand[1] = TI_PLAYOUT_NO_TILE;
+        played = TI_TRUE;
+    }
+    else if(hand[1] != TI_PLAYOUT_NO_TILE)
+    {
+        /* Neither tile can be played, so the second goes back */
+        s->pool[s->poolSize++] = hand[1];
+        hand[1] = TI_PLAYOUT_NO_TILE;
+    }
+
+    s->curPlayer++;
+    if(s->curPlayer >= s->numPlayers)
+    {
+        s->curPlayer = 0;
+    }
+
+    return played;
+}
+
+/****************************************************************************
+* playoutRandom - see tiPlayout.h for description
+****************************************************************************/
+int playoutRandom(PlayoutState *s, int range)
+{
+    /* xorshift32, scaled to the range with a multiply rather than a divide */
+    s->random ^= s->random << 13;
+    s->random ^= s->random >> 17;
+    s->random ^= s->random << 5;
+    return (int)(((unsigned long long)s->random * (unsigned int)range) >> 32);
+}
+
+/****************************************************************************
+* playoutGetTileType - see tiPlayout.h for description
+****************************************************************************/
+int playoutGetTileType(int tileId)
+{
+    return PlayoutTileType[tileId];
+}
+
+/****************************************************************************
+* playoutCountSquares - see tiPlayout.h for description
+****************************************************************************/
+int playoutCountSquares(unsigned long long mask)
+{
+    mask = mask - ((mask >> 1) & 0x5555555555555555ULL);
+    mask = (mask & 0x3333333333333333ULL) + ((mask >> 2) & 0x3333333333333333ULL);
+    mask = (mask + (mask >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (int)((mask * 0x0101010101010101ULL) >> 56);
+}
+
+/****************************************************************************
+* playoutFindSquare - see tiPlayout.h for description
+****************************************************************************/
+int playoutFindSquare(unsigned long long mask, int n)
+{
+    unsigned long long counts, before, found;
+    int shift;
+
+    /* Count the squares in each row, and add them up so that each row holds
+       the number of squares up to and including that row */
+    counts = mask - ((mask >> 1) & 0x5555555555555555ULL);
+    counts = (counts & 0x3333333333333333ULL) + ((counts >> 2) & 0x3333333333333333ULL);
+    counts = (counts + (counts >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    counts *= 0x0101010101010101ULL;
+
+    /* Find the first row whose total is more than n (all rows are compared
+       at once), then look the square up within that row */
+    found = ((counts | 0x8080808080808080ULL) - 
+             (unsigned long long)(n + 1) * 0x0101010101010101ULL) & 0x8080808080808080ULL;
+    shift = __builtin_ctzll(found) - 7;
+    before = ((counts << 8) >> shift) & 0xff;
+
+    return shift + PlayoutNthSquare[(mask >> shift) & 0xff][n - (int)before];
+}
+
+/****************************************************************************
+* playoutRun - see tiPlayout.h for description
+****************************************************************************/
+int playoutRun(PlayoutState *s, unsigned int seed)
+{
+    int counter, tilesPlayed, idleTurns, tilesHeld;
+
+    s->random = (seed != 0) ? seed : 1;
+    tilesPlayed = 0;
+    idleTurns = 0;
+    while(idleTurns < TI_PLAYOUT_MAX_IDLE_TURNS)
+    {
+        if(s->poolSize == 0)
+        {
+            tilesHeld = 0;
+            for(counter=0;counter<s->numPlayers;counter++)
+            {
+                tilesHeld += (s->hand[counter][0] != TI_PLAYOUT_NO_TILE) ? 1 : 0;
+            }
+            if(tilesHeld == 0)
+            {
+                break;
+            }
+        }
+
+        if(playoutTakeTurn(s) == TI_TRUE)
+        {
+            tilesPlayed++;
+            idleTurns = 0;
+        }
+        else
+        {
+            idleTurns++;
+        }
+    }
+
+    return tilesPlayed;
+}
@@ -0,0 +1,255 @@
+/****************************************************************************
+*
+* tiPlayout.h - Header for tiPlayout.c
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+
+#ifndef __TIPLAYOUT_H__
+#define __TIPLAYOUT_H__
+
+/*
+ * Playouts play a game from some position to the end with random moves, as
+ * quickly as possible, for AIs that search by sampling how games turn out.
+ * They work on a packed copy of the game (PlayoutState) rather than on the
+ * Board and TilePool:
+ *
+ *  - The 8x8 playing area is a 64 bit mask of occupied squares (bit
+ *    (y-1)*8 + (x-1) for square (x,y)), so finding the legal squares for a
+ *    tile takes a few shifts and masks.
+ *  - Tracks are never followed.  Instead, every exit of every empty square 
+ *    (a 'port', numbered square*8 + exit) knows what the track that runs up
+ *    to it from outside the square is connected to at its other end, and 
+ *    how many tiles long it is.  Placing a tile joins the tracks on either
+ *    side of each of its four paths, and a track is scored the moment both
+ *    of its ends are stations.
+ *  - The tile pool is an array of tile types; a tile is drawn by swapping a
+ *    random entry with the last one.
+ *
+ * Players take their turns the way the computer does (see 
+ * computerDetermineNextMove), except that tiles are placed on a random
+ * legal square.  Nothing is allocated and nothing is printed.
+ */
+
+#define TI_PLAYOUT_NUM_SQUARES          64
+#define TI_PLAYOUT_NUM_PORTS            (TI_PLAYOUT_NUM_SQUARES * TI_TILE_NUM_EXITS)
+
+/* The other ends that a track can have, besides a port: a station's own 
+   exit (TI_PLAYOUT_END_STATION + station number), either side of a station
+   square that isn't its exit, or a central station */
+#define TI_PLAYOUT_END_STATION          TI_PLAYOUT_NUM_PORTS
+#define TI_PLAYOUT_END_DEAD_END         (TI_PLAYOUT_END_STATION + TI_BOARD_NUM_STATIONS)
+#define TI_PLAYOUT_END_CENTRAL          (TI_PLAYOUT_END_DEAD_END + 1)
+
+/* The station ends get entries in PlayoutState as well, so that joining two
+   tracks never has to check what kind of ends they have.  Nothing ever 
+   reads them. */
+#define TI_PLAYOUT_NUM_ENDS             (TI_PLAYOUT_END_CENTRAL + 1)
+
+#define TI_PLAYOUT_NO_TILE              -1
+
+/* Tracks that aren't owned by anyone are scored to this extra entry of
+   PlayoutState.score, which nothing ever reads */
+#define TI_PLAYOUT_NO_OWNER             TI_MAX_PLAYERS
+
+/* A playout is stopped if this many turns in a row go by without a tile
+   being played (see TI_SELFPLAY_MAX_IDLE_TURNS) */
+#define TI_PLAYOUT_MAX_IDLE_TURNS       (2 * TI_MAX_PLAYERS)
+
+typedef struct {
+    unsigned long long occupied;
+    unsigned short end[TI_PLAYOUT_NUM_ENDS];
+    unsigned char length[TI_PLAYOUT_NUM_ENDS];
+    signed char pool[TI_TILEPOOL_NUM_TILES];
+    signed char hand[TI_MAX_PLAYERS][2];
+    int poolSize;
+    int score[TI_MAX_PLAYERS + 1];
+    int numPlayers;
+    int curPlayer;
+    unsigned int random;
+} PlayoutState;
+
+/****************************************************************************
+* playoutInitialize
+*
+* Description:
+*   Builds the tables used by playouts (tile exits, station owners and the
+*   squares each type of tile can't be played on).  Must be called before
+*   any other playout function, and again if the number of players changes.
+*
+* Arguments:
+*   Game *g - the game to take the tiles and stations from
+*
+* Returns:
+*   TI_OK or TI_ERROR.
+*
+****************************************************************************/
+int playoutInitialize(Game *g);
+
+/****************************************************************************
+* playoutLoadState
+*
+* Description:
+*   Packs the current position of a game into a playout state.
+*
+* Arguments:
+*   PlayoutState *s - the state to fill in
+*   Game *g         - the game
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void playoutLoadState(PlayoutState *s, Game *g);
+
+/****************************************************************************
+* playoutLegalSquares
+*
+* Description:
+*   Finds the squares that a type of tile can be legally played on, by the
+*   same rules as boardMarkLegalMoves.
+*
+* Arguments:
+*   PlayoutState *s - the state
+*   int type        - the type of tile (tileStripOffset)
+*
+* Returns:
+*   A mask of the legal squares.
+*
+****************************************************************************/
+unsigned long long playoutLegalSquares(PlayoutState *s, int type);
+
+/****************************************************************************
+* playoutPlaceTile
+*
+* Description:
+*   Places a tile, joining up the tracks that run into the square and 
+*   scoring any that are completed.
+*
+* Arguments:
+*   PlayoutState *s - the state
+*   int square      - the square (see PlayoutState)
+*   int type        - the type of tile
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void playoutPlaceTile(PlayoutState *s, int square, int type);
+
+/****************************************************************************
+* playoutTakeTurn
+*
+* Description:
+*   Plays the current player's turn with a random move and moves on to the
+*   next player.
+*
+* Arguments:
+*   PlayoutState *s - the state
+*
+* Returns:
+*   TI_TRUE if a tile was played, TI_FALSE otherwise.
+*
+****************************************************************************/
+int playoutTakeTurn(PlayoutState *s);
+
+/****************************************************************************
+* playoutRandom
+*
+* Description:
+*   Picks a random number for a playout.
+*
+* Arguments:
+*   PlayoutState *s - the state holding the random number generator
+*   int range       - the number of values to pick from
+*
+* Returns:
+*   A number from 0 to range-1.
+*
+****************************************************************************/
+int playoutRandom(PlayoutState *s, int range);
+
+/****************************************************************************
+* playoutGetTileType
+*
+* Description:
+*   Looks up the type of a tile (its tileStripOffset) in the tables built
+*   by playoutInitialize.
+*
+* Arguments:
+*   int tileId - the tile (0 to TI_TILEPOOL_NUM_TILES-1)
+*
+* Returns:
+*   The type of the tile.
+*
+****************************************************************************/
+int playoutGetTileType(int tileId);
+
+/****************************************************************************
+* playoutCountSquares
+*
+* Description:
+*   Counts the squares in a mask.
+*
+* Arguments:
+*   unsigned long long mask - the mask
+*
+* Returns:
+*   The number of squares.
+*
+****************************************************************************/
+int playoutCountSquares(unsigned long long mask);
+
+/****************************************************************************
+* playoutFindSquare
+*
+* Description:
+*   Finds the nth square in a mask, counting from square 0.
+*
+* Arguments:
+*   unsigned long long mask - the mask
+*   int n                   - which square to find (0 to the number of
+*                             squares in the mask - 1)
+*
+* Returns:
+*   The square.
+*
+****************************************************************************/
+int playoutFindSquare(unsigned long long mask, int n);
+
+/****************************************************************************
+* playoutRun
+*
+* Description:
+*   Plays random moves until the end of the game.  The final scores are left
+*   in s->score.
+*
+* Arguments:
+*   PlayoutState *s - the state
+*   unsigned int seed - the seed for the playout's random numbers
+*
+* Returns:
+*   The number of tiles played.
+*
+****************************************************************************/
+int playoutRun(PlayoutState *s, unsigned int seed);
+
+#endif /* __TIPLAYOUT_H__ */
@@ -0,0 +1,406 @@
+/****************************************************************************
+*
+* tiProfile.c - frame timing, and the HUD that shows it
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <SDL/SDL.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiRenderBackend.h"
+#include "tiMetrics.h"
+#include "tiProfile.h"
+
+#ifdef TI_PROFILE
+
+TiProfile *CurrentProfile = NULL;
+
+/****************************************************************************
+* profileInitialize - see tiProfile.h for description
+****************************************************************************/
+int profileInitialize(void)
+{
+    char *fileName;
+    int counter;
+
+    CurrentProfile = (TiProfile *)malloc(sizeof(TiProfile));
+    if(CurrentProfile == NULL)
+    {
+        return TI_ERROR;
+    }
+    memset(CurrentProfile, 0, sizeof(TiProfile));
+
+    fileName = getenv("TI_PROFILE_CSV");
+    if(fileName == NULL)
+    {
+        fileName = TI_PROFILE_CSV_FILE;
+    }
+    CurrentProfile->csv = fopen(fileName, "w");
+    if(CurrentProfile->csv == NULL)
+    {
+        perror("profileInitialize: Unable to open the profile CSV file");
+    }
+    else
+    {
+        fprintf(CurrentProfile->csv, "frame,ticks,interval_us,total_us,logic_us,events_us,"
+                "render_us,ai_us,assets_us,blits,pixels_blitted,pixels_presented");
+        for(counter=0;counter<TI_METRIC_NUM_COUNTERS;counter++)
+        {
+            fprintf(CurrentProfile->csv, ",%s", TI_METRIC_NAMES[counter]);
+        }
+        fprintf(CurrentProfile->csv, "\n");
+    }
+
+    CurrentProfile->hudVisible = (getenv("TI_PROFILE_HUD") != NULL) ? TI_TRUE : TI_FALSE;
+    CurrentProfile->sectionStart = metricsGetMicroseconds();
+    return TI_OK;
+}
+
+/****************************************************************************
+* profileDestroy - see tiProfile.h for description
+****************************************************************************/
+void profileDestroy(void)
+{
+    TiMetrics metrics;
+
+    if(CurrentProfile == NULL)
+    {
+        return;
+    }
+
+    if(CurrentProfile->numFrames > 0)
+    {
+        printf("Profile: %lu frames, %lu us per frame, worst %lu us (frame %lu)\n",
+               CurrentProfile->numFrames, 
+               CurrentProfile->totalTime / CurrentProfile->numFrames,
+               CurrentProfile->worstTime, CurrentProfile->worstFrame);
+    }
+    metricsSnapshot(&metrics);
+    metricsWrite(stdout, &metrics);
+
+    if(CurrentProfile->csv != NULL)
+    {
+        fclose(CurrentProfile->csv);
+    }
+    if(CurrentProfile->hudBacking != NULL)
+    {
+        SDL_FreeSurface(CurrentProfile->hudBacking);
+    }
+    free(CurrentProfile);
+    CurrentProfile = NULL;
+}
+
+/****************************************************************************
+* profileFrameBegin - see tiProfile.h for description
+****************************************************************************/
+void profileFrameBegin(void)
+{
+    TiRenderBackend *b;
+    unsigned long now;
+
+    if(CurrentProfile == NULL)
+    {
+        return;
+    }
+
+    now = metricsGetMicroseconds();
+    memset(&(CurrentProfile->current), 0, sizeof(TiProfileFrame));
+    CurrentProfile->current.ticks = renderBackendGetTicks();
+    if(CurrentProfile->numFrames > 0)
+    {
+        CurrentProfile->current.interval = now - CurrentProfile->frameStart;
+    }
+    CurrentProfile->frameStart = now;
+    CurrentProfile->sectionStart = now;
+    CurrentProfile->depth = 0;
+
+    b = renderBackendGetCurrent();
+    CurrentProfile->blitsAtStart = b->numBlits;
+    CurrentProfile->pixelsBlittedAtStart = b->pixelsBlitted;
+    CurrentProfile->pixelsPresentedAtStart = b->pixelsPresented;
+    metricsSnapshot(&(CurrentProfile->metricsAtStart));
+}
+
+/****************************************************************************
+* profileFrameEnd - see tiProfile.h for description
+****************************************************************************/
+void profileFrameEnd(void)
+{
+    TiRenderBackend *b;
+    TiProfileFrame *f;
+    TiMetrics metrics;
+    int counter;
+
+    if(CurrentProfile == NULL)
+    {
+        return;
+    }
+
+    f = &(CurrentProfile->current);
+    f->total = metricsGetMicroseconds() - CurrentProfile->frameStart;
+    b = renderBackendGetCurrent();
+    f->numBlits = b->numBlits - CurrentProfile->blitsAtStart;
+    f->pixelsBlitted = b->pixelsBlitted - CurrentProfile->pixelsBlittedAtStart;
+    f->pixelsPresented = b->pixelsPresented - CurrentProfile->pixelsPresentedAtStart;
+    metricsSnapshot(&metrics);
+    metricsDifference(&metrics, &(CurrentProfile->metricsAtStart), &metrics);
+    for(counter=0;counter<TI_METRIC_NUM_COUNTERS;counter++)
+    {
+        f->metrics[counter] = metrics.counters[counter];
+    }
+
+    if(CurrentProfile->csv != NULL)
+    {
+        fprintf(CurrentProfile->csv, "%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu",
+                CurrentProfile->numFrames, (unsigned long)f->ticks, f->interval, f->total,
+                f->sectionTime[TI_PROFILE_LOGIC], f->sectionTime[TI_PROFILE_EVENTS],
+                f->sectionTime[TI_PROFILE_RENDER], f->sectionTime[TI_PROFILE_AI],
+                f->sectionTime[TI_PROFILE_ASSETS], f->numBlits, f->pixelsBlitted,
+                f->pixelsPresented);
+        for(counter=0;counter<TI_METRIC_NUM_COUNTERS;counter++)
+        {
+            fprintf(CurrentProfile->csv, ",%lu", f->metrics[counter]);
+        }
+        fprintf(CurrentProfile->csv, "\n");
+    }
+
+    CurrentProfile->history[CurrentProfile->nextHistory] = *f;
+    CurrentProfile->nextHistory = (CurrentProfile->nextHistory + 1) % TI_PROFILE_HUD_FRAMES;
+
+    CurrentProfile->totalTime += f->total;
+    if(f->total > CurrentProfile->worstTime)
+    {
+        CurrentProfile->worstTime = f->total;
+        CurrentProfile->worstFrame = CurrentProfile->numFrames;
+    }
+    CurrentProfile->numFrames++;
+}
+
+/****************************************************************************
+* profileBegin - see tiProfile.h for description
+****************************************************************************/
+void profileBegin(int section)
+{
+    unsigned long now;
+
+    if(CurrentProfile == NULL || CurrentProfile->depth >= TI_PROFILE_MAX_DEPTH)
+    {
+        return;
+    }
+
+    /* Whatever section this is nested in stops counting until it ends */
+    now = metricsGetMicroseconds();
+    if(CurrentProfile->depth > 0)
+    {
+        CurrentProfile->current.sectionTime[CurrentProfile->stack[CurrentProfile->depth-1]] += 
+            now - CurrentProfile->sectionStart;
+    }
+    CurrentProfile->stack[CurrentProfile->depth] = section;
+    CurrentProfile->depth++;
+    CurrentProfile->sectionStart = now;
+}
+
+/****************************************************************************
+* profileEnd - see tiProfile.h for description
+****************************************************************************/
+void profileEnd(int section)
+{
+    unsigned long now;
+
+    if(CurrentProfile == NULL || CurrentProfile->depth == 0 ||
+       CurrentProfile->stack[CurrentProfile->depth-1] != section)
+    {
+        return;
+    }
+
+    now = metricsGetMicroseconds();
+    CurrentProfile->current.sectionTime[section] += now - CurrentProfile->sectionStart;
+    CurrentProfile->depth--;
+    CurrentProfile->sectionStart = now;
+}
+
+/****************************************************************************
+* profileToggleHud - see tiProfile.h for description
+****************************************************************************/
+void profileToggleHud(TiScreen *display)
+{
+    if(CurrentProfile == NULL)
+    {
+        return;
+    }
+
+    CurrentProfile->hudVisible = (CurrentProfile->hudVisible == TI_TRUE) ? TI_FALSE : TI_TRUE;
+    /* The screen never has the HUD on it, so sending the area again is 
+       all it takes to get rid of it */
+    renderMarkDirty(display, TI_PROFILE_HUD_X, TI_PROFILE_HUD_Y,
+                    TI_PROFILE_HUD_WIDTH, TI_PROFILE_HUD_HEIGHT);
+}
+
+/****************************************************************************
+* profileHudBar - see tiProfile.h for description
+****************************************************************************/
+int profileHudBar(SDL_Surface *screen, int x, int bottom, int height, int maxHeight, Uint32 color)
+{
+    SDL_Rect rect;
+
+    if(height > maxHeight)
+    {
+        height = maxHeight;
+    }
+    if(height > 0)
+    {
+        rect.x = x;
+        rect.y = bottom - height;
+        rect.w = TI_PROFILE_HUD_BAR_WIDTH;
+        rect.h = height;
+        SDL_FillRect(screen, &rect, color);
+    }
+    return height;
+}
+
+/****************************************************************************
+* profileDrawHud - see tiProfile.h for description
+****************************************************************************/
+void profileDrawHud(TiScreen *display)
+{
+    SDL_PixelFormat *format;
+    SDL_Rect rect;
+    Uint32 background, budget, untracked, blits, pixels;
+    Uint32 sectionColors[TI_PROFILE_NUM_SECTIONS];
+    TiProfileFrame *f;
+    unsigned long tracked, screenPixels;
+    int counter, counter2, x, bottom, room, height;
+
+    if(CurrentProfile == NULL || CurrentProfile->hudVisible == TI_FALSE)
+    {
+        return;
+    }
+
+    format = display->screen->format;
+    if(CurrentProfile->hudBacking == NULL)
+    {
+        CurrentProfile->hudBacking = SDL_CreateRGBSurface(SDL_SWSURFACE, 
+                                                          TI_PROFILE_HUD_WIDTH, TI_PROFILE_HUD_HEIGHT,
+                                                          format->BitsPerPixel, format->Rmask,
+                                                          format->Gmask, format->Bmask, format->Amask);
+        if(CurrentProfile->hudBacking == NULL)
+        {
+            return;
+        }
+    }
+
+    rect.x = TI_PROFILE_HUD_X;
+    rect.y = TI_PROFILE_HUD_Y;
+    rect.w = TI_PROFILE_HUD_WIDTH;
+    rect.h = TI_PROFILE_HUD_HEIGHT;
+    SDL_BlitSurface(display->screen, &rect, CurrentProfile->hudBacking, NULL);
+
+    /* Drawn straight to the screen rather than through the render backend,
+       so the HUD doesn't show up in its own counts */
+    background = SDL_MapRGB(format, 0, 0, 0);
+    budget = SDL_MapRGB(format, 255, 255, 255);
+    untracked = SDL_MapRGB(format, 96, 96, 96);
+    blits = SDL_MapRGB(format, 0, 192, 192);
+    pixels = SDL_MapRGB(format, 255, 128, 0);
+    sectionColors[TI_PROFILE_LOGIC] = SDL_MapRGB(format, 0, 192, 0);
+    sectionColors[TI_PROFILE_EVENTS] = SDL_MapRGB(format, 255, 255, 0);
+    sectionColors[TI_PROFILE_RENDER] = SDL_MapRGB(format, 64, 64, 255);
+    sectionColors[TI_PROFILE_AI] = SDL_MapRGB(format, 255, 0, 0);
+    sectionColors[TI_PROFILE_ASSETS] = SDL_MapRGB(format, 255, 0, 255);
+    SDL_FillRect(display->screen, &rect, background);
+
+    screenPixels = (unsigned long)display->screen->w * display->screen->h;
+    for(counter=0;counter<TI_PROFILE_HUD_FRAMES;counter++)
+    {
+        /* Oldest frame on the left */
+        f = &(CurrentProfile->history[(CurrentProfile->nextHistory + counter) % TI_PROFILE_HUD_FRAMES]);
+        x = TI_PROFILE_HUD_X + counter * TI_PROFILE_HUD_BAR_WIDTH;
+
+        /* The frame's time, one section on top of another */
+        bottom = TI_PROFILE_HUD_Y + TI_PROFILE_HUD_GRAPH_HEIGHT;
+        room = TI_PROFILE_HUD_GRAPH_HEIGHT;
+        tracked = 0;
+        for(counter2=0;counter2<TI_PROFILE_NUM_SECTIONS;counter2++)
+        {
+            tracked += f->sectionTime[counter2];
+            height = profileHudBar(display->screen, x, bottom, 
+                                   f->sectionTime[counter2] / TI_PROFILE_HUD_US_PER_PIXEL,
+                                   room, sectionColors[counter2]);
+            bottom -= height;
+            room -= height;
+        }
+        if(f->total > tracked)
+        {
+            profileHudBar(display->screen, x, bottom, 
+                          (f->total - tracked) / TI_PROFILE_HUD_US_PER_PIXEL, room, untracked);
+        }
+
+        /* The blits, and the pixels sent to the display (a full strip is 
+           the whole screen) */
+        bottom = TI_PROFILE_HUD_Y + TI_PROFILE_HUD_GRAPH_HEIGHT + 1 + TI_PROFILE_HUD_STRIP_HEIGHT;
+        profileHudBar(display->screen, x, bottom, f->numBlits / TI_PROFILE_HUD_BLITS_PER_PIXEL,
+                      TI_PROFILE_HUD_STRIP_HEIGHT, blits);
+        bottom += 1 + TI_PROFILE_HUD_STRIP_HEIGHT;
+        profileHudBar(display->screen, x, bottom, 
+                      f->pixelsPresented * TI_PROFILE_HUD_STRIP_HEIGHT / screenPixels,
+                      TI_PROFILE_HUD_STRIP_HEIGHT, pixels);
+    }
+
+    /* A line across the graph at the time there is for each frame */
+    rect.y = TI_PROFILE_HUD_Y + TI_PROFILE_HUD_GRAPH_HEIGHT - 
+             (TI_RENDER_FRAME_DURATION * 1000) / TI_PROFILE_HUD_US_PER_PIXEL;
+    rect.h = 1;
+    SDL_FillRect(display->screen, &rect, budget);
+
+    renderMarkDirty(display, TI_PROFILE_HUD_X, TI_PROFILE_HUD_Y,
+                    TI_PROFILE_HUD_WIDTH, TI_PROFILE_HUD_HEIGHT);
+}
+
+/****************************************************************************
+* profileEraseHud - see tiProfile.h for description
+****************************************************************************/
+void profileEraseHud(TiScreen *display)
+{
+    SDL_Rect rect;
+
+    if(CurrentProfile == NULL || CurrentProfile->hudVisible == TI_FALSE ||
+       CurrentProfile->hudBacking == NULL)
+    {
+        return;
+    }
+
+    rect.x = TI_PROFILE_HUD_X;
+    rect.y = TI_PROFILE_HUD_Y;
+    SDL_BlitSurface(CurrentProfile->hudBacking, NULL, display->screen, &rect);
+}
+
+#endif /* TI_PROFILE */
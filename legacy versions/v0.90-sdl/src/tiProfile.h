@@ -0,0 +1,278 @@
+/****************************************************************************
+*
+* tiProfile.h - Header for tiProfile.c
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#ifndef __TIPROFILE_H__
+#define __TIPROFILE_H__
+
+/*
+ * The profiler times each frame of the main loop, split up by what the 
+ * time was spent on: game logic, input, drawing, the computer players and
+ * loading images.  Sections can be nested (the computer players think 
+ * inside the game logic, for instance), and time spent in a nested section
+ * is only counted against that section.  Anything that isn't in a section
+ * (mostly putting the frame on the screen) is the difference between the 
+ * total and the sum of the sections.  Note that the pause after a computer
+ * player's move is counted as logic.
+ *
+ * Each frame is written as a line of a CSV file, along with the number of 
+ * blits and fills, the pixels they touched, the pixels sent to the 
+ * display, and the engine's counters (see tiMetrics.h).  The counters' 
+ * totals are printed when the game exits.  A bar graph of the last few frames can be shown over the 
+ * screen with TI_PROFILE_HUD_KEY (or from the start by setting 
+ * TI_PROFILE_HUD in the environment).
+ *
+ * All of this only exists when the game is built with TI_PROFILE defined
+ * ('make profile' or 'make nokia-profile').  Otherwise the TI_PROFILE_* 
+ * macros used by the rest of the game are empty.
+ */
+
+/* Sections of a frame */
+#define TI_PROFILE_LOGIC                    0
+#define TI_PROFILE_EVENTS                   1
+#define TI_PROFILE_RENDER                   2
+#define TI_PROFILE_AI                       3
+#define TI_PROFILE_ASSETS                   4
+#define TI_PROFILE_NUM_SECTIONS             5
+
+/* How deep sections can be nested */
+#define TI_PROFILE_MAX_DEPTH                8
+
+/* Where the frames are written, unless TI_PROFILE_CSV says otherwise */
+#define TI_PROFILE_CSV_FILE                 "profile.csv"
+
+/* The HUD.  One frame per bar, TI_PROFILE_HUD_BAR_WIDTH pixels wide, 
+   with the frame time graph above a strip for the number of blits and 
+   a strip for the pixels sent to the display. */
+#define TI_PROFILE_HUD_KEY                  SDLK_F7
+#define TI_PROFILE_HUD_FRAMES               100
+#define TI_PROFILE_HUD_BAR_WIDTH            2
+#define TI_PROFILE_HUD_GRAPH_HEIGHT         64
+#define TI_PROFILE_HUD_STRIP_HEIGHT         16
+#define TI_PROFILE_HUD_US_PER_PIXEL         500
+#define TI_PROFILE_HUD_BLITS_PER_PIXEL      8
+#define TI_PROFILE_HUD_WIDTH                (TI_PROFILE_HUD_FRAMES * TI_PROFILE_HUD_BAR_WIDTH)
+#define TI_PROFILE_HUD_HEIGHT               (TI_PROFILE_HUD_GRAPH_HEIGHT + 2 * TI_PROFILE_HUD_STRIP_HEIGHT + 2)
+#define TI_PROFILE_HUD_X                    4
+#define TI_PROFILE_HUD_Y                    (TI_GAME_YRES - TI_PROFILE_HUD_HEIGHT - 4)
+
+#ifdef TI_PROFILE
+
+typedef struct
+{
+    /* The game clock when the frame started */
+    Uint32 ticks;
+    /* Microseconds since the previous frame started */
+    unsigned long interval;
+    /* Microseconds from the start to the end of the frame, and the part of
+       that spent in each section */
+    unsigned long total;
+    unsigned long sectionTime[TI_PROFILE_NUM_SECTIONS];
+    /* From the render backend */
+    unsigned long numBlits;
+    unsigned long pixelsBlitted;
+    unsigned long pixelsPresented;
+    /* What the engine did (see tiMetrics.h) */
+    unsigned long metrics[TI_METRIC_NUM_COUNTERS];
+} TiProfileFrame;
+
+typedef struct
+{
+    /* The frame being timed, and the last few for the HUD */
+    TiProfileFrame current;
+    TiProfileFrame history[TI_PROFILE_HUD_FRAMES];
+    int nextHistory;
+    unsigned long numFrames;
+    unsigned long frameStart;
+
+    /* The sections that have begun and not ended, and when the innermost
+       one began (or picked up again after a nested one ended) */
+    int stack[TI_PROFILE_MAX_DEPTH];
+    int depth;
+    unsigned long sectionStart;
+
+    /* The render backend's counters at the start of the frame */
+    unsigned long blitsAtStart;
+    unsigned long pixelsBlittedAtStart;
+    unsigned long pixelsPresentedAtStart;
+    TiMetrics metricsAtStart;
+
+    FILE *csv;
+
+    /* The screen behind the HUD, which is put back once the frame has been
+       presented */
+    int hudVisible;
+    SDL_Surface *hudBacking;
+
+    /* Statistics */
+    unsigned long totalTime;
+    unsigned long worstTime;
+    unsigned long worstFrame;
+} TiProfile;
+
+extern TiProfile *CurrentProfile;
+
+#define TI_PROFILE_INITIALIZE()             profileInitialize()
+#define TI_PROFILE_DESTROY()                profileDestroy()
+#define TI_PROFILE_FRAME_BEGIN()            profileFrameBegin()
+#define TI_PROFILE_FRAME_END()              profileFrameEnd()
+#define TI_PROFILE_BEGIN(section)           profileBegin(section)
+#define TI_PROFILE_END(section)             profileEnd(section)
+#define TI_PROFILE_DRAW_HUD(display)        profileDrawHud(display)
+#define TI_PROFILE_ERASE_HUD(display)       profileEraseHud(display)
+
+/****************************************************************************
+* profileInitialize
+*
+* Description:
+*   Starts the profiler and opens the CSV file (TI_PROFILE_CSV, or 
+*   TI_PROFILE_CSV_FILE).  If the file can't be opened, the frames are 
+*   still timed for the HUD.
+*
+* Arguments:
+*   None.
+*
+* Returns:
+*   TI_OK, or TI_ERROR if the profiler couldn't be started.
+*
+****************************************************************************/
+int profileInitialize(void);
+
+/****************************************************************************
+* profileDestroy
+*
+* Description:
+*   Closes the CSV file, prints the average and worst frame times and the
+*   engine's counters, and stops the profiler.
+*
+* Arguments:
+*   None.
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void profileDestroy(void);
+
+/****************************************************************************
+* profileFrameBegin, profileFrameEnd
+*
+* Description:
+*   Mark the start and end of the work done for a frame.  The main loop's 
+*   sleep between frames goes outside of them.  Ending a frame writes it 
+*   to the CSV file and the HUD's history.
+*
+* Arguments:
+*   None.
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void profileFrameBegin(void);
+void profileFrameEnd(void);
+
+/****************************************************************************
+* profileBegin, profileEnd
+*
+* Description:
+*   Mark the start and end of a section of the frame.  Sections have to 
+*   end in the opposite order that they began.
+*
+* Arguments:
+*   int section - the section (TI_PROFILE_LOGIC, etc.)
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void profileBegin(int section);
+void profileEnd(int section);
+
+/****************************************************************************
+* profileToggleHud
+*
+* Description:
+*   Shows the HUD if it's hidden, and hides it if it's shown.
+*
+* Arguments:
+*   TiScreen *display - the display
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void profileToggleHud(TiScreen *display);
+
+/****************************************************************************
+* profileHudBar
+*
+* Description:
+*   Draws one of the HUD's bars, from the bottom up.
+*
+* Arguments:
+*   SDL_Surface *screen - the screen
+*   int x, bottom       - where the bottom left corner of the bar goes
+*   int height          - the height of the bar
+*   int maxHeight       - the height to cut the bar off at
+*   Uint32 color        - the color of the bar
+*
+* Returns:
+*   The height of the bar that was drawn.
+*
+****************************************************************************/
+int profileHudBar(SDL_Surface *screen, int x, int bottom, int height, int maxHeight, Uint32 color);
+
+/****************************************************************************
+* profileDrawHud, profileEraseHud
+*
+* Description:
+*   Draw the HUD on the screen (saving what was behind it), and put back 
+*   what was behind it.  The HUD is drawn just before the dirty areas are
+*   sent to the display and erased right after, so that the rest of the 
+*   game never sees it.
+*
+* Arguments:
+*   TiScreen *display - the display
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void profileDrawHud(TiScreen *display);
+void profileEraseHud(TiScreen *display);
+
+#else
+
+#define TI_PROFILE_INITIALIZE()
+#define TI_PROFILE_DESTROY()
+#define TI_PROFILE_FRAME_BEGIN()
+#define TI_PROFILE_FRAME_END()
+#define TI_PROFILE_BEGIN(section)
+#define TI_PROFILE_END(section)
+#define TI_PROFILE_DRAW_HUD(display)
+#define TI_PROFILE_ERASE_HUD(display)
+
+#endif /* TI_PROFILE */
+
+#endif /* __TIPROFILE_H__ */
@@ -0,0 +1,850 @@
+/****************************************************************************
+*
+* tiRecord.c - Game records, and playing them back
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <SDL/SDL.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiPlayout.h"
+#include "tiRecord.h"
+
+TiRecord *CurrentRecord = NULL;
+
+/* The state at the start of a game, kept by recordReplayStart for the
+   number of players the playout tables were last built for */
+PlayoutState RecordStartState;
+int RecordStartPlayers = 0;
+
+/****************************************************************************
+* recordInitialize - see tiRecord.h for description
+****************************************************************************/
+TiRecord *recordInitialize(void)
+{
+    TiRecord *r;
+
+    r = (TiRecord *)malloc(sizeof(TiRecord));
+    if(r == NULL)
+    {
+        return NULL;
+    }
+    memset(r, 0, sizeof(TiRecord));
+
+    r->events = (unsigned char *)malloc(TI_RECORD_INITIAL_SIZE);
+    if(r->events == NULL)
+    {
+        free(r);
+        return NULL;
+    }
+    r->size = TI_RECORD_INITIAL_SIZE;
+
+    r->keyframes = (TiRecordIndexEntry *)malloc(TI_RECORD_INITIAL_KEYFRAMES * sizeof(TiRecordIndexEntry));
+    if(r->keyframes == NULL)
+    {
+        free(r->events);
+        free(r);
+        return NULL;
+    }
+    r->maxKeyframes = TI_RECORD_INITIAL_KEYFRAMES;
+    r->header.magic = TI_RECORD_MAGIC;
+    r->header.version = TI_RECORD_VERSION;
+
+    return r;
+}
+
+/****************************************************************************
+* recordDestroy - see tiRecord.h for description
+****************************************************************************/
+void recordDestroy(TiRecord **r)
+{
+    if(*r == NULL)
+    {
+        return;
+    }
+
+    if((*r)->fp != NULL)
+    {
+        recordFlush(*r);
+        fclose((*r)->fp);
+    }
+    free((*r)->events);
+    free((*r)->keyframes);
+    free(*r);
+    *r = NULL;
+}
+
+/****************************************************************************
+* recordBegin - see tiRecord.h for description
+****************************************************************************/
+int recordBegin(TiRecord *r, Game *g, Uint32 seed, char *fileName)
+{
+    int counter;
+
+    if(r == NULL)
+    {
+        return TI_OK;
+    }
+
+    if(r->fp != NULL)
+    {
+        fclose(r->fp);
+        r->fp = NULL;
+    }
+
+    r->header.magic = TI_RECORD_MAGIC;
+    r->header.version = TI_RECORD_VERSION;
+    r->header.numPlayers = g->numPlayers;
+    r->header.seed = seed;
+    for(counter=0;counter<TI_MAX_PLAYERS;counter++)
+    {
+        r->header.controlledBy[counter] = g->players[counter].controlledBy;
+        r->header.aiLevel[counter] = g->players[counter].computerAiLevel;
+    }
+    r->header.numEvents = 0;
+    r->header.numBytes = 0;
+    r->header.numKeyframes = 0;
+    r->bytesWritten = 0;
+    recordStartPosition(r, &(r->position));
+
+    if(fileName != NULL)
+    {
+        r->fp = fopen(fileName, "wb");
+        if(r->fp == NULL)
+        {
+            return TI_ERROR;
+        }
+        r->headerOffset = 0;
+        return recordFlush(r);
+    }
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* recordAddEvent - see tiRecord.h for description
+****************************************************************************/
+void recordAddEvent(TiRecord *r, int event, int reserve, int value)
+{
+    unsigned char *e;
+
+    if(r == NULL)
+    {
+        return;
+    }
+    if(r->header.numEvents > 0 && r->header.numEvents % TI_RECORD_KEYFRAME_INTERVAL == 0 &&
+       (r->header.numKeyframes == 0 ||
+        r->keyframes[r->header.numKeyframes - 1].event != r->header.numEvents))
+    {
+        recordAddKeyframe(r);
+    }
+    if(recordGrow(r, 2) != TI_OK)
+    {
+        return;
+    }
+
+    e = r->events + r->header.numBytes;
+    e[0] = event | ((reserve == TI_TRUE) ? TI_RECORD_HELD_RESERVE : 0);
+    if(event == TI_RECORD_EVENT_DRAW || event == TI_RECORD_EVENT_PLAY)
+    {
+        e[1] = value;
+        r->header.numBytes += 2;
+    }
+    else
+    {
+        r->header.numBytes++;
+    }
+    r->header.numEvents++;
+    recordApplyEvent(r, &(r->position));
+
+    if(event == TI_RECORD_EVENT_END_TURN && r->fp != NULL)
+    {
+        recordFlush(r);
+    }
+}
+
+/****************************************************************************
+* recordEndGame - see tiRecord.h for description
+****************************************************************************/
+void recordEndGame(TiRecord *r, Game *g)
+{
+    unsigned char *e;
+    int counter, score;
+
+    if(r == NULL || recordGrow(r, 1 + 2 * g->numPlayers) != TI_OK)
+    {
+        return;
+    }
+
+    e = r->events + r->header.numBytes;
+    *e++ = TI_RECORD_EVENT_END_GAME;
+    for(counter=0;counter<g->numPlayers;counter++)
+    {
+        score = g->players[counter].score;
+        *e++ = score & 0xff;
+        *e++ = (score >> 8) & 0xff;
+    }
+    r->header.numBytes += 1 + 2 * g->numPlayers;
+    r->header.numEvents++;
+    recordApplyEvent(r, &(r->position));
+
+    if(r->fp != NULL)
+    {
+        recordFlush(r);
+        fclose(r->fp);
+        r->fp = NULL;
+    }
+}
+
+/****************************************************************************
+* recordGrow - see tiRecord.h for description
+****************************************************************************/
+int recordGrow(TiRecord *r, int numBytes)
+{
+    unsigned char *events;
+    int size;
+
+    if(r->header.numBytes + numBytes <= r->size)
+    {
+        return TI_OK;
+    }
+
+    size = r->size * 2;
+    while(size < r->header.numBytes + numBytes)
+    {
+        size *= 2;
+    }
+    events = (unsigned char *)realloc(r->events, size);
+    if(events == NULL)
+    {
+        perror("recordGrow: out of memory");
+        return TI_ERROR;
+    }
+    r->events = events;
+    r->size = size;
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* recordFlush - see tiRecord.h for description
+****************************************************************************/
+int recordFlush(TiRecord *r)
+{
+    if(r->fp == NULL)
+    {
+        return TI_ERROR;
+    }
+
+    /* The new events go after the ones already written (over the old
+       index), then the index and the header are brought up to date, so
+       that the file always holds a whole record no matter when the game
+       stops */
+    if(fseek(r->fp, r->headerOffset + sizeof(TiRecordHeader) + r->bytesWritten, SEEK_SET) != 0 ||
+       fwrite(r->events + r->bytesWritten, 1, r->header.numBytes - r->bytesWritten, r->fp) !=
+           r->header.numBytes - r->bytesWritten ||
+       fwrite(r->keyframes, sizeof(TiRecordIndexEntry), r->header.numKeyframes, r->fp) !=
+           r->header.numKeyframes)
+    {
+        return TI_ERROR;
+    }
+    r->bytesWritten = r->header.numBytes;
+
+    if(fseek(r->fp, r->headerOffset, SEEK_SET) != 0 ||
+       fwrite(&(r->header), sizeof(TiRecordHeader), 1, r->fp) != 1)
+    {
+        return TI_ERROR;
+    }
+    fflush(r->fp);
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* recordWrite - see tiRecord.h for description
+****************************************************************************/
+int recordWrite(FILE *fp, TiRecord *r)
+{
+    if(fwrite(&(r->header), sizeof(TiRecordHeader), 1, fp) != 1 ||
+       fwrite(r->events, 1, r->header.numBytes, fp) != r->header.numBytes ||
+       fwrite(r->keyframes, sizeof(TiRecordIndexEntry), r->header.numKeyframes, fp) !=
+           r->header.numKeyframes)
+    {
+        return TI_ERROR;
+    }
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* recordRead - see tiRecord.h for description
+****************************************************************************/
+int recordRead(FILE *fp, TiRecord *r)
+{
+    TiRecordIndexEntry *keyframes;
+    Uint32 numBytes;
+
+    if(fread(&(r->header), sizeof(TiRecordHeader), 1, fp) != 1)
+    {
+        return feof(fp) ? TI_RECORD_NO_MORE_RECORDS : TI_ERROR;
+    }
+    if(r->header.magic != TI_RECORD_MAGIC || r->header.version != TI_RECORD_VERSION ||
+       r->header.numPlayers < TI_MIN_PLAYERS || r->header.numPlayers > TI_MAX_PLAYERS)
+    {
+        return TI_ERROR;
+    }
+
+    /* Room is made for the events as if the record were empty */
+    numBytes = r->header.numBytes;
+    r->header.numBytes = 0;
+    r->bytesWritten = 0;
+    if(recordGrow(r, numBytes) != TI_OK)
+    {
+        return TI_ERROR;
+    }
+    r->header.numBytes = numBytes;
+    if(fread(r->events, 1, r->header.numBytes, fp) != r->header.numBytes)
+    {
+        return TI_ERROR;
+    }
+
+    if(r->header.numKeyframes > r->maxKeyframes)
+    {
+        keyframes = (TiRecordIndexEntry *)realloc(r->keyframes,
+                                                  r->header.numKeyframes * sizeof(TiRecordIndexEntry));
+        if(keyframes == NULL)
+        {
+            perror("recordRead: out of memory");
+            return TI_ERROR;
+        }
+        r->keyframes = keyframes;
+        r->maxKeyframes = r->header.numKeyframes;
+    }
+    if(fread(r->keyframes, sizeof(TiRecordIndexEntry), r->header.numKeyframes, fp) !=
+       r->header.numKeyframes)
+    {
+        return TI_ERROR;
+    }
+    recordStartPosition(r, &(r->position));
+
+    return recordCheckIndex(r);
+}
+
+/****************************************************************************
+* recordCheckIndex - see tiRecord.h for description
+****************************************************************************/
+int recordCheckIndex(TiRecord *r)
+{
+    Uint32 counter;
+
+    for(counter=0;counter<r->header.numKeyframes;counter++)
+    {
+        if(r->keyframes[counter].offset >= r->header.numBytes ||
+           r->header.numBytes - r->keyframes[counter].offset < 1 + sizeof(TiRecordKeyframe) ||
+           r->events[r->keyframes[counter].offset] != TI_RECORD_EVENT_KEYFRAME ||
+           r->events[r->keyframes[counter].offset + 1 + offsetof(TiRecordKeyframe, curPlayer)] >=
+               r->header.numPlayers)
+        {
+            return TI_ERROR;
+        }
+    }
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* recordAddKeyframe - see tiRecord.h for description
+****************************************************************************/
+int recordAddKeyframe(TiRecord *r)
+{
+    TiRecordIndexEntry *keyframes;
+    unsigned char *e;
+
+    if(recordGrow(r, 1 + sizeof(TiRecordKeyframe)) != TI_OK)
+    {
+        return TI_ERROR;
+    }
+    if(r->header.numKeyframes == r->maxKeyframes)
+    {
+        keyframes = (TiRecordIndexEntry *)realloc(r->keyframes,
+                                                  r->maxKeyframes * 2 * sizeof(TiRecordIndexEntry));
+        if(keyframes == NULL)
+        {
+            perror("recordAddKeyframe: out of memory");
+            return TI_ERROR;
+        }
+        r->keyframes = keyframes;
+        r->maxKeyframes *= 2;
+    }
+
+    r->keyframes[r->header.numKeyframes].event = r->position.event;
+    r->keyframes[r->header.numKeyframes].turn = r->position.turn;
+    r->keyframes[r->header.numKeyframes].offset = r->header.numBytes;
+    r->header.numKeyframes++;
+
+    e = r->events + r->header.numBytes;
+    e[0] = TI_RECORD_EVENT_KEYFRAME;
+    memcpy(e + 1, &(r->position.k), sizeof(TiRecordKeyframe));
+    r->header.numBytes += 1 + sizeof(TiRecordKeyframe);
+    recordApplyEvent(r, &(r->position));
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* recordStartPosition - see tiRecord.h for description
+****************************************************************************/
+void recordStartPosition(TiRecord *r, TiRecordPosition *p)
+{
+    memset(&(p->k), TI_RECORD_NO_TILE, sizeof(TiRecordKeyframe));
+    p->k.curPlayer = 0;
+    p->numPlayers = r->header.numPlayers;
+    p->event = 0;
+    p->turn = 0;
+    p->offset = 0;
+}
+
+/****************************************************************************
+* recordApplyEvent - see tiRecord.h for description
+****************************************************************************/
+int recordApplyEvent(TiRecord *r, TiRecordPosition *p)
+{
+    unsigned char *e;
+    Uint8 *hand;
+    Uint32 size;
+    int held;
+
+    if(p->offset >= r->header.numBytes)
+    {
+        return TI_ERROR;
+    }
+
+    /* The whole event has to be there before any of it is read */
+    e = r->events + p->offset;
+    switch(e[0] & TI_RECORD_EVENT_MASK)
+    {
+        case TI_RECORD_EVENT_DRAW:
+        case TI_RECORD_EVENT_PLAY:
+            size = 2;
+            break;
+        case TI_RECORD_EVENT_END_GAME:
+            size = 1 + 2 * p->numPlayers;
+            break;
+        case TI_RECORD_EVENT_KEYFRAME:
+            size = 1 + sizeof(TiRecordKeyframe);
+            break;
+        default:
+            size = 1;
+            break;
+    }
+    if(r->header.numBytes - p->offset < size)
+    {
+        return TI_ERROR;
+    }
+
+    hand = p->k.hand[p->k.curPlayer];
+    held = (e[0] & TI_RECORD_HELD_RESERVE) ? 1 : 0;
+    switch(e[0] & TI_RECORD_EVENT_MASK)
+    {
+        case TI_RECORD_EVENT_DRAW:
+            hand[held] = e[1];
+            p->offset += 2;
+            break;
+        case TI_RECORD_EVENT_PLAY:
+            if(e[1] >= TI_PLAYOUT_NUM_SQUARES)
+            {
+                return TI_ERROR;
+            }
+            p->k.square[e[1]] = hand[held];
+            if(held == 0)
+            {
+                hand[0] = hand[1];
+            }
+            hand[1] = TI_RECORD_NO_TILE;
+            p->offset += 2;
+            break;
+        case TI_RECORD_EVENT_DISCARD:
+            if(held == 0)
+            {
+                hand[0] = hand[1];
+            }
+            hand[1] = TI_RECORD_NO_TILE;
+            p->offset++;
+            break;
+        case TI_RECORD_EVENT_END_TURN:
+            p->k.curPlayer++;
+            if(p->k.curPlayer >= p->numPlayers)
+            {
+                p->k.curPlayer = 0;
+            }
+            p->turn++;
+            p->offset++;
+            break;
+        case TI_RECORD_EVENT_END_GAME:
+            p->offset += 1 + 2 * p->numPlayers;
+            break;
+        case TI_RECORD_EVENT_KEYFRAME:
+            /* Keyframes aren't events; they only say where the game is */
+            p->offset += 1 + sizeof(TiRecordKeyframe);
+            return TI_OK;
+        default:
+            return TI_ERROR;
+    }
+    p->event++;
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* recordSeek - see tiRecord.h for description
+****************************************************************************/
+int recordSeek(TiRecord *r, Uint32 event, TiRecordPosition *p)
+{
+    TiRecordIndexEntry *keyframe;
+    int low, high, middle;
+
+    /* Find the first keyframe after the event; the one before it is
+       where to start from */
+    low = 0;
+    high = r->header.numKeyframes;
+    while(low < high)
+    {
+        middle = (low + high) / 2;
+        if(r->keyframes[middle].event <= event)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    recordStartPosition(r, p);
+    if(low > 0)
+    {
+        keyframe = &(r->keyframes[low - 1]);
+        memcpy(&(p->k), r->events + keyframe->offset + 1, sizeof(TiRecordKeyframe));
+        p->event = keyframe->event;
+        p->turn = keyframe->turn;
+        p->offset = keyframe->offset + 1 + sizeof(TiRecordKeyframe);
+    }
+
+    while(p->event < event)
+    {
+        if(recordApplyEvent(r, p) != TI_OK)
+        {
+            return TI_ERROR;
+        }
+    }
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* recordSeekTurn - see tiRecord.h for description
+****************************************************************************/
+int recordSeekTurn(TiRecord *r, Uint32 turn, TiRecordPosition *p)
+{
+    TiRecordIndexEntry *keyframe;
+    int low, high, middle;
+
+    /* A keyframe taken part way through the turn is already past the end
+       of the turn before it, so only ones from earlier turns will do */
+    low = 0;
+    high = r->header.numKeyframes;
+    while(low < high)
+    {
+        middle = (low + high) / 2;
+        if(r->keyframes[middle].turn < turn)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    recordStartPosition(r, p);
+    if(low > 0)
+    {
+        keyframe = &(r->keyframes[low - 1]);
+        memcpy(&(p->k), r->events + keyframe->offset + 1, sizeof(TiRecordKeyframe));
+        p->event = keyframe->event;
+        p->turn = keyframe->turn;
+        p->offset = keyframe->offset + 1 + sizeof(TiRecordKeyframe);
+    }
+
+    while(p->turn < turn)
+    {
+        if(recordApplyEvent(r, p) != TI_OK)
+        {
+            return TI_ERROR;
+        }
+    }
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* recordLoadPosition - see tiRecord.h for description
+****************************************************************************/
+void recordLoadPosition(TiRecordPosition *p, Game *g)
+{
+    Board *b;
+    int counter, stationX, stationY, exit;
+
+    b = g->board;
+    recordLoadBoard(p, b);
+
+    /* Tiles on the board or in a hand are out of the pool */
+    for(counter=0;counter<TI_TILEPOOL_NUM_TILES;counter++)
+    {
+        g->tilepool->tileStatus[counter] = TI_TILE_UNPLAYED;
+    }
+    for(counter=0;counter<TI_PLAYOUT_NUM_SQUARES;counter++)
+    {
+        if(p->k.square[counter] != TI_RECORD_NO_TILE)
+        {
+            g->tilepool->tileStatus[p->k.square[counter]] = TI_TILE_PLAYED;
+        }
+    }
+    for(counter=0;counter<g->numPlayers;counter++)
+    {
+        g->players[counter].currentTileId = TI_TILE_NO_TILE;
+        g->players[counter].reserveTileId = TI_TILE_NO_TILE;
+        if(p->k.hand[counter][0] != TI_RECORD_NO_TILE)
+        {
+            g->players[counter].currentTileId = p->k.hand[counter][0];
+            g->tilepool->tileStatus[p->k.hand[counter][0]] = TI_TILE_PLAYED;
+        }
+        if(p->k.hand[counter][1] != TI_RECORD_NO_TILE)
+        {
+            g->players[counter].reserveTileId = p->k.hand[counter][1];
+            g->tilepool->tileStatus[p->k.hand[counter][1]] = TI_TILE_PLAYED;
+        }
+        g->players[counter].score = 0;
+        g->players[counter].numStationsComplete = 0;
+        g->players[counter].lastMoveX = TI_PLAYER_INVALID_LAST_MOVE;
+        g->players[counter].lastMoveY = TI_PLAYER_INVALID_LAST_MOVE;
+    }
+    tilePoolCalculatePlayedTiles(g->tilepool);
+    tilePoolCalculateUnplayedTiles(g->tilepool);
+
+    /* Put every train back in its station, and let the game score the
+       tracks that the board says are finished, the same as it did when
+       they were */
+    for(counter=0;counter<TI_BOARD_NUM_STATIONS;counter++)
+    {
+        b->trackStatus[counter] = TI_BOARD_TRACK_NOT_COMPLETE;
+        boardGetStationInfo(counter, &stationX, &stationY, &exit);
+        b->b[stationX][stationY].trainPresent = b->playerStations[g->numPlayers][counter];
+    }
+    g->curPlayer = p->k.curPlayer;
+    g->playerHasDrawn = TI_FALSE;
+    gameCheckForCompletedTracks(g);
+}
+
+/****************************************************************************
+* recordLoadBoard - see tiRecord.h for description
+****************************************************************************/
+void recordLoadBoard(TiRecordPosition *p, Board *b)
+{
+    BoardSquare *square;
+    int counter;
+
+    /* Squares are numbered across the rows inside the stations */
+    for(counter=0;counter<TI_PLAYOUT_NUM_SQUARES;counter++)
+    {
+        square = &(b->b[counter % 8 + 1][counter / 8 + 1]);
+        if(p->k.square[counter] != TI_RECORD_NO_TILE)
+        {
+            square->type = TI_BOARDSQUARE_TYPE_PLAYED_TILE;
+            square->tileIndex = p->k.square[counter];
+        }
+        else if(square->type == TI_BOARDSQUARE_TYPE_PLAYED_TILE)
+        {
+            square->type = TI_BOARDSQUARE_TYPE_TILE;
+            square->tileIndex = TI_TILE_NO_TILE;
+        }
+    }
+}
+
+/****************************************************************************
+* recordReplayStart - see tiRecord.h for description
+****************************************************************************/
+int recordReplayStart(TiRecord *r, Game *g, PlayoutState *s)
+{
+    int counter;
+
+    if(r->header.numPlayers < TI_MIN_PLAYERS || r->header.numPlayers > TI_MAX_PLAYERS)
+    {
+        return TI_ERROR;
+    }
+
+    if(RecordStartPlayers != r->header.numPlayers)
+    {
+        if(gameResetGameStructure(g) != TI_OK)
+        {
+            return TI_ERROR;
+        }
+        g->numPlayers = r->header.numPlayers;
+        g->curPlayer = 0;
+        for(counter=0;counter<TI_MAX_PLAYERS;counter++)
+        {
+            playerInitPlayer(&(g->players[counter]), r->header.controlledBy[counter], 0,
+                             r->header.aiLevel[counter]);
+        }
+        if(playoutInitialize(g) != TI_OK)
+        {
+            return TI_ERROR;
+        }
+        playoutLoadState(&RecordStartState, g);
+        RecordStartPlayers = r->header.numPlayers;
+    }
+
+    *s = RecordStartState;
+    return TI_OK;
+}
+
+/****************************************************************************
+* recordReplay - see tiRecord.h for description
+****************************************************************************/
+int recordReplay(TiRecord *r, PlayoutState *s)
+{
+    unsigned char *e, *end;
+    signed char *hand;
+    int numEvents, held, type, counter;
+
+    e = r->events;
+    end = r->events + r->header.numBytes;
+    numEvents = 0;
+    while(e < end)
+    {
+        hand = s->hand[s->curPlayer];
+        held = (e[0] & TI_RECORD_HELD_RESERVE) ? 1 : 0;
+        switch(e[0] & TI_RECORD_EVENT_MASK)
+        {
+            case TI_RECORD_EVENT_DRAW:
+                /* The first tile drawn goes in the first slot */
+                if(e + 1 >= end || e[1] >= TI_TILEPOOL_NUM_TILES || hand[held] != TI_PLAYOUT_NO_TILE ||
+                   (held == 1 && hand[0] == TI_PLAYOUT_NO_TILE))
+                {
+                    return numEvents;
+                }
+                type = playoutGetTileType(e[1]);
+                for(counter=0;counter<s->poolSize && s->pool[counter] != type;counter++)
+                {
+                }
+                if(counter == s->poolSize)
+                {
+                    return numEvents;
+                }
+                s->pool[counter] = s->pool[--s->poolSize];
+                hand[held] = type;
+                e += 2;
+                break;
+            case TI_RECORD_EVENT_PLAY:
+                if(e + 1 >= end || e[1] >= TI_PLAYOUT_NUM_SQUARES || hand[held] == TI_PLAYOUT_NO_TILE ||
+                   (playoutLegalSquares(s, hand[held]) & (1ULL << e[1])) == 0)
+                {
+                    return numEvents;
+                }
+                playoutPlaceTile(s, e[1], hand[held]);
+                if(held == 0)
+                {
+                    hand[0] = hand[1];
+                }
+                hand[1] = TI_PLAYOUT_NO_TILE;
+                e += 2;
+                break;
+            case TI_RECORD_EVENT_DISCARD:
+                if(hand[held] == TI_PLAYOUT_NO_TILE)
+                {
+                    return numEvents;
+                }
+                s->pool[s->poolSize++] = hand[held];
+                if(held == 0)
+                {
+                    hand[0] = hand[1];
+                }
+                hand[1] = TI_PLAYOUT_NO_TILE;
+                e++;
+                break;
+            case TI_RECORD_EVENT_END_TURN:
+                s->curPlayer++;
+                if(s->curPlayer >= s->numPlayers)
+                {
+                    s->curPlayer = 0;
+                }
+                e++;
+                break;
+            case TI_RECORD_EVENT_END_GAME:
+                if(e + 2 * s->numPlayers >= end)
+                {
+                    return numEvents;
+                }
+                for(counter=0;counter<s->numPlayers;counter++)
+                {
+                    if(s->score[counter] != (e[1 + 2 * counter] | (e[2 + 2 * counter] << 8)))
+                    {
+                        return numEvents;
+                    }
+                }
+                e += 1 + 2 * s->numPlayers;
+                break;
+            case TI_RECORD_EVENT_KEYFRAME:
+                /* Not an event, but it has to agree with the game */
+                if(e + sizeof(TiRecordKeyframe) >= end ||
+                   e[1 + offsetof(TiRecordKeyframe, curPlayer)] != s->curPlayer)
+                {
+                    return numEvents;
+                }
+                for(counter=0;counter<TI_PLAYOUT_NUM_SQUARES;counter++)
+                {
+                    if((e[1 + counter] != TI_RECORD_NO_TILE) != ((s->occupied >> counter) & 1))
+                    {
+                        return numEvents;
+                    }
+                }
+                e += 1 + sizeof(TiRecordKeyframe);
+                continue;
+            default:
+                return numEvents;
+        }
+        numEvents++;
+    }
+
+    return numEvents;
+}
@@ -0,0 +1,473 @@
+/****************************************************************************
+*
+* tiRecord.h - Header for tiRecord.c
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+
+#ifndef __TIRECORD_H__
+#define __TIRECORD_H__
+
+/*
+ * A game record holds everything needed to play a game back: the seed the
+ * random numbers started from, who was playing, and every tile drawn,
+ * played and discarded, in order.  Each of those is an event of one or
+ * two bytes.  The first byte holds the event number in its low bits, and
+ * which of the player's two tiles it was about in TI_RECORD_HELD_RESERVE;
+ * draws are followed by the tile drawn, and plays by the square played on
+ * ((y-1)*8 + (x-1), as in PlayoutState).  A turn that ends without a tile
+ * being played is a pass.  A finished game ends with TI_RECORD_EVENT_END_GAME
+ * and each player's score, two bytes each, low byte first.
+ *
+ * Every TI_RECORD_KEYFRAME_INTERVAL events, a keyframe is put in between
+ * them: the tile on every square, the tiles in every player's hand and
+ * whose turn it is.  The events are followed by an index of where the
+ * keyframes are, so that getting to any point in the game (recordSeek)
+ * only takes loading the keyframe before it and going through the events
+ * after that.  The scores, and which tracks are finished, follow from the
+ * tiles on the board, so recordLoadPosition can set a game up at any
+ * point of its record.  The game uses this to let the player go back and
+ * forth through a finished game.
+ *
+ * While a game is being played, the events are added to CurrentRecord
+ * (if there is one) and written to its file at the end of every turn, so
+ * the file holds the game so far even if the game never finishes.  A file
+ * can also hold any number of records, one after the other (see
+ * recordWrite).
+ *
+ * Games are played back (recordReplay) on a PlayoutState rather than on
+ * the Board, checking each event against the rules as it goes, so that
+ * records can be checked and analyzed as fast as playouts run.
+ *
+ * Like the log, the headers are in the byte order of the machine that
+ * wrote them.
+ */
+
+#define TI_RECORD_FILE                      "lastGame.tir"
+#define TI_RECORD_MAGIC                     0x43524954      /* 'TIRC' */
+#define TI_RECORD_VERSION                   2
+/* Room for the events of most games, so that recording rarely allocates */
+#define TI_RECORD_INITIAL_SIZE              1024
+#define TI_RECORD_INITIAL_KEYFRAMES         16
+/* Events between keyframes.  Getting to any point in a game never takes
+   going through more events than this. */
+#define TI_RECORD_KEYFRAME_INTERVAL         128
+
+/* Events */
+#define TI_RECORD_EVENT_DRAW                0   /* followed by the tile */
+#define TI_RECORD_EVENT_PLAY                1   /* followed by the square */
+#define TI_RECORD_EVENT_DISCARD             2
+#define TI_RECORD_EVENT_END_TURN            3
+#define TI_RECORD_EVENT_END_GAME            4   /* followed by the scores */
+#define TI_RECORD_EVENT_KEYFRAME            5   /* followed by a TiRecordKeyframe */
+#define TI_RECORD_EVENT_MASK                0x07
+#define TI_RECORD_HELD_RESERVE              0x08
+
+/* The square a play on board square (x,y) is recorded as */
+#define TI_RECORD_SQUARE(x, y)              (((y) - 1) * 8 + ((x) - 1))
+
+/* An empty square or hand slot in a keyframe */
+#define TI_RECORD_NO_TILE                   0xff
+
+/* Returned by recordRead at the end of a file */
+#define TI_RECORD_NO_MORE_RECORDS           -1
+
+/* Keys that go back and forth through a finished game */
+#define TI_RECORD_KEY_BACK                  SDLK_LEFT
+#define TI_RECORD_KEY_FORWARD               SDLK_RIGHT
+#define TI_RECORD_KEY_START                 SDLK_HOME
+#define TI_RECORD_KEY_END                   SDLK_END
+
+typedef struct
+{
+    Uint32 magic;
+    Uint16 version;
+    Uint16 numPlayers;
+    Uint32 seed;
+    Uint8 controlledBy[TI_MAX_PLAYERS];
+    Uint8 aiLevel[TI_MAX_PLAYERS];
+    /* The events that follow (not counting keyframes), and the keyframe
+       index after them */
+    Uint32 numEvents;
+    Uint32 numBytes;
+    Uint32 numKeyframes;
+} TiRecordHeader;
+
+typedef struct
+{
+    Uint8 square[TI_PLAYOUT_NUM_SQUARES];
+    Uint8 hand[TI_MAX_PLAYERS][2];
+    Uint8 curPlayer;
+} TiRecordKeyframe;
+
+typedef struct
+{
+    /* The events before the keyframe, the turns they finished, and where
+       the keyframe is in the events */
+    Uint32 event;
+    Uint32 turn;
+    Uint32 offset;
+} TiRecordIndexEntry;
+
+/* A point in a game */
+typedef struct
+{
+    TiRecordKeyframe k;
+    int numPlayers;
+    Uint32 event;
+    Uint32 turn;
+    /* Where the next event starts */
+    Uint32 offset;
+} TiRecordPosition;
+
+typedef struct
+{
+    TiRecordHeader header;
+    unsigned char *events;
+    int size;
+    TiRecordIndexEntry *keyframes;
+    int maxKeyframes;
+    /* Where the game has got to, as events are added */
+    TiRecordPosition position;
+    /* The file the game is written to as it's played, where its header
+       is, and how many bytes of events have been written so far */
+    FILE *fp;
+    long headerOffset;
+    Uint32 bytesWritten;
+} TiRecord;
+
+extern TiRecord *CurrentRecord;
+
+/****************************************************************************
+* recordInitialize
+*
+* Description:
+*   Allocates an empty record.
+*
+* Arguments:
+*   None.
+*
+* Returns:
+*   A pointer to the record, or NULL if an error was detected.
+*
+****************************************************************************/
+TiRecord *recordInitialize(void);
+
+/****************************************************************************
+* recordDestroy
+*
+* Description:
+*   Closes the record's file, if it has one, and frees the record.
+*
+* Arguments:
+*   TiRecord **r - the record to destroy
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void recordDestroy(TiRecord **r);
+
+/****************************************************************************
+* recordBegin
+*
+* Description:
+*   Empties a record and starts it off with the players of a game that's
+*   about to be played.  If a file name is given, the file is replaced
+*   and the game is written to it as it's played.
+*
+* Arguments:
+*   TiRecord *r    - the record (or NULL, in which case nothing happens)
+*   Game *g        - the game, with its players set up
+*   Uint32 seed    - the seed the game's random numbers start from
+*   char *fileName - the file to write to, or NULL
+*
+* Returns:
+*   TI_OK or TI_ERROR.
+*
+****************************************************************************/
+int recordBegin(TiRecord *r, Game *g, Uint32 seed, char *fileName);
+
+/****************************************************************************
+* recordAddEvent
+*
+* Description:
+*   Adds an event to the end of a record.  The end of a turn is written to
+*   the record's file, if it has one.
+*
+* Arguments:
+*   TiRecord *r - the record (or NULL, in which case nothing happens)
+*   int event   - TI_RECORD_EVENT_DRAW, etc.
+*   int reserve - TI_TRUE if the event is about the player's reserve tile
+*   int value   - the tile drawn or the square played on (see above)
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void recordAddEvent(TiRecord *r, int event, int reserve, int value);
+
+/****************************************************************************
+* recordEndGame
+*
+* Description:
+*   Adds the players' final scores to the end of a record and closes its
+*   file.
+*
+* Arguments:
+*   TiRecord *r - the record (or NULL, in which case nothing happens)
+*   Game *g     - the game
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void recordEndGame(TiRecord *r, Game *g);
+
+/****************************************************************************
+* recordGrow
+*
+* Description:
+*   Makes sure a record has room for more events.
+*
+* Arguments:
+*   TiRecord *r  - the record
+*   int numBytes - the number of bytes of events to make room for
+*
+* Returns:
+*   TI_OK or TI_ERROR.
+*
+****************************************************************************/
+int recordGrow(TiRecord *r, int numBytes);
+
+/****************************************************************************
+* recordFlush
+*
+* Description:
+*   Writes the events that haven't been written yet to the record's file,
+*   followed by the keyframe index, and updates the header at the start
+*   of it.
+*
+* Arguments:
+*   TiRecord *r - the record
+*
+* Returns:
+*   TI_OK or TI_ERROR.
+*
+****************************************************************************/
+int recordFlush(TiRecord *r);
+
+/****************************************************************************
+* recordWrite
+*
+* Description:
+*   Writes a whole record to the current position of a file.
+*
+* Arguments:
+*   FILE *fp    - the file
+*   TiRecord *r - the record
+*
+* Returns:
+*   TI_OK or TI_ERROR.
+*
+****************************************************************************/
+int recordWrite(FILE *fp, TiRecord *r);
+
+/****************************************************************************
+* recordRead
+*
+* Description:
+*   Reads the next record in a file.
+*
+* Arguments:
+*   FILE *fp    - the file
+*   TiRecord *r - the record to read into
+*
+* Returns:
+*   TI_OK, TI_RECORD_NO_MORE_RECORDS at the end of the file, or TI_ERROR
+*   if what's there isn't a record.
+*
+****************************************************************************/
+int recordRead(FILE *fp, TiRecord *r);
+
+/****************************************************************************
+* recordCheckIndex
+*
+* Description:
+*   Checks that every entry in a record's keyframe index points at a
+*   keyframe, since seeking trusts the index.
+*
+* Arguments:
+*   TiRecord *r - the record
+*
+* Returns:
+*   TI_OK, or TI_ERROR if the index is damaged.
+*
+****************************************************************************/
+int recordCheckIndex(TiRecord *r);
+
+/****************************************************************************
+* recordAddKeyframe
+*
+* Description:
+*   Adds a keyframe of where the game has got to to the end of a record,
+*   and to its index.
+*
+* Arguments:
+*   TiRecord *r - the record
+*
+* Returns:
+*   TI_OK or TI_ERROR.
+*
+****************************************************************************/
+int recordAddKeyframe(TiRecord *r);
+
+/****************************************************************************
+* recordStartPosition
+*
+* Description:
+*   Sets a position up at the start of a record's game.
+*
+* Arguments:
+*   TiRecord *r         - the record
+*   TiRecordPosition *p - the position
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void recordStartPosition(TiRecord *r, TiRecordPosition *p);
+
+/****************************************************************************
+* recordApplyEvent
+*
+* Description:
+*   Moves a position on past the event at its offset.  The event isn't
+*   checked against the rules (see recordReplay for that).
+*
+* Arguments:
+*   TiRecord *r         - the record
+*   TiRecordPosition *p - the position
+*
+* Returns:
+*   TI_OK, or TI_ERROR if there are no more events, or the next one isn't
+*   an event or is cut off by the end of the record.
+*
+****************************************************************************/
+int recordApplyEvent(TiRecord *r, TiRecordPosition *p);
+
+/****************************************************************************
+* recordSeek
+*
+* Description:
+*   Finds the position after a number of events (or, with recordSeekTurn,
+*   after a number of turns), starting from the last keyframe before it.
+*
+* Arguments:
+*   TiRecord *r         - the record
+*   Uint32 event/turn   - the number of events or turns
+*   TiRecordPosition *p - the position to fill in
+*
+* Returns:
+*   TI_OK, or TI_ERROR if the record isn't that long.
+*
+****************************************************************************/
+int recordSeek(TiRecord *r, Uint32 event, TiRecordPosition *p);
+int recordSeekTurn(TiRecord *r, Uint32 turn, TiRecordPosition *p);
+
+/****************************************************************************
+* recordLoadPosition
+*
+* Description:
+*   Sets a game up at a position: the tiles on the board and in the
+*   players' hands, whose turn it is, and the scores and finished tracks
+*   that follow from the board.
+*
+* Arguments:
+*   TiRecordPosition *p - the position
+*   Game *g             - the game, with the record's players
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void recordLoadPosition(TiRecordPosition *p, Game *g);
+
+/****************************************************************************
+* recordLoadBoard
+*
+* Description:
+*   Puts the tiles of a position on a board, and nothing else.  Useful for
+*   looking at the tracks of many positions at once, each on its own copy
+*   of the board.
+*
+* Arguments:
+*   TiRecordPosition *p - the position
+*   Board *b            - the board
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void recordLoadBoard(TiRecordPosition *p, Board *b);
+
+/****************************************************************************
+* recordReplayStart
+*
+* Description:
+*   Sets up a playout state at the start of a record's game.  The playout
+*   tables are only rebuilt (which resets the game) when the number of
+*   players is different from the last record's, so anything else that
+*   calls playoutInitialize in between must be kept apart from replays.
+*
+* Arguments:
+*   TiRecord *r     - the record
+*   Game *g         - the game to build the playout tables from
+*   PlayoutState *s - the state to set up
+*
+* Returns:
+*   TI_OK or TI_ERROR.
+*
+****************************************************************************/
+int recordReplayStart(TiRecord *r, Game *g, PlayoutState *s);
+
+/****************************************************************************
+* recordReplay
+*
+* Description:
+*   Plays a record's events on a playout state set up by recordReplayStart,
+*   stopping at the first one that breaks the rules (a draw into a hand
+*   slot that's already full, a tile that isn't in the pool, a play on an
+*   illegal square, or final scores that aren't what the game came to) or
+*   at a keyframe that doesn't match the game.
+*
+* Arguments:
+*   TiRecord *r     - the record
+*   PlayoutState *s - the state
+*
+* Returns:
+*   The number of events played.  If that's fewer than the record has,
+*   the next one broke the rules.
+*
+****************************************************************************/
+int recordReplay(TiRecord *r, PlayoutState *s);
+
+#endif /* __TIRECORD_H__ */
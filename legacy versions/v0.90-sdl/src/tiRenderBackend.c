@@ -0,0 +1,549 @@
+/****************************************************************************
+*
+* tiRenderBackend.c - display backends (SDL and headless)
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <SDL/SDL.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiRenderBackend.h"
+
+TiRenderBackend TI_RENDER_BACKEND_SDL =
+{
+    "sdl", NULL,
+    sdlBackendOpen, sdlBackendClose, sdlBackendBlit, sdlBackendFill,
+    sdlBackendPresent, sdlBackendCreateSurface, sdlBackendConvertSurface,
+    sdlBackendPollEvent, sdlBackendWaitEvent, sdlBackendGetTicks, sdlBackendDelay
+};
+
+TiRenderBackend TI_RENDER_BACKEND_HEADLESS =
+{
+    "headless", NULL,
+    headlessBackendOpen, headlessBackendClose, headlessBackendBlit, headlessBackendFill,
+    headlessBackendPresent, sdlBackendCreateSurface, headlessBackendConvertSurface,
+    headlessBackendPollEvent, headlessBackendWaitEvent, headlessBackendGetTicks,
+    headlessBackendDelay
+};
+
+TiRenderBackend *CurrentBackend = NULL;
+
+/****************************************************************************
+* renderBackendFind - see tiRenderBackend.h for description
+****************************************************************************/
+TiRenderBackend *renderBackendFind(char *name)
+{
+    if(name == NULL || strcmp(name, TI_RENDER_BACKEND_SDL.name) == 0)
+    {
+        return &TI_RENDER_BACKEND_SDL;
+    }
+    if(strcmp(name, TI_RENDER_BACKEND_HEADLESS.name) == 0)
+    {
+        return &TI_RENDER_BACKEND_HEADLESS;
+    }
+    return NULL;
+}
+
+/****************************************************************************
+* renderBackendOpen - see tiRenderBackend.h for description
+****************************************************************************/
+int renderBackendOpen(TiRenderBackend *b, int xRes, int yRes, int bpp)
+{
+    if(b->open(b, xRes, yRes, bpp) == TI_ERROR)
+    {
+        return TI_ERROR;
+    }
+    CurrentBackend = b;
+    return TI_OK;
+}
+
+/****************************************************************************
+* renderBackendClose - see tiRenderBackend.h for description
+****************************************************************************/
+void renderBackendClose(TiRenderBackend *b)
+{
+    b->close(b);
+    b->screen = NULL;
+    if(CurrentBackend == b)
+    {
+        CurrentBackend = NULL;
+    }
+}
+
+/****************************************************************************
+* renderBackendGetCurrent - see tiRenderBackend.h for description
+****************************************************************************/
+TiRenderBackend *renderBackendGetCurrent(void)
+{
+    return CurrentBackend;
+}
+
+/****************************************************************************
+* renderBackendLoadScript - see tiRenderBackend.h for description
+****************************************************************************/
+int renderBackendLoadScript(TiRenderBackend *b, char *fileName)
+{
+    FILE *fp;
+    char curLine[TI_LINE_MAX];
+    char type[TI_LINE_MAX];
+    TiScriptEvent *event;
+    unsigned int frame;
+    int x, y;
+
+    fp = fopen(fileName, "r");
+    if(fp == NULL)
+    {
+        return TI_ERROR;
+    }
+
+    b->numScriptEvents = 0;
+    while(fgets(curLine, TI_LINE_MAX, fp) != NULL &&
+          b->numScriptEvents < TI_RENDER_BACKEND_MAX_SCRIPT_EVENTS)
+    {
+        event = &(b->script[b->numScriptEvents]);
+        if(sscanf(curLine, "%u %s %d %d", &frame, type, &x, &y) == 4 &&
+           strcmp(type, "click") == 0)
+        {
+            event->type = TI_SCRIPT_EVENT_CLICK;
+            event->x = x;
+            event->y = y;
+        }
+        else if(sscanf(curLine, "%u %s", &frame, type) == 2 &&
+                strcmp(type, "quit") == 0)
+        {
+            event->type = TI_SCRIPT_EVENT_QUIT;
+        }
+        else
+        {
+            continue;
+        }
+        event->frame = frame;
+        b->numScriptEvents++;
+    }
+
+    fclose(fp);
+    return TI_OK;
+}
+
+/****************************************************************************
+* renderBackendGetTicks - see tiRenderBackend.h for description
+****************************************************************************/
+Uint32 renderBackendGetTicks(void)
+{
+    return CurrentBackend->getTicks(CurrentBackend);
+}
+
+/****************************************************************************
+* renderBackendDelay - see tiRenderBackend.h for description
+****************************************************************************/
+void renderBackendDelay(Uint32 ms)
+{
+    CurrentBackend->delay(CurrentBackend, ms);
+}
+
+/****************************************************************************
+* renderBackendPollEvent - see tiRenderBackend.h for description
+****************************************************************************/
+int renderBackendPollEvent(SDL_Event *event)
+{
+    return CurrentBackend->pollEvent(CurrentBackend, event);
+}
+
+/****************************************************************************
+* renderBackendWaitEvent - see tiRenderBackend.h for description
+****************************************************************************/
+void renderBackendWaitEvent(void)
+{
+    CurrentBackend->waitEvent(CurrentBackend);
+}
+
+/****************************************************************************
+* sdlBackendOpen - see tiRenderBackend.h for description
+****************************************************************************/
+int sdlBackendOpen(TiRenderBackend *b, int xRes, int yRes, int bpp)
+{
+    if(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) == -1)
+    {
+        return TI_ERROR;
+    }
+
+    b->screen = SDL_SetVideoMode(xRes, yRes, bpp, SDL_SWSURFACE);
+    if(b->screen == NULL)
+    {
+        SDL_Quit();
+        return TI_ERROR;
+    }
+
+    /* Run full-screen and disable the mouse cursor on Nokia tablets */
+#ifdef _NOKIA_N800_
+    SDL_WM_ToggleFullScreen(b->screen);
+    SDL_ShowCursor(SDL_DISABLE);
+#endif
+
+    SDL_WM_SetCaption("TrackInsanity", NULL);
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* sdlBackendClose - see tiRenderBackend.h for description
+****************************************************************************/
+void sdlBackendClose(TiRenderBackend *b)
+{
+    SDL_Quit();
+}
+
+/****************************************************************************
+* sdlBackendBlit - see tiRenderBackend.h for description
+****************************************************************************/
+void sdlBackendBlit(TiRenderBackend *b, SDL_Surface *source, SDL_Rect *sourceRect,
+                    SDL_Surface *dest, SDL_Rect *destRect)
+{
+    SDL_BlitSurface(source, sourceRect, dest, destRect);
+#ifdef TI_PROFILE
+    b->numBlits++;
+    if(destRect != NULL)
+    {
+        b->pixelsBlitted += (unsigned long)destRect->w * destRect->h;
+    }
+#endif
+}
+
+/****************************************************************************
+* sdlBackendFill - see tiRenderBackend.h for description
+****************************************************************************/
+void sdlBackendFill(TiRenderBackend *b, SDL_Surface *dest, SDL_Rect *rect, Uint32 color)
+{
+    SDL_FillRect(dest, rect, color);
+#ifdef TI_PROFILE
+    b->numBlits++;
+    b->pixelsBlitted += (rect != NULL) ? (unsigned long)rect->w * rect->h :
+                                         (unsigned long)dest->w * dest->h;
+#endif
+}
+
+/****************************************************************************
+* sdlBackendPresent - see tiRenderBackend.h for description
+****************************************************************************/
+void sdlBackendPresent(TiRenderBackend *b, int numRects, SDL_Rect *rects)
+{
+#ifdef TI_PROFILE
+    int counter;
+#endif
+
+    if(rects == NULL)
+    {
+        SDL_UpdateRect(b->screen, 0, 0, 0, 0);
+    }
+    else if(numRects > 0)
+    {
+        SDL_UpdateRects(b->screen, numRects, rects);
+    }
+
+#ifdef TI_PROFILE
+    if(rects == NULL)
+    {
+        b->pixelsPresented += (unsigned long)b->screen->w * b->screen->h;
+    }
+    else
+    {
+        for(counter=0;counter<numRects;counter++)
+        {
+            b->pixelsPresented += (unsigned long)rects[counter].w * rects[counter].h;
+        }
+    }
+#endif
+}
+
+/****************************************************************************
+* sdlBackendCreateSurface - see tiRenderBackend.h for description
+****************************************************************************/
+SDL_Surface *sdlBackendCreateSurface(TiRenderBackend *b, int w, int h)
+{
+    SDL_PixelFormat *format;
+
+    format = b->screen->format;
+    return SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, format->BitsPerPixel,
+                                format->Rmask, format->Gmask, 
+                                format->Bmask, format->Amask);
+}
+
+/****************************************************************************
+* sdlBackendConvertSurface - see tiRenderBackend.h for description
+****************************************************************************/
+SDL_Surface *sdlBackendConvertSurface(TiRenderBackend *b, SDL_Surface *image)
+{
+    return SDL_DisplayFormat(image);
+}
+
+/****************************************************************************
+* sdlBackendPollEvent - see tiRenderBackend.h for description
+****************************************************************************/
+int sdlBackendPollEvent(TiRenderBackend *b, SDL_Event *event)
+{
+    return SDL_PollEvent(event);
+}
+
+/****************************************************************************
+* sdlBackendWaitEvent - see tiRenderBackend.h for description
+****************************************************************************/
+void sdlBackendWaitEvent(TiRenderBackend *b)
+{
+    SDL_WaitEvent(NULL);
+}
+
+/****************************************************************************
+* sdlBackendGetTicks - see tiRenderBackend.h for description
+****************************************************************************/
+Uint32 sdlBackendGetTicks(TiRenderBackend *b)
+{
+    return SDL_GetTicks();
+}
+
+/****************************************************************************
+* sdlBackendDelay - see tiRenderBackend.h for description
+****************************************************************************/
+void sdlBackendDelay(TiRenderBackend *b, Uint32 ms)
+{
+    SDL_Delay(ms);
+}
+
+/****************************************************************************
+* headlessBackendOpen - see tiRenderBackend.h for description
+****************************************************************************/
+int headlessBackendOpen(TiRenderBackend *b, int xRes, int yRes, int bpp)
+{
+    /* The timer is still wanted for the computer players' time slices */
+    if(SDL_Init(SDL_INIT_TIMER) == -1)
+    {
+        return TI_ERROR;
+    }
+
+    /* The same formats SDL gives the game on the desktop */
+    if(bpp == 16)
+    {
+        b->screen = SDL_CreateRGBSurface(SDL_SWSURFACE, xRes, yRes, 16,
+                                         0xF800, 0x07E0, 0x001F, 0);
+    }
+    else
+    {
+        b->screen = SDL_CreateRGBSurface(SDL_SWSURFACE, xRes, yRes, 32,
+                                         0x00FF0000, 0x0000FF00, 0x000000FF, 0);
+    }
+    if(b->screen == NULL)
+    {
+        SDL_Quit();
+        return TI_ERROR;
+    }
+
+    b->numFrames = 0;
+    b->nextScriptEvent = 0;
+    b->quitSent = TI_FALSE;
+    b->numBlits = 0;
+    b->pixelsBlitted = 0;
+    b->pixelsPresented = 0;
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* headlessBackendClose - see tiRenderBackend.h for description
+****************************************************************************/
+void headlessBackendClose(TiRenderBackend *b)
+{
+    Uint32 checksum;
+    Uint8 *row;
+    int counter, counter2, rowBytes;
+
+    /* FNV-1a over the visible part of each row */
+    checksum = 2166136261U;
+    rowBytes = b->screen->w * b->screen->format->BytesPerPixel;
+    for(counter=0;counter<b->screen->h;counter++)
+    {
+        row = (Uint8 *)b->screen->pixels + counter * b->screen->pitch;
+        for(counter2=0;counter2<rowBytes;counter2++)
+        {
+            checksum = (checksum ^ row[counter2]) * 16777619U;
+        }
+    }
+
+    if(b->numFrames > 0)
+    {
+        printf("Headless: %lu frames, %lu blits and %lu pixels blitted per frame, "
+               "%lu pixels presented per frame, last frame %08x\n",
+               (unsigned long)b->numFrames, b->numBlits / b->numFrames,
+               b->pixelsBlitted / b->numFrames, b->pixelsPresented / b->numFrames,
+               (unsigned int)checksum);
+    }
+
+    SDL_FreeSurface(b->screen);
+    SDL_Quit();
+}
+
+/****************************************************************************
+* headlessBackendBlit - see tiRenderBackend.h for description
+****************************************************************************/
+void headlessBackendBlit(TiRenderBackend *b, SDL_Surface *source, SDL_Rect *sourceRect,
+                         SDL_Surface *dest, SDL_Rect *destRect)
+{
+    SDL_BlitSurface(source, sourceRect, dest, destRect);
+    /* SDL leaves the part that was actually drawn in destRect */
+    b->numBlits++;
+    if(destRect != NULL)
+    {
+        b->pixelsBlitted += (unsigned long)destRect->w * destRect->h;
+    }
+}
+
+/****************************************************************************
+* headlessBackendFill - see tiRenderBackend.h for description
+****************************************************************************/
+void headlessBackendFill(TiRenderBackend *b, SDL_Surface *dest, SDL_Rect *rect, Uint32 color)
+{
+    SDL_FillRect(dest, rect, color);
+    b->numBlits++;
+    if(rect != NULL)
+    {
+        b->pixelsBlitted += (unsigned long)rect->w * rect->h;
+    }
+    else
+    {
+        b->pixelsBlitted += (unsigned long)dest->w * dest->h;
+    }
+}
+
+/****************************************************************************
+* headlessBackendPresent - see tiRenderBackend.h for description
+****************************************************************************/
+void headlessBackendPresent(TiRenderBackend *b, int numRects, SDL_Rect *rects)
+{
+    int counter;
+
+    if(rects == NULL)
+    {
+        b->pixelsPresented += (unsigned long)b->screen->w * b->screen->h;
+    }
+    else
+    {
+        for(counter=0;counter<numRects;counter++)
+        {
+            b->pixelsPresented += (unsigned long)rects[counter].w * rects[counter].h;
+        }
+    }
+
+    /* The clock only moves when a frame is finished */
+    b->numFrames++;
+}
+
+/****************************************************************************
+* headlessBackendConvertSurface - see tiRenderBackend.h for description
+****************************************************************************/
+SDL_Surface *headlessBackendConvertSurface(TiRenderBackend *b, SDL_Surface *image)
+{
+    return SDL_ConvertSurface(image, b->screen->format, SDL_SWSURFACE);
+}
+
+/****************************************************************************
+* headlessBackendPollEvent - see tiRenderBackend.h for description
+****************************************************************************/
+int headlessBackendPollEvent(TiRenderBackend *b, SDL_Event *event)
+{
+    TiScriptEvent *scripted;
+    Uint32 lastFrame;
+
+    /* Once the script has run out (or if there isn't one), give the game
+       a while to finish what it's doing, then stop */
+    if(b->nextScriptEvent >= b->numScriptEvents)
+    {
+        lastFrame = 0;
+        if(b->numScriptEvents > 0)
+        {
+            lastFrame = b->script[b->numScriptEvents - 1].frame;
+        }
+        if(b->quitSent == TI_FALSE && b->numFrames >= lastFrame + TI_RENDER_HEADLESS_FRAMES)
+        {
+            event->type = SDL_QUIT;
+            b->quitSent = TI_TRUE;
+            return 1;
+        }
+        return 0;
+    }
+
+    scripted = &(b->script[b->nextScriptEvent]);
+    if(scripted->frame > b->numFrames)
+    {
+        return 0;
+    }
+    b->nextScriptEvent++;
+
+    if(scripted->type == TI_SCRIPT_EVENT_QUIT)
+    {
+        event->type = SDL_QUIT;
+        b->quitSent = TI_TRUE;
+    }
+    else
+    {
+        event->type = SDL_MOUSEBUTTONDOWN;
+        event->button.type = SDL_MOUSEBUTTONDOWN;
+        event->button.which = 0;
+        event->button.button = SDL_BUTTON_LEFT;
+        event->button.state = SDL_PRESSED;
+        event->button.x = scripted->x;
+        event->button.y = scripted->y;
+    }
+    return 1;
+}
+
+/****************************************************************************
+* headlessBackendWaitEvent - see tiRenderBackend.h for description
+****************************************************************************/
+void headlessBackendWaitEvent(TiRenderBackend *b)
+{
+    /* Scripted events turn up on their own frame, so keep drawing frames
+       until they do */
+}
+
+/****************************************************************************
+* headlessBackendGetTicks - see tiRenderBackend.h for description
+****************************************************************************/
+Uint32 headlessBackendGetTicks(TiRenderBackend *b)
+{
+    return b->numFrames * TI_RENDER_FRAME_DURATION;
+}
+
+/****************************************************************************
+* headlessBackendDelay - see tiRenderBackend.h for description
+****************************************************************************/
+void headlessBackendDelay(TiRenderBackend *b, Uint32 ms)
+{
+    /* Nothing to wait for; time only passes a frame at a time */
+}
@@ -0,0 +1,231 @@
+/****************************************************************************
+*
+* tiRenderBackend.h - Header for tiRenderBackend.c
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#ifndef __TIRENDERBACKEND_H__
+#define __TIRENDERBACKEND_H__
+
+/*
+ * Everything the render code needs from the display goes through a render
+ * backend: opening the screen, blitting and filling, sending finished 
+ * frames to the display, making surfaces in the screen's format, and the
+ * clock and input that drive the state machine.  
+ *
+ * The SDL backend is the game as it has always run.  The headless backend
+ * draws into a framebuffer in memory and never touches the video 
+ * subsystem, so the whole game (title screens, dialogs and all) can run 
+ * where there is no display.  Its clock moves on one frame each time a 
+ * frame is presented, and its input comes from a script, so a run does 
+ * the same thing every time.  It counts the blits and pixels that go into
+ * each frame, and prints them, along with a checksum of the last frame, 
+ * when it's closed.
+ *
+ * The backend is picked with the TI_RENDER_BACKEND environment variable
+ * ("sdl", the default, or "headless").  A headless script, named by 
+ * TI_HEADLESS_SCRIPT, has one event per line:
+ *
+ *   <frame> click <x> <y>
+ *   <frame> quit
+ *
+ * A headless run quits TI_RENDER_HEADLESS_FRAMES after the script's last
+ * event (or after its first frames, without a script) if the script 
+ * hasn't quit already.
+ */
+
+#define TI_RENDER_BACKEND_MAX_SCRIPT_EVENTS 256
+#define TI_RENDER_HEADLESS_FRAMES           600
+/* Headless runs always start from the same random seed */
+#define TI_RENDER_HEADLESS_SEED             1
+
+#define TI_SCRIPT_EVENT_CLICK               0
+#define TI_SCRIPT_EVENT_QUIT                1
+
+typedef struct
+{
+    Uint32 frame;
+    int type;
+    int x;
+    int y;
+} TiScriptEvent;
+
+typedef struct TiRenderBackend
+{
+    char *name;
+    /* The surface everything is drawn to, once the backend is open */
+    SDL_Surface *screen;
+
+    int (*open)(struct TiRenderBackend *b, int xRes, int yRes, int bpp);
+    void (*close)(struct TiRenderBackend *b);
+    void (*blit)(struct TiRenderBackend *b, SDL_Surface *source, SDL_Rect *sourceRect,
+                 SDL_Surface *dest, SDL_Rect *destRect);
+    void (*fill)(struct TiRenderBackend *b, SDL_Surface *dest, SDL_Rect *rect, Uint32 color);
+    /* Sends the given parts of the screen to the display (all of it if 
+       rects is NULL).  Called once per frame, even if nothing changed. */
+    void (*present)(struct TiRenderBackend *b, int numRects, SDL_Rect *rects);
+    /* Surfaces in the screen's format */
+    SDL_Surface *(*createSurface)(struct TiRenderBackend *b, int w, int h);
+    SDL_Surface *(*convertSurface)(struct TiRenderBackend *b, SDL_Surface *image);
+    int (*pollEvent)(struct TiRenderBackend *b, SDL_Event *event);
+    /* Sleeps until there is an event, and leaves it to be polled */
+    void (*waitEvent)(struct TiRenderBackend *b);
+    Uint32 (*getTicks)(struct TiRenderBackend *b);
+    void (*delay)(struct TiRenderBackend *b, Uint32 ms);
+
+    /* Headless state: the frame clock, the script, and what went into the
+       frames drawn so far */
+    Uint32 numFrames;
+    TiScriptEvent script[TI_RENDER_BACKEND_MAX_SCRIPT_EVENTS];
+    int numScriptEvents;
+    int nextScriptEvent;
+    int quitSent;
+    /* (The SDL backend only keeps these in profiling builds) */
+    unsigned long numBlits;
+    unsigned long pixelsBlitted;
+    unsigned long pixelsPresented;
+} TiRenderBackend;
+
+extern TiRenderBackend TI_RENDER_BACKEND_SDL;
+extern TiRenderBackend TI_RENDER_BACKEND_HEADLESS;
+
+/****************************************************************************
+* renderBackendFind
+*
+* Description:
+*   Looks up a backend by name.
+*
+* Arguments:
+*   char *name - "sdl" or "headless".  NULL picks the SDL backend.
+*
+* Returns:
+*   The backend, or NULL if there isn't one by that name.
+*
+****************************************************************************/
+TiRenderBackend *renderBackendFind(char *name);
+
+/****************************************************************************
+* renderBackendOpen
+*
+* Description:
+*   Opens a backend's screen and makes it the current backend.
+*
+* Arguments:
+*   TiRenderBackend *b - the backend
+*   int xRes, yRes     - the size of the screen
+*   int bpp            - the screen's bits per pixel
+*
+* Returns:
+*   TI_OK, or TI_ERROR if the screen couldn't be opened.
+*
+****************************************************************************/
+int renderBackendOpen(TiRenderBackend *b, int xRes, int yRes, int bpp);
+
+/****************************************************************************
+* renderBackendClose
+*
+* Description:
+*   Closes a backend's screen.  If it's the current backend, there no 
+*   longer is one.
+*
+* Arguments:
+*   TiRenderBackend *b - the backend
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void renderBackendClose(TiRenderBackend *b);
+
+/****************************************************************************
+* renderBackendGetCurrent
+*
+* Description:
+*   Returns the backend that was opened last.
+*
+* Arguments:
+*   None.
+*
+* Returns:
+*   The current backend, or NULL if none is open.
+*
+****************************************************************************/
+TiRenderBackend *renderBackendGetCurrent(void);
+
+/****************************************************************************
+* renderBackendLoadScript
+*
+* Description:
+*   Reads the input events for a headless run (see above for the format).
+*   Lines that can't be read are skipped, and events must be in frame 
+*   order.
+*
+* Arguments:
+*   TiRenderBackend *b - the backend
+*   char *fileName     - the script
+*
+* Returns:
+*   TI_OK, or TI_ERROR if the script couldn't be opened.
+*
+****************************************************************************/
+int renderBackendLoadScript(TiRenderBackend *b, char *fileName);
+
+/****************************************************************************
+* renderBackendGetTicks, renderBackendDelay, renderBackendPollEvent,
+* renderBackendWaitEvent
+*
+* Description:
+*   The current backend's clock, sleep and input, in place of SDL_GetTicks,
+*   SDL_Delay, SDL_PollEvent and SDL_WaitEvent(NULL).
+*
+****************************************************************************/
+Uint32 renderBackendGetTicks(void);
+void renderBackendDelay(Uint32 ms);
+int renderBackendPollEvent(SDL_Event *event);
+void renderBackendWaitEvent(void);
+
+/* The backends' operations (see TiRenderBackend) */
+int sdlBackendOpen(TiRenderBackend *b, int xRes, int yRes, int bpp);
+void sdlBackendClose(TiRenderBackend *b);
+void sdlBackendBlit(TiRenderBackend *b, SDL_Surface *source, SDL_Rect *sourceRect,
+                    SDL_Surface *dest, SDL_Rect *destRect);
+void sdlBackendFill(TiRenderBackend *b, SDL_Surface *dest, SDL_Rect *rect, Uint32 color);
+void sdlBackendPresent(TiRenderBackend *b, int numRects, SDL_Rect *rects);
+SDL_Surface *sdlBackendCreateSurface(TiRenderBackend *b, int w, int h);
+SDL_Surface *sdlBackendConvertSurface(TiRenderBackend *b, SDL_Surface *image);
+int sdlBackendPollEvent(TiRenderBackend *b, SDL_Event *event);
+void sdlBackendWaitEvent(TiRenderBackend *b);
+Uint32 sdlBackendGetTicks(TiRenderBackend *b);
+void sdlBackendDelay(TiRenderBackend *b, Uint32 ms);
+
+int headlessBackendOpen(TiRenderBackend *b, int xRes, int yRes, int bpp);
+void headlessBackendClose(TiRenderBackend *b);
+void headlessBackendBlit(TiRenderBackend *b, SDL_Surface *source, SDL_Rect *sourceRect,
+                         SDL_Surface *dest, SDL_Rect *destRect);
+void headlessBackendFill(TiRenderBackend *b, SDL_Surface *dest, SDL_Rect *rect, Uint32 color);
+void headlessBackendPresent(TiRenderBackend *b, int numRects, SDL_Rect *rects);
+SDL_Surface *headlessBackendConvertSurface(TiRenderBackend *b, SDL_Surface *image);
+int headlessBackendPollEvent(TiRenderBackend *b, SDL_Event *event);
+void headlessBackendWaitEvent(TiRenderBackend *b);
+Uint32 headlessBackendGetTicks(TiRenderBackend *b);
+void headlessBackendDelay(TiRenderBackend *b, Uint32 ms);
+
+#endif /* __TIRENDERBACKEND_H__ */
@@ -0,0 +1,218 @@
+/****************************************************************************
+*
+* tiRenderCheck.c - Checks of the screen update code
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <SDL/SDL.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+
+/*
+ * Usage: tiRenderCheck
+ *
+ * Draws on the headless backend (see tiRenderBackend.h) the way the game
+ * does when one dialog replaces another while the first is still sliding
+ * in: the backing is put back over the first dialog, and the second one
+ * slides in over the same place.  Once both slides are done, the screen
+ * has to show the second dialog everywhere it was drawn.  It's checked
+ * with the second dialog in the same place as the first (the computer
+ * thinking dialog giving way to the action dialog) and partly over it
+ * (the action dialog giving way to the tile draw dialog).
+ *
+ * Exits with an error if any check fails.
+ */
+
+#define TI_RENDER_CHECK_MAX_FRAMES      200
+
+typedef struct
+{
+    char *name;
+    SDL_Rect first;
+    SDL_Rect second;
+} TiRenderCheck;
+
+TiRenderCheck TI_RENDER_CHECKS[] =
+{
+    { "same place",     { 320, 400, 480, 80 },  { 320, 400, 480, 80 } },
+    { "overlapping",    { 320, 400, 480, 80 },  { 360, 40, 400, 400 } }
+};
+
+Game *GameInstance;
+
+/****************************************************************************
+* renderCheckFlush
+*
+* Moves the slides along a frame and updates the screen, like the main loop.
+****************************************************************************/
+void renderCheckFlush(TiScreen *display)
+{
+    renderAdvanceTransitions(display);
+    renderFlushDirty(display);
+}
+
+/****************************************************************************
+* renderCheckDialogs
+*
+* Slides the first dialog in, replaces it with the second part way, and
+* lets the second finish.  Returns TI_OK if the screen ends up showing the
+* second dialog.
+****************************************************************************/
+int renderCheckDialogs(TiScreen *display, TiRenderCheck *check, SDL_Surface *backing,
+                       SDL_Surface *first, SDL_Surface *second)
+{
+    SDL_Rect *r;
+    int bytesPerPixel, counter;
+
+    renderApplySurface(0, 0, backing, display->screen);
+    renderMarkDirty(display, 0, 0, display->xRes, display->yRes);
+    renderFlushDirty(display);
+
+    /* The first dialog starts sliding in... */
+    r = &(check->first);
+    renderTransitionSurface(display, NULL, first, r->x, r->y, r->w, r->h, TI_TRUE);
+    renderCheckFlush(display);
+    if(renderTransitionsActive(display) == TI_FALSE)
+    {
+        fprintf(stderr, "%s: the first dialog finished sliding too soon\n", check->name);
+        return TI_ERROR;
+    }
+
+    /* ...and is replaced before it gets there, the way the game puts the
+       backing back and draws the next dialog */
+    renderBlitSurface(r->x, r->y, r->x, r->y, r->w, r->h, backing, display->screen);
+    renderMarkDirty(display, r->x, r->y, r->w, r->h);
+    r = &(check->second);
+    renderTransitionSurface(display, NULL, second, r->x, r->y, r->w, r->h, TI_FALSE);
+
+    for(counter=0;counter<TI_RENDER_CHECK_MAX_FRAMES;counter++)
+    {
+        renderCheckFlush(display);
+        if(renderTransitionsActive(display) == TI_FALSE)
+        {
+            break;
+        }
+    }
+    renderFlushDirty(display);
+
+    bytesPerPixel = display->screen->format->BytesPerPixel;
+    for(counter=0;counter<r->h;counter++)
+    {
+        if(memcmp((Uint8 *)display->screen->pixels + (r->y + counter) * display->screen->pitch +
+                  r->x * bytesPerPixel,
+                  (Uint8 *)second->pixels + counter * second->pitch,
+                  r->w * bytesPerPixel) != 0)
+        {
+            fprintf(stderr, "%s: row %d doesn't show the second dialog\n", check->name,
+                    r->y + counter);
+            return TI_ERROR;
+        }
+    }
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* renderCheckRun
+*
+* Makes the backing and the two dialogs (each a different color) and runs
+* one check with them.
+****************************************************************************/
+int renderCheckRun(TiScreen *display, TiRenderCheck *check)
+{
+    SDL_Surface *backing, *first, *second;
+    int result;
+
+    backing = display->backend->createSurface(display->backend, display->xRes, display->yRes);
+    first = display->backend->createSurface(display->backend, display->xRes, display->yRes);
+    second = display->backend->createSurface(display->backend, display->xRes, display->yRes);
+    if(backing == NULL || first == NULL || second == NULL)
+    {
+        perror("Unable to make surfaces");
+        result = TI_ERROR;
+    }
+    else
+    {
+        display->backend->fill(display->backend, backing, NULL,
+                               SDL_MapRGB(backing->format, 0, 0x40, 0));
+        display->backend->fill(display->backend, first, NULL,
+                               SDL_MapRGB(first->format, 0xFF, 0, 0));
+        display->backend->fill(display->backend, second, NULL,
+                               SDL_MapRGB(second->format, 0, 0, 0xFF));
+        result = renderCheckDialogs(display, check, backing, first, second);
+    }
+
+    if(backing != NULL)
+    {
+        SDL_FreeSurface(backing);
+    }
+    if(first != NULL)
+    {
+        SDL_FreeSurface(first);
+    }
+    if(second != NULL)
+    {
+        SDL_FreeSurface(second);
+    }
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    TiScreen *display;
+    int numBad, counter;
+
+    srand(TI_RENDER_HEADLESS_SEED);
+    display = renderInitialize(TI_GAME_XRES, TI_GAME_YRES, TI_GAME_DEPTH,
+                               &TI_RENDER_BACKEND_HEADLESS);
+    if(display == NULL)
+    {
+        perror("Unable to initialize render structure");
+        return 1;
+    }
+
+    numBad = 0;
+    for(counter=0;counter<sizeof(TI_RENDER_CHECKS) / sizeof(TiRenderCheck);counter++)
+    {
+        if(renderCheckRun(display, &(TI_RENDER_CHECKS[counter])) != TI_OK)
+        {
+            numBad++;
+        }
+    }
+    fprintf(stderr, "render checks:            %d (%d failed)\n",
+            (int)(sizeof(TI_RENDER_CHECKS) / sizeof(TiRenderCheck)), numBad);
+
+    renderDestroy(&display);
+
+    return (numBad > 0) ? 1 : 0;
+}
@@ -27,7 +27,6 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <errno.h>
-#include <math.h>
 #include <SDL/SDL.h>
 #include <SDL/SDL_image.h>
 #include "tiMain.h"
@@ -38,6 +37,48 @@
 #include "tiPlayer.h"
 #include "tiGame.h"
 #include "tiComputerAI.h"
+#include "tiLog.h"
+#include "tiMetrics.h"
+#include "tiProfile.h"
+#include "tiPlayout.h"
+#include "tiRecord.h"
+
+/* The images used in the game itself, which are loaded in the background */
+TiAssetFile TI_RENDER_IN_GAME_IMAGES[TI_RENDER_NUM_IN_GAME_IMAGES] =
+{
+    {offsetof(TiAssets, gameplayBG), "data/board/boardBG.png"},
+    {offsetof(TiAssets, playerColors), "data/board/playerColorTabs.png"},
+    {offsetof(TiAssets, playerLightBG), "data/board/activePlayerBG1.png"},
+    {offsetof(TiAssets, playerStationsChart), "data/board/activePlayerStations.png"},
+    {offsetof(TiAssets, tileStripSmall), "data/board/tileStrip40.png"},
+    {offsetof(TiAssets, tileStripLarge), "data/board/tileStrip64.png"},
+    {offsetof(TiAssets, stationStatus), "data/board/activePlayerStationStatus.png"},
+    {offsetof(TiAssets, playerStrings), "data/board/playerNumberText.png"},
+    {offsetof(TiAssets, playerTypeStrings), "data/board/playerHumanComputer.png"},
+    {offsetof(TiAssets, playerScoreString), "data/board/playerScoreText.png"},
+    {offsetof(TiAssets, currentPlayer), "data/board/currentPlayer.png"},
+    {offsetof(TiAssets, currentTile), "data/board/currentTile.png"},
+    {offsetof(TiAssets, selectTileDialog), "data/board/selectTile.png"},
+    {offsetof(TiAssets, selectActionDialog), "data/board/selectAction.png"},
+    {offsetof(TiAssets, selectPlayActive), "data/board/selectActionPlayTile.png"},
+    {offsetof(TiAssets, selectDrawActive), "data/board/selectActionDrawTile.png"},
+    {offsetof(TiAssets, selectDiscardActive), "data/board/selectActionDiscard.png"},
+    {offsetof(TiAssets, selectPassActive), "data/board/selectActionPass.png"},
+    {offsetof(TiAssets, chooseDiscardDialog), "data/board/chooseDiscard.png"},
+    {offsetof(TiAssets, confirmExitDialog), "data/board/confirmExit.png"},
+    {offsetof(TiAssets, cancelPlayTileButton), "data/board/cancelButton.png"},
+    {offsetof(TiAssets, computerThinkingDialog), "data/board/cpuThinking.png"},
+    {offsetof(TiAssets, gameFinishedDialog), "data/board/gameFinished.png"},
+    {offsetof(TiAssets, drawTileHighlightLarge), "data/board/drawTileHighlight80.png"},
+    {offsetof(TiAssets, darkenMask), "data/board/darkenMask.png"},
+    {offsetof(TiAssets, validMoveMask), "data/board/validMask.png"},
+    {offsetof(TiAssets, scoreBacking), "data/board/scoreBacking.png"},
+    {offsetof(TiAssets, digits), "data/board/digits.png"},
+    {offsetof(TiAssets, trains), "data/board/trains.png"},
+    {offsetof(TiAssets, stations), "data/board/stations.png"},
+    {offsetof(TiAssets, trackOverlays), "data/board/trackOverlays.png"},
+    {offsetof(TiAssets, lastMoveHighlights), "data/board/lastMoveHighlights.png"}
+};
 
 /****************************************************************************
 * renderSharedDataInitialize - see tiRenderSDL.h for description
@@ -54,16 +95,28 @@ TiSharedData *renderSharedDataInitialize(void)
     }
 
     s->renderState = TI_STATE_NO_STATE;
-    s->titleStartTicks = SDL_GetTicks();
+    s->titleStartTicks = renderBackendGetTicks();
     s->curTicks = 0;
     s->numFrames = 0;
     s->lastFrameTicks = 0;
     s->cyclesLeftOver = 0;
 
+    s->surfacePool = surfacePoolInitialize();
+    if(s->surfacePool == NULL)
+    {
+        free(s);
+        return NULL;
+    }
+
     s->dialogBacking = NULL;
-    s->boardAreaBacking = NULL;
+    s->boardLayer = NULL;
     s->currentPlayerBacking = NULL;
     s->currentTileBacking = NULL;
+    for(counter=0;counter<TI_MAX_PLAYERS;counter++)
+    {
+        s->gameScores[counter].surface = NULL;
+        s->resultsScores[counter].surface = NULL;
+    }
 
     renderResetSharedDataStructure(s);
 
@@ -97,23 +150,18 @@ int renderResetSharedDataStructure(TiSharedData *data)
 
     if(data->dialogBacking != NULL)
     {
-        SDL_FreeSurface(data->dialogBacking);
+        surfacePoolRelease(data->surfacePool, data->dialogBacking);
         data->dialogBacking = NULL;
     }
-    if(data->boardAreaBacking != NULL)
-    {
-        SDL_FreeSurface(data->boardAreaBacking);
-        data->boardAreaBacking = NULL;
-    }
     if(data->currentPlayerBacking != NULL)
     {
-        SDL_FreeSurface(data->currentPlayerBacking);
+        surfacePoolRelease(data->surfacePool, data->currentPlayerBacking);
         data->currentPlayerBacking = NULL;
     }
 
     if(data->currentTileBacking != NULL)
     {
-        SDL_FreeSurface(data->currentTileBacking);
+        surfacePoolRelease(data->surfacePool, data->currentTileBacking);
         data->currentTileBacking = NULL;
     }
 
@@ -136,8 +184,20 @@ int renderResetSharedDataStructure(TiSharedData *data)
     data->drawValidMoveMasks = TI_FALSE;
     data->restoreBoardArea = TI_FALSE;
     data->drawTileOnBoard = TI_FALSE;
+    data->lastMovePlayer = TI_RENDER_NO_LAST_MOVE_PLAYER;
+    for(counter=0;counter<TI_BOARD_NUM_STATIONS;counter++)
+    {
+        data->trackPaths[counter].valid = TI_FALSE;
+    }
+    for(counter=0;counter<TI_MAX_PLAYERS;counter++)
+    {
+        data->gameScores[counter].value = TI_RENDER_NO_SCORE;
+        data->resultsScores[counter].value = TI_RENDER_NO_SCORE;
+    }
+    data->replayTurn = TI_RENDER_REPLAY_AT_END;
 
-    data->numFilesLoaded = 0;
+    data->loadingAssets = TI_FALSE;
+    data->ponderFinished = TI_FALSE;
 
     data->currentMove = NULL;
     data->previousMove = NULL;
@@ -149,39 +209,81 @@ int renderResetSharedDataStructure(TiSharedData *data)
 ****************************************************************************/
 int renderSharedDataDestroy(TiSharedData **data)
 {
-    if((*data)->dialogBacking != NULL)
-    {
-        SDL_FreeSurface((*data)->dialogBacking);
-        (*data)->dialogBacking = NULL;
-    }
-    if((*data)->boardAreaBacking != NULL)
-    {
-        SDL_FreeSurface((*data)->boardAreaBacking);
-        (*data)->boardAreaBacking = NULL;
-    }
-    if((*data)->currentPlayerBacking != NULL)
+    int counter;
+
+    if((*data)->boardLayer != NULL)
     {
-        SDL_FreeSurface((*data)->currentPlayerBacking);
-        (*data)->currentPlayerBacking = NULL;
+        SDL_FreeSurface((*data)->boardLayer);
+        (*data)->boardLayer = NULL;
     }
 
-    if((*data)->currentTileBacking != NULL)
+    for(counter=0;counter<TI_MAX_PLAYERS;counter++)
     {
-        SDL_FreeSurface((*data)->currentTileBacking);
-        (*data)->currentTileBacking = NULL;
+        if((*data)->gameScores[counter].surface != NULL)
+        {
+            SDL_FreeSurface((*data)->gameScores[counter].surface);
+        }
+        if((*data)->resultsScores[counter].surface != NULL)
+        {
+            SDL_FreeSurface((*data)->resultsScores[counter].surface);
+        }
     }
 
+    /* The backings belong to the pool, which frees them */
+    (*data)->dialogBacking = NULL;
+    (*data)->currentPlayerBacking = NULL;
+    (*data)->currentTileBacking = NULL;
+    surfacePoolDestroy(&(*data)->surfacePool);
+
     free(*data);
     *data = NULL;
     return TI_OK;
 }
 
+/****************************************************************************
+* renderReserveSurfaces - see tiRenderSDL.h for description
+****************************************************************************/
+void renderReserveSurfaces(TiScreen *display, TiSharedData *data)
+{
+    SDL_PixelFormat *format;
+    int counter;
+
+    format = display->screen->format;
+
+    /* Only one dialog is up at a time */
+    surfacePoolReserve(data->surfacePool, TI_RENDER_GAME_SELECT_ACTION_OFFSET[2],
+                       TI_RENDER_GAME_SELECT_ACTION_OFFSET[3], format);
+    surfacePoolReserve(data->surfacePool, TI_RENDER_GAME_DRAW_TILE_OFFSET[2],
+                       TI_RENDER_GAME_DRAW_TILE_OFFSET[3], format);
+    surfacePoolReserve(data->surfacePool, TI_RENDER_GAME_CHOOSE_DISCARD_OFFSET[2],
+                       TI_RENDER_GAME_CHOOSE_DISCARD_OFFSET[3], format);
+    surfacePoolReserve(data->surfacePool, TI_RENDER_GAME_CPU_THINKING_OFFSET[2],
+                       TI_RENDER_GAME_CPU_THINKING_OFFSET[3], format);
+    surfacePoolReserve(data->surfacePool, TI_RENDER_GAME_FINISHED_OFFSETS[2],
+                       TI_RENDER_GAME_FINISHED_OFFSETS[3], format);
+    surfacePoolReserve(data->surfacePool, TI_RENDER_GAME_CONFIRM_EXIT_OFFSET[2],
+                       TI_RENDER_GAME_CONFIRM_EXIT_OFFSET[3], format);
+
+    /* The player and tile highlights are each held for one player at a 
+       time, and can be up along with a dialog */
+    for(counter=0;counter<TI_MAX_PLAYERS;counter++)
+    {
+        surfacePoolReserve(data->surfacePool, TI_RENDER_GAME_CUR_PLAYER_OFFSETS[counter][2],
+                           TI_RENDER_GAME_CUR_PLAYER_OFFSETS[counter][3], format);
+        surfacePoolReserve(data->surfacePool, TI_RENDER_GAME_PLAYER_TILE1_HIGHLIGHT_OFFSETS[counter][2],
+                           TI_RENDER_GAME_PLAYER_TILE1_HIGHLIGHT_OFFSETS[counter][3], format);
+        surfacePoolReserve(data->surfacePool, TI_RENDER_GAME_PLAYER_TILE2_HIGHLIGHT_OFFSETS[counter][2],
+                           TI_RENDER_GAME_PLAYER_TILE2_HIGHLIGHT_OFFSETS[counter][3], format);
+    }
+}
+
 /****************************************************************************
 * renderInitialize - see tiRenderSDL.h for description
 ****************************************************************************/
-TiScreen *renderInitialize(int xRes, int yRes, int bpp)
+TiScreen *renderInitialize(int xRes, int yRes, int bpp, TiRenderBackend *backend)
 {
     TiScreen *s;
+    int counter;
 
     s = malloc(sizeof(TiScreen));
     if(s == NULL)
@@ -192,26 +294,30 @@ TiScreen *renderInitialize(int xRes, int yRes, int bpp)
     s->xRes = xRes;
     s->yRes = yRes;
 
-    if(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) == -1)
+    if(renderBackendOpen(backend, s->xRes, s->yRes, bpp) == TI_ERROR)
     {
         free(s);
         return NULL;
     }
+    s->backend = backend;
+    s->screen = backend->screen;
 
-    s->screen = SDL_SetVideoMode(s->xRes, s->yRes,bpp ,SDL_SWSURFACE);
-    if(s->screen == NULL)
+    for(counter=0;counter<TI_RENDER_MAX_TRANSITIONS;counter++)
     {
-        free(s);
-        return NULL;
+        s->transitions[counter].active = TI_FALSE;
+        s->transitions[counter].from = NULL;
+        s->transitions[counter].to = NULL;
     }
 
-    /* Run full-screen and disable the mouse cursor on Nokia tablets */
-#ifdef _NOKIA_N800_
-    SDL_WM_ToggleFullScreen(s->screen);
-    SDL_ShowCursor(SDL_DISABLE);
-#endif
-
-    SDL_WM_SetCaption("TrackInsanity", NULL);
+    s->numDirtyRects = 0;
+    s->dirtyFullScreen = TI_FALSE;
+    s->pixelsMarked = 0;
+    s->lastPixelsMarked = 0;
+    s->lastPixelsPushed = 0;
+    s->lastRectsPushed = 0;
+    s->totalPixelsMarked = 0;
+    s->totalPixelsPushed = 0;
+    s->numFlushes = 0;
 
     return s;
 }
@@ -221,9 +327,28 @@ TiScreen *renderInitialize(int xRes, int yRes, int bpp)
 ****************************************************************************/
 void renderDestroy(TiScreen **display)
 {
+    int counter;
+
+    if((*display)->numFlushes > 0)
+    {
+        TI_LOG(TI_LOG_INFO, TI_LOG_EVENT_SCREEN_UPDATES, (*display)->numFlushes,
+               (*display)->totalPixelsPushed / (*display)->numFlushes,
+               (*display)->totalPixelsMarked / (*display)->numFlushes, 0);
+    }
+    for(counter=0;counter<TI_RENDER_MAX_TRANSITIONS;counter++)
+    {
+        if((*display)->transitions[counter].from != NULL)
+        {
+            SDL_FreeSurface((*display)->transitions[counter].from);
+        }
+        if((*display)->transitions[counter].to != NULL)
+        {
+            SDL_FreeSurface((*display)->transitions[counter].to);
+        }
+    }
+    renderBackendClose((*display)->backend);
     free(*display);
     *display = NULL;
-    SDL_Quit();
     return;
 }
 
@@ -234,7 +359,6 @@ SDL_Surface *renderLoadImage(char *fileName)
 {
     SDL_Surface *loadedImage = NULL;
     SDL_Surface *optimizedImage = NULL;
-    Uint32 colorkey;
 
     loadedImage = IMG_Load(fileName);
     if(loadedImage == NULL)
@@ -243,11 +367,28 @@ SDL_Surface *renderLoadImage(char *fileName)
     }
     else
     {
-        optimizedImage = SDL_DisplayFormat(loadedImage);
+        optimizedImage = renderConvertImage(loadedImage);
+    }
+
+    return optimizedImage;
+}
+
+/****************************************************************************
+* renderConvertImage - see tiRenderSDL.h for description
+****************************************************************************/
+SDL_Surface *renderConvertImage(SDL_Surface *loadedImage)
+{
+    SDL_Surface *optimizedImage = NULL;
+    Uint32 colorkey;
+
+    optimizedImage = renderBackendGetCurrent()->convertSurface(renderBackendGetCurrent(),
+                                                               loadedImage);
+    if(optimizedImage != NULL)
+    {
         colorkey = SDL_MapRGB(optimizedImage->format, 0xFF, 0, 0xFF);
         SDL_SetColorKey(optimizedImage, SDL_RLEACCEL | SDL_SRCCOLORKEY, colorkey);
-        SDL_FreeSurface(loadedImage);
     }
+    SDL_FreeSurface(loadedImage);
 
     return optimizedImage;
 }
@@ -317,25 +458,65 @@ TiAssets *renderAssetsInitialize(void)
     a->resultsSmallPlayers = NULL;
     a->resultsLargePlayers = NULL;
 
+    a->cache = assetCacheInitialize(TI_ASSET_CACHE_BUDGET);
+    if(a->cache == NULL)
+    {
+        free(a);
+        return NULL;
+    }
+    if(assetCacheLoadAtlasIndex(a->cache, TI_ATLAS_INDEX_FILE) == TI_ERROR)
+    {
+        TI_LOG(TI_LOG_WARNING, TI_LOG_EVENT_ASSET_FALLBACK, TI_LOG_FALLBACK_NO_ATLAS, 0, 0, 0);
+    }
+    if(assetCacheOpenPack(a->cache, TI_ASSET_PACK_FILE) == TI_ERROR)
+    {
+        TI_LOG(TI_LOG_WARNING, TI_LOG_EVENT_ASSET_FALLBACK, TI_LOG_FALLBACK_NO_PACK, 0, 0, 0);
+    }
+    if(assetCacheStartLoader(a->cache) == TI_ERROR)
+    {
+        TI_LOG(TI_LOG_WARNING, TI_LOG_EVENT_ASSET_FALLBACK, TI_LOG_FALLBACK_NO_LOADER, 0, 0, 0);
+    }
+
     return a;
 }
 
+/****************************************************************************
+* renderAssetsDestroy - see tiRenderSDL.h for description
+****************************************************************************/
+void renderAssetsDestroy(TiAssets **assets)
+{
+    assetCacheDestroy(&((*assets)->cache));
+    free(*assets);
+    *assets = NULL;
+}
+
 void renderDisplayLoadingDialog(TiScreen *display, TiAssets *assets, TiSharedData *data)
 {
     renderBlitSurface(0, 0, TI_RENDER_LOADING_DIALOG_X, TI_RENDER_LOADING_DIALOG_Y,
                       TI_RENDER_LOADING_DIALOG_WIDTH, TI_RENDER_LOADING_DIALOG_HEIGHT,
                       assets->loadingDialog, display->screen);
-    SDL_UpdateRect(display->screen, TI_RENDER_LOADING_DIALOG_X, TI_RENDER_LOADING_DIALOG_Y,
-                   TI_RENDER_LOADING_DIALOG_WIDTH, TI_RENDER_LOADING_DIALOG_HEIGHT);
+    renderMarkDirty(display, TI_RENDER_LOADING_DIALOG_X, TI_RENDER_LOADING_DIALOG_Y,
+                    TI_RENDER_LOADING_DIALOG_WIDTH, TI_RENDER_LOADING_DIALOG_HEIGHT);
 }
 
 void renderUpdateProgressBar(TiScreen *display, TiAssets *assets, TiSharedData *data)
 {
+    unsigned long bytesDone, bytesTotal;
+    float fractionDone;
+
+    /* Nothing left to decode means the bar is full */
+    assetCacheLoaderProgress(assets->cache, &bytesDone, &bytesTotal);
+    fractionDone = (bytesTotal > 0) ? (float)bytesDone / (float)bytesTotal : 1.0;
+    if(fractionDone > 1.0)
+    {
+        fractionDone = 1.0;
+    }
+
     renderBlitSurface(0, 0, TI_RENDER_PROGRESS_BAR_X, TI_RENDER_PROGRESS_BAR_Y,
-                      TI_RENDER_PROGRESS_BAR_WIDTH * (float)((float)data->numFilesLoaded / (float)TI_RENDER_LOADING_DIALOG_NUM_FILES),
+                      TI_RENDER_PROGRESS_BAR_WIDTH * fractionDone,
                       TI_RENDER_PROGRESS_BAR_HEIGHT, assets->progressBar, display->screen);
-    SDL_UpdateRect(display->screen, TI_RENDER_PROGRESS_BAR_X, TI_RENDER_PROGRESS_BAR_Y,
-                   TI_RENDER_PROGRESS_BAR_WIDTH, TI_RENDER_PROGRESS_BAR_HEIGHT);
+    renderMarkDirty(display, TI_RENDER_PROGRESS_BAR_X, TI_RENDER_PROGRESS_BAR_Y,
+                    TI_RENDER_PROGRESS_BAR_WIDTH, TI_RENDER_PROGRESS_BAR_HEIGHT);
 }
 
 /****************************************************************************
@@ -345,13 +526,15 @@ int renderLoadAssets(TiScreen *display, TiAssets *assets, TiSharedData *data)
 {
 
     int status = TI_OK;
+    int counter;
+    SDL_Surface **s;
 
     /* Yay for lazy evaluation! */
 
     if(data->renderState == TI_STATE_COMPANY_LOGO)
     {
         if((assets->logoScreenBG == NULL) &&
-        ((assets->logoScreenBG = renderLoadImage("data/title/holygoat.png")) == NULL))
+        ((assets->logoScreenBG = assetCacheAcquire(assets->cache, "data/title/holygoat.png")) == NULL))
         {
             status = TI_ERROR;
         }
@@ -366,12 +549,12 @@ int renderLoadAssets(TiScreen *display, TiAssets *assets, TiSharedData *data)
        data->renderState == TI_STATE_GAME_RESULTS_SCREEN)
     {
         if((assets->trainBannerTop == NULL) &&
-        ((assets->trainBannerTop = renderLoadImage("data/title/trainbannertop.png")) == NULL))
+        ((assets->trainBannerTop = assetCacheAcquire(assets->cache, "data/title/trainbannertop.png")) == NULL))
         {
             status = TI_ERROR;
         }
         if((assets->trainBannerBottom == NULL) &&
-        ((assets->trainBannerBottom = renderLoadImage("data/title/trainbannerbottom.png")) == NULL))
+        ((assets->trainBannerBottom = assetCacheAcquire(assets->cache, "data/title/trainbannerbottom.png")) == NULL))
         {
             status = TI_ERROR;
         }
@@ -383,368 +566,123 @@ int renderLoadAssets(TiScreen *display, TiAssets *assets, TiSharedData *data)
     data->renderState == TI_STATE_NEW_GAME_SCREEN)
     {
         if((assets->titleScreenBG == NULL) &&
-        ((assets->titleScreenBG = renderLoadImage("data/title/titleScreen.png")) == NULL))
+        ((assets->titleScreenBG = assetCacheAcquire(assets->cache, "data/title/titleScreen.png")) == NULL))
         {
             status = TI_ERROR;
         }
         if((assets->tapScreenMsg == NULL) &&
-        ((assets->tapScreenMsg = renderLoadImage("data/title/tapscreen.png")) == NULL))
+        ((assets->tapScreenMsg = assetCacheAcquire(assets->cache, "data/title/tapscreen.png")) == NULL))
         {
             status = TI_ERROR;
         }
         if((assets->titleMenu == NULL) &&
-        ((assets->titleMenu = renderLoadImage("data/title/titlemenu.png")) == NULL))
+        ((assets->titleMenu = assetCacheAcquire(assets->cache, "data/title/titlemenu.png")) == NULL))
         {
             status = TI_ERROR;
         }
         if((assets->newGameBG == NULL) &&
-        ((assets->newGameBG = renderLoadImage("data/newGame/newGameMenu.png")) == NULL))
+        ((assets->newGameBG = assetCacheAcquire(assets->cache, "data/newGame/newGameMenu.png")) == NULL))
         {
             status = TI_ERROR;
         }
         if((assets->numPlayersDigits == NULL) &&
-        ((assets->numPlayersDigits = renderLoadImage("data/newGame/numPlayersHighlighted.png")) == NULL))
+        ((assets->numPlayersDigits = assetCacheAcquire(assets->cache, "data/newGame/numPlayersHighlighted.png")) == NULL))
         {
             status = TI_ERROR;
         }
         if((assets->humanCpu == NULL) &&
-        ((assets->humanCpu = renderLoadImage("data/newGame/humanCPUHighlighted.png")) == NULL))
+        ((assets->humanCpu = assetCacheAcquire(assets->cache, "data/newGame/humanCPUHighlighted.png")) == NULL))
         {
             status = TI_ERROR;
         }
         if((assets->optionScreenBG == NULL) &&
-        ((assets->optionScreenBG = renderLoadImage("data/options/optionScreen.png")) == NULL))
+        ((assets->optionScreenBG = assetCacheAcquire(assets->cache, "data/options/optionScreen.png")) == NULL))
         {
             status = TI_ERROR;
         }        
         if((assets->optionDigits == NULL) &&
-        ((assets->optionDigits = renderLoadImage("data/options/digitsHighlighted.png")) == NULL))
+        ((assets->optionDigits = assetCacheAcquire(assets->cache, "data/options/digitsHighlighted.png")) == NULL))
         {
             status = TI_ERROR;
         }        
         if((assets->optionYesNo == NULL) &&
-        ((assets->optionYesNo = renderLoadImage("data/options/yesNoHighlighted.png")) == NULL))
+        ((assets->optionYesNo = assetCacheAcquire(assets->cache, "data/options/yesNoHighlighted.png")) == NULL))
         {
             status = TI_ERROR;
         }
         if((assets->optionShowLastMove == NULL) &&
-        ((assets->optionShowLastMove = renderLoadImage("data/options/showLastMoveHighlighted.png")) == NULL))
+        ((assets->optionShowLastMove = assetCacheAcquire(assets->cache, "data/options/showLastMoveHighlighted.png")) == NULL))
         {
             status = TI_ERROR;
         }        
         if((assets->optionAILevel == NULL) &&
-        ((assets->optionAILevel = renderLoadImage("data/options/aiLevelHighlighted.png")) == NULL))
+        ((assets->optionAILevel = assetCacheAcquire(assets->cache, "data/options/aiLevelHighlighted.png")) == NULL))
         {
             status = TI_ERROR;
         }
     }
 
-    if(data->renderState == TI_STATE_NEW_GAME_SCREEN)
+    if(data->renderState == TI_STATE_NEW_GAME_SCREEN ||
+       data->renderState == TI_STATE_IN_GAME)
     {
         if((assets->loadingDialog == NULL) &&
-        ((assets->loadingDialog = renderLoadImage("data/title/loadingDialog.png")) == NULL))
+        ((assets->loadingDialog = assetCacheAcquire(assets->cache, "data/title/loadingDialog.png")) == NULL))
         {
             status = TI_ERROR;
         }
 
         if((assets->progressBar == NULL) &&
-        ((assets->progressBar = renderLoadImage("data/title/progressBar.png")) == NULL))
+        ((assets->progressBar = assetCacheAcquire(assets->cache, "data/title/progressBar.png")) == NULL))
         {
             status = TI_ERROR;
         }
     }
 
-    if(data->renderState == TI_STATE_IN_GAME)
+    /* The in-game images are decoded in the background while the loading
+       dialog is up, so they're only acquired once that's done */
+    if(data->renderState == TI_STATE_IN_GAME && data->loadingAssets == TI_FALSE)
     {
-        renderDisplayLoadingDialog(display, assets, data);
-
-        if((assets->gameplayBG == NULL) &&
-        ((assets->gameplayBG = renderLoadImage("data/board/boardBG.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->playerColors == NULL) &&
-        ((assets->playerColors = renderLoadImage("data/board/playerColorTabs.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->playerLightBG == NULL) &&
-        ((assets->playerLightBG = renderLoadImage("data/board/activePlayerBG1.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->playerStationsChart == NULL) &&
-        ((assets->playerStationsChart = renderLoadImage("data/board/activePlayerStations.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->tileStripSmall == NULL) &&
-        ((assets->tileStripSmall = renderLoadImage("data/board/tileStrip40.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->tileStripLarge == NULL) &&
-        ((assets->tileStripLarge = renderLoadImage("data/board/tileStrip64.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->stationStatus == NULL) &&
-        ((assets->stationStatus = renderLoadImage("data/board/activePlayerStationStatus.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->playerStrings == NULL) &&
-        ((assets->playerStrings = renderLoadImage("data/board/playerNumberText.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->playerTypeStrings == NULL) &&
-        ((assets->playerTypeStrings = renderLoadImage("data/board/playerHumanComputer.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->playerScoreString == NULL) &&
-        ((assets->playerScoreString = renderLoadImage("data/board/playerScoreText.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->currentPlayer == NULL) &&
-        ((assets->currentPlayer = renderLoadImage("data/board/currentPlayer.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->currentTile == NULL) &&
-        ((assets->currentTile = renderLoadImage("data/board/currentTile.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->selectTileDialog == NULL) &&
-        ((assets->selectTileDialog = renderLoadImage("data/board/selectTile.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->selectActionDialog == NULL) &&
-        ((assets->selectActionDialog = renderLoadImage("data/board/selectAction.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->selectPlayActive == NULL) &&
-        ((assets->selectPlayActive = renderLoadImage("data/board/selectActionPlayTile.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->selectDrawActive == NULL) &&
-        ((assets->selectDrawActive = renderLoadImage("data/board/selectActionDrawTile.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->selectDiscardActive == NULL) &&
-        ((assets->selectDiscardActive = renderLoadImage("data/board/selectActionDiscard.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->selectPassActive == NULL) &&
-        ((assets->selectPassActive = renderLoadImage("data/board/selectActionPass.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->chooseDiscardDialog == NULL) &&
-        ((assets->chooseDiscardDialog = renderLoadImage("data/board/chooseDiscard.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->confirmExitDialog == NULL) &&
-        ((assets->confirmExitDialog = renderLoadImage("data/board/confirmExit.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->cancelPlayTileButton == NULL) &&
-        ((assets->cancelPlayTileButton = renderLoadImage("data/board/cancelButton.png")) == NULL))
+        for(counter=0;counter<TI_RENDER_NUM_IN_GAME_IMAGES;counter++)
         {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->computerThinkingDialog == NULL) &&
-        ((assets->computerThinkingDialog = renderLoadImage("data/board/cpuThinking.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->gameFinishedDialog == NULL) &&
-        ((assets->gameFinishedDialog = renderLoadImage("data/board/gameFinished.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->drawTileHighlightLarge == NULL) &&
-        ((assets->drawTileHighlightLarge = renderLoadImage("data/board/drawTileHighlight80.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->darkenMask == NULL) &&
-        ((assets->darkenMask = renderLoadImage("data/board/darkenMask.png")) == NULL))
-        {
-            status = TI_ERROR;
+            s = (SDL_Surface **)((char *)assets + TI_RENDER_IN_GAME_IMAGES[counter].offset);
+            if((*s == NULL) &&
+            ((*s = assetCacheAcquire(assets->cache, TI_RENDER_IN_GAME_IMAGES[counter].fileName)) == NULL))
+            {
+                status = TI_ERROR;
+            }
         }
         SDL_SetAlpha(assets->darkenMask, SDL_SRCALPHA, 128);
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->validMoveMask == NULL) &&
-        ((assets->validMoveMask = renderLoadImage("data/board/validMask.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
         SDL_SetAlpha(assets->validMoveMask, SDL_SRCALPHA, 80);
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->scoreBacking == NULL) &&
-        ((assets->scoreBacking = renderLoadImage("data/board/scoreBacking.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->digits == NULL) &&
-        ((assets->digits = renderLoadImage("data/board/digits.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->trains == NULL) &&
-        ((assets->trains = renderLoadImage("data/board/trains.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->stations == NULL) &&
-        ((assets->stations = renderLoadImage("data/board/stations.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->trackOverlays == NULL) &&
-        ((assets->trackOverlays = renderLoadImage("data/board/trackOverlays.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
-
-        if((assets->lastMoveHighlights == NULL) &&
-        ((assets->lastMoveHighlights = renderLoadImage("data/board/lastMoveHighlights.png")) == NULL))
-        {
-            status = TI_ERROR;
-        }
-        data->numFilesLoaded++;
-        renderUpdateProgressBar(display, assets, data);
     }
 
     if(data->renderState == TI_STATE_GAME_RESULTS_SCREEN)
     {
         if((assets->resultsBackground == NULL) &&
-        ((assets->resultsBackground = renderLoadImage("data/results/resultsScreen.png")) == NULL))
+        ((assets->resultsBackground = assetCacheAcquire(assets->cache, "data/results/resultsScreen.png")) == NULL))
         {
             status = TI_ERROR;
         }
 
         if((assets->resultsSmallDigits == NULL) &&
-        ((assets->resultsSmallDigits = renderLoadImage("data/results/digitsSmall.png")) == NULL))
+        ((assets->resultsSmallDigits = assetCacheAcquire(assets->cache, "data/results/digitsSmall.png")) == NULL))
         {
             status = TI_ERROR;
         }
 
         if((assets->resultsLargeDigits == NULL) &&
-        ((assets->resultsLargeDigits = renderLoadImage("data/results/digitsLarge.png")) == NULL))
+        ((assets->resultsLargeDigits = assetCacheAcquire(assets->cache, "data/results/digitsLarge.png")) == NULL))
         {
             status = TI_ERROR;
         }
 
         if((assets->resultsSmallPlayers == NULL) &&
-        ((assets->resultsSmallPlayers = renderLoadImage("data/results/playersSmall.png")) == NULL))
+        ((assets->resultsSmallPlayers = assetCacheAcquire(assets->cache, "data/results/playersSmall.png")) == NULL))
         {
             status = TI_ERROR;
         }
 
         if((assets->resultsLargePlayers == NULL) &&
-        ((assets->resultsLargePlayers = renderLoadImage("data/results/playersLarge.png")) == NULL))
+        ((assets->resultsLargePlayers = assetCacheAcquire(assets->cache, "data/results/playersLarge.png")) == NULL))
         {
             status = TI_ERROR;
         }
@@ -753,14 +691,52 @@ int renderLoadAssets(TiScreen *display, TiAssets *assets, TiSharedData *data)
     return status;
 }
 
+/****************************************************************************
+* renderPrefetchInGameAssets - see tiRenderSDL.h for description
+****************************************************************************/
+void renderPrefetchInGameAssets(TiAssets *assets)
+{
+    int counter;
+
+    for(counter=0;counter<TI_RENDER_NUM_IN_GAME_IMAGES;counter++)
+    {
+        assetCachePrefetch(assets->cache, TI_RENDER_IN_GAME_IMAGES[counter].fileName);
+    }
+}
+
+/****************************************************************************
+* renderUpdateLoading - see tiRenderSDL.h for description
+****************************************************************************/
+void renderUpdateLoading(TiScreen *display, TiAssets *assets, TiSharedData *data)
+{
+    int status;
+
+    renderUpdateProgressBar(display, assets, data);
+
+    /* Anything that failed to decode in the background is tried again (and
+       reported) by renderLoadAssets */
+    if(assetCacheLoaderBusy(assets->cache) == TI_FALSE)
+    {
+        data->loadingAssets = TI_FALSE;
+        TI_PROFILE_BEGIN(TI_PROFILE_ASSETS);
+        status = renderLoadAssets(display, assets, data);
+        TI_PROFILE_END(TI_PROFILE_ASSETS);
+        if(status == TI_ERROR)
+        {
+            perror("renderUpdateLoading: Unable to load all images! Exiting game!\n");
+            exit(0);
+        }
+    }
+}
+
 /****************************************************************************
 * renderFreeHelper- see tiRenderSDL.h for description
 ****************************************************************************/
-void renderFreeHelper(SDL_Surface **s)
+void renderFreeHelper(TiAssets *assets, SDL_Surface **s)
 {
     if(*s != NULL)
     {
-        SDL_FreeSurface(*s);
+        assetCacheRelease(assets->cache, *s);
         *s = NULL;
     }
 }
@@ -770,9 +746,11 @@ void renderFreeHelper(SDL_Surface **s)
 ****************************************************************************/
 int renderFreeAssets(TiAssets *assets, TiSharedData *data)
 {
+    int counter;
+
     if(data->renderState != TI_STATE_COMPANY_LOGO)
     {
-        renderFreeHelper(&(assets->logoScreenBG));
+        renderFreeHelper(assets, &(assets->logoScreenBG));
     }
 
     /* The train banners are also used at the 'final results' screen, so they
@@ -784,8 +762,8 @@ int renderFreeAssets(TiAssets *assets, TiSharedData *data)
        data->renderState != TI_STATE_NEW_GAME_SCREEN &&
        data->renderState != TI_STATE_GAME_RESULTS_SCREEN)
     {
-        renderFreeHelper(&(assets->trainBannerTop));
-        renderFreeHelper(&(assets->trainBannerBottom));
+        renderFreeHelper(assets, &(assets->trainBannerTop));
+        renderFreeHelper(assets, &(assets->trainBannerBottom));
     }
 
     if(data->renderState != TI_STATE_TITLE_SCREEN &&
@@ -793,71 +771,41 @@ int renderFreeAssets(TiAssets *assets, TiSharedData *data)
     data->renderState != TI_STATE_OPTIONS_SCREEN &&
     data->renderState != TI_STATE_NEW_GAME_SCREEN)
     {
-        renderFreeHelper(&(assets->titleScreenBG));
-        renderFreeHelper(&(assets->tapScreenMsg));
-        renderFreeHelper(&(assets->titleMenu));
-        renderFreeHelper(&(assets->newGameBG));
-        renderFreeHelper(&(assets->numPlayersDigits));
-        renderFreeHelper(&(assets->humanCpu));
-        renderFreeHelper(&(assets->optionScreenBG));
-        renderFreeHelper(&(assets->optionDigits));
-        renderFreeHelper(&(assets->optionYesNo));
-        renderFreeHelper(&(assets->optionShowLastMove));
-        renderFreeHelper(&(assets->optionAILevel));
+        renderFreeHelper(assets, &(assets->titleScreenBG));
+        renderFreeHelper(assets, &(assets->tapScreenMsg));
+        renderFreeHelper(assets, &(assets->titleMenu));
+        renderFreeHelper(assets, &(assets->newGameBG));
+        renderFreeHelper(assets, &(assets->numPlayersDigits));
+        renderFreeHelper(assets, &(assets->humanCpu));
+        renderFreeHelper(assets, &(assets->optionScreenBG));
+        renderFreeHelper(assets, &(assets->optionDigits));
+        renderFreeHelper(assets, &(assets->optionYesNo));
+        renderFreeHelper(assets, &(assets->optionShowLastMove));
+        renderFreeHelper(assets, &(assets->optionAILevel));
     }
 
     if(data->renderState != TI_STATE_NEW_GAME_SCREEN &&
        data->renderState != TI_STATE_IN_GAME)
     {
-        renderFreeHelper(&(assets->loadingDialog));
-        renderFreeHelper(&(assets->progressBar));
+        renderFreeHelper(assets, &(assets->loadingDialog));
+        renderFreeHelper(assets, &(assets->progressBar));
     }
 
     if(data->renderState != TI_STATE_IN_GAME)
     {
-        renderFreeHelper(&(assets->gameplayBG));
-        renderFreeHelper(&(assets->playerColors));
-        renderFreeHelper(&(assets->playerLightBG));
-        renderFreeHelper(&(assets->playerStationsChart));
-        renderFreeHelper(&(assets->tileStripSmall));
-        renderFreeHelper(&(assets->tileStripLarge));
-        renderFreeHelper(&(assets->stationStatus));
-        renderFreeHelper(&(assets->playerStrings));
-        renderFreeHelper(&(assets->playerTypeStrings));
-        renderFreeHelper(&(assets->playerScoreString));
-        renderFreeHelper(&(assets->currentPlayer));
-        renderFreeHelper(&(assets->currentTile));
-
-        renderFreeHelper(&(assets->selectTileDialog));
-        renderFreeHelper(&(assets->selectActionDialog));
-        renderFreeHelper(&(assets->selectPlayActive));
-        renderFreeHelper(&(assets->selectDrawActive));
-        renderFreeHelper(&(assets->selectDiscardActive));
-        renderFreeHelper(&(assets->selectPassActive));
-        renderFreeHelper(&(assets->chooseDiscardDialog));
-        renderFreeHelper(&(assets->confirmExitDialog));
-        renderFreeHelper(&(assets->cancelPlayTileButton));
-        renderFreeHelper(&(assets->computerThinkingDialog));
-        renderFreeHelper(&(assets->gameFinishedDialog));
-
-        renderFreeHelper(&(assets->drawTileHighlightLarge));
-        renderFreeHelper(&(assets->darkenMask));
-        renderFreeHelper(&(assets->validMoveMask));
-        renderFreeHelper(&(assets->scoreBacking));
-        renderFreeHelper(&(assets->digits));
-        renderFreeHelper(&(assets->trains));
-        renderFreeHelper(&(assets->stations));
-        renderFreeHelper(&(assets->trackOverlays));
-        renderFreeHelper(&(assets->lastMoveHighlights));
+        for(counter=0;counter<TI_RENDER_NUM_IN_GAME_IMAGES;counter++)
+        {
+            renderFreeHelper(assets, (SDL_Surface **)((char *)assets + TI_RENDER_IN_GAME_IMAGES[counter].offset));
+        }
     }
 
     if(data->renderState != TI_STATE_GAME_RESULTS_SCREEN)
     {
-        renderFreeHelper(&(assets->resultsBackground));
-        renderFreeHelper(&(assets->resultsSmallDigits));
-        renderFreeHelper(&(assets->resultsLargeDigits));
-        renderFreeHelper(&(assets->resultsSmallPlayers));
-        renderFreeHelper(&(assets->resultsLargePlayers));
+        renderFreeHelper(assets, &(assets->resultsBackground));
+        renderFreeHelper(assets, &(assets->resultsSmallDigits));
+        renderFreeHelper(assets, &(assets->resultsLargeDigits));
+        renderFreeHelper(assets, &(assets->resultsSmallPlayers));
+        renderFreeHelper(assets, &(assets->resultsLargePlayers));
     }
 
     return TI_OK;
@@ -869,18 +817,20 @@ int renderFreeAssets(TiAssets *assets, TiSharedData *data)
 void renderSetRenderState(int curState, int prevState, TiScreen *display, TiAssets *assets, TiSharedData *data)
 {
     Game *g;
+    int status;
+    Uint32 seed;
 
-    renderFreeAssets(assets, data);
-
+    renderFinishTransitions(display);
+    data->loadingAssets = TI_FALSE;
     switch(curState)
     {
         case TI_STATE_COMPANY_LOGO:
-            printf("Changing render state to TI_STATE_COMPANY_LOGO\n");
+            TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_RENDER_STATE, curState, prevState, 0, 0);
             data->renderState = curState;
             data->refreshBG = TI_TRUE;
             break;
         case TI_STATE_TITLE_SCREEN:
-            printf("Changing render state to TI_STATE_TITLE_SCREEN\n");
+            TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_RENDER_STATE, curState, prevState, 0, 0);
             data->renderState = curState;
             data->refreshBG = TI_TRUE;
             data->topTrainX = TI_RENDER_TRAIN_INITIAL_X;
@@ -889,24 +839,26 @@ void renderSetRenderState(int curState, int prevState, TiScreen *display, TiAsse
             data->bottomTrainDirection = TI_RENDER_TRAIN_DIR_LEFT;               
             break;
         case TI_STATE_TITLE_MENU_SCREEN:
-            printf("Changing render state to TI_STATE_TITLE_MENU_SCREEN\n");
+            TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_RENDER_STATE, curState, prevState, 0, 0);
             data->renderState = curState;
             data->refreshBG = TI_TRUE;
             break;
         case TI_STATE_NEW_GAME_SCREEN:
-            printf("Changing render state to TI_STATE_NEW_GAME_SCREEN\n");
+            TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_RENDER_STATE, curState, prevState, 0, 0);
             data->renderState = curState;
             data->refreshBG = TI_TRUE;
             data->refreshPlayersList = TI_TRUE;
+            /* Most likely, a game is about to start */
+            renderPrefetchInGameAssets(assets);
             break;
         case TI_STATE_OPTIONS_SCREEN:
-            printf("Changing render state to TI_STATE_OPTIONS_SCREEN\n");
+            TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_RENDER_STATE, curState, prevState, 0, 0);
             data->renderState = curState;
             data->refreshBG = TI_TRUE;
             data->refreshOptionsScreen = TI_TRUE;
             break;
         case TI_STATE_IN_GAME:
-            printf("Changing render state to TI_STATE_IN_GAME\n");
+            TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_RENDER_STATE, curState, prevState, 0, 0);
             data->renderState = curState;
             data->refreshBG = TI_TRUE;
             data->refreshPlayerTiles = TI_TRUE;
@@ -916,10 +868,22 @@ void renderSetRenderState(int curState, int prevState, TiScreen *display, TiAsse
             data->refreshTrackOverlays = TI_TRUE;
             g = gameGetGlobalGameInstance();
             gameInitializePlayersFromUi(g, data);
+            /* Each game starts its random numbers from a seed of its own, 
+               which goes in the game's record */
+            seed = (Uint32)rand();
+            srand(seed);
+            if(recordBegin(CurrentRecord, g, seed, TI_RECORD_FILE) != TI_OK)
+            {
+                perror("Unable to write the game record");
+            }
             gameSetGameState(g, TI_GAME_STATE_SELECT_ACTION);
+            /* Whatever wasn't prefetched at the new game screen is decoded
+               now, while the loading dialog is up */
+            renderPrefetchInGameAssets(assets);
+            data->loadingAssets = TI_TRUE;
             break;
         case TI_STATE_GAME_RESULTS_SCREEN:
-            printf("Changing render state to TI_STATE_GAME_RESULTS_SCREEN\n");
+            TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_RENDER_STATE, curState, prevState, 0, 0);
             data->renderState = curState;
             data->refreshBG = TI_TRUE;
             data->topTrainX = TI_RENDER_TRAIN_INITIAL_X;
@@ -928,7 +892,7 @@ void renderSetRenderState(int curState, int prevState, TiScreen *display, TiAsse
             data->bottomTrainDirection = TI_RENDER_TRAIN_DIR_LEFT;
             break;
         case TI_STATE_END_GAME:
-            printf("Changing render state to TI_STATE_END_GAME\n");
+            TI_LOG(TI_LOG_DEBUG, TI_LOG_EVENT_RENDER_STATE, curState, prevState, 0, 0);
             data->renderState = curState;
             data->exitGame = TI_TRUE;
             break;
@@ -937,12 +901,24 @@ void renderSetRenderState(int curState, int prevState, TiScreen *display, TiAsse
             break;
     }
 
-    if(renderLoadAssets(display, assets, data) == TI_ERROR)
+    TI_PROFILE_BEGIN(TI_PROFILE_ASSETS);
+    status = renderLoadAssets(display, assets, data);
+    TI_PROFILE_END(TI_PROFILE_ASSETS);
+    if(status == TI_ERROR)
     {
         perror("renderSetRenderState: Unable to load all images! Exiting game!\n");
         exit(0);
     }
-    data->stateStartTicks = SDL_GetTicks();
+
+    /* Let go of anything the new state doesn't use.  Images shared with the
+       previous state were never released, and the rest stay in the asset
+       cache for the next time they're needed. */
+    renderFreeAssets(assets, data);
+    if(data->loadingAssets == TI_TRUE)
+    {
+        renderDisplayLoadingDialog(display, assets, data);
+    }
+    data->stateStartTicks = renderBackendGetTicks();
 }
 
 /****************************************************************************
@@ -951,7 +927,7 @@ void renderSetRenderState(int curState, int prevState, TiScreen *display, TiAsse
 void renderCheckTimingConditions(TiScreen *display, TiAssets *assets, TiSharedData *data)
 {
     Uint32 curTime;
-    curTime = SDL_GetTicks();
+    curTime = renderBackendGetTicks();
 
     switch(data->renderState)
     {
@@ -969,15 +945,196 @@ void renderCheckTimingConditions(TiScreen *display, TiAssets *assets, TiSharedDa
     }
 }
 
+/****************************************************************************
+* renderMarkDirty - see tiRenderSDL.h for description
+****************************************************************************/
+void renderMarkDirty(TiScreen *display, int x, int y, int w, int h)
+{
+    SDL_Rect *other;
+    int left, top, right, bottom;
+    int counter;
+
+    if(x == 0 && y == 0 && w == 0 && h == 0)
+    {
+        w = display->xRes;
+        h = display->yRes;
+    }
+
+    /* Keep to the screen, as SDL_UpdateRects requires */
+    if(x < 0)
+    {
+        w += x;
+        x = 0;
+    }
+    if(y < 0)
+    {
+        h += y;
+        y = 0;
+    }
+    if(x + w > display->xRes)
+    {
+        w = display->xRes - x;
+    }
+    if(y + h > display->yRes)
+    {
+        h = display->yRes - y;
+    }
+    if(w <= 0 || h <= 0)
+    {
+        return;
+    }
+
+    display->pixelsMarked += (unsigned long)w * h;
+    if(display->dirtyFullScreen == TI_TRUE)
+    {
+        return;
+    }
+    if(w == display->xRes && h == display->yRes)
+    {
+        display->dirtyFullScreen = TI_TRUE;
+        display->numDirtyRects = 0;
+        return;
+    }
+
+    /* Merge with any rectangle where the combined area is no bigger than 
+       the two apart.  The merged rectangle might now do the same with one
+       that was already looked at, so start over after each merge. */
+    counter = 0;
+    while(counter < display->numDirtyRects)
+    {
+        other = &(display->dirtyRects[counter]);
+        left = (x < other->x) ? x : other->x;
+        top = (y < other->y) ? y : other->y;
+        right = (x + w > other->x + other->w) ? x + w : other->x + other->w;
+        bottom = (y + h > other->y + other->h) ? y + h : other->y + other->h;
+        if((right - left) * (bottom - top) <= w * h + other->w * other->h)
+        {
+            x = left;
+            y = top;
+            w = right - left;
+            h = bottom - top;
+            *other = display->dirtyRects[--display->numDirtyRects];
+            counter = 0;
+        }
+        else
+        {
+            counter++;
+        }
+    }
+
+    if(display->numDirtyRects >= TI_RENDER_MAX_DIRTY_RECTS)
+    {
+        display->dirtyFullScreen = TI_TRUE;
+        display->numDirtyRects = 0;
+        return;
+    }
+
+    other = &(display->dirtyRects[display->numDirtyRects++]);
+    other->x = x;
+    other->y = y;
+    other->w = w;
+    other->h = h;
+}
+
+/****************************************************************************
+* renderFlushDirty - see tiRenderSDL.h for description
+****************************************************************************/
+void renderFlushDirty(TiScreen *display)
+{
+    TiTransition *t;
+    int counter, counter2, done;
+
+    /* Keep what's under every sliding surface to put back afterwards.  All
+       of it is kept before any of it is covered up, since two slides can 
+       be over the same part of the screen (a dialog replacing another in 
+       the same place), and the second mustn't keep the first's covering */
+    for(counter=0;counter<TI_RENDER_MAX_TRANSITIONS;counter++)
+    {
+        t = &(display->transitions[counter]);
+        if(t->active == TI_TRUE)
+        {
+            renderBlitSurface(t->x, t->y, 0, 0, t->w, t->h, display->screen, t->to);
+        }
+    }
+
+    /* Then cover up the parts that haven't arrived yet */
+    for(counter=0;counter<TI_RENDER_MAX_TRANSITIONS;counter++)
+    {
+        t = &(display->transitions[counter]);
+        if(t->active == TI_FALSE)
+        {
+            continue;
+        }
+        for(counter2=0;counter2<t->h;counter2++)
+        {
+            done = (int)t->rowDone[counter2];
+            if(done >= t->w)
+            {
+                continue;
+            }
+            if(t->fromLeft == TI_TRUE)
+            {
+                renderBlitSurface(done, counter2, t->x + done, t->y + counter2,
+                                  t->w - done, 1, t->from, display->screen);
+            }
+            else
+            {
+                renderBlitSurface(0, counter2, t->x, t->y + counter2,
+                                  t->w - done, 1, t->from, display->screen);
+            }
+        }
+    }
+
+    if(display->dirtyFullScreen == TI_TRUE)
+    {
+        display->backend->present(display->backend, 0, NULL);
+        display->lastPixelsPushed = (unsigned long)display->xRes * display->yRes;
+        display->lastRectsPushed = 1;
+    }
+    else
+    {
+        display->backend->present(display->backend, display->numDirtyRects, 
+                                  display->dirtyRects);
+        display->lastPixelsPushed = 0;
+        for(counter=0;counter<display->numDirtyRects;counter++)
+        {
+            display->lastPixelsPushed += (unsigned long)display->dirtyRects[counter].w *
+                                         display->dirtyRects[counter].h;
+        }
+        display->lastRectsPushed = display->numDirtyRects;
+    }
+
+    display->lastPixelsMarked = display->pixelsMarked;
+    display->totalPixelsMarked += display->pixelsMarked;
+    display->totalPixelsPushed += display->lastPixelsPushed;
+    display->numFlushes++;
+
+    display->pixelsMarked = 0;
+    display->numDirtyRects = 0;
+    display->dirtyFullScreen = TI_FALSE;
+
+    for(counter=0;counter<TI_RENDER_MAX_TRANSITIONS;counter++)
+    {
+        t = &(display->transitions[counter]);
+        if(t->active == TI_TRUE)
+        {
+            renderBlitSurface(0, 0, t->x, t->y, t->w, t->h, t->to, display->screen);
+        }
+    }
+}
+
 /****************************************************************************
 * renderApplySurface - see tiRenderSDL.h for description
 ****************************************************************************/
 void renderApplySurface(int x, int y, SDL_Surface *source, SDL_Surface *dest)
 {
     SDL_Rect offset;
+    TiRenderBackend *backend;
+
     offset.x = x;
     offset.y = y;
-    SDL_BlitSurface(source, NULL, dest, &offset);
+    backend = renderBackendGetCurrent();
+    backend->blit(backend, source, NULL, dest, &offset);
 }
 
 /****************************************************************************
@@ -988,6 +1145,8 @@ void renderBlitSurface(int srcX, int srcY, int dstX, int dstY, int w, int h,
 {
     SDL_Rect sourceRect;
     SDL_Rect destRect;
+    TiRenderBackend *backend;
+
     sourceRect.x = srcX;
     sourceRect.y = srcY;
     sourceRect.w = w;
@@ -996,7 +1155,8 @@ void renderBlitSurface(int srcX, int srcY, int dstX, int dstY, int w, int h,
     destRect.y = dstY;
     destRect.w = w;
     destRect.h = h;
-    SDL_BlitSurface(source, &sourceRect, dest, &destRect);
+    backend = renderBackendGetCurrent();
+    backend->blit(backend, source, &sourceRect, dest, &destRect);
 }
 
 /****************************************************************************
@@ -1026,7 +1186,7 @@ int renderProcessComputerMove(TiScreen *display, TiAssets *a,  TiSharedData *dat
     switch(cur->moveType)
     {
         case TI_CPU_MOVE_DRAW:
-            SDL_Delay(rand() % TI_CPU_DYNAMIC_DELAY);
+            renderBackendDelay(rand() % TI_CPU_DYNAMIC_DELAY);
             if(g->players[g->curPlayer].currentTileId == TI_TILE_NO_TILE)
             {
                 g->players[g->curPlayer].currentTileId = tilePoolDrawRandomTile(g->tilepool);
@@ -1039,13 +1199,15 @@ int renderProcessComputerMove(TiScreen *display, TiAssets *a,  TiSharedData *dat
                 g->selectedMoveIsReserveTile = TI_TRUE;
                 g->selectedMoveTileId = g->players[g->curPlayer].reserveTileId;
             }
+            recordAddEvent(CurrentRecord, TI_RECORD_EVENT_DRAW, g->selectedMoveIsReserveTile,
+                           g->selectedMoveTileId);
             renderDrawCurrentTileHighlight(display, a, data);
             data->refreshPlayerTiles = TI_TRUE;
             renderUpdateScreen(display, a, data);
             break;
         case TI_CPU_MOVE_PLAY:
             /* Sleep for a while to make CPU moves non-instantaneous */
-            SDL_Delay((rand() % TI_CPU_DYNAMIC_DELAY) + TI_CPU_STATIC_DELAY);
+            renderBackendDelay((rand() % TI_CPU_DYNAMIC_DELAY) + TI_CPU_STATIC_DELAY);
             g->selectedMoveTileX = cur->moveX;
             g->selectedMoveTileY = cur->moveY;
             if(cur->heldTile == TI_CPU_HELD_TILE_PRIMARY)
@@ -1080,18 +1242,13 @@ int renderProcessComputerMove(TiScreen *display, TiAssets *a,  TiSharedData *dat
                 printf("Attempted placement of %d at (%d, %d)\n", g->selectedMoveTileId, g->selectedMoveTileX, g->selectedMoveTileY);
                 exit(-1);
             }
+            recordAddEvent(CurrentRecord, TI_RECORD_EVENT_PLAY, g->selectedMoveIsReserveTile,
+                           TI_RECORD_SQUARE(g->selectedMoveTileX, g->selectedMoveTileY));
 
-            /* Undraw the previous player's move if the user has selected the 'Last Player' option */
-            renderUndrawPreviousMove(display, a, data);
-            /* 'Undraw' the current player's last move */
-            renderDrawTile(display, a, data , g->players[g->curPlayer].lastMoveX,
-                           g->players[g->curPlayer].lastMoveY,
-                           g->board->b[g->players[g->curPlayer].lastMoveX][g->players[g->curPlayer].lastMoveY].tileIndex);
             g->players[g->curPlayer].lastMoveX = g->selectedMoveTileX;
             g->players[g->curPlayer].lastMoveY = g->selectedMoveTileY;
-            renderDrawTileOnBoard(display, a, data);
-            renderLastMoves(display, a, data);
-            renderTrackOverlays(display, a, data);
+            data->lastMovePlayer = g->curPlayer;
+            renderUpdateBoardLayer(display, a, data);
             renderDrawCurrentTileHighlight(display, a, data);
             data->refreshPlayerTiles = TI_TRUE;
             renderUpdateScreen(display, a, data);
@@ -1099,7 +1256,7 @@ int renderProcessComputerMove(TiScreen *display, TiAssets *a,  TiSharedData *dat
             break;
         case TI_CPU_MOVE_DISCARD:
             /* Sleep for a while to make CPU moves non-instantaneous */
-            SDL_Delay((rand() % TI_CPU_DYNAMIC_DELAY) + TI_CPU_STATIC_DELAY);
+            renderBackendDelay((rand() % TI_CPU_DYNAMIC_DELAY) + TI_CPU_STATIC_DELAY);
             if(cur->heldTile == TI_CPU_HELD_TILE_PRIMARY)
             {
                 g->selectedMoveTileId = g->players[g->curPlayer].currentTileId;
@@ -1135,8 +1292,12 @@ void renderUpdateLogic(TiScreen *display, TiSharedData *data, TiAssets *a)
 {
 
     Game *g;
+    ComputerAIPacket moves[2];
+    int pondering;
     g = gameGetGlobalGameInstance();
 
+    renderAdvanceTransitions(display);
+
     switch(data->renderState)
     {
         case TI_STATE_COMPANY_LOGO:
@@ -1180,36 +1341,70 @@ void renderUpdateLogic(TiScreen *display, TiSharedData *data, TiAssets *a)
             }
             break;
         case TI_STATE_IN_GAME:
+            if(data->loadingAssets == TI_TRUE)
+            {
+                break;
+            }
             switch(g->gameState)
             {
                 case TI_GAME_STATE_COMPUTER_MOVE:
-                    data->currentMove = computerDetermineNextMove(NULL);
-                    if(data->currentMove == NULL)
+                    /* The computer's move doesn't give the screen a chance
+                       to update until it's done, so let the 'thinking' 
+                       dialog be drawn and finish arriving first */
+                    if(g->gameStateChanged == TI_TRUE || 
+                       renderTransitionsActive(display) == TI_TRUE)
                     {
-                        perror("Unable to get CPU move!\n");
-                        exit(-1);
+                        break;
                     }
+                    data->previousMove = NULL;
+                    data->currentMove = &(moves[0]);
+                    TI_PROFILE_BEGIN(TI_PROFILE_AI);
+                    computerDetermineNextMove(NULL, data->currentMove);
+                    TI_PROFILE_END(TI_PROFILE_AI);
                     while(data->currentMove->moveType != TI_CPU_MOVE_END_TURN)
                     {
                         renderProcessComputerMove(display, a, data);
-                        if(data->previousMove != NULL)
-                        {
-                            free(data->previousMove);
-                        }
                         data->previousMove = data->currentMove;
-                        data->currentMove = computerDetermineNextMove(data->previousMove);
+                        data->currentMove = (data->previousMove == &(moves[0])) ?
+                                            &(moves[1]) : &(moves[0]);
+                        TI_PROFILE_BEGIN(TI_PROFILE_AI);
+                        computerDetermineNextMove(data->previousMove, data->currentMove);
+                        TI_PROFILE_END(TI_PROFILE_AI);
                     }
+                    /* Pause briefly before handing over to the next player,
+                       for longer if the computer is passing after a draw */
                     if(data->previousMove != NULL)
                     {
-                        free(data->previousMove);
-                        data->previousMove = NULL;
+                        if(data->previousMove->moveType == TI_CPU_MOVE_DRAW)
+                        {
+                            renderBackendDelay((rand() % TI_CPU_DYNAMIC_DELAY) + TI_CPU_STATIC_DELAY);
+                        }
+                        else
+                        {
+                            renderBackendDelay((rand() % TI_CPU_PASS_DYNAMIC_DELAY) + TI_CPU_PASS_STATIC_DELAY);
+                        }
                     }
-                    if(data->currentMove != NULL)
+                    data->previousMove = NULL;
+                    data->currentMove = NULL;
+                    gameSetGameState(g, TI_GAME_STATE_END_TURN);
+                    break;
+                case TI_GAME_STATE_SELECT_ACTION:
+                case TI_GAME_STATE_TILE_SELECT:
+                    /* Let the computer players think ahead while the
+                       human player decides what to do */
+                    if(g->players[g->curPlayer].controlledBy == TI_PLAYER_HUMAN)
                     {
-                        free(data->currentMove);
-                        data->currentMove = NULL;
+                        TI_PROFILE_BEGIN(TI_PROFILE_AI);
+                        pondering = computerPonder(TI_CPU_PONDER_TIME_SLICE);
+                        TI_PROFILE_END(TI_PROFILE_AI);
+                        if(pondering == TI_FALSE)
+                        {
+                            data->ponderFinished = TI_TRUE;
+                            data->ponderBoardHash = boardCalculateHash(g->board);
+                            data->ponderPlayer = g->curPlayer;
+                            data->ponderTilesLeft = g->tilepool->numUnplayedTiles;
+                        }
                     }
-                    gameSetGameState(g, TI_GAME_STATE_END_TURN);
                     break;
                 case TI_GAME_STATE_GAME_FINISHED:
                     break;
@@ -1253,8 +1448,8 @@ void renderDrawAnimatedTrains(TiScreen *display, TiAssets *a, TiSharedData *data
     renderBlitSurface(0, 0, data->bottomTrainX,
                     TI_GAME_YRES-31, TI_RENDER_TRAIN_BANNER_WIDTH, 22,
                     a->trainBannerBottom, display->screen);
-    SDL_UpdateRect(display->screen, 0, 0, TI_GAME_XRES-1, 40);
-    SDL_UpdateRect(display->screen, 0, TI_GAME_YRES-40, TI_GAME_XRES-1,40);
+    renderMarkDirty(display, 0, 0, TI_GAME_XRES-1, 40);
+    renderMarkDirty(display, 0, TI_GAME_YRES-40, TI_GAME_XRES-1,40);
 }
 
 /****************************************************************************
@@ -1265,7 +1460,7 @@ void renderTitleScreenDrawBase(TiScreen *display, TiAssets *a, TiSharedData *dat
     if(data->refreshBG == TI_TRUE)
     {
         renderApplySurface(0,0, a->titleScreenBG, display->screen);
-        SDL_UpdateRect(display->screen, 0, 0, 0, 0);
+        renderMarkDirty(display, 0, 0, 0, 0);
         data->refreshBG = TI_FALSE;
     }
 
@@ -1322,7 +1517,7 @@ void renderNewGameScreenExtras(TiScreen *display, TiAssets *a, TiSharedData *dat
                                   a->humanCpu, display->screen);
             }
         }
-        SDL_UpdateRect(display->screen, 0, 0, 0, 0);
+        renderMarkDirty(display, 0, 0, 0, 0);
         data->refreshPlayersList = TI_FALSE;
     }
 }
@@ -1446,7 +1641,7 @@ void renderOptionsScreenExtras(TiScreen *display, TiAssets *a, TiSharedData *dat
                           TI_RENDER_OPTIONS_SOUND_OFFSETS[g->tmpEffectsVolume][3],
                           a->optionDigits, display->screen);
 
-        SDL_UpdateRect(display->screen, 0, 0, 0, 0);
+        renderMarkDirty(display, 0, 0, 0, 0);
         data->refreshOptionsScreen = TI_FALSE;
     }     
 }
@@ -1455,27 +1650,18 @@ void renderLastMoves(TiScreen *display, TiAssets *a, TiSharedData *data)
 {
     Game *g;
     int counter;
-    int lastPlayer;
 
     g = gameGetGlobalGameInstance();
 
     for(counter=0;counter<g->numPlayers;counter++)
     {
         if(g->showLastMove == TI_GAME_OPTIONS_ALL_PLAYERS ||
-           (g->showLastMove == TI_GAME_OPTIONS_LAST_PLAYER && counter == g->curPlayer))
+           (g->showLastMove == TI_GAME_OPTIONS_LAST_PLAYER && counter == data->lastMovePlayer))
         {
             if(g->players[counter].lastMoveX != TI_PLAYER_INVALID_LAST_MOVE &&
                g->players[counter].lastMoveY != TI_PLAYER_INVALID_LAST_MOVE)
             {
-                renderBlitSurface(counter * TI_RENDER_SMALL_TILE_WIDTH, 0,
-                                  TI_RENDER_BOARD_TILE_AREA_X + ((g->players[counter].lastMoveX - 1) * TI_RENDER_SMALL_TILE_WIDTH),
-                                  TI_RENDER_BOARD_TILE_AREA_Y + ((g->players[counter].lastMoveY - 1) * TI_RENDER_SMALL_TILE_WIDTH),
-                                  TI_RENDER_SMALL_TILE_WIDTH, TI_RENDER_SMALL_TILE_WIDTH,
-                                  a->lastMoveHighlights, display->screen);
-                SDL_UpdateRect(display->screen,
-                               TI_RENDER_BOARD_TILE_AREA_X + (g->players[counter].lastMoveX * TI_RENDER_SMALL_TILE_WIDTH),
-                               TI_RENDER_BOARD_TILE_AREA_Y + (g->players[counter].lastMoveY * TI_RENDER_SMALL_TILE_WIDTH),
-                               TI_RENDER_SMALL_TILE_WIDTH, TI_RENDER_SMALL_TILE_WIDTH);
+                data->boardCellsWanted[g->players[counter].lastMoveX - 1][g->players[counter].lastMoveY - 1].lastMoves |= (1 << counter);
             }
         }
     }
@@ -1486,23 +1672,63 @@ void renderLastMoves(TiScreen *display, TiAssets *a, TiSharedData *data)
 ****************************************************************************/
 void renderTrackOverlay(TiScreen *display, TiAssets *a, TiSharedData *data, int station)
 {
+    Game *g;
+    TiTrackPath *path;
+    TiBoardCell *cell;
+    int counter;
+
+    g = gameGetGlobalGameInstance();
+    path = &(data->trackPaths[station]);
+
+    /* User doesn't want track overlays, so just return */
+    if(g->highlightTracks == TI_GAME_OPTIONS_NO)
+    {
+        return;
+    }
 
+    /* A track only changes when a tile is played on the square it runs 
+       into, so the last walk along it is good until then */
+    if(path->valid == TI_FALSE ||
+       (path->endX != TI_RENDER_NO_PATH_END &&
+        g->board->b[path->endX][path->endY].type == TI_BOARDSQUARE_TYPE_PLAYED_TILE))
+    {
+        renderUpdateTrackPath(data, station);
+    }
+
+    for(counter=0;counter<path->numSegments;counter++)
+    {
+        cell = &(data->boardCellsWanted[path->segmentX[counter]-1][path->segmentY[counter]-1]);
+        if(cell->numOverlays < TI_RENDER_MAX_CELL_OVERLAYS)
+        {
+            cell->overlayOffset[cell->numOverlays] = path->segmentOffset[counter];
+            cell->overlayPlayer[cell->numOverlays] = path->player;
+            cell->numOverlays++;
+        }
+    }
+}
+
+/****************************************************************************
+* renderUpdateTrackPath - see tiRenderSDL.h for description
+****************************************************************************/
+void renderUpdateTrackPath(TiSharedData *data, int station)
+{
     Game *g;
     Board *b;
+    TiTrackPath *path;
     int stationX, stationY, stationExit;
     int newX, newY, newExit, newType;
     int oldX, oldY, oldExit;
-    int loopCatcher, loopLimit;
     int player;
 
     g = gameGetGlobalGameInstance();
     b = g->board;
+    path = &(data->trackPaths[station]);
 
-    /* User doesn't want track overlays, so just return */
-    if(g->highlightTracks == TI_GAME_OPTIONS_NO)
-    {
-        return;
-    }
+    /* Whatever happens below, don't come back until something changes */
+    path->valid = TI_TRUE;
+    path->numSegments = 0;
+    path->endX = TI_RENDER_NO_PATH_END;
+    path->endY = TI_RENDER_NO_PATH_END;
 
     player = g->board->playerStations[g->numPlayers][station];
 
@@ -1513,7 +1739,7 @@ void renderTrackOverlay(TiScreen *display, TiAssets *a, TiSharedData *data, int
 
     /* Subtract one from the player number to get the correct vertical offset into the 
        track overlay file */
-    player = player - 1;
+    path->player = player - 1;
 
     /* Determine the starting point */
     boardGetStationInfo(station, &stationX, &stationY, &stationExit);
@@ -1534,35 +1760,60 @@ void renderTrackOverlay(TiScreen *display, TiAssets *a, TiSharedData *data, int
     newType = boardFindNextTrackSection(b, stationX, stationY, stationExit,
                                         &newX, &newY, &newExit);
 
-    loopCatcher = 0;
-    loopLimit = 255;
-
     while((newType == TI_BOARDSQUARE_TYPE_PLAYED_TILE) &&
-        (loopCatcher < loopLimit))
+        (path->numSegments < TI_RENDER_MAX_PATH_SEGMENTS))
     {
-        loopCatcher++;
         oldX = newX;
         oldY = newY;
         oldExit = tileGetExit(
                     &(b->tp->t[b->b[newX][newY].tileIndex]),
                     newExit);
-       renderBlitSurface(TI_RENDER_GAME_TRACK_OVERLAY_EXITS[oldExit][newExit] * TI_RENDER_SMALL_TILE_WIDTH,
-                          player * TI_RENDER_SMALL_TILE_WIDTH,
-                          TI_RENDER_BOARD_TILE_AREA_X + ((oldX-1) * TI_RENDER_SMALL_TILE_WIDTH),
-                          TI_RENDER_BOARD_TILE_AREA_Y + ((oldY-1) * TI_RENDER_SMALL_TILE_WIDTH),
-                          TI_RENDER_SMALL_TILE_WIDTH,
-                          TI_RENDER_SMALL_TILE_WIDTH,
-                          a->trackOverlays, display->screen);
+        path->segmentX[path->numSegments] = oldX;
+        path->segmentY[path->numSegments] = oldY;
+        path->segmentOffset[path->numSegments] = TI_RENDER_GAME_TRACK_OVERLAY_EXITS[oldExit][newExit];
+        path->numSegments++;
         newType = boardFindNextTrackSection(b, oldX, oldY, oldExit,
                                             &newX, &newY, &newExit);
     }
 
-    if(loopCatcher >= loopLimit)  /* Broke out from possible infinite loop */
+    if(path->numSegments >= TI_RENDER_MAX_PATH_SEGMENTS)  /* Broke out from possible infinite loop */
     {
         perror("boardCalculateTrackScore: infinite loop caught");
         return;
     }
 
+    path->endX = newX;
+    path->endY = newY;
+}
+
+/****************************************************************************
+* renderShowRecordedTurn - see tiRenderSDL.h for description
+****************************************************************************/
+void renderShowRecordedTurn(TiSharedData *data, int turn)
+{
+    Game *g;
+    TiRecordPosition position;
+    int counter;
+
+    g = gameGetGlobalGameInstance();
+    if(CurrentRecord == NULL || turn < 0 || turn > (int)CurrentRecord->position.turn ||
+       recordSeekTurn(CurrentRecord, turn, &position) != TI_OK)
+    {
+        return;
+    }
+    recordLoadPosition(&position, g);
+    data->replayTurn = turn;
+
+    /* Tiles come off the board as well as going on, so none of the tracks
+       can be trusted, and there's no last move to show */
+    for(counter=0;counter<TI_BOARD_NUM_STATIONS;counter++)
+    {
+        data->trackPaths[counter].valid = TI_FALSE;
+    }
+    data->lastMovePlayer = TI_RENDER_NO_LAST_MOVE_PLAYER;
+
+    /* Have the finished game dialog put back over the new board */
+    g->gameStateChanged = TI_TRUE;
 }
 
 /****************************************************************************
@@ -1572,82 +1823,119 @@ void renderTrackOverlays(TiScreen *display, TiAssets *a, TiSharedData *data)
 {
     int counter;
 
-    for(counter=0;counter< TI_BOARD_NUM_STATIONS;counter++)
+    for(counter=0;counter< TI_BOARD_NUM_STATIONS;counter++)
+    {
+        renderTrackOverlay(display, a, data, counter);
+    }
+}
+
+/****************************************************************************
+* renderPlayerScore - see tiRenderSDL.h for description
+****************************************************************************/
+void renderPlayerScore(TiScreen *display, TiAssets *a, TiSharedData *data, int player)
+{
+    Game *g;
+    TiScoreString *cached;
+    int score;
+
+    g = gameGetGlobalGameInstance();
+
+    score = g->players[player].score;
+
+    /* The score should never be this high.  If it is, just don't draw it */
+    if(score > TI_RENDER_MAX_SCORE)
+    {
+        return;
+    }
+
+    /* Only redraw the digits if the score has changed since last time */
+    cached = &data->gameScores[player];
+    if(cached->surface == NULL)
+    {
+        cached->surface = renderCreateScoreSurface(display, 
+                                                   TI_RENDER_GAME_SCORE_BACKING_WIDTH,
+                                                   TI_RENDER_GAME_SCORE_BACKING_HEIGHT,
+                                                   TI_FALSE);
+        if(cached->surface == NULL)
+        {
+            return;
+        }
+    }
+    if(cached->value != score)
+    {
+        renderBlitSurface(0, 0, 0, 0,
+                          TI_RENDER_GAME_SCORE_BACKING_WIDTH, TI_RENDER_GAME_SCORE_BACKING_HEIGHT,
+                          a->scoreBacking, cached->surface);
+        cached->width = renderDrawScoreDigits(cached->surface, a->digits, score,
+                                              TI_RENDER_GAME_DIGIT_OFFSET,
+                                              TI_RENDER_GAME_DIGIT_WIDTHS,
+                                              TI_RENDER_GAME_DIGIT_HEIGHT,
+                                              TI_RENDER_GAME_LETTER_SPACING);
+        cached->value = score;
+    }
+
+    renderBlitSurface(0, 0, TI_RENDER_GAME_PLAYER_SCORE_OFFSETS[player][0],
+                      TI_RENDER_GAME_PLAYER_SCORE_OFFSETS[player][1],
+                      TI_RENDER_GAME_SCORE_BACKING_WIDTH, TI_RENDER_GAME_SCORE_BACKING_HEIGHT,
+                      cached->surface, display->screen);
+    renderMarkDirty(display, TI_RENDER_GAME_PLAYER_SCORE_OFFSETS[player][0],
+                    TI_RENDER_GAME_PLAYER_SCORE_OFFSETS[player][1],
+                    TI_RENDER_GAME_SCORE_BACKING_WIDTH, TI_RENDER_GAME_SCORE_BACKING_HEIGHT);
+
+    return;
+}
+
+/****************************************************************************
+* renderCreateScoreSurface - see tiRenderSDL.h for description
+****************************************************************************/
+SDL_Surface *renderCreateScoreSurface(TiScreen *display, int w, int h, int transparent)
+{
+    SDL_Surface *surface;
+
+    surface = display->backend->createSurface(display->backend, w, h);
+    if(surface == NULL)
+    {
+        return NULL;
+    }
+
+    if(transparent == TI_TRUE)
     {
-        renderTrackOverlay(display, a, data, counter);
+        SDL_SetColorKey(surface, SDL_SRCCOLORKEY, 
+                        SDL_MapRGB(surface->format, 0xFF, 0, 0xFF));
     }
 
-    SDL_UpdateRect(display->screen,
-                   TI_RENDER_BOARD_TILE_AREA_X,
-                   TI_RENDER_BOARD_TILE_AREA_Y,
-                   TI_RENDER_BOARD_TILE_AREA_MAX_X - TI_RENDER_BOARD_TILE_AREA_X,
-                   TI_RENDER_BOARD_TILE_AREA_MAX_Y - TI_RENDER_BOARD_TILE_AREA_Y);
+    return surface;
 }
 
 /****************************************************************************
-* renderPlayerScore - see tiRenderSDL.h for description
+* renderDrawScoreDigits - see tiRenderSDL.h for description
 ****************************************************************************/
-void renderPlayerScore(TiScreen *display, TiAssets *a, TiSharedData *data, int player)
+int renderDrawScoreDigits(SDL_Surface *dest, SDL_Surface *digits, int score,
+                          int digitOffset, int *digitWidths, int digitHeight,
+                          int spacing)
 {
-    Game *g;
     int blitX;
-    int blitY;
-    int score;
-    int numDigits;
+    int divisor;
     int digit;
-    int counter, offset;
-
-    g = gameGetGlobalGameInstance();
 
     /* Start with the most significant digit, and work toward the least */
-    blitX = TI_RENDER_GAME_PLAYER_SCORE_OFFSETS[player][0];
-    blitY = TI_RENDER_GAME_PLAYER_SCORE_OFFSETS[player][1];
-
-    /* Get a copy of the score */
-    score = g->players[player].score;
-
-    /* The score should never be this high.  If it is, just don't draw it */
-    if(score > 9999)
-    {
-        return;
-    }
-    else if(score > 999 && score <= 9999)
-    {
-        numDigits = 4;
-    }
-    else if(score > 99 && score <= 999)
-    {
-        numDigits = 3;
-    }
-    else if(score > 9 && score <= 99)
-    {
-        numDigits = 2;
-    }
-    else
+    divisor = 1;
+    while(divisor * 10 <= score)
     {
-        numDigits = 1;
+        divisor *= 10;
     }
 
-    renderBlitSurface(0, 0, TI_RENDER_GAME_PLAYER_SCORE_OFFSETS[player][0],
-                      TI_RENDER_GAME_PLAYER_SCORE_OFFSETS[player][1],
-                      TI_RENDER_GAME_SCORE_BACKING_WIDTH, TI_RENDER_GAME_SCORE_BACKING_HEIGHT,
-                      a->scoreBacking, display->screen);
-
-    for(counter=numDigits-1;counter>=0;counter--)
+    blitX = 0;
+    while(divisor > 0)
     {
-        digit = score / pow(10, counter);
-        score = score - (digit * pow(10, counter));
-        offset = digit * TI_RENDER_GAME_DIGIT_OFFSET;
-        renderBlitSurface(offset, 0, blitX, blitY, TI_RENDER_GAME_DIGIT_WIDTHS[digit],
-                          TI_RENDER_GAME_DIGIT_HEIGHT, a->digits, display->screen);
-        blitX += (TI_RENDER_GAME_DIGIT_WIDTHS[digit] + TI_RENDER_GAME_LETTER_SPACING);
+        digit = (score / divisor) % 10;
+        renderBlitSurface(digit * digitOffset, 0, blitX, 0, digitWidths[digit],
+                          digitHeight, digits, dest);
+        blitX += (digitWidths[digit] + spacing);
+        divisor /= 10;
     }
 
-    SDL_UpdateRect(display->screen, TI_RENDER_GAME_PLAYER_SCORE_OFFSETS[player][0],
-                   TI_RENDER_GAME_PLAYER_SCORE_OFFSETS[player][1],
-                   TI_RENDER_GAME_SCORE_BACKING_WIDTH, TI_RENDER_GAME_SCORE_BACKING_HEIGHT);
-
-    return;
+    return blitX;
 }
 
 /****************************************************************************
@@ -1686,24 +1974,23 @@ void renderTrainsAndStations(TiScreen *display, TiAssets *a, TiSharedData *data)
         }
     }
 
-    SDL_UpdateRect(display->screen, TI_RENDER_BOARD_AREA_X, TI_RENDER_BOARD_AREA_Y,
-                   TI_RENDER_BOARD_AREA_WIDTH, TI_RENDER_BOARD_AREA_HEIGHT);
+    renderMarkDirty(display, TI_RENDER_BOARD_AREA_X, TI_RENDER_BOARD_AREA_Y,
+                    TI_RENDER_BOARD_AREA_WIDTH, TI_RENDER_BOARD_AREA_HEIGHT);
 }
 
 /****************************************************************************
-* renderRestoreBoardBacking - see tiRenderSDL.h for description
+* renderRestoreBoardArea - see tiRenderSDL.h for description
 ****************************************************************************/
-void renderRestoreBoardBacking(TiScreen *display, TiAssets *a, TiSharedData *data, int refreshScreen)
+void renderRestoreBoardArea(TiScreen *display, TiAssets *a, TiSharedData *data)
 {
-    renderBlitSurface(0, 0, TI_RENDER_BOARD_AREA_X, TI_RENDER_BOARD_AREA_Y,
+    /* Nothing but the background, the stations and trains, and the board
+       layer is drawn here, so there's no need to save what was underneath */
+    renderBlitSurface(TI_RENDER_BOARD_AREA_X, TI_RENDER_BOARD_AREA_Y,
+                      TI_RENDER_BOARD_AREA_X, TI_RENDER_BOARD_AREA_Y,
                       TI_RENDER_BOARD_AREA_WIDTH, TI_RENDER_BOARD_AREA_HEIGHT,
-                      data->boardAreaBacking, display->screen);
-    if(refreshScreen == TI_TRUE)
-    {
-        SDL_UpdateRect(display->screen,
-                       TI_RENDER_BOARD_AREA_X, TI_RENDER_BOARD_AREA_Y,
-                       TI_RENDER_BOARD_AREA_WIDTH, TI_RENDER_BOARD_AREA_HEIGHT);
-    }
+                      a->gameplayBG, display->screen);
+    renderTrainsAndStations(display, a, data);
+    renderPresentBoardLayer(display, a, data);
 }
 
 /****************************************************************************
@@ -1711,21 +1998,8 @@ void renderRestoreBoardBacking(TiScreen *display, TiAssets *a, TiSharedData *dat
 ****************************************************************************/
 void renderDrawCurrentPlayerHighlight(TiScreen *display, TiAssets *a, TiSharedData *data)
 {
-    Uint32 rmask, gmask, bmask, amask;
     Game *g;
 
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-    rmask = 0xff000000;
-    gmask = 0x00ff0000;
-    bmask = 0x0000ff00;
-    amask = 0x00000000;
-#else
-    rmask = 0x000000ff;
-    gmask = 0x0000ff00;
-    bmask = 0x00ff0000;
-    amask = 0x00000000;
-#endif
-
     g = gameGetGlobalGameInstance();
 
     /* Restore the original player backing */
@@ -1737,20 +2011,24 @@ void renderDrawCurrentPlayerHighlight(TiScreen *display, TiAssets *a, TiSharedDa
                           TI_RENDER_GAME_CUR_PLAYER_OFFSETS[data->currentPlayerBackingPlayerNum][2],
                           TI_RENDER_GAME_CUR_PLAYER_OFFSETS[data->currentPlayerBackingPlayerNum][3],
                           data->currentPlayerBacking, display->screen);
-        SDL_UpdateRect(display->screen,
-                       TI_RENDER_GAME_CUR_PLAYER_OFFSETS[data->currentPlayerBackingPlayerNum][0],
-                       TI_RENDER_GAME_CUR_PLAYER_OFFSETS[data->currentPlayerBackingPlayerNum][1],
-                       TI_RENDER_GAME_CUR_PLAYER_OFFSETS[data->currentPlayerBackingPlayerNum][2],
-                       TI_RENDER_GAME_CUR_PLAYER_OFFSETS[data->currentPlayerBackingPlayerNum][3]);
-        SDL_FreeSurface(data->currentPlayerBacking);
+        renderMarkDirty(display,
+                        TI_RENDER_GAME_CUR_PLAYER_OFFSETS[data->currentPlayerBackingPlayerNum][0],
+                        TI_RENDER_GAME_CUR_PLAYER_OFFSETS[data->currentPlayerBackingPlayerNum][1],
+                        TI_RENDER_GAME_CUR_PLAYER_OFFSETS[data->currentPlayerBackingPlayerNum][2],
+                        TI_RENDER_GAME_CUR_PLAYER_OFFSETS[data->currentPlayerBackingPlayerNum][3]);
+        surfacePoolRelease(data->surfacePool, data->currentPlayerBacking);
         data->currentPlayerBacking = NULL;
     }
 
     /* Grab the new backing data */
-    data->currentPlayerBacking = SDL_CreateRGBSurface(SDL_SWSURFACE,
-                                                      TI_RENDER_GAME_CUR_PLAYER_OFFSETS[g->curPlayer][2],
-                                                      TI_RENDER_GAME_CUR_PLAYER_OFFSETS[g->curPlayer][3],
-                                                      32, rmask, gmask, bmask, amask);
+    data->currentPlayerBacking = surfacePoolAcquire(data->surfacePool,
+                                                    TI_RENDER_GAME_CUR_PLAYER_OFFSETS[g->curPlayer][2],
+                                                    TI_RENDER_GAME_CUR_PLAYER_OFFSETS[g->curPlayer][3],
+                                                    display->screen->format);
+    if(data->currentPlayerBacking == NULL)
+    {
+        return;
+    }
     renderBlitSurface(TI_RENDER_GAME_CUR_PLAYER_OFFSETS[g->curPlayer][0],
                       TI_RENDER_GAME_CUR_PLAYER_OFFSETS[g->curPlayer][1],
                       0, 0,
@@ -1765,11 +2043,11 @@ void renderDrawCurrentPlayerHighlight(TiScreen *display, TiAssets *a, TiSharedDa
                       TI_RENDER_GAME_CUR_PLAYER_OFFSETS[g->curPlayer][2],
                       TI_RENDER_GAME_CUR_PLAYER_OFFSETS[g->curPlayer][3],
                       a->currentPlayer, display->screen);
-    SDL_UpdateRect(display->screen,
-                   TI_RENDER_GAME_CUR_PLAYER_OFFSETS[g->curPlayer][0],
-                   TI_RENDER_GAME_CUR_PLAYER_OFFSETS[g->curPlayer][1],
-                   TI_RENDER_GAME_CUR_PLAYER_OFFSETS[g->curPlayer][2],
-                   TI_RENDER_GAME_CUR_PLAYER_OFFSETS[g->curPlayer][3]);
+    renderMarkDirty(display,
+                    TI_RENDER_GAME_CUR_PLAYER_OFFSETS[g->curPlayer][0],
+                    TI_RENDER_GAME_CUR_PLAYER_OFFSETS[g->curPlayer][1],
+                    TI_RENDER_GAME_CUR_PLAYER_OFFSETS[g->curPlayer][2],
+                    TI_RENDER_GAME_CUR_PLAYER_OFFSETS[g->curPlayer][3]);
 
     data->currentPlayerBackingPlayerNum = g->curPlayer;
 }
@@ -1779,22 +2057,9 @@ void renderDrawCurrentPlayerHighlight(TiScreen *display, TiAssets *a, TiSharedDa
 ****************************************************************************/
 void renderDrawCurrentTileHighlight(TiScreen *display, TiAssets *a, TiSharedData *data)
 {
-    Uint32 rmask, gmask, bmask, amask;
     Game *g;
     int x, y, w, h;
 
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-    rmask = 0xff000000;
-    gmask = 0x00ff0000;
-    bmask = 0x0000ff00;
-    amask = 0x00000000;
-#else
-    rmask = 0x000000ff;
-    gmask = 0x0000ff00;
-    bmask = 0x00ff0000;
-    amask = 0x00000000;
-#endif
-
     g = gameGetGlobalGameInstance();
 
     /* Restore the original tile backing */
@@ -1803,10 +2068,10 @@ void renderDrawCurrentTileHighlight(TiScreen *display, TiAssets *a, TiSharedData
         renderBlitSurface(0, 0, data->currentTileBackingX, data->currentTileBackingY,
                           data->currentTileBackingW, data->currentTileBackingH,
                           data->currentTileBacking, display->screen);
-        SDL_UpdateRect(display->screen,
-                       data->currentTileBackingX, data->currentTileBackingY,
-                       data->currentTileBackingW, data->currentTileBackingH);
-        SDL_FreeSurface(data->currentTileBacking);
+        renderMarkDirty(display,
+                        data->currentTileBackingX, data->currentTileBackingY,
+                        data->currentTileBackingW, data->currentTileBackingH);
+        surfacePoolRelease(data->surfacePool, data->currentTileBacking);
         data->currentTileBacking = NULL;
     }
 
@@ -1829,13 +2094,17 @@ void renderDrawCurrentTileHighlight(TiScreen *display, TiAssets *a, TiSharedData
             h = TI_RENDER_GAME_PLAYER_TILE1_HIGHLIGHT_OFFSETS[g->curPlayer][3];
         }
 
-        data->currentTileBacking = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h,
-                                                        32, rmask, gmask, bmask, amask);
+        data->currentTileBacking = surfacePoolAcquire(data->surfacePool, w, h,
+                                                      display->screen->format);
+        if(data->currentTileBacking == NULL)
+        {
+            return;
+        }
         renderBlitSurface(x, y, 0, 0, w, h, display->screen, data->currentTileBacking);
 
         /* Draw the highlight */
         renderBlitSurface(0, 0, x, y, w, h, a->currentTile, display->screen);
-        SDL_UpdateRect(display->screen, x, y, w, h);
+        renderMarkDirty(display, x, y, w, h);
 
         data->currentTileBackingX = x;
         data->currentTileBackingY = y;
@@ -1845,39 +2114,151 @@ void renderDrawCurrentTileHighlight(TiScreen *display, TiAssets *a, TiSharedData
 }
 
 /****************************************************************************
-* renderDrawTile - see tiRenderSDL.h for description
+* renderUpdateBoardLayer - see tiRenderSDL.h for description
 ****************************************************************************/
-void renderDrawTile(TiScreen *display, TiAssets *a, TiSharedData *data, int x, int y, int tile)
+void renderUpdateBoardLayer(TiScreen *display, TiAssets *a, TiSharedData *data)
 {
     Game *g;
+    int counter, counter2;
 
     g = gameGetGlobalGameInstance();
 
-    if(x< 1 || y < 1)
+    /* The layer is made the first time it's needed, and kept */
+    if(data->boardLayer == NULL)
     {
-        return;
+        data->boardLayer = display->backend->createSurface(display->backend,
+                                                           TI_RENDER_BOARD_CELLS * TI_RENDER_SMALL_TILE_WIDTH,
+                                                           TI_RENDER_BOARD_CELLS * TI_RENDER_SMALL_TILE_WIDTH);
+        if(data->boardLayer == NULL)
+        {
+            perror("Unable to allocate board layer!");
+            exit(0);
+        }
+        for(counter=0;counter<TI_RENDER_BOARD_CELLS;counter++)
+        {
+            for(counter2=0;counter2<TI_RENDER_BOARD_CELLS;counter2++)
+            {
+                data->boardCells[counter][counter2].tileIndex = TI_RENDER_CELL_UNKNOWN;
+            }
+        }
     }
 
-    renderBlitSurface(tilePoolGetTileIndexForTileId(g->tilepool, tile) * TI_RENDER_SMALL_TILE_WIDTH,
-                      0, (TI_RENDER_BOARD_TILE_AREA_X + ((x - 1) * TI_RENDER_SMALL_TILE_WIDTH)),
-                      (TI_RENDER_BOARD_TILE_AREA_Y + ((y - 1) * TI_RENDER_SMALL_TILE_WIDTH)),
-                      TI_RENDER_SMALL_TILE_WIDTH, TI_RENDER_SMALL_TILE_WIDTH,
-                      a->tileStripSmall, display->screen);
-    SDL_UpdateRect(display->screen,
-                   (TI_RENDER_BOARD_TILE_AREA_X + ((x - 1) * TI_RENDER_SMALL_TILE_WIDTH)),
-                   (TI_RENDER_BOARD_TILE_AREA_Y + ((y - 1) * TI_RENDER_SMALL_TILE_WIDTH)),
-                   TI_RENDER_SMALL_TILE_WIDTH, TI_RENDER_SMALL_TILE_WIDTH);
+    /* Work out what should be in each cell */
+    memset(data->boardCellsWanted, 0, sizeof(data->boardCellsWanted));
+    for(counter=0;counter<TI_RENDER_BOARD_CELLS;counter++)
+    {
+        for(counter2=0;counter2<TI_RENDER_BOARD_CELLS;counter2++)
+        {
+            if(g->board->b[counter+1][counter2+1].type == TI_BOARDSQUARE_TYPE_PLAYED_TILE)
+            {
+                data->boardCellsWanted[counter][counter2].tileIndex = g->board->b[counter+1][counter2+1].tileIndex;
+            }
+            else
+            {
+                data->boardCellsWanted[counter][counter2].tileIndex = TI_TILE_NO_TILE;
+            }
+        }
+    }
+    renderLastMoves(display, a, data);
+    renderTrackOverlays(display, a, data);
+
+    /* Mark the cells that are changing */
+    for(counter=0;counter<TI_RENDER_BOARD_CELLS;counter++)
+    {
+        for(counter2=0;counter2<TI_RENDER_BOARD_CELLS;counter2++)
+        {
+            if(memcmp(&(data->boardCells[counter][counter2]), &(data->boardCellsWanted[counter][counter2]),
+                      sizeof(TiBoardCell)) != 0)
+            {
+                data->boardCells[counter][counter2] = data->boardCellsWanted[counter][counter2];
+                data->boardCellDirty[counter][counter2] = TI_TRUE;
+            }
+        }
+    }
+
+    /* And redraw them */
+    for(counter=0;counter<TI_RENDER_BOARD_CELLS;counter++)
+    {
+        for(counter2=0;counter2<TI_RENDER_BOARD_CELLS;counter2++)
+        {
+            if(data->boardCellDirty[counter][counter2] == TI_TRUE)
+            {
+                renderDrawBoardCell(display, a, data, counter + 1, counter2 + 1);
+                data->boardCellDirty[counter][counter2] = TI_FALSE;
+            }
+        }
+    }
 }
 
 /****************************************************************************
-* renderDrawTileOnBoard - see tiRenderSDL.h for description
+* renderDrawBoardCell - see tiRenderSDL.h for description
 ****************************************************************************/
-void renderDrawTileOnBoard(TiScreen *display, TiAssets *a, TiSharedData *data)
+void renderDrawBoardCell(TiScreen *display, TiAssets *a, TiSharedData *data, int x, int y)
 {
     Game *g;
+    TiBoardCell *cell;
+    int layerX, layerY;
+    int counter;
 
     g = gameGetGlobalGameInstance();
-    renderDrawTile(display, a, data, g->selectedMoveTileX, g->selectedMoveTileY, g->selectedMoveTileId);
+    cell = &(data->boardCells[x-1][y-1]);
+    layerX = (x - 1) * TI_RENDER_SMALL_TILE_WIDTH;
+    layerY = (y - 1) * TI_RENDER_SMALL_TILE_WIDTH;
+
+    /* Empty squares are whatever the background has there */
+    if(cell->tileIndex == TI_TILE_NO_TILE)
+    {
+        renderBlitSurface(TI_RENDER_BOARD_TILE_AREA_X + layerX, TI_RENDER_BOARD_TILE_AREA_Y + layerY,
+                          layerX, layerY, TI_RENDER_SMALL_TILE_WIDTH, TI_RENDER_SMALL_TILE_WIDTH,
+                          a->gameplayBG, data->boardLayer);
+    }
+    else
+    {
+        renderBlitSurface(tilePoolGetTileIndexForTileId(g->tilepool, cell->tileIndex) * TI_RENDER_SMALL_TILE_WIDTH, 0,
+                          layerX, layerY, TI_RENDER_SMALL_TILE_WIDTH, TI_RENDER_SMALL_TILE_WIDTH,
+                          a->tileStripSmall, data->boardLayer);
+    }
+
+    for(counter=0;counter<TI_MAX_PLAYERS;counter++)
+    {
+        if(cell->lastMoves & (1 << counter))
+        {
+            renderBlitSurface(counter * TI_RENDER_SMALL_TILE_WIDTH, 0, layerX, layerY,
+                              TI_RENDER_SMALL_TILE_WIDTH, TI_RENDER_SMALL_TILE_WIDTH,
+                              a->lastMoveHighlights, data->boardLayer);
+        }
+    }
+
+    for(counter=0;counter<cell->numOverlays;counter++)
+    {
+        renderBlitSurface(cell->overlayOffset[counter] * TI_RENDER_SMALL_TILE_WIDTH,
+                          cell->overlayPlayer[counter] * TI_RENDER_SMALL_TILE_WIDTH,
+                          layerX, layerY, TI_RENDER_SMALL_TILE_WIDTH, TI_RENDER_SMALL_TILE_WIDTH,
+                          a->trackOverlays, data->boardLayer);
+    }
+
+    renderBlitSurface(layerX, layerY,
+                      TI_RENDER_BOARD_TILE_AREA_X + layerX, TI_RENDER_BOARD_TILE_AREA_Y + layerY,
+                      TI_RENDER_SMALL_TILE_WIDTH, TI_RENDER_SMALL_TILE_WIDTH,
+                      data->boardLayer, display->screen);
+    renderMarkDirty(display,
+                    TI_RENDER_BOARD_TILE_AREA_X + layerX, TI_RENDER_BOARD_TILE_AREA_Y + layerY,
+                    TI_RENDER_SMALL_TILE_WIDTH, TI_RENDER_SMALL_TILE_WIDTH);
+}
+
+/****************************************************************************
+* renderPresentBoardLayer - see tiRenderSDL.h for description
+****************************************************************************/
+void renderPresentBoardLayer(TiScreen *display, TiAssets *a, TiSharedData *data)
+{
+    renderUpdateBoardLayer(display, a, data);
+    renderBlitSurface(0, 0, TI_RENDER_BOARD_TILE_AREA_X, TI_RENDER_BOARD_TILE_AREA_Y,
+                      TI_RENDER_BOARD_CELLS * TI_RENDER_SMALL_TILE_WIDTH,
+                      TI_RENDER_BOARD_CELLS * TI_RENDER_SMALL_TILE_WIDTH,
+                      data->boardLayer, display->screen);
+    renderMarkDirty(display, TI_RENDER_BOARD_TILE_AREA_X, TI_RENDER_BOARD_TILE_AREA_Y,
+                    TI_RENDER_BOARD_CELLS * TI_RENDER_SMALL_TILE_WIDTH,
+                    TI_RENDER_BOARD_CELLS * TI_RENDER_SMALL_TILE_WIDTH);
 }
 
 /****************************************************************************
@@ -1947,7 +2328,8 @@ void renderInGameScreen(TiScreen *display, TiAssets *a, TiSharedData *data)
             }
         }
 
-        SDL_UpdateRect(display->screen, 0, 0, 0, 0);
+        renderPresentBoardLayer(display, a, data);
+        renderMarkDirty(display, 0, 0, 0, 0);
         data->refreshBG = TI_FALSE;
         data->refreshPlayerTiles = TI_TRUE;
         data->refreshPlayerStations = TI_TRUE;
@@ -2002,16 +2384,16 @@ void renderInGameScreen(TiScreen *display, TiAssets *a, TiSharedData *data)
                                   a->tileStripSmall, display->screen);
 
                 /* Make sure the changes make it onto the screen */
-                SDL_UpdateRect(display->screen,
-                               TI_RENDER_GAME_PLAYER_TILE1_OFFSETS[counter][0],
-                               TI_RENDER_GAME_PLAYER_TILE1_OFFSETS[counter][1],
-                               TI_RENDER_GAME_PLAYER_TILE1_OFFSETS[counter][2],
-                               TI_RENDER_GAME_PLAYER_TILE1_OFFSETS[counter][3]);
-                SDL_UpdateRect(display->screen,
-                               TI_RENDER_GAME_PLAYER_TILE2_OFFSETS[counter][0],
-                               TI_RENDER_GAME_PLAYER_TILE2_OFFSETS[counter][1],
-                               TI_RENDER_GAME_PLAYER_TILE2_OFFSETS[counter][2],
-                               TI_RENDER_GAME_PLAYER_TILE2_OFFSETS[counter][3]);
+                renderMarkDirty(display,
+                                TI_RENDER_GAME_PLAYER_TILE1_OFFSETS[counter][0],
+                                TI_RENDER_GAME_PLAYER_TILE1_OFFSETS[counter][1],
+                                TI_RENDER_GAME_PLAYER_TILE1_OFFSETS[counter][2],
+                                TI_RENDER_GAME_PLAYER_TILE1_OFFSETS[counter][3]);
+                renderMarkDirty(display,
+                                TI_RENDER_GAME_PLAYER_TILE2_OFFSETS[counter][0],
+                                TI_RENDER_GAME_PLAYER_TILE2_OFFSETS[counter][1],
+                                TI_RENDER_GAME_PLAYER_TILE2_OFFSETS[counter][2],
+                                TI_RENDER_GAME_PLAYER_TILE2_OFFSETS[counter][3]);
             }
         }
         data->refreshPlayerTiles = TI_FALSE;
@@ -2071,11 +2453,11 @@ void renderInGameScreen(TiScreen *display, TiAssets *a, TiSharedData *data)
                                          a->stationStatus, display->screen);
                     }
                 }
-                SDL_UpdateRect(display->screen,
-                               TI_RENDER_GAME_PLAYER_STATIONS_OFFSETS[counter][0],
-                               TI_RENDER_GAME_PLAYER_STATIONS_OFFSETS[counter][1],
-                               TI_RENDER_GAME_PLAYER_STATIONS_OFFSETS[counter][2],
-                               TI_RENDER_GAME_PLAYER_STATIONS_OFFSETS[counter][3]);
+                renderMarkDirty(display,
+                                TI_RENDER_GAME_PLAYER_STATIONS_OFFSETS[counter][0],
+                                TI_RENDER_GAME_PLAYER_STATIONS_OFFSETS[counter][1],
+                                TI_RENDER_GAME_PLAYER_STATIONS_OFFSETS[counter][2],
+                                TI_RENDER_GAME_PLAYER_STATIONS_OFFSETS[counter][3]);
             }
         }//
         /* Mark the finished/unfinished stations for each player */
@@ -2094,11 +2476,9 @@ void renderInGameScreen(TiScreen *display, TiAssets *a, TiSharedData *data)
         data->refreshPlayerScores = TI_FALSE;
     }
 
-    if(data->restoreBoardArea == TI_TRUE && data->boardAreaBacking != NULL)
+    if(data->restoreBoardArea == TI_TRUE)
     {
-        renderRestoreBoardBacking(display, a, data, TI_TRUE);
-        SDL_FreeSurface(data->boardAreaBacking);
-        data->boardAreaBacking = NULL;
+        renderRestoreBoardArea(display, a, data);
         data->restoreBoardArea = TI_FALSE;
     }
 
@@ -2110,23 +2490,17 @@ void renderInGameScreen(TiScreen *display, TiAssets *a, TiSharedData *data)
 
     if(data->refreshTrackOverlays == TI_TRUE)
     {
-        renderTrackOverlays(display, a, data);
+        renderUpdateBoardLayer(display, a, data);
         data->refreshTrackOverlays = TI_FALSE;
     }
 
     if(data->drawTileOnBoard == TI_TRUE)
     {
-        /* 'Undraw' the last player's move if the 'Last Player' option was selected */
-        renderUndrawPreviousMove(display, a, data);
-        /* 'Undraw' the current player's move */
-        renderDrawTile(display, a, data , g->players[g->curPlayer].lastMoveX,
-                       g->players[g->curPlayer].lastMoveY,
-                       g->board->b[g->players[g->curPlayer].lastMoveX][g->players[g->curPlayer].lastMoveY].tileIndex);
         g->players[g->curPlayer].lastMoveX = g->selectedMoveTileX;
         g->players[g->curPlayer].lastMoveY = g->selectedMoveTileY;
-        renderDrawTileOnBoard(display, a, data);
+        data->lastMovePlayer = g->curPlayer;
+        renderUpdateBoardLayer(display, a, data);
         data->drawTileOnBoard = TI_FALSE;
-        renderLastMoves(display, a, data);
         /* This shouldn't be here.  There's no event to latch to that otherwise signals this state change */
         g->selectedMoveTileX = -1;
         g->selectedMoveTileY = -1;
@@ -2136,31 +2510,6 @@ void renderInGameScreen(TiScreen *display, TiAssets *a, TiSharedData *data)
 
 }
 
-void renderUndrawPreviousMove(TiScreen *display, TiAssets *a, TiSharedData *data)
-{
-    int lastPlayer;
-    Game *g;
-
-    g = gameGetGlobalGameInstance();
-
-   /* 'Undraw' the last player's move if the user has set 'Show Player moves' to 'Last Player' */
-   if(g->showLastMove == TI_GAME_OPTIONS_LAST_PLAYER)
-   {
-       lastPlayer = g->curPlayer - 1;
-       if(lastPlayer < 0)
-       {
-           lastPlayer = g->numPlayers -1;
-       }
-
-       if(g->players[lastPlayer].lastMoveX != TI_PLAYER_INVALID_LAST_MOVE &&
-          g->players[lastPlayer].lastMoveY != TI_PLAYER_INVALID_LAST_MOVE)
-       {
-          renderDrawTile(display, a, data , g->players[lastPlayer].lastMoveX,
-                         g->players[lastPlayer].lastMoveY,
-                         g->board->b[g->players[lastPlayer].lastMoveX][g->players[lastPlayer].lastMoveY].tileIndex);
-       }
-   }
-}
 /****************************************************************************
 * renderTransitionSurface - see tiRenderSDL.h for description
 ****************************************************************************/
@@ -2168,70 +2517,193 @@ void renderTransitionSurface(TiScreen *display, TiSharedData *data,
                              SDL_Surface *surf, int x, int y, int w, int h,
                              int fromLeft)
 {
-    float *xVals;
-    float *accels;
-    int   *finished;
+    TiTransition *t;
+    int counter;
+    float minSpeed = TI_RENDER_TRANSITION_MIN_SPEED;
+    float maxSpeed = TI_RENDER_TRANSITION_MAX_SPEED;
 
-    int counter, counter2, numFinished;
-    float minAccel = TI_RENDER_TRANSITION_MIN_ACCEL;
-    float maxAccel = TI_RENDER_TRANSITION_MAX_ACCEL;
+    t = NULL;
+    for(counter=0;counter<TI_RENDER_MAX_TRANSITIONS;counter++)
+    {
+        if(display->transitions[counter].active == TI_FALSE)
+        {
+            t = &(display->transitions[counter]);
+            break;
+        }
+    }
+    if(t == NULL)
+    {
+        renderFinishTransitions(display);
+        t = &(display->transitions[0]);
+    }
 
-    xVals = malloc(h * sizeof(float));
-    accels = malloc(h * sizeof(float));
-    finished = malloc(h * sizeof(int));
+    /* The buffers are made the first time they're needed, and kept */
+    if(t->from == NULL)
+    {
+        t->from = display->backend->createSurface(display->backend, 
+                                                  display->xRes, display->yRes);
+    }
+    if(t->to == NULL)
+    {
+        t->to = display->backend->createSurface(display->backend, 
+                                                display->xRes, display->yRes);
+    }
 
-    if(xVals == NULL || accels == NULL || finished == NULL)
+    if(x < 0 || y < 0 || x + w > display->xRes || y + h > display->yRes ||
+       t->from == NULL || t->to == NULL)
     {
-        perror("Out of memory!\n");
-        exit(-1);
+        /* Can't slide it, so just draw it */
+        renderBlitSurface(0, 0, x, y, w, h, surf, display->screen);
+        renderMarkDirty(display, x, y, w, h);
+        return;
     }
 
     /* Speed things up on larger dialog boxes */
     if(w > 500 || h > 200)
     {
-        minAccel *= 3.0;
-        maxAccel *= 3.0;
+        minSpeed *= 3.0;
+        maxSpeed *= 3.0;
     }
 
-    numFinished=0;
-
+    renderBlitSurface(x, y, 0, 0, w, h, display->screen, t->from);
     for(counter=0; counter<h; counter++)
     {
-        if(fromLeft == TI_TRUE)
+        t->rowDone[counter] = 0;
+        t->rowSpeed[counter] = rand() * ((maxSpeed - minSpeed) / RAND_MAX) + minSpeed;
+    }
+    t->x = x;
+    t->y = y;
+    t->w = w;
+    t->h = h;
+    t->fromLeft = fromLeft;
+    t->active = TI_TRUE;
+
+    renderBlitSurface(0, 0, x, y, w, h, surf, display->screen);
+    renderMarkDirty(display, x, y, w, h);
+}
+
+/****************************************************************************
+* renderAdvanceTransitions - see tiRenderSDL.h for description
+****************************************************************************/
+void renderAdvanceTransitions(TiScreen *display)
+{
+    TiTransition *t;
+    int counter, counter2, numFinished;
+
+    for(counter=0;counter<TI_RENDER_MAX_TRANSITIONS;counter++)
+    {
+        t = &(display->transitions[counter]);
+        if(t->active == TI_FALSE)
         {
-            xVals[counter] = x;
+            continue;
         }
-        else
+
+        numFinished = 0;
+        for(counter2=0;counter2<t->h;counter2++)
+        {
+            t->rowDone[counter2] += t->rowSpeed[counter2];
+            if(t->rowDone[counter2] >= t->w)
+            {
+                t->rowDone[counter2] = t->w;
+                numFinished++;
+            }
+        }
+        if(numFinished == t->h)
         {
-            xVals[counter] = (x + w - 1);
+            t->active = TI_FALSE;
         }
-        accels[counter] = rand() * ((maxAccel - minAccel) / RAND_MAX) + minAccel;
-        finished[counter] = TI_FALSE;
+        renderMarkDirty(display, t->x, t->y, t->w, t->h);
     }
+}
+
+/****************************************************************************
+* renderFinishTransitions - see tiRenderSDL.h for description
+****************************************************************************/
+void renderFinishTransitions(TiScreen *display)
+{
+    TiTransition *t;
+    int counter;
 
-    while(numFinished < h)
+    /* The screen already holds the finished picture, so it only has to be
+       shown */
+    for(counter=0;counter<TI_RENDER_MAX_TRANSITIONS;counter++)
     {
-        counter2=0;
-        for(counter=0;counter<h;counter++)
+        t = &(display->transitions[counter]);
+        if(t->active == TI_TRUE)
         {
-            if(finished[counter] == TI_FALSE)
-            {
-                renderBlitSurface(xVals[counter]-x, counter, xVals[counter], y + counter,
-                                  accels[counter]+1, 1, surf, display->screen);
-                xVals[counter] = xVals[counter] + accels[counter];
-                if(xVals[counter] >= x+w)
-                {
-                    finished[counter] = TI_TRUE;
-                    numFinished++;
-                }
-            } 
+            t->active = TI_FALSE;
+            renderMarkDirty(display, t->x, t->y, t->w, t->h);
         }
-        SDL_UpdateRect(display->screen, x, y, w, h);
     }
+}
+
+/****************************************************************************
+* renderIsIdle - see tiRenderSDL.h for description
+****************************************************************************/
+int renderIsIdle(TiScreen *display, TiAssets *a, TiSharedData *data)
+{
+    Game *g;
+
+    g = gameGetGlobalGameInstance();
+
+    if(renderTransitionsActive(display) == TI_TRUE ||
+       assetCacheLoaderBusy(a->cache) == TI_TRUE)
+    {
+        return TI_FALSE;
+    }
+
+    /* The title screens all have trains running across them, and the logo
+       screen moves on by itself */
+    if(data->renderState != TI_STATE_IN_GAME || data->loadingAssets == TI_TRUE)
+    {
+        return TI_FALSE;
+    }
+
+    /* The new state's dialog hasn't been drawn yet */
+    if(g->gameStateChanged == TI_TRUE)
+    {
+        return TI_FALSE;
+    }
+
+    switch(g->gameState)
+    {
+        case TI_GAME_STATE_SELECT_ACTION:
+        case TI_GAME_STATE_TILE_SELECT:
+            /* The computer players think ahead while a human player 
+               decides, so wait for them to run out of things to think 
+               about first */
+            if(data->ponderFinished == TI_FALSE ||
+               data->ponderPlayer != g->curPlayer ||
+               data->ponderTilesLeft != g->tilepool->numUnplayedTiles ||
+               data->ponderBoardHash != boardCalculateHash(g->board))
+            {
+                return TI_FALSE;
+            }
+            return TI_TRUE;
+        case TI_GAME_STATE_TILE_DRAW:
+        case TI_GAME_STATE_GAME_FINISHED:
+        case TI_GAME_STATE_CONFIRM_EXIT:
+            return TI_TRUE;
+        default:
+            return TI_FALSE;
+    }
+}
+
+/****************************************************************************
+* renderTransitionsActive - see tiRenderSDL.h for description
+****************************************************************************/
+int renderTransitionsActive(TiScreen *display)
+{
+    int counter;
 
-    free(xVals);
-    free(accels);
-    free(finished);
+    for(counter=0;counter<TI_RENDER_MAX_TRANSITIONS;counter++)
+    {
+        if(display->transitions[counter].active == TI_TRUE)
+        {
+            return TI_TRUE;
+        }
+    }
+    return TI_FALSE;
 }
 
 /****************************************************************************
@@ -2247,7 +2719,7 @@ void renderRestoreDisplayBacking(TiScreen *display, TiAssets *a,
                                 data->dialogBackingX, data->dialogBackingY,
                                 data->dialogBackingW, data->dialogBackingH,
                                 TI_TRUE);
-        SDL_FreeSurface(data->dialogBacking);
+        surfacePoolRelease(data->surfacePool, data->dialogBacking);
         data->dialogBacking = NULL;
     }
 }
@@ -2259,36 +2731,22 @@ int renderDisplayDialog(TiScreen *display, SDL_Surface *dialog, TiSharedData *da
                          int x, int y, int w, int h)
 {
 
-    Uint32 rmask, gmask, bmask, amask;
-
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-    rmask = 0xff000000;
-    gmask = 0x00ff0000;
-    bmask = 0x0000ff00;
-    amask = 0x00000000;
-#else
-    rmask = 0x000000ff;
-    gmask = 0x0000ff00;
-    bmask = 0x00ff0000;
-    amask = 0x00000000;
-#endif
 
     if(data->dialogBacking != NULL)
     {
-        SDL_FreeSurface(data->dialogBacking);
+        surfacePoolRelease(data->surfacePool, data->dialogBacking);
         data->dialogBacking = NULL;
     }
 
     /* Grab the contents behind the dialog */
-    data->dialogBacking = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 32,
-                                               rmask, gmask, bmask, amask);
+    data->dialogBacking = surfacePoolAcquire(data->surfacePool, w, h, 
+                                             display->screen->format);
     if(data->dialogBacking == NULL)
     {
         return TI_ERROR;
     }
 
     renderBlitSurface(x, y, 0, 0, w, h, display->screen, data->dialogBacking);
-    SDL_UpdateRect(data->dialogBacking, 0, 0, w, h);
 
     /* Blit the dialog to the screen */
     renderTransitionSurface(display, data, dialog, x, y, w, h, TI_TRUE);
@@ -2308,41 +2766,13 @@ void renderDrawDarkenMasks(TiScreen *display, TiAssets *a, TiSharedData *data)
 {
     Game *g;
     int  counter, counter2;
-    Uint32 rmask, gmask, bmask, amask;
-
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-    rmask = 0xff000000;
-    gmask = 0x00ff0000;
-    bmask = 0x0000ff00;
-    amask = 0x00000000;
-#else
-    rmask = 0x000000ff;
-    gmask = 0x0000ff00;
-    bmask = 0x00ff0000;
-    amask = 0x00000000;
-#endif
 
     g = gameGetGlobalGameInstance();
 
     if(data->drawDarkenMask == TI_TRUE)
     {
-        if(data->boardAreaBacking != NULL)
-        {
-            SDL_FreeSurface(data->boardAreaBacking);
-        }
-        data->boardAreaBacking = SDL_CreateRGBSurface(SDL_SWSURFACE, TI_RENDER_BOARD_AREA_WIDTH, 
-                                                      TI_RENDER_BOARD_AREA_HEIGHT, 32,
-                                                      rmask, gmask, bmask, amask);
-        if(data->boardAreaBacking == NULL)
-        {
-            perror("Unable to allocated surface!");
-            exit(0);
-        }
-
-        renderBlitSurface(TI_RENDER_BOARD_AREA_X, TI_RENDER_BOARD_AREA_Y, 0, 0,
-                          TI_RENDER_BOARD_AREA_WIDTH, TI_RENDER_BOARD_AREA_HEIGHT,
-                          display->screen, data->boardAreaBacking);
-        /* Now blit the darkening mask */
+        /* Nothing needs saving first; renderRestoreBoardArea can put the 
+           board back together from the board layer */
         renderBlitSurface(0, 0, TI_RENDER_BOARD_AREA_X, TI_RENDER_BOARD_AREA_Y,
                           TI_RENDER_BOARD_AREA_WIDTH, TI_RENDER_BOARD_AREA_HEIGHT,
                           a->darkenMask, display->screen);
@@ -2350,9 +2780,9 @@ void renderDrawDarkenMasks(TiScreen *display, TiAssets *a, TiSharedData *data)
            move masks are not to be redrawn */
         if(data->drawValidMoveMasks != TI_TRUE)
         {
-            SDL_UpdateRect(display->screen,
-                           TI_RENDER_BOARD_AREA_X, TI_RENDER_BOARD_AREA_Y,
-                           TI_RENDER_BOARD_AREA_WIDTH, TI_RENDER_BOARD_AREA_HEIGHT);
+            renderMarkDirty(display,
+                            TI_RENDER_BOARD_AREA_X, TI_RENDER_BOARD_AREA_Y,
+                            TI_RENDER_BOARD_AREA_WIDTH, TI_RENDER_BOARD_AREA_HEIGHT);
             data->drawDarkenMask = TI_FALSE;
         }
     }
@@ -2378,9 +2808,9 @@ void renderDrawDarkenMasks(TiScreen *display, TiAssets *a, TiSharedData *data)
                     }
                 }
             }
-            SDL_UpdateRect(display->screen,
-                           TI_RENDER_BOARD_AREA_X, TI_RENDER_BOARD_AREA_Y,
-                           TI_RENDER_BOARD_AREA_WIDTH, TI_RENDER_BOARD_AREA_HEIGHT);
+            renderMarkDirty(display,
+                            TI_RENDER_BOARD_AREA_X, TI_RENDER_BOARD_AREA_Y,
+                            TI_RENDER_BOARD_AREA_WIDTH, TI_RENDER_BOARD_AREA_HEIGHT);
             data->drawValidMoveMasks = TI_FALSE;
         }
     }
@@ -2396,11 +2826,11 @@ void renderDrawPlayCancelButton(TiScreen *display, TiAssets *a, TiSharedData *da
                       TI_RENDER_PLAY_CANCEL_BUTTON_MAX_X - TI_RENDER_PLAY_CANCEL_BUTTON_MIN_X,
                       TI_RENDER_PLAY_CANCEL_BUTTON_MAX_Y - TI_RENDER_PLAY_CANCEL_BUTTON_MIN_Y,
                       a->cancelPlayTileButton, display->screen);
-    SDL_UpdateRect(display->screen,
-                   TI_RENDER_PLAY_CANCEL_BUTTON_MIN_X,
-                   TI_RENDER_PLAY_CANCEL_BUTTON_MIN_Y,
-                   TI_RENDER_PLAY_CANCEL_BUTTON_MAX_X - TI_RENDER_PLAY_CANCEL_BUTTON_MIN_X,
-                   TI_RENDER_PLAY_CANCEL_BUTTON_MAX_Y - TI_RENDER_PLAY_CANCEL_BUTTON_MIN_Y);
+    renderMarkDirty(display,
+                    TI_RENDER_PLAY_CANCEL_BUTTON_MIN_X,
+                    TI_RENDER_PLAY_CANCEL_BUTTON_MIN_Y,
+                    TI_RENDER_PLAY_CANCEL_BUTTON_MAX_X - TI_RENDER_PLAY_CANCEL_BUTTON_MIN_X,
+                    TI_RENDER_PLAY_CANCEL_BUTTON_MAX_Y - TI_RENDER_PLAY_CANCEL_BUTTON_MIN_Y);
 }
 
 /****************************************************************************
@@ -2426,15 +2856,11 @@ void renderDrawGameStateSpecificDialogs(TiScreen *display, TiAssets *a,
     renderRestoreDisplayBacking(display, a, data);
 
     /* Holy crap!  This is an ugly hack.  if restoring the backing from a 'discard' operation,
-       and if the user is in 'Last Player' mode, delete all player highlights */
+       and if the user is in 'Last Player' mode, delete all player highlights.  They
+       come off the board when the track overlays are refreshed below. */
     if(g->deleteLastPlayerHighlight == TI_TRUE && g->showLastMove == TI_GAME_OPTIONS_LAST_PLAYER)
     {
-        for(counter=0;counter<g->numPlayers;counter++)
-        {
-            renderDrawTile(display, a, data , g->players[counter].lastMoveX,
-                           g->players[counter].lastMoveY,
-                           g->board->b[g->players[counter].lastMoveX][g->players[counter].lastMoveY].tileIndex);
-        }
+        data->lastMovePlayer = TI_RENDER_NO_LAST_MOVE_PLAYER;
         g->deleteLastPlayerHighlight = TI_FALSE;
     }
 
@@ -2503,11 +2929,11 @@ void renderDrawGameStateSpecificDialogs(TiScreen *display, TiAssets *a,
                                       TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PLAY][2],
                                       TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PLAY][3],
                                       a->selectPlayActive, display->screen);
-                    SDL_UpdateRect(display->screen, 
-                                   TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PLAY][0],
-                                   TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PLAY][1],
-                                   TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PLAY][2],
-                                   TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PLAY][3]);
+                    renderMarkDirty(display, 
+                                    TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PLAY][0],
+                                    TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PLAY][1],
+                                    TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PLAY][2],
+                                    TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PLAY][3]);
                     g->playIsValid = TI_TRUE;
                 }
             }
@@ -2523,11 +2949,11 @@ void renderDrawGameStateSpecificDialogs(TiScreen *display, TiAssets *a,
                                   TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DRAW][2],
                                   TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DRAW][3],
                                   a->selectDrawActive, display->screen);
-                SDL_UpdateRect(display->screen, 
-                               TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DRAW][0],
-                               TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DRAW][1],
-                               TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DRAW][2],
-                               TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DRAW][3]);
+                renderMarkDirty(display, 
+                                TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DRAW][0],
+                                TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DRAW][1],
+                                TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DRAW][2],
+                                TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DRAW][3]);
                 g->drawIsValid = TI_TRUE;
             }
             else 
@@ -2543,11 +2969,11 @@ void renderDrawGameStateSpecificDialogs(TiScreen *display, TiAssets *a,
                                   TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DISCARD][2],
                                   TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DISCARD][3],
                                   a->selectDiscardActive, display->screen);
-                SDL_UpdateRect(display->screen, 
-                               TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DISCARD][0],
-                               TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DISCARD][1],
-                               TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DISCARD][2],
-                               TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DISCARD][3]);
+                renderMarkDirty(display, 
+                                TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DISCARD][0],
+                                TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DISCARD][1],
+                                TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DISCARD][2],
+                                TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_DISCARD][3]);
                 g->discardIsValid = TI_TRUE;
             }
             else 
@@ -2562,11 +2988,11 @@ void renderDrawGameStateSpecificDialogs(TiScreen *display, TiAssets *a,
                               TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PASS][2],
                               TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PASS][3],
                               a->selectPassActive, display->screen);
-            SDL_UpdateRect(display->screen, 
-                           TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PASS][0],
-                           TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PASS][1],
-                           TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PASS][2],
-                           TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PASS][3]);
+            renderMarkDirty(display, 
+                            TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PASS][0],
+                            TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PASS][1],
+                            TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PASS][2],
+                            TI_RENDER_GAME_SELECT_ACTION_TEXT_OFFSETS[TI_OFFSET_PASS][3]);
             g->passIsValid = TI_TRUE;
 
             break;
@@ -2588,11 +3014,11 @@ void renderDrawGameStateSpecificDialogs(TiScreen *display, TiAssets *a,
                                   TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[counter][2],
                                   TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[counter][3],
                                   a->tileStripLarge, display->screen);
-                SDL_UpdateRect(display->screen, 
-                               TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[counter][0],
-                               TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[counter][1],
-                               TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[counter][2],
-                               TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[counter][3]);
+                renderMarkDirty(display, 
+                                TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[counter][0],
+                                TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[counter][1],
+                                TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[counter][2],
+                                TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[counter][3]);
             }
             break;
         case TI_GAME_STATE_TILE_SELECT:
@@ -2679,11 +3105,11 @@ void renderDrawGameStateDynamicElements(TiScreen *display, TiAssets *a,
                                   TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->prevDrawTileHighlighted][2],
                                   TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->prevDrawTileHighlighted][3],
                                   a->tileStripLarge, display->screen);
-                SDL_UpdateRect(display->screen, 
-                               TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->prevDrawTileHighlighted][0] - TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET,
-                               TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->prevDrawTileHighlighted][1] - TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET,
-                               TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->prevDrawTileHighlighted][2] + (2*TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET),
-                               TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->prevDrawTileHighlighted][3] + (2*TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET));
+                renderMarkDirty(display, 
+                                TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->prevDrawTileHighlighted][0] - TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET,
+                                TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->prevDrawTileHighlighted][1] - TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET,
+                                TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->prevDrawTileHighlighted][2] + (2*TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET),
+                                TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->prevDrawTileHighlighted][3] + (2*TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET));
 
                 /* Draw the highlight around the new tile */
                 renderBlitSurface(0,0, TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->drawTileHighlighted][0] - TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET,
@@ -2691,11 +3117,11 @@ void renderDrawGameStateDynamicElements(TiScreen *display, TiAssets *a,
                                   TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->drawTileHighlighted][2] + (2*TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET),
                                   TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->drawTileHighlighted][3] + (2*TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET),
                                   a->drawTileHighlightLarge, display->screen);
-                SDL_UpdateRect(display->screen, 
-                               TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->drawTileHighlighted][0] - TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET,
-                               TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->drawTileHighlighted][1] - TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET,
-                               TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->drawTileHighlighted][2] + (2*TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET),
-                               TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->drawTileHighlighted][3] + (2*TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET));
+                renderMarkDirty(display, 
+                                TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->drawTileHighlighted][0] - TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET,
+                                TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->drawTileHighlighted][1] - TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET,
+                                TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->drawTileHighlighted][2] + (2*TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET),
+                                TI_RENDER_GAME_DRAW_TILE_TILE_OFFSETS[data->drawTileHighlighted][3] + (2*TI_RENDER_LARGE_TILE_HIGHLIGHT_OFFSET));
                 data->refreshDrawTileHighlighted = TI_FALSE;
             }
             break;
@@ -2711,70 +3137,62 @@ void renderDrawGameStateDynamicElements(TiScreen *display, TiAssets *a,
 ****************************************************************************/
 void renderResultsScoreDigits(TiScreen *display, TiAssets *a, TiSharedData *data, int rank, int score)
 {
-    int blitX;
-    int blitY;
-    int numDigits;
-    int digit;
-    int counter, offset;
+    TiScoreString *cached;
     SDL_Surface *digitSurface;
-    int tmpScore;
-
-    if(rank == 0)
-    {
-        digitSurface = a->resultsLargeDigits;
-    }
-    else
-    {
-        digitSurface = a->resultsSmallDigits;
-    }
-
-    /* Start with the most significant digit, and work toward the least */
-    blitX = TI_RENDER_GAME_RESULTS_SCORE_OFFSETS[rank][0];
-    blitY = TI_RENDER_GAME_RESULTS_SCORE_OFFSETS[rank][1];
-
-    tmpScore = score;
+    int digitOffset, digitHeight, spacing;
+    int *digitWidths;
 
     /* The score should never be this high.  If it is, just don't draw it */
-    if(tmpScore > 9999)
+    if(score > TI_RENDER_MAX_SCORE)
     {
         return;
     }
-    else if(tmpScore > 999 && tmpScore <= 9999)
-    {
-        numDigits = 4;
-    }
-    else if(tmpScore > 99 && tmpScore <= 999)
-    {
-        numDigits = 3;
-    }
-    else if(tmpScore > 9 && tmpScore <= 99)
+
+    /* The winner's score is drawn bigger than everybody else's */
+    if(rank == 0)
     {
-        numDigits = 2;
+        digitSurface = a->resultsLargeDigits;
+        digitOffset = TI_RENDER_GAME_RESULTS_LARGE_DIGIT_OFFSET;
+        digitWidths = TI_RENDER_GAME_RESULTS_LARGE_DIGIT_WIDTHS;
+        digitHeight = TI_RENDER_GAME_RESULTS_LARGE_DIGIT_HEIGHT;
+        spacing = TI_RENDER_GAME_RESULTS_LARGE_DIGIT_SPACING;
     }
     else
     {
-        numDigits = 1;
+        digitSurface = a->resultsSmallDigits;
+        digitOffset = TI_RENDER_GAME_RESULTS_SMALL_DIGIT_OFFSET;
+        digitWidths = TI_RENDER_GAME_RESULTS_SMALL_DIGIT_WIDTHS;
+        digitHeight = TI_RENDER_GAME_RESULTS_SMALL_DIGIT_HEIGHT;
+        spacing = TI_RENDER_GAME_RESULTS_SMALL_DIGIT_SPACING;
     }
 
-    for(counter=numDigits-1;counter>=0;counter--)
+    /* Only redraw the digits if the score for this rank has changed.  The
+       digits go over the results screen background, so the surface is 
+       transparent wherever they don't cover it. */
+    cached = &data->resultsScores[rank];
+    if(cached->surface == NULL)
     {
-        digit = tmpScore / pow(10, counter);
-        tmpScore = tmpScore - (digit * pow(10, counter));
-        if(rank == 0)
-        {
-            offset = digit * TI_RENDER_GAME_RESULTS_LARGE_DIGIT_OFFSET ;
-            renderBlitSurface(offset, 0, blitX, blitY, TI_RENDER_GAME_RESULTS_LARGE_DIGIT_WIDTHS[digit],
-                              TI_RENDER_GAME_RESULTS_LARGE_DIGIT_HEIGHT, digitSurface, display->screen);
-            blitX += (TI_RENDER_GAME_RESULTS_LARGE_DIGIT_WIDTHS[digit] + TI_RENDER_GAME_RESULTS_LARGE_DIGIT_SPACING);
-        }
-        else
+        cached->surface = renderCreateScoreSurface(display, 
+                                                   TI_RENDER_MAX_SCORE_DIGITS * digitOffset,
+                                                   digitHeight, TI_TRUE);
+        if(cached->surface == NULL)
         {
-            offset = digit * TI_RENDER_GAME_RESULTS_SMALL_DIGIT_OFFSET ;
-            renderBlitSurface(offset, 0, blitX, blitY, TI_RENDER_GAME_RESULTS_SMALL_DIGIT_WIDTHS[digit],
-                              TI_RENDER_GAME_RESULTS_SMALL_DIGIT_HEIGHT, digitSurface, display->screen);
-            blitX += (TI_RENDER_GAME_RESULTS_SMALL_DIGIT_WIDTHS[digit] + TI_RENDER_GAME_RESULTS_SMALL_DIGIT_SPACING);
+            return;
         }
     }
+    if(cached->value != score)
+    {
+        display->backend->fill(display->backend, cached->surface, NULL, 
+                               cached->surface->format->colorkey);
+        cached->width = renderDrawScoreDigits(cached->surface, digitSurface, score,
+                                              digitOffset, digitWidths, digitHeight,
+                                              spacing);
+        cached->value = score;
+    }
+
+    renderBlitSurface(0, 0, TI_RENDER_GAME_RESULTS_SCORE_OFFSETS[rank][0],
+                      TI_RENDER_GAME_RESULTS_SCORE_OFFSETS[rank][1],
+                      cached->width, digitHeight, cached->surface, display->screen);
 }
 
 /****************************************************************************
@@ -2855,7 +3273,7 @@ void renderResultsScreen(TiScreen *display, TiAssets *a, TiSharedData *data)
         /* Scores */
         renderResultsScores(display, a, data);
 
-        SDL_UpdateRect(display->screen, 0, 0, 0, 0);
+        renderMarkDirty(display, 0, 0, 0, 0);
         data->refreshBG = TI_FALSE;
     }
 
@@ -2868,13 +3286,18 @@ void renderResultsScreen(TiScreen *display, TiAssets *a, TiSharedData *data)
 ****************************************************************************/
 void renderUpdateScreen(TiScreen *display, TiAssets *a, TiSharedData *data)
 {
+    /* Pick up anything the background loader has finished */
+    TI_PROFILE_BEGIN(TI_PROFILE_ASSETS);
+    assetCacheCollect(a->cache);
+    TI_PROFILE_END(TI_PROFILE_ASSETS);
+
     switch(data->renderState)
     {
         case TI_STATE_COMPANY_LOGO:
             if(data->refreshBG == TI_TRUE)
             {
                 renderApplySurface(0,0, a->logoScreenBG, display->screen);
-                SDL_UpdateRect(display->screen, 0, 0, 0, 0);
+                renderMarkDirty(display, 0, 0, 0, 0);
                 data->refreshBG = TI_FALSE;
             }
             break;
@@ -2889,7 +3312,7 @@ void renderUpdateScreen(TiScreen *display, TiAssets *a, TiSharedData *data)
                 renderBlitSurface(0,0,TI_RENDER_TAP_MSG_X, TI_RENDER_TAP_MSG_Y,
                                 TI_RENDER_TAP_MSG_WIDTH, TI_RENDER_TAP_MSG_HEIGHT,
                                 a->tapScreenMsg, display->screen);
-                SDL_UpdateRect(display->screen, TI_RENDER_TAP_MSG_X, TI_RENDER_TAP_MSG_Y,
+                renderMarkDirty(display, TI_RENDER_TAP_MSG_X, TI_RENDER_TAP_MSG_Y,
                             TI_RENDER_TAP_MSG_WIDTH, TI_RENDER_TAP_MSG_HEIGHT);
             }
             if((data->numFrames % TI_RENDER_FRAME_RATE) >= TI_RENDER_TAP_MSG_FRAME_HIDDEN &&
@@ -2899,7 +3322,7 @@ void renderUpdateScreen(TiScreen *display, TiAssets *a, TiSharedData *data)
                                 TI_RENDER_TAP_MSG_X, TI_RENDER_TAP_MSG_Y,
                                 TI_RENDER_TAP_MSG_WIDTH, TI_RENDER_TAP_MSG_HEIGHT,
                                 a->titleScreenBG, display->screen);
-                SDL_UpdateRect(display->screen, TI_RENDER_TAP_MSG_X, TI_RENDER_TAP_MSG_Y,
+                renderMarkDirty(display, TI_RENDER_TAP_MSG_X, TI_RENDER_TAP_MSG_Y,
                                 TI_RENDER_TAP_MSG_WIDTH, TI_RENDER_TAP_MSG_HEIGHT);
             }
             break;
@@ -2910,7 +3333,7 @@ void renderUpdateScreen(TiScreen *display, TiAssets *a, TiSharedData *data)
             renderBlitSurface(0, 0, TI_RENDER_TITLE_MENU_X, TI_RENDER_TITLE_MENU_Y,
                             TI_RENDER_TITLE_MENU_WIDTH, TI_RENDER_TITLE_MENU_HEIGHT,
                             a->titleMenu, display->screen);
-            SDL_UpdateRect(display->screen, TI_RENDER_TITLE_MENU_X, TI_RENDER_TITLE_MENU_Y,
+            renderMarkDirty(display, TI_RENDER_TITLE_MENU_X, TI_RENDER_TITLE_MENU_Y,
                         TI_RENDER_TITLE_MENU_WIDTH, TI_RENDER_TITLE_MENU_HEIGHT);
             break;
         case TI_STATE_NEW_GAME_SCREEN:
@@ -2923,6 +3346,11 @@ void renderUpdateScreen(TiScreen *display, TiAssets *a, TiSharedData *data)
             renderOptionsScreenExtras(display, a, data);
             break;
         case TI_STATE_IN_GAME:
+            if(data->loadingAssets == TI_TRUE)
+            {
+                renderUpdateLoading(display, a, data);
+                break;
+            }
             renderInGameScreen(display, a, data);
             renderDrawGameStateSpecificDialogs(display, a, data);
             renderDrawGameStateDynamicElements(display, a, data);
@@ -2936,6 +3364,10 @@ void renderUpdateScreen(TiScreen *display, TiAssets *a, TiSharedData *data)
             perror("renderUpdateScreen: unknown state");
             break;
     }
+
+    TI_PROFILE_DRAW_HUD(display);
+    renderFlushDirty(display);
+    TI_PROFILE_ERASE_HUD(display);
 }
 
 /****************************************************************************
@@ -2960,7 +3392,7 @@ void renderProcessInGameEvents(TiScreen *display, TiAssets *assets, TiSharedData
     {
        if(g->gameState == TI_GAME_STATE_TILE_SELECT)
        {
-            renderRestoreBoardBacking(display, assets, data, TI_FALSE);
+            renderRestoreBoardArea(display, assets, data);
        }
        gameSetGameState(g, TI_GAME_STATE_CONFIRM_EXIT);
     }
@@ -3021,7 +3453,8 @@ void renderProcessInGameEvents(TiScreen *display, TiAssets *assets, TiSharedData
             {
                 if(g->passIsValid == TI_TRUE)
                 {
-                    renderUndrawPreviousMove(display, assets, data);
+                    /* The previous player's move isn't the last one any more */
+                    data->lastMovePlayer = TI_RENDER_NO_LAST_MOVE_PLAYER;
                     gameSetGameState(g, TI_GAME_STATE_END_TURN);
                 }
                 else
@@ -3068,6 +3501,8 @@ void renderProcessInGameEvents(TiScreen *display, TiAssets *assets, TiSharedData
                     g->selectedMoveIsReserveTile = TI_TRUE;
                     g->selectedMoveTileId = g->players[g->curPlayer].reserveTileId;
                 }
+                recordAddEvent(CurrentRecord, TI_RECORD_EVENT_DRAW, g->selectedMoveIsReserveTile,
+                               g->selectedMoveTileId);
                 data->drawTileHighlighted = 0;
                 data->prevDrawTileHighlighted = 0;
                 data->refreshDrawTileHighlighted = TI_TRUE;
@@ -3103,7 +3538,7 @@ void renderProcessInGameEvents(TiScreen *display, TiAssets *assets, TiSharedData
                     data->drawDarkenMask = TI_TRUE;
                     data->drawValidMoveMasks = TI_TRUE;
                     boardMarkLegalMoves(g->board, tilePoolGetTile(g->tilepool, g->selectedMoveTileId));
-                    renderRestoreBoardBacking(display, assets, data, TI_FALSE);
+                    renderRestoreBoardArea(display, assets, data);
                     renderDrawDarkenMasks(display, assets, data);
                     renderDrawPlayCancelButton(display, assets, data);
                     renderDrawCurrentTileHighlight(display, assets, data);
@@ -3121,7 +3556,7 @@ void renderProcessInGameEvents(TiScreen *display, TiAssets *assets, TiSharedData
                     data->drawDarkenMask = TI_TRUE;
                     data->drawValidMoveMasks = TI_TRUE;
                     boardMarkLegalMoves(g->board, tilePoolGetTile(g->tilepool, g->selectedMoveTileId));
-                    renderRestoreBoardBacking(display, assets, data, TI_FALSE);
+                    renderRestoreBoardArea(display, assets, data);
                     renderDrawDarkenMasks(display, assets, data);
                     renderDrawPlayCancelButton(display, assets, data);
                     renderDrawCurrentTileHighlight(display, assets, data);
@@ -3174,7 +3609,7 @@ void renderProcessInGameEvents(TiScreen *display, TiAssets *assets, TiSharedData
                yPos >= TI_RENDER_PLAY_CANCEL_BUTTON_MIN_Y && yPos < TI_RENDER_PLAY_CANCEL_BUTTON_MAX_Y)
             {
                 /* Restore everything as it was and go back to the 'select action state' */
-                renderRestoreBoardBacking(display, assets, data, TI_FALSE);
+                renderRestoreBoardArea(display, assets, data);
                 gameSetGameState(g, TI_GAME_STATE_SELECT_ACTION);
             }
             break;
@@ -3218,8 +3653,8 @@ void renderProcessInGameEvents(TiScreen *display, TiAssets *assets, TiSharedData
                     perror("Discard failed!\n");
                     exit(-1);
                 }
-                /* 'Undraw' the last player's move if the 'Last Player' option was selected */
-                renderUndrawPreviousMove(display, assets, data);
+                /* The previous player's move isn't the last one any more */
+                data->lastMovePlayer = TI_RENDER_NO_LAST_MOVE_PLAYER;
                 g->deleteLastPlayerHighlight = TI_TRUE;
                 gameSetGameState(g, TI_GAME_STATE_END_TURN);
             }
@@ -3239,7 +3674,11 @@ void renderProcessInGameEvents(TiScreen *display, TiAssets *assets, TiSharedData
                yPos >= TI_RENDER_GAME_FINISHED_BUTTON_OFFSETS[1] &&
                yPos < TI_RENDER_GAME_FINISHED_BUTTON_OFFSETS[1]+ TI_RENDER_GAME_FINISHED_BUTTON_OFFSETS[3])
             {
-                /* Go to the game results screen */
+                /* Go to the game results screen, with the game as it ended */
+                if(data->replayTurn != TI_RENDER_REPLAY_AT_END)
+                {
+                    renderShowRecordedTurn(data, CurrentRecord->position.turn);
+                }
                 renderSetRenderState(TI_STATE_GAME_RESULTS_SCREEN, data->renderState, display, assets, data);
             }
             break;
@@ -3293,11 +3732,57 @@ void renderProcessEvents(TiScreen *display, TiAssets *assets, TiSharedData *data
     int xPos, yPos, counter;
     Game *g;
 
-    while(SDL_PollEvent(&event))
+    while(renderBackendPollEvent(&event))
     {
+        /* The window was closed (or a headless run's script has ended) */
+        if(event.type == SDL_QUIT)
+        {
+            data->exitGame = TI_TRUE;
+            break;
+        }
+
+#ifdef TI_PROFILE
+        if(event.type == SDL_KEYDOWN && event.key.keysym.sym == TI_PROFILE_HUD_KEY)
+        {
+            profileToggleHud(display);
+            continue;
+        }
+#endif
+
+        /* Go back and forth through a finished game */
+        if(event.type == SDL_KEYDOWN && data->renderState == TI_STATE_IN_GAME && CurrentRecord != NULL)
+        {
+            g = gameGetGlobalGameInstance();
+            if(g->gameState == TI_GAME_STATE_GAME_FINISHED)
+            {
+                counter = (data->replayTurn == TI_RENDER_REPLAY_AT_END) ?
+                          (int)CurrentRecord->position.turn : data->replayTurn;
+                switch(event.key.keysym.sym)
+                {
+                    case TI_RECORD_KEY_BACK:
+                        renderShowRecordedTurn(data, counter - 1);
+                        break;
+                    case TI_RECORD_KEY_FORWARD:
+                        renderShowRecordedTurn(data, counter + 1);
+                        break;
+                    case TI_RECORD_KEY_START:
+                        renderShowRecordedTurn(data, 0);
+                        break;
+                    case TI_RECORD_KEY_END:
+                        renderShowRecordedTurn(data, CurrentRecord->position.turn);
+                        break;
+                    default:
+                        break;
+                }
+                continue;
+            }
+        }
+
         /* Check for mouse clicks */
         if(event.type == SDL_MOUSEBUTTONDOWN)
         {
+            /* Don't make the player wait for anything still sliding in */
+            renderFinishTransitions(display);
             xPos = event.button.x;
             yPos = event.button.y;
             switch(data->renderState)
@@ -3502,7 +3987,10 @@ void renderProcessEvents(TiScreen *display, TiAssets *assets, TiSharedData *data
                     }
                     break;                                             
                 case TI_STATE_IN_GAME:
-                    renderProcessInGameEvents(display, assets, data, &event);
+                    if(data->loadingAssets == TI_FALSE)
+                    {
+                        renderProcessInGameEvents(display, assets, data, &event);
+                    }
                     break;
                 case TI_STATE_GAME_RESULTS_SCREEN:
                         if(xPos >= TI_RENDER_GAME_RESULTS_TO_TITLE_MIN_X &&
@@ -26,6 +26,9 @@
 #define __TIRENDERSDL_H__
 
 #include "tiComputerAI.h"
+#include "tiAssetCache.h"
+#include "tiSurfacePool.h"
+#include "tiRenderBackend.h"
 
 /* Aim for 60 FPS */
 #define TI_RENDER_FRAME_RATE                60
@@ -59,15 +62,43 @@ for each player */
  */
 #define TI_RENDER_NUM_DRAW_TILES_TO_DISPLAY     12
 
-#define TI_RENDER_LOADING_DIALOG_NUM_FILES      31
+#define TI_RENDER_NUM_IN_GAME_IMAGES            32
 
-#ifdef _NOKIA_N800_
-#define TI_RENDER_TRANSITION_MIN_ACCEL          10.0
-#define TI_RENDER_TRANSITION_MAX_ACCEL          15.0
-#else
-#define TI_RENDER_TRANSITION_MIN_ACCEL          2.0
-#define TI_RENDER_TRANSITION_MAX_ACCEL          6.0
-#endif
+/* The most separate rectangles of the screen to update in one frame; past 
+ * this, the whole screen is updated.
+ */
+#define TI_RENDER_MAX_DIRTY_RECTS               64
+
+/* Dialogs slide onto the screen a row at a time, each row moving at its own
+ * speed (in pixels per frame) somewhere between these.  Up to 
+ * TI_RENDER_MAX_TRANSITIONS can be sliding at once.
+ */
+#define TI_RENDER_TRANSITION_MIN_SPEED          15.0
+#define TI_RENDER_TRANSITION_MAX_SPEED          45.0
+#define TI_RENDER_MAX_TRANSITIONS               2
+
+/* The part of the board that tiles can be played on is 8 cells square.
+ * Each cell of the board layer holds a tile, any last move highlights, and
+ * the track overlays running across it; a tile has 8 exits, and each track
+ * can be traced from the stations at both of its ends.
+ */
+#define TI_RENDER_BOARD_CELLS                   (TI_BOARD_WIDTH - 2)
+#define TI_RENDER_MAX_CELL_OVERLAYS             8
+#define TI_RENDER_CELL_UNKNOWN                  -2
+#define TI_RENDER_NO_LAST_MOVE_PLAYER           -1
+
+/* The longest track that will be followed before giving up on it as a loop */
+#define TI_RENDER_MAX_PATH_SEGMENTS             255
+#define TI_RENDER_NO_PATH_END                   -1
+
+/* Scores are drawn with up to 4 digits; anything bigger isn't drawn */
+#define TI_RENDER_MAX_SCORE_DIGITS              4
+#define TI_RENDER_MAX_SCORE                     9999
+#define TI_RENDER_NO_SCORE                      -1
+
+/* Before the player starts going back through a finished game, the game
+   is shown as it ended */
+#define TI_RENDER_REPLAY_AT_END                 -1
 
 /* A list of all of the possible render states for the game.  The items drawn
  * on-screen are dependent on the current render state
@@ -85,6 +116,44 @@ enum
     TI_STATE_END_GAME
 };
 
+/* What's drawn into one cell of the board layer */
+typedef struct
+{
+    int tileIndex;
+    /* One bit for each player whose last move this was */
+    int lastMoves;
+    int numOverlays;
+    int overlayOffset[TI_RENDER_MAX_CELL_OVERLAYS];
+    int overlayPlayer[TI_RENDER_MAX_CELL_OVERLAYS];
+} TiBoardCell;
+
+/* The track overlay segments along the track leaving one station, kept
+ * from one move to the next
+ */
+typedef struct
+{
+    int valid;
+    int player;
+    /* The square the track runs into.  The track can only get longer when
+       a tile is played there. */
+    int endX;
+    int endY;
+    int numSegments;
+    int segmentX[TI_RENDER_MAX_PATH_SEGMENTS];
+    int segmentY[TI_RENDER_MAX_PATH_SEGMENTS];
+    int segmentOffset[TI_RENDER_MAX_PATH_SEGMENTS];
+} TiTrackPath;
+
+/* A score, already drawn with the digits of one of the score styles, so 
+ * that it can be put on the screen with one blit
+ */
+typedef struct
+{
+    int value;
+    int width;
+    SDL_Surface *surface;
+} TiScoreString;
+
 typedef struct
 {
     /* Current part of the game we're executing */
@@ -115,12 +184,31 @@ typedef struct
     int bottomTrainDirection;
     int selectedPlayers;
     int playerState[TI_MAX_PLAYERS];
-    /* Holds the contents of the display behind a dialog */
+    /* Holds the contents of the display behind a dialog (all three are
+       handed out by surfacePool) */
+    TiSurfacePool *surfacePool;
     SDL_Surface *currentPlayerBacking;
     SDL_Surface *currentTileBacking;
     SDL_Surface *dialogBacking;
-    /* Allows the restoration of the board after valid moves have been marked on it */
-    SDL_Surface *boardAreaBacking;
+    /* The tile area of the board with the tiles, last move highlights and
+       track overlays already drawn on it.  boardCells is what each cell of
+       the layer holds, and boardCellsWanted what it should hold; only the
+       cells where the two differ are marked dirty and redrawn. */
+    SDL_Surface *boardLayer;
+    TiBoardCell boardCells[TI_RENDER_BOARD_CELLS][TI_RENDER_BOARD_CELLS];
+    TiBoardCell boardCellsWanted[TI_RENDER_BOARD_CELLS][TI_RENDER_BOARD_CELLS];
+    int boardCellDirty[TI_RENDER_BOARD_CELLS][TI_RENDER_BOARD_CELLS];
+    /* The player whose move is highlighted when only the last player's move
+       is shown */
+    int lastMovePlayer;
+    /* The track leaving each station, as of the last time it changed */
+    TiTrackPath trackPaths[TI_BOARD_NUM_STATIONS];
+    /* Each player's score as drawn in game (on top of the score backing),
+       and the score for each rank on the results screen */
+    TiScoreString gameScores[TI_MAX_PLAYERS];
+    TiScoreString resultsScores[TI_MAX_PLAYERS];
+    /* The turn of the finished game being shown (see renderShowRecordedTurn) */
+    int replayTurn;
 
     int dialogBackingX;
     int dialogBackingY;
@@ -147,19 +235,68 @@ typedef struct
     int restoreBoardArea;
     int drawTileOnBoard;
 
-    /* Progress bar variables */
-    int numFilesLoaded;
+    /* Set while the in-game images are being loaded in the background */
+    int loadingAssets;
+
+    /* The position the computer players last finished thinking ahead on
+       (see renderIsIdle) */
+    int ponderFinished;
+    unsigned int ponderBoardHash;
+    int ponderPlayer;
+    int ponderTilesLeft;
 
     /* Used for computer AI */
     ComputerAIPacket *currentMove;
     ComputerAIPacket *previousMove;
 } TiSharedData;
 
+/* A surface sliding onto the screen.  The screen itself always holds what
+ * it will look like once the slide is done; the part of each row that 
+ * hasn't arrived yet is painted over from 'from' just before the screen is
+ * updated, and put back from 'to' just after.
+ */
 typedef struct
 {
+    int active;
+    int x;
+    int y;
+    int w;
+    int h;
+    int fromLeft;
+    /* How much of each row has arrived, and how fast it's arriving */
+    float rowDone[TI_GAME_YRES];
+    float rowSpeed[TI_GAME_YRES];
+    /* What the area looked like before, and looks like after.  Both are 
+       the size of the screen, and are kept between transitions. */
+    SDL_Surface *from;
+    SDL_Surface *to;
+} TiTransition;
+
+typedef struct
+{
+    /* What draws it, and what it's drawn to (the backend's screen) */
+    TiRenderBackend *backend;
     SDL_Surface *screen;
     int xRes;
     int yRes;
+
+    TiTransition transitions[TI_RENDER_MAX_TRANSITIONS];
+
+    /* Parts of the screen drawn on since the last flush */
+    SDL_Rect dirtyRects[TI_RENDER_MAX_DIRTY_RECTS];
+    int numDirtyRects;
+    int dirtyFullScreen;
+
+    /* Pixels asked to be updated, and actually sent to the display, since
+       the last flush and during the last flush */
+    unsigned long pixelsMarked;
+    unsigned long lastPixelsMarked;
+    unsigned long lastPixelsPushed;
+    int lastRectsPushed;
+    /* Totals over the whole run */
+    unsigned long totalPixelsMarked;
+    unsigned long totalPixelsPushed;
+    unsigned long numFlushes;
 } TiScreen;
 
 typedef struct
@@ -233,8 +370,20 @@ typedef struct
     SDL_Surface *resultsSmallPlayers;
     SDL_Surface *resultsLargePlayers;
 
+    /* Where all of the above come from */
+    TiAssetCache *cache;
+
 } TiAssets;
 
+/* An image file, and where in TiAssets it goes */
+typedef struct
+{
+    size_t offset;
+    char *fileName;
+} TiAssetFile;
+
+extern TiAssetFile TI_RENDER_IN_GAME_IMAGES[TI_RENDER_NUM_IN_GAME_IMAGES];
+
 /****************************************************************************
 * renderSharedDataInitialize
 *
@@ -266,6 +415,24 @@ TiSharedData *renderSharedDataInitialize(void);
 ****************************************************************************/
 int renderSharedDataDestroy(TiSharedData **data);
 
+/****************************************************************************
+* renderReserveSurfaces
+*
+* Description:
+*   Makes the surfaces used to save the screen behind dialogs and the 
+*   player and tile highlights, so that showing them doesn't have to.
+*   Must be called after the video mode is set.
+*
+* Arguments:
+*   TiScreen *display  - the display
+*   TiSharedData *data - the shared data structure that holds the pool
+*
+* Returns:
+*   Nothing.  Any size that couldn't be made is made when it's needed.
+*
+****************************************************************************/
+void renderReserveSurfaces(TiScreen *display, TiSharedData *data);
+
 /****************************************************************************
 * renderInitialize
 *
@@ -276,13 +443,14 @@ int renderSharedDataDestroy(TiSharedData **data);
 *   int xRes - the horizontal resolution of the display
 *   int yRes - the vertical resolution of the display
 *   int bpp  - the bit depth of the display
+*   TiRenderBackend *backend - what to draw with (see tiRenderBackend.h)
 *
 * Returns:
 *   A pointer to the display data structure, or NULL if an error was
 *   detected.
 *
 ****************************************************************************/
-TiScreen *renderInitialize(int xRes, int yRes, int bpp);
+TiScreen *renderInitialize(int xRes, int yRes, int bpp, TiRenderBackend *backend);
 
 /****************************************************************************
 * renderDestroy
@@ -315,6 +483,22 @@ void renderDestroy(TiScreen **display);
 ****************************************************************************/
 SDL_Surface *renderLoadImage(char *fileName);
 
+/****************************************************************************
+* renderConvertImage
+*
+* Description:
+*   Converts a freshly decoded image to the display format, with magenta
+*   as the transparent color.  Must be called from the main thread.
+*
+* Arguments:
+*   SDL_Surface *loadedImage - the decoded image (freed by the function)
+*
+* Returns:
+*   A pointer to the converted image, or NULL if an error was detected.
+*
+****************************************************************************/
+SDL_Surface *renderConvertImage(SDL_Surface *loadedImage);
+
 /****************************************************************************
 * renderAssetsInitialize
 *
@@ -331,11 +515,29 @@ SDL_Surface *renderLoadImage(char *fileName);
 ****************************************************************************/
 TiAssets *renderAssetsInitialize(void);
 
+/****************************************************************************
+* renderAssetsDestroy
+*
+* Description:
+*   Frees an TiAssets structure, along with every image in its cache.
+*
+* Arguments:
+*   TiAssets **assets - the structure to free (set to NULL)
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void renderAssetsDestroy(TiAssets **assets);
+
 /****************************************************************************
 * renderLoadAssets
 *
 * Description:
-*   Loads the images and sounds needed for the current render state
+*   Loads the images and sounds needed for the current render state.  Images
+*   that have been loaded before come from the asset cache.  While 
+*   data->loadingAssets is set, the in-game images are left alone, since 
+*   they're still being decoded in the background.
 *
 * Arguments:
 *   TiScreen *display - the screen data
@@ -349,13 +551,50 @@ TiAssets *renderAssetsInitialize(void);
 ****************************************************************************/
 int renderLoadAssets(TiScreen *display, TiAssets *assets, TiSharedData *data);
 
+/****************************************************************************
+* renderPrefetchInGameAssets
+*
+* Description:
+*   Starts decoding the in-game images in the background, so that they're
+*   ready (or at least partly ready) by the time a game starts.
+*
+* Arguments:
+*   TiAssets *assets - the asset pool
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void renderPrefetchInGameAssets(TiAssets *assets);
+
+/****************************************************************************
+* renderUpdateLoading
+*
+* Description:
+*   Shows the progress of the in-game images being decoded, and once 
+*   they're all done, loads them and clears data->loadingAssets so the game
+*   can start.
+*
+* Arguments:
+*   TiScreen *display - the screen data
+*   TiAssets *assets - the asset pool
+*   TiSharedData *data - the shared data structure
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void renderUpdateLoading(TiScreen *display, TiAssets *assets, TiSharedData *data);
+
 /****************************************************************************
 * renderFreeHelper
 *
 * Description:
-*   If necessary, frees the specified SDL_Surface and sets it to NULL.
+*   If necessary, releases the specified SDL_Surface back to the asset 
+*   cache and sets it to NULL.
 *
 * Arguments:
+*   TiAssets *assets - the asset pool the image was loaded into
 *   SDL_Surface **s - a pointer to a SDL_Surface pointer that points to
 *                     a loaded image.  A pointer to a pointer is used since
 *                     the value of the pointer will be changed by the
@@ -365,22 +604,22 @@ int renderLoadAssets(TiScreen *display, TiAssets *assets, TiSharedData *data);
 *   Nothing.
 *
 ****************************************************************************/
-void renderFreeHelper(SDL_Surface **s);
+void renderFreeHelper(TiAssets *assets, SDL_Surface **s);
 
 /****************************************************************************
 * renderFreeAssets
 *
 * Description:
-*   If necessary, frees the specified SDL_Surface and sets it to NULL.
+*   Releases the images that the current render state doesn't use back to
+*   the asset cache.
 *
 * Arguments:
-*   SDL_Surface **s - a pointer to a SDL_Surface pointer that points to
-*                     a loaded image.  A pointer to a pointer is used since
-*                     the value of the pointer will be changed by the
-*                     function.
+*   TiAssets *assets - the asset pool
+*   TiSharedData *data - the shared data structure that contains the
+*                        current render state.
 *
 * Returns:
-*   Nothing.
+*   TI_OK
 *
 ****************************************************************************/
 int renderFreeAssets(TiAssets *assets, TiSharedData *data);
@@ -427,6 +666,234 @@ void renderSetRenderState(int curState, int prevState, TiScreen *display, TiAsse
 ****************************************************************************/
 void renderCheckTimingConditions(TiScreen *display, TiAssets *assets, TiSharedData *data);
 
+/****************************************************************************
+* renderMarkDirty
+*
+* Description:
+*   Records that part of the screen has been drawn on and needs to be sent
+*   to the display at the next flush.  Takes the same arguments as 
+*   SDL_UpdateRect, including all zeros for the whole screen.  Overlapping
+*   and adjacent rectangles are merged, as long as the merged rectangle 
+*   isn't bigger than the ones it replaces put together.
+*
+* Arguments:
+*   TiScreen *display - the display structure
+*   int x, y          - the top left corner of the area
+*   int w, h          - the size of the area
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void renderMarkDirty(TiScreen *display, int x, int y, int w, int h);
+
+/****************************************************************************
+* renderFlushDirty
+*
+* Description:
+*   Sends every part of the screen marked dirty since the last flush to 
+*   the display with a single SDL_UpdateRects call, and updates the pixel
+*   counters.  Called once a frame from renderUpdateScreen, and by anything
+*   that has to show what it's drawn right away.
+*
+* Arguments:
+*   TiScreen *display - the display structure
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void renderFlushDirty(TiScreen *display);
+
+/****************************************************************************
+* renderTransitionSurface
+*
+* Description:
+*   Draws a surface to the screen, and starts it sliding in over what was 
+*   there before.  Returns straight away; the slide is moved along by 
+*   renderAdvanceTransitions.  Anything drawn on top of the surface 
+*   afterwards slides in along with it.
+*
+* Arguments:
+*   TiScreen *display  - the display structure
+*   TiSharedData *data - the shared data structure
+*   SDL_Surface *surf  - the surface to draw (can be freed right away)
+*   int x, y           - where to draw it
+*   int w, h           - how much of it to draw
+*   int fromLeft       - TI_TRUE to slide in from the left, TI_FALSE for
+*                        the right
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void renderTransitionSurface(TiScreen *display, TiSharedData *data,
+                             SDL_Surface *surf, int x, int y, int w, int h,
+                             int fromLeft);
+
+/****************************************************************************
+* renderAdvanceTransitions
+*
+* Description:
+*   Moves every sliding surface along by one frame.  Called once per fixed
+*   logic step, so slides take the same time however fast the machine is.
+*
+* Arguments:
+*   TiScreen *display - the display structure
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void renderAdvanceTransitions(TiScreen *display);
+
+/****************************************************************************
+* renderFinishTransitions
+*
+* Description:
+*   Cancels every slide in progress, leaving the surfaces where they would
+*   have ended up.
+*
+* Arguments:
+*   TiScreen *display - the display structure
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void renderFinishTransitions(TiScreen *display);
+
+/****************************************************************************
+* renderIsIdle
+*
+* Description:
+*   Checks whether the game is waiting on the player with nothing moving on
+*   the screen, so that the main loop can sleep until there is input.  That 
+*   is only ever the case in game, on a human player's turn, once the 
+*   computer players have finished thinking ahead, with no dialogs sliding
+*   and nothing being loaded.  Everywhere else there's an animation or a 
+*   timer to keep up with.
+*
+* Arguments:
+*   TiScreen *display  - the display
+*   TiAssets *a        - the asset pool
+*   TiSharedData *data - the shared data structure
+*
+* Returns:
+*   TI_TRUE if nothing will change until there is input, TI_FALSE if not.
+*
+****************************************************************************/
+int renderIsIdle(TiScreen *display, TiAssets *a, TiSharedData *data);
+
+/****************************************************************************
+* renderTransitionsActive
+*
+* Description:
+*   Checks whether anything is still sliding.
+*
+* Arguments:
+*   TiScreen *display - the display structure
+*
+* Returns:
+*   TI_TRUE or TI_FALSE
+*
+****************************************************************************/
+int renderTransitionsActive(TiScreen *display);
+
+/****************************************************************************
+* renderUpdateBoardLayer
+*
+* Description:
+*   Works out what each cell of the board layer should hold from the state
+*   of the board, marks the cells that have changed as dirty, and redraws
+*   just those cells, both in the layer and on the screen.  Playing a tile
+*   costs a few cell redraws rather than a redraw of the whole board.
+*
+* Arguments:
+*   TiScreen     *display - the display to draw to
+*   TiAssets     *a - the asset pool to grab images from
+*   TiSharedData *data - the shared data structure
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void renderUpdateBoardLayer(TiScreen *display, TiAssets *a, TiSharedData *data);
+
+/****************************************************************************
+* renderDrawBoardCell
+*
+* Description:
+*   Redraws one cell of the board layer from its entry in boardCells, and
+*   copies it to the screen.
+*
+* Arguments:
+*   TiScreen     *display - the display to draw to
+*   TiAssets     *a - the asset pool to grab images from
+*   TiSharedData *data - the shared data structure
+*   int x, y - the board position of the cell (1 to TI_RENDER_BOARD_CELLS)
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void renderDrawBoardCell(TiScreen *display, TiAssets *a, TiSharedData *data, int x, int y);
+
+/****************************************************************************
+* renderPresentBoardLayer
+*
+* Description:
+*   Brings the board layer up to date and copies all of it to the screen.
+*   Used when something else has been drawn over the board.
+*
+* Arguments:
+*   TiScreen     *display - the display to draw to
+*   TiAssets     *a - the asset pool to grab images from
+*   TiSharedData *data - the shared data structure
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void renderPresentBoardLayer(TiScreen *display, TiAssets *a, TiSharedData *data);
+
+/****************************************************************************
+* renderUpdateTrackPath
+*
+* Description:
+*   Follows the track leaving a station and records the overlay segment 
+*   for each tile along it, and the square the track runs into.  Called by
+*   renderTrackOverlay only when a tile has been played on that square, so
+*   only the tracks a move actually extends are followed again.
+*
+* Arguments:
+*   TiSharedData *data - the shared data structure
+*   int station - the station the track leaves from
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void renderUpdateTrackPath(TiSharedData *data, int station);
+
+/****************************************************************************
+* renderShowRecordedTurn
+*
+* Description:
+*   Puts the game on the board as it was at the end of one of its turns,
+*   from the current game record, and has the whole game screen redrawn.
+*   Used to go back and forth through a finished game.
+*
+* Arguments:
+*   TiSharedData *data - the shared data structure
+*   int turn - the number of turns played (up to the number in the game)
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void renderShowRecordedTurn(TiSharedData *data, int turn);
+
 /****************************************************************************
 * renderApplySurface
 *
@@ -560,11 +1027,10 @@ void renderOptionsScreenExtras(TiScreen *display, TiAssets *a, TiSharedData *dat
 void renderProcessEvents(TiScreen *display, TiAssets *assets, TiSharedData *data);
 void renderProcessInGameEvents(TiScreen *display, TiAssets *assets, TiSharedData *data, SDL_Event *event);
 void renderTrainsAndStations(TiScreen *display, TiAssets *a, TiSharedData *data);
-void renderDrawTileOnBoard(TiScreen *display, TiAssets *a, TiSharedData *data);
 int renderProcessComputerMove(TiScreen *display, TiAssets *a,  TiSharedData *data);
 void renderDrawAnimatedTrains(TiScreen *display, TiAssets *a, TiSharedData *data);
 void renderTrackOverlay(TiScreen *display, TiAssets *a, TiSharedData *data, int station);
-void renderRestoreBoardBacking(TiScreen *display, TiAssets *a, TiSharedData *data, int refreshScreen);
+void renderRestoreBoardArea(TiScreen *display, TiAssets *a, TiSharedData *data);
 void renderDrawCurrentTileHighlight(TiScreen *display, TiAssets *a, TiSharedData *data);
 void renderDrawCurrentPlayerHighlight(TiScreen *display, TiAssets *a, TiSharedData *data);
 int renderDisplayDialog(TiScreen *display, SDL_Surface *dialog, TiSharedData *data,
@@ -575,10 +1041,50 @@ void renderResultsScores(TiScreen *display, TiAssets *a, TiSharedData *data);
 void renderResultsScoreDigits(TiScreen *display, TiAssets *a, TiSharedData *data, int rank, int score);
 void renderResultsScreen(TiScreen *display, TiAssets *a, TiSharedData *data);
 void renderPlayerScore(TiScreen *display, TiAssets *a, TiSharedData *data, int player);
+
+/****************************************************************************
+* renderCreateScoreSurface
+*
+* Description:
+*   Creates a surface in the display's format to hold a score string.
+*
+* Arguments:
+*   TiScreen *display - the display
+*   int w, h          - the size of the surface
+*   int transparent   - TI_TRUE if the parts of the surface that the digits
+*                       don't cover should be transparent
+*
+* Returns:
+*   The surface, or NULL if it couldn't be created.
+*
+****************************************************************************/
+SDL_Surface *renderCreateScoreSurface(TiScreen *display, int w, int h, int transparent);
+
+/****************************************************************************
+* renderDrawScoreDigits
+*
+* Description:
+*   Draws a score onto a surface, one digit at a time, starting at its top
+*   left corner.  The digits are worked out with integer division.
+*
+* Arguments:
+*   SDL_Surface *dest   - the surface to draw to
+*   SDL_Surface *digits - the digit images (0 to 9, left to right)
+*   int score           - the score, at most TI_RENDER_MAX_SCORE
+*   int digitOffset     - the distance between digits in the digit images
+*   int *digitWidths    - the width of each digit
+*   int digitHeight     - the height of the digits
+*   int spacing         - the space left between digits
+*
+* Returns:
+*   The width of the drawn score.
+*
+****************************************************************************/
+int renderDrawScoreDigits(SDL_Surface *dest, SDL_Surface *digits, int score,
+                          int digitOffset, int *digitWidths, int digitHeight,
+                          int spacing);
 int renderResetSharedDataStructure(TiSharedData *data);
 void renderTrackOverlays(TiScreen *display, TiAssets *a, TiSharedData *data);
 void renderLastMoves(TiScreen *display, TiAssets *a, TiSharedData *data);
-void renderDrawTile(TiScreen *display, TiAssets *a, TiSharedData *data, int x, int y, int tile);
-void renderUndrawPreviousMove(TiScreen *display, TiAssets *a, TiSharedData *data);
 
 #endif /* __TIRENDERSDL_H__ */
@@ -0,0 +1,304 @@
+/****************************************************************************
+*
+* tiReplay.c - Game record checker and replay benchmark
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <SDL/SDL.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiSelfPlay.h"
+#include "tiPlayout.h"
+#include "tiMetrics.h"
+#include "tiRecord.h"
+
+/*
+ * Usage: tiReplay [-g <games> <players>] <record file>
+ *
+ * Plays back every record in a file (the game writes bin/lastGame.tir),
+ * checking each one against the rules, and prints any that don't follow
+ * them along with the event where they stopped.  It also checks that
+ * seeking to every point in them gets the same position as going through
+ * all of the events up to it, and that a game set up from the end of one
+ * has the scores it finished with.  Then it plays them all back TI_REPLAY_PASSES more
+ * times, and seeks to TI_REPLAY_SEEKS random points in them, to see how
+ * fast records replay and seek.  Run from the bin directory so the data
+ * files can be found.
+ *
+ * With -g, the file is first replaced with the records of seeded games
+ * between the strongest computer players, played out with self-play.
+ * Exits with an error if any record breaks the rules.
+ */
+
+#define TI_REPLAY_PASSES        50
+#define TI_REPLAY_SEEKS         100000
+
+Game *GameInstance;
+
+int main(int argc, char **argv)
+{
+    FILE *fp;
+    TiRecord **records, **moreRecords;
+    PlayoutState state;
+    TiRecordPosition position, seekPosition;
+    char *fileName;
+    int numGames, numPlayers, numRecords, maxRecords, numBad, counter, pass, result;
+    int aiLevels[TI_MAX_PLAYERS];
+    unsigned long numEvents, numBytes, numKeyframes, replayed, startTime, replayTime, seekTime;
+    Uint32 event;
+
+    numGames = 0;
+    numPlayers = 0;
+    fileName = NULL;
+    if(argc == 2)
+    {
+        fileName = argv[1];
+    }
+    else if(argc == 5 && strcmp(argv[1], "-g") == 0)
+    {
+        numGames = atoi(argv[2]);
+        numPlayers = atoi(argv[3]);
+        fileName = argv[4];
+        if(numGames <= 0 || numPlayers < TI_MIN_PLAYERS || numPlayers > TI_MAX_PLAYERS)
+        {
+            fileName = NULL;
+        }
+    }
+    if(fileName == NULL)
+    {
+        fprintf(stderr, "Usage: %s [-g <games> <players (%d-%d)>] <record file>\n", argv[0],
+                TI_MIN_PLAYERS, TI_MAX_PLAYERS);
+        return 1;
+    }
+
+    if(SDL_Init(SDL_INIT_TIMER) < 0)
+    {
+        perror("Unable to initialize SDL timer");
+        return 1;
+    }
+
+    GameInstance = gameInitialize(TI_TILE_DATA_FILE, TI_STATION_DATA_FILE);
+    if(GameInstance == NULL)
+    {
+        perror("Unable to initialize Game structure");
+        SDL_Quit();
+        return 1;
+    }
+
+    /* Record some self-play games */
+    if(numGames > 0)
+    {
+        fp = fopen(fileName, "wb");
+        CurrentRecord = recordInitialize();
+        if(fp == NULL || CurrentRecord == NULL)
+        {
+            perror("Unable to write records");
+            gameDestroy(&GameInstance);
+            SDL_Quit();
+            return 1;
+        }
+        for(counter=0;counter<TI_MAX_PLAYERS;counter++)
+        {
+            aiLevels[counter] = TI_PLAYER_AI_SMARTEST;
+        }
+        for(counter=0;counter<numGames;counter++)
+        {
+            srand(counter + 1);
+            if(selfPlayInitGame(GameInstance, numPlayers, aiLevels) != TI_OK ||
+               recordBegin(CurrentRecord, GameInstance, counter + 1, NULL) != TI_OK ||
+               selfPlayPlayGame(GameInstance) < 0)
+            {
+                perror("Unable to play game");
+                break;
+            }
+            recordEndGame(CurrentRecord, GameInstance);
+            recordWrite(fp, CurrentRecord);
+        }
+        recordDestroy(&CurrentRecord);
+        fclose(fp);
+    }
+
+    /* Read every record in the file */
+    fp = fopen(fileName, "rb");
+    if(fp == NULL)
+    {
+        perror("Unable to open record file");
+        gameDestroy(&GameInstance);
+        SDL_Quit();
+        return 1;
+    }
+    records = NULL;
+    numRecords = 0;
+    maxRecords = 0;
+    numEvents = 0;
+    numBytes = 0;
+    numKeyframes = 0;
+    result = TI_OK;
+    while(result == TI_OK)
+    {
+        if(numRecords == maxRecords)
+        {
+            maxRecords = (maxRecords > 0) ? maxRecords * 2 : 64;
+            moreRecords = (TiRecord **)realloc(records, maxRecords * sizeof(TiRecord *));
+            if(moreRecords == NULL)
+            {
+                perror("Out of memory");
+                break;
+            }
+            records = moreRecords;
+        }
+        records[numRecords] = recordInitialize();
+        if(records[numRecords] == NULL)
+        {
+            perror("Out of memory");
+            break;
+        }
+        result = recordRead(fp, records[numRecords]);
+        if(result != TI_OK)
+        {
+            recordDestroy(&(records[numRecords]));
+            break;
+        }
+        numEvents += records[numRecords]->header.numEvents;
+        numBytes += records[numRecords]->header.numBytes;
+        numKeyframes += records[numRecords]->header.numKeyframes;
+        numRecords++;
+    }
+    fclose(fp);
+    if(result == TI_ERROR)
+    {
+        fprintf(stderr, "Record %d in %s is damaged; only the ones before it are checked\n",
+                numRecords + 1, fileName);
+    }
+
+    /* Check them */
+    numBad = 0;
+    for(counter=0;counter<numRecords;counter++)
+    {
+        if(recordReplayStart(records[counter], GameInstance, &state) != TI_OK)
+        {
+            perror("Unable to set up replay");
+            break;
+        }
+        replayed = recordReplay(records[counter], &state);
+        if(replayed != records[counter]->header.numEvents)
+        {
+            fprintf(stderr, "Record %d (seed %lu) breaks the rules at event %lu\n", counter + 1,
+                    (unsigned long)records[counter]->header.seed, replayed + 1);
+            numBad++;
+            continue;
+        }
+
+        /* The game set up from the end of the record has to score the same */
+        recordSeek(records[counter], records[counter]->header.numEvents, &position);
+        recordLoadPosition(&position, GameInstance);
+        for(pass=0;pass<state.numPlayers;pass++)
+        {
+            if(GameInstance->players[pass].score != state.score[pass])
+            {
+                fprintf(stderr, "Record %d (seed %lu) loads with the wrong scores\n", counter + 1,
+                        (unsigned long)records[counter]->header.seed);
+                numBad++;
+                break;
+            }
+        }
+
+        recordStartPosition(records[counter], &position);
+        for(event=0;event<=records[counter]->header.numEvents;event++)
+        {
+            while(position.event < event)
+            {
+                if(recordApplyEvent(records[counter], &position) != TI_OK)
+                {
+                    break;
+                }
+            }
+            if(position.event != event ||
+               recordSeek(records[counter], event, &seekPosition) != TI_OK ||
+               memcmp(&(position.k), &(seekPosition.k), sizeof(TiRecordKeyframe)) != 0 ||
+               position.turn != seekPosition.turn)
+            {
+                fprintf(stderr, "Record %d (seed %lu) seeks to the wrong place at event %lu\n",
+                        counter + 1, (unsigned long)records[counter]->header.seed,
+                        (unsigned long)event);
+                numBad++;
+                break;
+            }
+        }
+    }
+
+    /* And time them */
+    replayed = 0;
+    startTime = metricsGetMicroseconds();
+    for(pass=0;pass<TI_REPLAY_PASSES;pass++)
+    {
+        for(counter=0;counter<numRecords;counter++)
+        {
+            recordReplayStart(records[counter], GameInstance, &state);
+            replayed += recordReplay(records[counter], &state);
+        }
+    }
+    replayTime = metricsGetMicroseconds() - startTime;
+
+    seekTime = 0;
+    if(numRecords > 0)
+    {
+        srand(1);
+        startTime = metricsGetMicroseconds();
+        for(pass=0;pass<TI_REPLAY_SEEKS;pass++)
+        {
+            counter = rand() % numRecords;
+            recordSeek(records[counter], rand() % (records[counter]->header.numEvents + 1), &position);
+        }
+        seekTime = metricsGetMicroseconds() - startTime;
+    }
+
+    fprintf(stderr, "records:                  %d (%d break the rules)\n", numRecords, numBad);
+    fprintf(stderr, "events:                   %lu (%.2f bytes each)\n", numEvents,
+            (numEvents > 0) ? ((double)numBytes / numEvents) : 0.0);
+    fprintf(stderr, "keyframes:                %lu\n", numKeyframes);
+    fprintf(stderr, "events replayed/second:   %.0f\n",
+            (replayTime > 0) ? (replayed * 1000000.0 / replayTime) : 0.0);
+    fprintf(stderr, "seeks/second:             %.0f\n",
+            (seekTime > 0) ? (TI_REPLAY_SEEKS * 1000000.0 / seekTime) : 0.0);
+
+    for(counter=0;counter<numRecords;counter++)
+    {
+        recordDestroy(&(records[counter]));
+    }
+    free(records);
+    gameDestroy(&GameInstance);
+    SDL_Quit();
+
+    return (numBad > 0 || result == TI_ERROR) ? 1 : 0;
+}
@@ -0,0 +1,264 @@
+/****************************************************************************
+*
+* tiSelfPlay.c - Runs games between computer players without the UI
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <SDL/SDL.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiSelfPlay.h"
+#include "tiPlayout.h"
+#include "tiRecord.h"
+
+/****************************************************************************
+* selfPlayInitGame - see tiSelfPlay.h for description
+****************************************************************************/
+int selfPlayInitGame(Game *g, int numPlayers, int *aiLevels)
+{
+    int counter;
+    int stationX, stationY, exit;
+
+    if(numPlayers < TI_MIN_PLAYERS || numPlayers > TI_MAX_PLAYERS)
+    {
+        return TI_ERROR;
+    }
+
+    if(gameResetGameStructure(g) != TI_OK)
+    {
+        return TI_ERROR;
+    }
+
+    for(counter=0; counter<TI_MAX_PLAYERS; counter++)
+    {
+        if(counter < numPlayers)
+        {
+            playerInitPlayer(&(g->players[counter]), TI_PLAYER_COMPUTER, 0,
+                             aiLevels[counter]);
+        }
+        else
+        {
+            playerInitPlayer(&(g->players[counter]), TI_PLAYER_NOBODY, 0,
+                             TI_PLAYER_AI_DEFAULT);
+        }
+    }
+
+    g->numStationsPerPlayer = (int)(TI_BOARD_NUM_STATIONS / numPlayers);
+    g->numPlayers = numPlayers;
+    g->curPlayer = 0;
+
+    /* Populate all station tiles with the appropriate owner */
+    for(counter=0; counter<TI_BOARD_NUM_STATIONS; counter++)
+    {
+        boardGetStationInfo(counter, &stationX, &stationY, &exit);
+        g->board->b[stationX][stationY].trainPresent = g->board->playerStations[g->numPlayers][counter];
+    }
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* selfPlayApplyMove - see tiSelfPlay.h for description
+****************************************************************************/
+int selfPlayApplyMove(Game *g, ComputerAIPacket *p)
+{
+    Player *player;
+
+    player = &(g->players[g->curPlayer]);
+
+    switch(p->moveType)
+    {
+        case TI_CPU_MOVE_DRAW:
+            if(g->tilepool->numUnplayedTiles <= 0)
+            {
+                return TI_ERROR;
+            }
+            if(player->currentTileId == TI_TILE_NO_TILE)
+            {
+                player->currentTileId = tilePoolDrawRandomTile(g->tilepool);
+                recordAddEvent(CurrentRecord, TI_RECORD_EVENT_DRAW, TI_FALSE, player->currentTileId);
+            }
+            else
+            {
+                player->reserveTileId = tilePoolDrawRandomTile(g->tilepool);
+                recordAddEvent(CurrentRecord, TI_RECORD_EVENT_DRAW, TI_TRUE, player->reserveTileId);
+            }
+            break;
+        case TI_CPU_MOVE_PLAY:
+            g->selectedMoveTileX = p->moveX;
+            g->selectedMoveTileY = p->moveY;
+            if(p->heldTile == TI_CPU_HELD_TILE_PRIMARY)
+            {
+                g->selectedMoveTileId = player->currentTileId;
+                player->currentTileId = player->reserveTileId;
+                player->reserveTileId = TI_TILE_NO_TILE;
+            }
+            else if(p->heldTile == TI_CPU_HELD_TILE_RESERVE)
+            {
+                g->selectedMoveTileId = player->reserveTileId;
+                player->reserveTileId = TI_TILE_NO_TILE;
+            }
+            else
+            {
+                return TI_ERROR;
+            }
+            boardMarkLegalMoves(g->board, tilePoolGetTile(g->tilepool, g->selectedMoveTileId));
+            if(boardPlaceTile(g->board, g->selectedMoveTileX, g->selectedMoveTileY,
+                              g->selectedMoveTileId) == TI_BOARD_ILLEGAL_MOVE)
+            {
+                return TI_ERROR;
+            }
+            recordAddEvent(CurrentRecord, TI_RECORD_EVENT_PLAY,
+                           (p->heldTile == TI_CPU_HELD_TILE_RESERVE) ? TI_TRUE : TI_FALSE,
+                           TI_RECORD_SQUARE(g->selectedMoveTileX, g->selectedMoveTileY));
+            player->lastMoveX = g->selectedMoveTileX;
+            player->lastMoveY = g->selectedMoveTileY;
+            gameCheckForCompletedTracks(g);
+            break;
+        case TI_CPU_MOVE_DISCARD:
+            if(p->heldTile == TI_CPU_HELD_TILE_PRIMARY)
+            {
+                g->selectedMoveTileId = player->currentTileId;
+                g->selectedMoveIsReserveTile = TI_FALSE;
+            }
+            else
+            {
+                g->selectedMoveTileId = player->reserveTileId;
+                g->selectedMoveIsReserveTile = TI_TRUE;
+            }
+            if(gameDiscardTile(g) != TI_OK)
+            {
+                return TI_ERROR;
+            }
+            break;
+        case TI_CPU_MOVE_END_TURN:
+            break;
+        default:
+            return TI_ERROR;
+    }
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* selfPlayTakeTurn - see tiSelfPlay.h for description
+****************************************************************************/
+int selfPlayTakeTurn(Game *g)
+{
+    ComputerAIPacket moves[2];
+    ComputerAIPacket *cur, *prev;
+    int decisions;
+
+    prev = NULL;
+    cur = &(moves[0]);
+    computerDetermineNextMove(NULL, cur);
+    decisions = 1;
+    while(cur->moveType != TI_CPU_MOVE_END_TURN)
+    {
+        if(selfPlayApplyMove(g, cur) != TI_OK)
+        {
+            return -1;
+        }
+        prev = cur;
+        cur = (prev == &(moves[0])) ? &(moves[1]) : &(moves[0]);
+        computerDetermineNextMove(prev, cur);
+        decisions++;
+    }
+
+    recordAddEvent(CurrentRecord, TI_RECORD_EVENT_END_TURN, TI_FALSE, 0);
+    g->curPlayer++;
+    if(g->curPlayer >= g->numPlayers)
+    {
+        g->curPlayer = 0;
+    }
+
+    return decisions;
+}
+
+/****************************************************************************
+* selfPlayPlayGame - see tiSelfPlay.h for description
+****************************************************************************/
+int selfPlayPlayGame(Game *g)
+{
+    int decisions, result, idleTurns, tilesLeft, lastTilesLeft;
+
+    decisions = 0;
+    idleTurns = 0;
+    lastTilesLeft = selfPlayCountTilesLeft(g);
+    while(gameCheckForEndOfGame(g) == TI_FALSE && idleTurns < TI_SELFPLAY_MAX_IDLE_TURNS)
+    {
+        result = selfPlayTakeTurn(g);
+        if(result < 0)
+        {
+            return -1;
+        }
+        decisions += result;
+
+        /* Discarded tiles go back into the pool, so only playing a tile
+           changes the number of tiles left */
+        tilesLeft = selfPlayCountTilesLeft(g);
+        if(tilesLeft == lastTilesLeft)
+        {
+            idleTurns++;
+        }
+        else
+        {
+            idleTurns = 0;
+        }
+        lastTilesLeft = tilesLeft;
+    }
+
+    return decisions;
+}
+
+/****************************************************************************
+* selfPlayCountTilesLeft - see tiSelfPlay.h for description
+****************************************************************************/
+int selfPlayCountTilesLeft(Game *g)
+{
+    int counter, tilesLeft;
+
+    tilesLeft = g->tilepool->numUnplayedTiles;
+    for(counter=0; counter<g->numPlayers; counter++)
+    {
+        if(g->players[counter].currentTileId != TI_TILE_NO_TILE)
+        {
+            tilesLeft++;
+        }
+        if(g->players[counter].reserveTileId != TI_TILE_NO_TILE)
+        {
+            tilesLeft++;
+        }
+    }
+
+    return tilesLeft;
+}
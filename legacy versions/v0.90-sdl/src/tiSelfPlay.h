@@ -0,0 +1,123 @@
+/****************************************************************************
+*
+* tiSelfPlay.h - Header for tiSelfPlay.c
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+
+#ifndef __TISELFPLAY_H__
+#define __TISELFPLAY_H__
+
+/*
+ * Self-play runs games between computer players without any of the 
+ * rendering, delays or game state machine used by the UI, so that the AI
+ * can be benchmarked and tested.  Moves are applied to the global game
+ * instance with the same rules that renderProcessComputerMove uses.
+ */
+
+/* Near the end of a game, the tiles left can all be ones that have no legal
+   place on the board.  The players then just draw and discard them forever,
+   so a game is called off once this many turns in a row go by without a 
+   tile being played. */
+#define TI_SELFPLAY_MAX_IDLE_TURNS      60
+
+/****************************************************************************
+* selfPlayInitGame
+*
+* Description:
+*   Resets the global game instance and sets it up for a game between 
+*   computer players.
+*
+* Arguments:
+*   Game *g        - the game (must be the global game instance)
+*   int numPlayers - the number of players (TI_MIN_PLAYERS - TI_MAX_PLAYERS)
+*   int *aiLevels  - the AI level of each player
+*
+* Returns:
+*   TI_OK or TI_ERROR.
+*
+****************************************************************************/
+int selfPlayInitGame(Game *g, int numPlayers, int *aiLevels);
+
+/****************************************************************************
+* selfPlayApplyMove
+*
+* Description:
+*   Applies a single computer move for the current player.
+*
+* Arguments:
+*   Game *g              - the game
+*   ComputerAIPacket *p  - the move to apply
+*
+* Returns:
+*   TI_OK, or TI_ERROR if the move couldn't be applied.
+*
+****************************************************************************/
+int selfPlayApplyMove(Game *g, ComputerAIPacket *p);
+
+/****************************************************************************
+* selfPlayTakeTurn
+*
+* Description:
+*   Plays the current player's whole turn and moves on to the next player.
+*
+* Arguments:
+*   Game *g - the game
+*
+* Returns:
+*   The number of decisions the computer player made, or -1 on error.
+*
+****************************************************************************/
+int selfPlayTakeTurn(Game *g);
+
+/****************************************************************************
+* selfPlayPlayGame
+*
+* Description:
+*   Plays turns until the end of the game, or until the game stalls (see
+*   TI_SELFPLAY_MAX_IDLE_TURNS).
+*
+* Arguments:
+*   Game *g - the game
+*
+* Returns:
+*   The number of decisions the computer players made, or -1 on error.
+*
+****************************************************************************/
+int selfPlayPlayGame(Game *g);
+
+/****************************************************************************
+* selfPlayCountTilesLeft
+*
+* Description:
+*   Counts the tiles that haven't been played yet, whether they're in the
+*   tile pool or held by a player.
+*
+* Arguments:
+*   Game *g - the game
+*
+* Returns:
+*   The number of tiles left.
+*
+****************************************************************************/
+int selfPlayCountTilesLeft(Game *g);
+
+#endif /* __TISELFPLAY_H__ */
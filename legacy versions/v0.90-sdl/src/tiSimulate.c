@@ -0,0 +1,204 @@
+/****************************************************************************
+*
+* tiSimulate.c - Self-play game database builder
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <SDL/SDL.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiSelfPlay.h"
+#include "tiPlayout.h"
+#include "tiMetrics.h"
+#include "tiRecord.h"
+#include "tiGameDb.h"
+
+/*
+ * Usage: tiSimulate <games> <players> <database>
+ *
+ * Plays self-play games and adds their records to a game database (see
+ * tiGameDb.h), creating it if it isn't there.  Each game's seed is its
+ * number in the database, so no two games share one, and each player's
+ * AI level is picked at random from the seed.  Then the database is
+ * mapped back in, and the games just added are played back by the rules
+ * to check them.  Run from the bin directory so the data files can be
+ * found.
+ *
+ * Exits with an error if a game can't be played or added, or if any game
+ * doesn't replay.
+ */
+
+Game *GameInstance;
+
+int main(int argc, char **argv)
+{
+    TiGameDbWriter *w;
+    TiGameDb *db;
+    TiGameDbBlock *block;
+    TiRecord record;
+    PlayoutState state;
+    Uint64 firstGame;
+    Uint32 seed;
+    int numGames, numAdded, numPlayers, numBad, numChecked, failed, counter, counter2;
+    int aiLevels[TI_MAX_PLAYERS];
+    unsigned long startTime, writeTime, checkTime;
+
+    numGames = 0;
+    numPlayers = 0;
+    if(argc == 4)
+    {
+        numGames = atoi(argv[1]);
+        numPlayers = atoi(argv[2]);
+    }
+    if(numGames <= 0 || numPlayers < TI_MIN_PLAYERS || numPlayers > TI_MAX_PLAYERS)
+    {
+        fprintf(stderr, "Usage: %s <games> <players (%d-%d)> <database>\n", argv[0],
+                TI_MIN_PLAYERS, TI_MAX_PLAYERS);
+        return 1;
+    }
+
+    if(SDL_Init(SDL_INIT_TIMER) < 0)
+    {
+        perror("Unable to initialize SDL timer");
+        return 1;
+    }
+
+    GameInstance = gameInitialize(TI_TILE_DATA_FILE, TI_STATION_DATA_FILE);
+    w = gameDbOpenWriter(argv[3]);
+    CurrentRecord = recordInitialize();
+    if(GameInstance == NULL || w == NULL || CurrentRecord == NULL)
+    {
+        perror("Unable to set up");
+        gameDbCloseWriter(&w);
+        recordDestroy(&CurrentRecord);
+        gameDestroy(&GameInstance);
+        SDL_Quit();
+        return 1;
+    }
+
+    /* Play the games */
+    firstGame = w->header.numGames;
+    numAdded = 0;
+    failed = TI_FALSE;
+    startTime = metricsGetMicroseconds();
+    for(counter=0;counter<numGames;counter++)
+    {
+        seed = (Uint32)(firstGame + counter + 1);
+        srand(seed);
+        for(counter2=0;counter2<TI_MAX_PLAYERS;counter2++)
+        {
+            aiLevels[counter2] = rand() % (TI_PLAYER_AI_SMARTEST + 1);
+        }
+        if(selfPlayInitGame(GameInstance, numPlayers, aiLevels) != TI_OK ||
+           recordBegin(CurrentRecord, GameInstance, seed, NULL) != TI_OK ||
+           selfPlayPlayGame(GameInstance) < 0)
+        {
+            perror("Unable to play game");
+            failed = TI_TRUE;
+            break;
+        }
+        recordEndGame(CurrentRecord, GameInstance);
+        if(gameDbAddRecord(w, CurrentRecord) != TI_OK)
+        {
+            perror("Unable to add game to database");
+            failed = TI_TRUE;
+            break;
+        }
+        numAdded++;
+    }
+    gameDbCloseWriter(&w);
+    writeTime = metricsGetMicroseconds() - startTime;
+    recordDestroy(&CurrentRecord);
+
+    db = gameDbOpen(argv[3]);
+    if(db == NULL)
+    {
+        perror("Unable to open database");
+        gameDestroy(&GameInstance);
+        SDL_Quit();
+        return 1;
+    }
+
+    /* The last block is only written when the writer is closed */
+    if(db->header->numGames - firstGame != (Uint64)numAdded)
+    {
+        fprintf(stderr, "Only %lu of the games added were written\n",
+                (unsigned long)(db->header->numGames - firstGame));
+        numAdded = (int)(db->header->numGames - firstGame);
+        failed = TI_TRUE;
+    }
+
+    /* Check the new games, skipping the blocks they aren't in */
+    numBad = 0;
+    numChecked = 0;
+    startTime = metricsGetMicroseconds();
+    for(block=gameDbFirstBlock(db);block!=NULL;block=gameDbNextBlock(db, block))
+    {
+        if(block->firstGame + block->numGames <= firstGame)
+        {
+            continue;
+        }
+        for(counter=0;counter<block->numGames;counter++)
+        {
+            if(block->firstGame + counter < firstGame)
+            {
+                continue;
+            }
+            if(gameDbGetRecord(block, counter, &record) != TI_OK ||
+               recordReplayStart(&record, GameInstance, &state) != TI_OK ||
+               recordReplay(&record, &state) != record.header.numEvents)
+            {
+                fprintf(stderr, "Game %lu (seed %lu) doesn't replay\n",
+                        (unsigned long)(block->firstGame + counter + 1),
+                        (unsigned long)TI_GAMEDB_ENTRIES(block)[counter].seed);
+                numBad++;
+            }
+            numChecked++;
+        }
+    }
+    checkTime = metricsGetMicroseconds() - startTime;
+
+    fprintf(stderr, "games added:              %d of %d (%.0f/second)\n", numAdded, numGames,
+            (writeTime > 0) ? (numAdded * 1000000.0 / writeTime) : 0.0);
+    fprintf(stderr, "games in database:        %lu in %lu blocks (%.0f bytes each)\n",
+            (unsigned long)db->header->numGames, (unsigned long)db->header->numBlocks,
+            (db->header->numGames > 0) ? ((double)db->header->size / db->header->numGames) : 0.0);
+    fprintf(stderr, "games checked:            %d (%d don't replay, %.0f/second)\n", numChecked,
+            numBad, (checkTime > 0) ? (numChecked * 1000000.0 / checkTime) : 0.0);
+
+    gameDbClose(&db);
+    gameDestroy(&GameInstance);
+    SDL_Quit();
+
+    return (failed == TI_TRUE || numBad > 0) ? 1 : 0;
+}
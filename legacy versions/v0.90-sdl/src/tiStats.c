@@ -0,0 +1,515 @@
+/****************************************************************************
+*
+* tiStats.c - Statistics over a database of recorded games
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+#include <SDL/SDL.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiPlayout.h"
+#include "tiMetrics.h"
+#include "tiRecord.h"
+#include "tiGameDb.h"
+
+/*
+ * Usage: tiStats [-j threads] <database>
+ *
+ * Works out the numbers used to balance the station layouts from a game
+ * database (see tiGameDb.h and tiSimulate.c): how often each seat wins
+ * for each number of players (and so how much going first is worth), how
+ * each AI level does, how the final scores are spread, how long the
+ * finished tracks are, and how many of them end at a central station.
+ *
+ * The games are split into one run of games per thread (one per core by
+ * default).  Wins and scores come straight from the database's entries;
+ * the tracks are followed on each thread's own copy of the board, set up
+ * from the end of each game's record.  Nothing the threads touch is
+ * shared except the mapped database, which they only read, so each one
+ * adds up its own totals and they're put together at the end.  Run from
+ * the bin directory so the data files can be found.
+ */
+
+#define TI_STATS_MAX_THREADS            64
+#define TI_STATS_NUM_AI_LEVELS          (TI_PLAYER_AI_SMARTEST + 1)
+
+/* Final scores are counted in buckets this many points wide; the last
+   bucket has everything past the others */
+#define TI_STATS_SCORE_BUCKET           10
+#define TI_STATS_SCORE_BUCKETS          20
+#define TI_STATS_HISTOGRAM_WIDTH        50
+
+/* One thread's totals.  Seats are counted by the number of players in the
+   game.  A tie for first is a fraction of a win for each player in it. */
+typedef struct {
+    unsigned long games;
+    unsigned long unfinished;
+    unsigned long damaged;
+    unsigned long seatGames[TI_MAX_PLAYERS + 1];
+    double seatWins[TI_MAX_PLAYERS + 1][TI_MAX_PLAYERS];
+    double seatScores[TI_MAX_PLAYERS + 1][TI_MAX_PLAYERS];
+    /* The wins expected of a level are what it would win if every seat
+       were as good as every other */
+    unsigned long levelSeats[TI_STATS_NUM_AI_LEVELS];
+    double levelWins[TI_STATS_NUM_AI_LEVELS];
+    double levelExpected[TI_STATS_NUM_AI_LEVELS];
+    double levelScores[TI_STATS_NUM_AI_LEVELS];
+    unsigned long levelTracks[TI_STATS_NUM_AI_LEVELS];
+    unsigned long levelCentral[TI_STATS_NUM_AI_LEVELS];
+    unsigned long scores[TI_STATS_SCORE_BUCKETS];
+    unsigned long numScores;
+    double scoreSum;
+    double scoreSquares;
+    unsigned long tracks;
+    unsigned long trackTiles;
+    unsigned long centralTracks;
+} StatsTotals;
+
+typedef struct {
+    TiGameDb *db;
+    Uint64 firstGame;
+    Uint64 numGames;
+    Board board;
+    StatsTotals totals;
+} StatsWorker;
+
+char *StatsLevelNames[TI_STATS_NUM_AI_LEVELS] = {"default", "smarter", "smartest"};
+
+Game *GameInstance;
+
+/****************************************************************************
+* statsAddGame
+*
+* Adds a game to a worker's totals.
+****************************************************************************/
+void statsAddGame(StatsWorker *w, TiGameDbEntry *entry, TiRecord *r)
+{
+    StatsTotals *t;
+    TiRecordPosition position;
+    double win;
+    int counter, numPlayers, best, numBest, level, bucket, owner, length, destination;
+    int stationX, stationY, stationExit, endX, endY, endType;
+
+    t = &(w->totals);
+    t->games++;
+    if(entry->finished == TI_FALSE)
+    {
+        t->unfinished++;
+        return;
+    }
+
+    numPlayers = entry->numPlayers;
+    best = 0;
+    numBest = 0;
+    for(counter=0;counter<numPlayers;counter++)
+    {
+        if(entry->score[counter] > best || numBest == 0)
+        {
+            best = entry->score[counter];
+            numBest = 0;
+        }
+        if(entry->score[counter] == best)
+        {
+            numBest++;
+        }
+    }
+
+    t->seatGames[numPlayers]++;
+    for(counter=0;counter<numPlayers;counter++)
+    {
+        win = (entry->score[counter] == best) ? (1.0 / numBest) : 0.0;
+        level = entry->aiLevel[counter] % TI_STATS_NUM_AI_LEVELS;
+        t->seatWins[numPlayers][counter] += win;
+        t->seatScores[numPlayers][counter] += entry->score[counter];
+        t->levelSeats[level]++;
+        t->levelWins[level] += win;
+        t->levelExpected[level] += 1.0 / numPlayers;
+        t->levelScores[level] += entry->score[counter];
+
+        bucket = entry->score[counter] / TI_STATS_SCORE_BUCKET;
+        if(bucket >= TI_STATS_SCORE_BUCKETS)
+        {
+            bucket = TI_STATS_SCORE_BUCKETS - 1;
+        }
+        t->scores[bucket]++;
+        t->numScores++;
+        t->scoreSum += entry->score[counter];
+        t->scoreSquares += (double)entry->score[counter] * entry->score[counter];
+    }
+
+    /* Follow every player's tracks on the board as it was at the end */
+    if(recordSeek(r, r->header.numEvents, &position) != TI_OK)
+    {
+        t->damaged++;
+        return;
+    }
+    recordLoadBoard(&position, &(w->board));
+    for(counter=0;counter<TI_BOARD_NUM_STATIONS;counter++)
+    {
+        owner = w->board.playerStations[numPlayers][counter];
+        if(owner == TI_BOARD_NO_TRAIN)
+        {
+            continue;
+        }
+        boardGetStationInfo(counter, &stationX, &stationY, &stationExit);
+        endType = boardFollowTrack(&(w->board), stationX, stationY, stationExit, &endX, &endY);
+        if(endType != TI_BOARDSQUARE_TYPE_STATION && endType != TI_BOARDSQUARE_TYPE_CENTRAL)
+        {
+            continue;
+        }
+        w->board.b[stationX][stationY].trainPresent = owner;
+        length = boardCalculateTrackScore(&(w->board), counter, TI_TILE_NO_TILE, NULL, &destination);
+        level = entry->aiLevel[owner - 1] % TI_STATS_NUM_AI_LEVELS;
+        if(destination == TI_BOARDSQUARE_TYPE_CENTRAL)
+        {
+            length /= 2;
+            t->centralTracks++;
+            t->levelCentral[level]++;
+        }
+        t->tracks++;
+        t->trackTiles += length;
+        t->levelTracks[level]++;
+    }
+}
+
+/****************************************************************************
+* statsWorker
+*
+* Thread function.  Adds up the totals for a worker's run of games.
+****************************************************************************/
+int statsWorker(void *data)
+{
+    StatsWorker *w;
+    TiGameDbBlock *block;
+    TiRecord record;
+    Uint64 game;
+    int counter;
+
+    w = (StatsWorker *)data;
+    metricsRegisterThread();
+
+    for(block=gameDbFirstBlock(w->db);block!=NULL;block=gameDbNextBlock(w->db, block))
+    {
+        if(block->firstGame >= w->firstGame + w->numGames)
+        {
+            break;
+        }
+        if(block->firstGame + block->numGames <= w->firstGame)
+        {
+            continue;
+        }
+        for(counter=0;counter<block->numGames;counter++)
+        {
+            game = block->firstGame + counter;
+            if(game < w->firstGame || game >= w->firstGame + w->numGames)
+            {
+                continue;
+            }
+            if(gameDbGetRecord(block, counter, &record) != TI_OK)
+            {
+                w->totals.games++;
+                w->totals.damaged++;
+                continue;
+            }
+            statsAddGame(w, &(TI_GAMEDB_ENTRIES(block)[counter]), &record);
+        }
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+* statsMerge
+*
+* Adds one set of totals into another.
+****************************************************************************/
+void statsMerge(StatsTotals *to, StatsTotals *from)
+{
+    int counter, counter2;
+
+    to->games += from->games;
+    to->unfinished += from->unfinished;
+    to->damaged += from->damaged;
+    for(counter=0;counter<=TI_MAX_PLAYERS;counter++)
+    {
+        to->seatGames[counter] += from->seatGames[counter];
+        for(counter2=0;counter2<TI_MAX_PLAYERS;counter2++)
+        {
+            to->seatWins[counter][counter2] += from->seatWins[counter][counter2];
+            to->seatScores[counter][counter2] += from->seatScores[counter][counter2];
+        }
+    }
+    for(counter=0;counter<TI_STATS_NUM_AI_LEVELS;counter++)
+    {
+        to->levelSeats[counter] += from->levelSeats[counter];
+        to->levelWins[counter] += from->levelWins[counter];
+        to->levelExpected[counter] += from->levelExpected[counter];
+        to->levelScores[counter] += from->levelScores[counter];
+        to->levelTracks[counter] += from->levelTracks[counter];
+        to->levelCentral[counter] += from->levelCentral[counter];
+    }
+    for(counter=0;counter<TI_STATS_SCORE_BUCKETS;counter++)
+    {
+        to->scores[counter] += from->scores[counter];
+    }
+    to->numScores += from->numScores;
+    to->scoreSum += from->scoreSum;
+    to->scoreSquares += from->scoreSquares;
+    to->tracks += from->tracks;
+    to->trackTiles += from->trackTiles;
+    to->centralTracks += from->centralTracks;
+}
+
+/****************************************************************************
+* statsPrint
+*
+* Prints the totals as tables.
+****************************************************************************/
+void statsPrint(StatsTotals *t)
+{
+    double mean, average, fraction, most;
+    int counter, counter2, width;
+
+    printf("games:            %lu (%lu unfinished, %lu damaged)\n\n", t->games, t->unfinished,
+           t->damaged);
+
+    printf("Win rate by seat (ties for first are shared)\n");
+    printf("players     games");
+    for(counter=0;counter<TI_MAX_PLAYERS;counter++)
+    {
+        printf("  seat %d", counter + 1);
+    }
+    printf("\n");
+    for(counter=TI_MIN_PLAYERS;counter<=TI_MAX_PLAYERS;counter++)
+    {
+        if(t->seatGames[counter] == 0)
+        {
+            continue;
+        }
+        printf("%7d %9lu", counter, t->seatGames[counter]);
+        for(counter2=0;counter2<counter;counter2++)
+        {
+            printf("  %5.1f%%", 100.0 * t->seatWins[counter][counter2] / t->seatGames[counter]);
+        }
+        printf("\n");
+    }
+
+    printf("\nFirst player advantage\n");
+    printf("players  win rate  even share  points over the average\n");
+    for(counter=TI_MIN_PLAYERS;counter<=TI_MAX_PLAYERS;counter++)
+    {
+        if(t->seatGames[counter] == 0)
+        {
+            continue;
+        }
+        average = 0.0;
+        for(counter2=0;counter2<counter;counter2++)
+        {
+            average += t->seatScores[counter][counter2];
+        }
+        average /= counter * (double)t->seatGames[counter];
+        printf("%7d    %5.1f%%      %5.1f%%  %+6.2f\n", counter,
+               100.0 * t->seatWins[counter][0] / t->seatGames[counter], 100.0 / counter,
+               t->seatScores[counter][0] / t->seatGames[counter] - average);
+    }
+
+    printf("\nBy AI level\n");
+    printf("level        seats  win rate  even share  points  central tracks\n");
+    for(counter=0;counter<TI_STATS_NUM_AI_LEVELS;counter++)
+    {
+        if(t->levelSeats[counter] == 0)
+        {
+            continue;
+        }
+        printf("%-8s %9lu    %5.1f%%      %5.1f%%  %6.2f  %5.1f%%\n", StatsLevelNames[counter],
+               t->levelSeats[counter], 100.0 * t->levelWins[counter] / t->levelSeats[counter],
+               100.0 * t->levelExpected[counter] / t->levelSeats[counter],
+               t->levelScores[counter] / t->levelSeats[counter],
+               (t->levelTracks[counter] > 0) ?
+                   (100.0 * t->levelCentral[counter] / t->levelTracks[counter]) : 0.0);
+    }
+
+    if(t->numScores > 0)
+    {
+        mean = t->scoreSum / t->numScores;
+        printf("\nFinal scores: average %.2f, standard deviation %.2f\n", mean,
+               sqrt(t->scoreSquares / t->numScores - mean * mean));
+        most = 0.0;
+        for(counter=0;counter<TI_STATS_SCORE_BUCKETS;counter++)
+        {
+            if(t->scores[counter] > most)
+            {
+                most = t->scores[counter];
+            }
+        }
+        for(counter=0;counter<TI_STATS_SCORE_BUCKETS;counter++)
+        {
+            if(counter < TI_STATS_SCORE_BUCKETS - 1)
+            {
+                printf("%4d-%-4d", counter * TI_STATS_SCORE_BUCKET,
+                       (counter + 1) * TI_STATS_SCORE_BUCKET - 1);
+            }
+            else
+            {
+                printf("%4d+    ", counter * TI_STATS_SCORE_BUCKET);
+            }
+            fraction = (double)t->scores[counter] / t->numScores;
+            printf(" %5.1f%%  ", 100.0 * fraction);
+            width = (int)(TI_STATS_HISTOGRAM_WIDTH * t->scores[counter] / most + 0.5);
+            for(counter2=0;counter2<width;counter2++)
+            {
+                printf("#");
+            }
+            printf("\n");
+        }
+    }
+
+    printf("\nTracks finished:  %lu, %.2f tiles long on average\n", t->tracks,
+           (t->tracks > 0) ? ((double)t->trackTiles / t->tracks) : 0.0);
+    printf("Central stations: %lu (%.1f%% of finished tracks)\n", t->centralTracks,
+           (t->tracks > 0) ? (100.0 * t->centralTracks / t->tracks) : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+    TiGameDb *db;
+    StatsWorker *workers;
+    SDL_Thread **threads;
+    StatsTotals totals;
+    Uint64 numGames;
+    unsigned long startTime, statsTime;
+    int numThreads, option, counter;
+
+    numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    while((option = getopt(argc, argv, "j:")) != -1)
+    {
+        switch(option)
+        {
+            case 'j':
+                numThreads = atoi(optarg);
+                break;
+            default:
+                numThreads = 0;
+                break;
+        }
+    }
+    if(optind != argc - 1 || numThreads <= 0)
+    {
+        fprintf(stderr, "Usage: %s [-j threads] <database>\n", argv[0]);
+        return 1;
+    }
+    if(numThreads > TI_STATS_MAX_THREADS)
+    {
+        numThreads = TI_STATS_MAX_THREADS;
+    }
+
+    if(SDL_Init(SDL_INIT_TIMER) < 0)
+    {
+        perror("Unable to initialize SDL timer");
+        return 1;
+    }
+
+    metricsInitialize();
+
+    GameInstance = gameInitialize(TI_TILE_DATA_FILE, TI_STATION_DATA_FILE);
+    db = gameDbOpen(argv[optind]);
+    if(GameInstance == NULL || db == NULL)
+    {
+        perror("Unable to set up");
+        gameDbClose(&db);
+        gameDestroy(&GameInstance);
+        SDL_Quit();
+        return 1;
+    }
+
+    numGames = db->header->numGames;
+    if(numGames < (Uint64)numThreads)
+    {
+        numThreads = (numGames > 0) ? (int)numGames : 1;
+    }
+    workers = (StatsWorker *)malloc(numThreads * sizeof(StatsWorker));
+    threads = (SDL_Thread **)malloc(numThreads * sizeof(SDL_Thread *));
+    if(workers == NULL || threads == NULL)
+    {
+        perror("Out of memory");
+        free(workers);
+        free(threads);
+        gameDbClose(&db);
+        gameDestroy(&GameInstance);
+        SDL_Quit();
+        return 1;
+    }
+
+    /* One run of games for each thread */
+    startTime = metricsGetMicroseconds();
+    for(counter=0;counter<numThreads;counter++)
+    {
+        memset(&(workers[counter]), 0, sizeof(StatsWorker));
+        workers[counter].db = db;
+        workers[counter].firstGame = numGames * counter / numThreads;
+        workers[counter].numGames = numGames * (counter + 1) / numThreads - workers[counter].firstGame;
+        workers[counter].board = *(GameInstance->board);
+        threads[counter] = SDL_CreateThread(statsWorker, &(workers[counter]));
+        if(threads[counter] == NULL)
+        {
+            /* Do this run here instead */
+            statsWorker(&(workers[counter]));
+        }
+    }
+    memset(&totals, 0, sizeof(StatsTotals));
+    for(counter=0;counter<numThreads;counter++)
+    {
+        if(threads[counter] != NULL)
+        {
+            SDL_WaitThread(threads[counter], NULL);
+        }
+        statsMerge(&totals, &(workers[counter].totals));
+    }
+    statsTime = metricsGetMicroseconds() - startTime;
+
+    statsPrint(&totals);
+    fprintf(stderr, "%lu games on %d threads in %.2f seconds (%.0f games/second)\n",
+            totals.games, numThreads, statsTime / 1000000.0,
+            (statsTime > 0) ? (totals.games * 1000000.0 / statsTime) : 0.0);
+
+    free(workers);
+    free(threads);
+    gameDbClose(&db);
+    metricsDestroy();
+    gameDestroy(&GameInstance);
+    SDL_Quit();
+
+    return (totals.damaged > 0) ? 1 : 0;
+}
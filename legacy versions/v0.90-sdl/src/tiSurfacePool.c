@@ -0,0 +1,200 @@
+/****************************************************************************
+*
+* tiSurfacePool.c - pool of surfaces for saving parts of the screen
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <SDL/SDL.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiLog.h"
+#include "tiSurfacePool.h"
+
+/****************************************************************************
+* surfacePoolInitialize - see tiSurfacePool.h for description
+****************************************************************************/
+TiSurfacePool *surfacePoolInitialize(void)
+{
+    TiSurfacePool *pool;
+
+    pool = malloc(sizeof(TiSurfacePool));
+    if(pool == NULL)
+    {
+        return NULL;
+    }
+
+    pool->numEntries = 0;
+    pool->acquires = 0;
+    pool->misses = 0;
+
+    return pool;
+}
+
+/****************************************************************************
+* surfacePoolDestroy - see tiSurfacePool.h for description
+****************************************************************************/
+void surfacePoolDestroy(TiSurfacePool **pool)
+{
+    int counter;
+
+    if(*pool == NULL)
+    {
+        return;
+    }
+
+    if((*pool)->acquires > 0)
+    {
+        TI_LOG(TI_LOG_INFO, TI_LOG_EVENT_SURFACE_POOL, (*pool)->numEntries, (*pool)->acquires,
+               (*pool)->misses, 0);
+    }
+    for(counter=0;counter<(*pool)->numEntries;counter++)
+    {
+        SDL_FreeSurface((*pool)->entries[counter].surface);
+    }
+
+    free(*pool);
+    *pool = NULL;
+}
+
+/****************************************************************************
+* surfacePoolReserve - see tiSurfacePool.h for description
+****************************************************************************/
+int surfacePoolReserve(TiSurfacePool *pool, int w, int h, SDL_PixelFormat *format)
+{
+    SDL_Surface *surface;
+    int counter;
+
+    for(counter=0;counter<pool->numEntries;counter++)
+    {
+        if(surfacePoolMatches(pool->entries[counter].surface, w, h, format) == TI_TRUE)
+        {
+            return TI_OK;
+        }
+    }
+
+    if(pool->numEntries >= TI_SURFACE_POOL_MAX_ENTRIES)
+    {
+        return TI_ERROR;
+    }
+
+    surface = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, format->BitsPerPixel,
+                                   format->Rmask, format->Gmask, 
+                                   format->Bmask, format->Amask);
+    if(surface == NULL)
+    {
+        return TI_ERROR;
+    }
+
+    pool->entries[pool->numEntries].surface = surface;
+    pool->entries[pool->numEntries].inUse = TI_FALSE;
+    pool->numEntries++;
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* surfacePoolAcquire - see tiSurfacePool.h for description
+****************************************************************************/
+SDL_Surface *surfacePoolAcquire(TiSurfacePool *pool, int w, int h, 
+                                SDL_PixelFormat *format)
+{
+    SDL_Surface *surface;
+    int counter;
+
+    pool->acquires++;
+
+    for(counter=0;counter<pool->numEntries;counter++)
+    {
+        if(pool->entries[counter].inUse == TI_FALSE &&
+           surfacePoolMatches(pool->entries[counter].surface, w, h, format) == TI_TRUE)
+        {
+            pool->entries[counter].inUse = TI_TRUE;
+            return pool->entries[counter].surface;
+        }
+    }
+
+    /* Nothing free of this size, so make one */
+    pool->misses++;
+    surface = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, format->BitsPerPixel,
+                                   format->Rmask, format->Gmask, 
+                                   format->Bmask, format->Amask);
+    if(surface == NULL)
+    {
+        return NULL;
+    }
+
+    if(pool->numEntries < TI_SURFACE_POOL_MAX_ENTRIES)
+    {
+        pool->entries[pool->numEntries].surface = surface;
+        pool->entries[pool->numEntries].inUse = TI_TRUE;
+        pool->numEntries++;
+    }
+
+    return surface;
+}
+
+/****************************************************************************
+* surfacePoolRelease - see tiSurfacePool.h for description
+****************************************************************************/
+void surfacePoolRelease(TiSurfacePool *pool, SDL_Surface *surface)
+{
+    int counter;
+
+    for(counter=0;counter<pool->numEntries;counter++)
+    {
+        if(pool->entries[counter].surface == surface)
+        {
+            pool->entries[counter].inUse = TI_FALSE;
+            return;
+        }
+    }
+
+    /* Made when the pool was full */
+    SDL_FreeSurface(surface);
+}
+
+/****************************************************************************
+* surfacePoolMatches - see tiSurfacePool.h for description
+****************************************************************************/
+int surfacePoolMatches(SDL_Surface *surface, int w, int h, SDL_PixelFormat *format)
+{
+    if(surface->w == w && surface->h == h &&
+       surface->format->BitsPerPixel == format->BitsPerPixel &&
+       surface->format->Rmask == format->Rmask &&
+       surface->format->Gmask == format->Gmask &&
+       surface->format->Bmask == format->Bmask &&
+       surface->format->Amask == format->Amask)
+    {
+        return TI_TRUE;
+    }
+    return TI_FALSE;
+}
@@ -0,0 +1,167 @@
+/****************************************************************************
+*
+* tiSurfacePool.h - Header for tiSurfacePool.c
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#ifndef __TISURFACEPOOL_H__
+#define __TISURFACEPOOL_H__
+
+/*
+ * The surface pool holds the small surfaces used to save what's on the 
+ * screen behind a dialog or a highlight, so that it can be put back later.
+ * They used to be created every time a dialog was opened or the current
+ * player changed, and in a 32 bit format, so that saving and restoring 
+ * them went through SDL's conversion blitters as well (the screen is 16 
+ * bits).  The pool's surfaces are all made in the display's format, and 
+ * the sizes the game needs are made once, at startup (see 
+ * surfacePoolReserve); after that, acquiring and releasing one just marks
+ * it in use or not.
+ *
+ * A size that wasn't reserved is still made when it's asked for, and kept
+ * for next time.  The number of surfaces made that way is logged (as a
+ * TI_LOG_EVENT_SURFACE_POOL record) when the pool is destroyed, and should
+ * be zero.
+ */
+
+#define TI_SURFACE_POOL_MAX_ENTRIES         16
+
+typedef struct
+{
+    SDL_Surface *surface;
+    int inUse;
+} TiSurfacePoolEntry;
+
+typedef struct
+{
+    TiSurfacePoolEntry entries[TI_SURFACE_POOL_MAX_ENTRIES];
+    int numEntries;
+    /* Statistics */
+    unsigned long acquires;
+    unsigned long misses;
+} TiSurfacePool;
+
+/****************************************************************************
+* surfacePoolInitialize
+*
+* Description:
+*   Creates an empty surface pool.
+*
+* Arguments:
+*   None.
+*
+* Returns:
+*   A pointer to the pool, or NULL if it couldn't be created.
+*
+****************************************************************************/
+TiSurfacePool *surfacePoolInitialize(void);
+
+/****************************************************************************
+* surfacePoolDestroy
+*
+* Description:
+*   Frees every surface in the pool, whether it's in use or not, and the 
+*   pool itself.
+*
+* Arguments:
+*   TiSurfacePool **pool - the pool to destroy (set to NULL)
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void surfacePoolDestroy(TiSurfacePool **pool);
+
+/****************************************************************************
+* surfacePoolReserve
+*
+* Description:
+*   Makes sure the pool has a surface of the given size and format, 
+*   creating one if it doesn't.  Asking for the same size twice only 
+*   makes one surface, so sizes that are in use at the same time have to
+*   be reserved by acquiring them.
+*
+* Arguments:
+*   TiSurfacePool *pool     - the pool
+*   int w, h                - the size of the surface
+*   SDL_PixelFormat *format - the format of the surface (the display's)
+*
+* Returns:
+*   TI_OK, or TI_ERROR if the surface couldn't be created.
+*
+****************************************************************************/
+int surfacePoolReserve(TiSurfacePool *pool, int w, int h, SDL_PixelFormat *format);
+
+/****************************************************************************
+* surfacePoolAcquire
+*
+* Description:
+*   Hands out a surface of the given size and format that isn't in use, 
+*   creating one if there isn't one.  If the pool is full, the new surface
+*   isn't kept, and is freed when it's released.  The surface's contents
+*   are whatever was left in it.
+*
+* Arguments:
+*   TiSurfacePool *pool     - the pool
+*   int w, h                - the size of the surface
+*   SDL_PixelFormat *format - the format of the surface (the display's)
+*
+* Returns:
+*   The surface, or NULL if one couldn't be created.
+*
+****************************************************************************/
+SDL_Surface *surfacePoolAcquire(TiSurfacePool *pool, int w, int h, 
+                                SDL_PixelFormat *format);
+
+/****************************************************************************
+* surfacePoolRelease
+*
+* Description:
+*   Gives a surface handed out by surfacePoolAcquire back to the pool.
+*
+* Arguments:
+*   TiSurfacePool *pool  - the pool
+*   SDL_Surface *surface - the surface
+*
+* Returns:
+*   Nothing.
+*
+****************************************************************************/
+void surfacePoolRelease(TiSurfacePool *pool, SDL_Surface *surface);
+
+/****************************************************************************
+* surfacePoolMatches
+*
+* Description:
+*   Checks whether a surface has the given size and format.
+*
+* Arguments:
+*   SDL_Surface *surface    - the surface
+*   int w, h                - the size 
+*   SDL_PixelFormat *format - the format
+*
+* Returns:
+*   TI_TRUE if it does, TI_FALSE if it doesn't.
+*
+****************************************************************************/
+int surfacePoolMatches(SDL_Surface *surface, int w, int h, SDL_PixelFormat *format);
+
+#endif /* __TISURFACEPOOL_H__ */
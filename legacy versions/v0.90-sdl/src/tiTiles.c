@@ -36,6 +36,7 @@
 #include "tiPlayer.h"
 #include "tiGame.h"
 #include "tiComputerAI.h"
+#include "tiMetrics.h"
 
 /****************************************************************************
  * tilePoolInitialize - see tiTiles.h for description
@@ -249,6 +250,7 @@ int tilePoolDrawRandomTile(TilePool *pool)
     pool->tileStatus[index] = TI_TILE_PLAYED;
     tilePoolCalculatePlayedTiles(pool);
     tilePoolCalculateUnplayedTiles(pool);
+    TI_METRICS_ADD(TI_METRIC_TILE_DRAWS, 1);
 
     return index;
 }
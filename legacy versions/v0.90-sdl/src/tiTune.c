@@ -0,0 +1,492 @@
+/****************************************************************************
+*
+* tiTune.c - tunes the AI evaluation weights by self-play
+*
+* Copyright 2007 Shaun Brandt / Holy Meatgoat Software
+*     <damaniel@damaniel.org>
+*
+* This file is part of TrackInsanity.
+*
+* TrackInsanity is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* TrackInsanity is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with TrackInsanity; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*
+****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <SDL/SDL.h>
+#include "tiMain.h"
+#include "tiTiles.h"
+#include "tiBoard.h"
+#include "tiRenderSDL.h"
+#include "tiCoords.h"
+#include "tiPlayer.h"
+#include "tiGame.h"
+#include "tiComputerAI.h"
+#include "tiSelfPlay.h"
+
+/*
+ * Usage: tiTune [-i iterations] [-g games] [-p players] [-j workers]
+ *               [-s seed] [-f start profile] [-o output profile]
+ *
+ * Searches for better AI evaluation weights with SPSA (simultaneous
+ * perturbation stochastic approximation).  Each iteration, every weight is
+ * nudged up or down at random to make two profiles, and the two play a
+ * match against each other.  Every pair of games uses the same tile order
+ * with the seats swapped, so the match is decided by the weights rather
+ * than by the draw.  The weights then move towards whichever side won, by
+ * an amount that depends on the margin.
+ *
+ * The game engine keeps its state in globals, so the games of a match are
+ * split between worker processes (one per core by default) rather than
+ * threads.  At the end, the tuned profile plays a match against the one
+ * it started from, and the better of the two is written out.  Run from the
+ * bin directory so the data files can be found.
+ */
+
+#define TI_TUNE_DEFAULT_ITERATIONS      100
+#define TI_TUNE_DEFAULT_GAMES           10000
+#define TI_TUNE_DEFAULT_PLAYERS         2
+
+/* SPSA gain sequences: the step size is a / (k + 1 + A)^alpha and the
+   perturbation size is c / (k + 1)^gamma for iteration k.  The margins are
+   measured in points per game. */
+#define TI_TUNE_GAIN_A                  0.05
+#define TI_TUNE_GAIN_STABILITY          10.0
+#define TI_TUNE_GAIN_ALPHA              0.602
+#define TI_TUNE_PERTURB_C               0.2
+#define TI_TUNE_PERTURB_GAMMA           0.101
+
+/* Weights are kept within these bounds */
+#define TI_TUNE_MIN_WEIGHT              0.05
+#define TI_TUNE_MAX_WEIGHT              20.0
+
+#define TI_TUNE_NUM_WEIGHTS             4
+
+/* What each worker sends back to the tuner */
+typedef struct {
+    int games;
+    double margin;
+} TuneResult;
+
+Game *GameInstance;
+
+/****************************************************************************
+* tuneProfileToArray / tuneArrayToProfile
+*
+* Convert between a profile and an array of weights, so that the tuner can
+* treat all of the weights alike.
+****************************************************************************/
+void tuneProfileToArray(AIEvalProfile *p, double *w)
+{
+    w[0] = p->completeTrack;
+    w[1] = p->incompleteTrack;
+    w[2] = p->completeCentralStation;
+    w[3] = p->blockOpponent;
+}
+
+void tuneArrayToProfile(double *w, AIEvalProfile *p)
+{
+    int counter;
+    double clamped[TI_TUNE_NUM_WEIGHTS];
+
+    for(counter=0;counter<TI_TUNE_NUM_WEIGHTS;counter++)
+    {
+        clamped[counter] = w[counter];
+        if(clamped[counter] < TI_TUNE_MIN_WEIGHT)
+        {
+            clamped[counter] = TI_TUNE_MIN_WEIGHT;
+        }
+        if(clamped[counter] > TI_TUNE_MAX_WEIGHT)
+        {
+            clamped[counter] = TI_TUNE_MAX_WEIGHT;
+        }
+    }
+    p->completeTrack = clamped[0];
+    p->incompleteTrack = clamped[1];
+    p->completeCentralStation = clamped[2];
+    p->blockOpponent = clamped[3];
+}
+
+/****************************************************************************
+* tunePlayGames
+*
+* Plays games [firstGame, firstGame+numGames) of a match between two 
+* profiles.  In even numbered games, the even numbered seats play profile
+* a; in odd numbered games, the seats are swapped.  Each pair of games uses
+* the same seed.
+*
+* Returns TI_OK or TI_ERROR, and fills in the number of games played and
+* the total number of points per game that profile a won by.
+****************************************************************************/
+int tunePlayGames(AIEvalProfile *a, AIEvalProfile *b, int numPlayers,
+                  unsigned int seed, int firstGame, int numGames, TuneResult *r)
+{
+    int game, counter, aSeats;
+    int aiLevels[TI_MAX_PLAYERS];
+    double aScore, bScore;
+
+    for(counter=0;counter<TI_MAX_PLAYERS;counter++)
+    {
+        aiLevels[counter] = TI_PLAYER_AI_SMARTEST;
+    }
+
+    r->games = 0;
+    r->margin = 0.0;
+    for(game=firstGame;game<firstGame+numGames;game++)
+    {
+        for(counter=0;counter<numPlayers;counter++)
+        {
+            if((counter + game) % 2 == 0)
+            {
+                computerSetPlayerProfile(counter, a);
+            }
+            else
+            {
+                computerSetPlayerProfile(counter, b);
+            }
+        }
+
+        srand(seed + (game / 2));
+        if(selfPlayInitGame(GameInstance, numPlayers, aiLevels) != TI_OK ||
+           selfPlayPlayGame(GameInstance) < 0)
+        {
+            return TI_ERROR;
+        }
+
+        aScore = 0.0;
+        bScore = 0.0;
+        aSeats = 0;
+        for(counter=0;counter<numPlayers;counter++)
+        {
+            if((counter + game) % 2 == 0)
+            {
+                aScore += GameInstance->players[counter].score;
+                aSeats++;
+            }
+            else
+            {
+                bScore += GameInstance->players[counter].score;
+            }
+        }
+        r->margin += (aScore / aSeats) - (bScore / (numPlayers - aSeats));
+        r->games++;
+    }
+
+    return TI_OK;
+}
+
+/****************************************************************************
+* tunePlayMatch
+*
+* Plays a match between two profiles, split between numWorkers worker 
+* processes.
+*
+* Returns the average number of points per game that profile a won by, or
+* fills in *error if a worker failed.
+****************************************************************************/
+double tunePlayMatch(AIEvalProfile *a, AIEvalProfile *b, int numPlayers,
+                     unsigned int seed, int numGames, int numWorkers, int *error)
+{
+    int counter, firstGame, gamesPerWorker, numGamesForWorker, status;
+    int fds[2];
+    int *readFds;
+    pid_t *pids;
+    TuneResult r, total;
+
+    *error = TI_FALSE;
+    total.games = 0;
+    total.margin = 0.0;
+
+    readFds = malloc(numWorkers * sizeof(int));
+    pids = malloc(numWorkers * sizeof(pid_t));
+    if(readFds == NULL || pids == NULL)
+    {
+        free(readFds);
+        free(pids);
+        *error = TI_TRUE;
+        return 0.0;
+    }
+
+    /* Hand out the games in pairs, so a pair never gets split up */
+    gamesPerWorker = ((numGames / 2 + numWorkers - 1) / numWorkers) * 2;
+    firstGame = 0;
+    for(counter=0;counter<numWorkers;counter++)
+    {
+        readFds[counter] = -1;
+        pids[counter] = -1;
+        numGamesForWorker = gamesPerWorker;
+        if(firstGame + numGamesForWorker > numGames)
+        {
+            numGamesForWorker = numGames - firstGame;
+        }
+        if(numGamesForWorker <= 0)
+        {
+            continue;
+        }
+
+        if(pipe(fds) != 0)
+        {
+            perror("tunePlayMatch: unable to create pipe");
+            *error = TI_TRUE;
+            break;
+        }
+        pids[counter] = fork();
+        if(pids[counter] < 0)
+        {
+            perror("tunePlayMatch: unable to start worker");
+            close(fds[0]);
+            close(fds[1]);
+            *error = TI_TRUE;
+            break;
+        }
+        if(pids[counter] == 0)
+        {
+            /* Worker process */
+            close(fds[0]);
+            if(tunePlayGames(a, b, numPlayers, seed, firstGame, numGamesForWorker, &r) != TI_OK)
+            {
+                _exit(1);
+            }
+            if(write(fds[1], &r, sizeof(TuneResult)) != sizeof(TuneResult))
+            {
+                _exit(1);
+            }
+            _exit(0);
+        }
+        close(fds[1]);
+        readFds[counter] = fds[0];
+        firstGame += numGamesForWorker;
+    }
+
+    for(counter=0;counter<numWorkers;counter++)
+    {
+        if(pids[counter] <= 0)
+        {
+            continue;
+        }
+        if(read(readFds[counter], &r, sizeof(TuneResult)) == sizeof(TuneResult))
+        {
+            total.games += r.games;
+            total.margin += r.margin;
+        }
+        else
+        {
+            *error = TI_TRUE;
+        }
+        close(readFds[counter]);
+        if(waitpid(pids[counter], &status, 0) < 0 || !WIFEXITED(status) ||
+           WEXITSTATUS(status) != 0)
+        {
+            *error = TI_TRUE;
+        }
+    }
+
+    free(readFds);
+    free(pids);
+
+    if(*error == TI_TRUE || total.games == 0)
+    {
+        *error = TI_TRUE;
+        return 0.0;
+    }
+
+    return total.margin / total.games;
+}
+
+/****************************************************************************
+* tunePrintProfile
+****************************************************************************/
+void tunePrintProfile(char *label, AIEvalProfile *p)
+{
+    fprintf(stderr, "%s complete %.3f  incomplete %.3f  central %.3f  block %.3f\n",
+            label, p->completeTrack, p->incompleteTrack,
+            p->completeCentralStation, p->blockOpponent);
+}
+
+int main(int argc, char **argv)
+{
+    int numIterations, numGames, numPlayers, numWorkers;
+    int option, iteration, counter, error;
+    unsigned int seed;
+    char *startFile, *outFile;
+    double theta[TI_TUNE_NUM_WEIGHTS], thetaPlus[TI_TUNE_NUM_WEIGHTS];
+    double thetaMinus[TI_TUNE_NUM_WEIGHTS], delta[TI_TUNE_NUM_WEIGHTS];
+    double stepSize, perturbSize, margin;
+    AIEvalProfile startProfile, plusProfile, minusProfile, tunedProfile;
+    Uint32 startTicks;
+
+    numIterations = TI_TUNE_DEFAULT_ITERATIONS;
+    numGames = TI_TUNE_DEFAULT_GAMES;
+    numPlayers = TI_TUNE_DEFAULT_PLAYERS;
+    numWorkers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    seed = 1;
+    startFile = NULL;
+    outFile = TI_AI_PROFILE_FILE;
+
+    while((option = getopt(argc, argv, "i:g:p:j:s:f:o:")) != -1)
+    {
+        switch(option)
+        {
+            case 'i':
+                numIterations = atoi(optarg);
+                break;
+            case 'g':
+                numGames = atoi(optarg);
+                break;
+            case 'p':
+                numPlayers = atoi(optarg);
+                break;
+            case 'j':
+                numWorkers = atoi(optarg);
+                break;
+            case 's':
+                seed = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'f':
+                startFile = optarg;
+                break;
+            case 'o':
+                outFile = optarg;
+                break;
+            default:
+                numIterations = 0;
+                break;
+        }
+    }
+    if(numWorkers <= 0)
+    {
+        numWorkers = 1;
+    }
+    if(numIterations <= 0 || numGames < 2 || numPlayers < TI_MIN_PLAYERS ||
+       numPlayers > TI_MAX_PLAYERS)
+    {
+        fprintf(stderr, "Usage: %s [-i iterations] [-g games] [-p players (%d-%d)] "
+                "[-j workers] [-s seed] [-f start profile] [-o output profile]\n",
+                argv[0], TI_MIN_PLAYERS, TI_MAX_PLAYERS);
+        return 1;
+    }
+    /* Games are played in pairs */
+    numGames += numGames % 2;
+
+    if(SDL_Init(SDL_INIT_TIMER) < 0)
+    {
+        perror("Unable to initialize SDL timer");
+        return 1;
+    }
+
+    GameInstance = gameInitialize(TI_TILE_DATA_FILE, TI_STATION_DATA_FILE);
+    if(GameInstance == NULL)
+    {
+        perror("Unable to initialize Game structure");
+        SDL_Quit();
+        return 1;
+    }
+
+    if(startFile != NULL)
+    {
+        if(computerProfileLoad(&startProfile, startFile) != TI_OK)
+        {
+            perror("Unable to load starting profile");
+            gameDestroy(&GameInstance);
+            SDL_Quit();
+            return 1;
+        }
+    }
+    else
+    {
+        computerProfileSetDefaults(&startProfile);
+    }
+    tuneProfileToArray(&startProfile, theta);
+
+    fprintf(stderr, "tuning with %d games per iteration on %d workers\n",
+            numGames, numWorkers);
+    tunePrintProfile("start:    ", &startProfile);
+
+    srand(seed);
+    for(iteration=0;iteration<numIterations;iteration++)
+    {
+        startTicks = SDL_GetTicks();
+        stepSize = TI_TUNE_GAIN_A /
+                   pow(iteration + 1 + TI_TUNE_GAIN_STABILITY, TI_TUNE_GAIN_ALPHA);
+        perturbSize = TI_TUNE_PERTURB_C / pow(iteration + 1, TI_TUNE_PERTURB_GAMMA);
+
+        for(counter=0;counter<TI_TUNE_NUM_WEIGHTS;counter++)
+        {
+            delta[counter] = (rand() % 2 == 0) ? 1.0 : -1.0;
+            thetaPlus[counter] = theta[counter] + perturbSize * delta[counter];
+            thetaMinus[counter] = theta[counter] - perturbSize * delta[counter];
+        }
+        tuneArrayToProfile(thetaPlus, &plusProfile);
+        tuneArrayToProfile(thetaMinus, &minusProfile);
+
+        margin = tunePlayMatch(&plusProfile, &minusProfile, numPlayers,
+                               seed + iteration * numGames, numGames, numWorkers, &error);
+        if(error == TI_TRUE)
+        {
+            perror("Self-play match failed");
+            gameDestroy(&GameInstance);
+            SDL_Quit();
+            return 1;
+        }
+
+        /* The margin estimates the difference in strength between the two
+           profiles, so it's used directly as the gradient estimate */
+        for(counter=0;counter<TI_TUNE_NUM_WEIGHTS;counter++)
+        {
+            theta[counter] += stepSize * margin / (2.0 * perturbSize * delta[counter]);
+        }
+        tuneArrayToProfile(theta, &tunedProfile);
+        tuneProfileToArray(&tunedProfile, theta);
+
+        fprintf(stderr, "iteration %4d: margin %+7.3f (%u ms)\n", iteration + 1,
+                margin, (unsigned int)(SDL_GetTicks() - startTicks));
+        tunePrintProfile("          ", &tunedProfile);
+    }
+
+    /* Only keep the tuned weights if they actually beat the starting ones */
+    margin = tunePlayMatch(&tunedProfile, &startProfile, numPlayers,
+                           seed + numIterations * numGames, numGames, numWorkers, &error);
+    if(error == TI_TRUE)
+    {
+        perror("Self-play match failed");
+        gameDestroy(&GameInstance);
+        SDL_Quit();
+        return 1;
+    }
+    fprintf(stderr, "tuned vs. start: margin %+.3f points per game\n", margin);
+    if(margin <= 0.0)
+    {
+        tunedProfile = startProfile;
+    }
+    tunePrintProfile("best:     ", &tunedProfile);
+
+    if(computerProfileSave(&tunedProfile, outFile) != TI_OK)
+    {
+        gameDestroy(&GameInstance);
+        SDL_Quit();
+        return 1;
+    }
+    fprintf(stderr, "wrote %s\n", outFile);
+
+    gameDestroy(&GameInstance);
+    SDL_Quit();
+    return 0;
+}